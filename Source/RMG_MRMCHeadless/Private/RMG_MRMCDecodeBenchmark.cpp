@@ -0,0 +1,95 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+
+// Decoding takes a few nanoseconds, far less than a cycle counter read, so datagrams are timed in
+// batches and each batch records its mean per datagram
+static const int32 DecodeBenchmarkBatch = 1024;
+
+struct FRMG_MRMCDecodeBenchmarkDatagram
+{
+	int32 Size;
+	uint8 Data[RMG_MRMCPacketLayout::FRelayHeader::Size + RMG_MRMCPacketDecoder::MaxPacketSize];
+};
+
+// Strips any relay header and decodes every datagram; returns a checksum of the decoded samples so the
+// work cannot be optimised away
+static float RunDecodeScenario(const TCHAR* Name, const TArray<FRMG_MRMCDecodeBenchmarkDatagram>& Datagrams)
+{
+	FRMG_MRMCLatencyHistogram PerDatagram;
+	FRMG_MRMCDecodedPacket Packet;
+	float Checksum = 0.0f;
+	int32 NumRejected = 0;
+	double Seconds = 0.0;
+
+	for (int32 First = 0; First < Datagrams.Num(); First += DecodeBenchmarkBatch)
+	{
+		const int32 Last = FMath::Min(First + DecodeBenchmarkBatch, Datagrams.Num());
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Idx = First; Idx < Last; Idx++)
+		{
+			const uint8* Data = Datagrams[Idx].Data;
+			int32 Size = Datagrams[Idx].Size;
+			int64 ReceiveUnixNs;
+			RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, ReceiveUnixNs);
+			if (RMG_MRMCPacketDecoder::Decode(Data, Size, Packet))
+			{
+				Checksum += Packet.Robot.xv + Packet.Robot.zoom;
+			}
+			else
+			{
+				NumRejected++;
+			}
+		}
+		const double BatchSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		PerDatagram.RecordSeconds(BatchSeconds / (Last - First));
+		Seconds += BatchSeconds;
+	}
+
+	RMG_MRMCHeadless::LogResult(Name, Datagrams.Num(), Seconds, PerDatagram);
+	if (NumRejected > 0)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Warning, TEXT("%s: %d datagrams rejected"), Name, NumRejected);
+	}
+	return Checksum;
+}
+
+void RMG_MRMCBenchmark::RunDecode(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Decode: relay header check and decode only, per-datagram times are batch means"));
+
+	const int32 NumDatagrams = 1000000 * Scale;
+	const ERMG_MRMCPacketVariant Variants[] = { ERMG_MRMCPacketVariant::Basic, ERMG_MRMCPacketVariant::FrameCounter, ERMG_MRMCPacketVariant::Timecode };
+	const TCHAR* const Names[] = { TEXT("decode 36 byte"), TEXT("decode 40 byte"), TEXT("decode 44 byte") };
+
+	TArray<FRMG_MRMCDecodeBenchmarkDatagram> Datagrams;
+	Datagrams.SetNumUninitialized(NumDatagrams);
+	float Checksum = 0.0f;
+	for (int32 VariantIdx = 0; VariantIdx < UE_ARRAY_COUNT(Variants); VariantIdx++)
+	{
+		for (int32 Idx = 0; Idx < NumDatagrams; Idx++)
+		{
+			Datagrams[Idx].Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Idx / 50.0, Idx, Variants[VariantIdx]), Datagrams[Idx].Data);
+		}
+		Checksum += RunDecodeScenario(Names[VariantIdx], Datagrams);
+	}
+
+	// every size in turn, every other datagram relayed, so neither the size switch nor the strip is predictable
+	for (int32 Idx = 0; Idx < NumDatagrams; Idx++)
+	{
+		FRMG_MRMCDecodeBenchmarkDatagram& Datagram = Datagrams[Idx];
+		const FRMG_MRMCDecodedPacket Packet = RMG_MRMCHeadless::MakeOrbitSample(Idx / 50.0, Idx, Variants[Idx % 3]);
+		if (Idx % 2 == 0)
+		{
+			RMG_MRMCPacketDecoder::WriteRelayHeader(Idx * 20000000ll, Datagram.Data);
+			Datagram.Size = RMG_MRMCPacketLayout::FRelayHeader::Size + RMG_MRMCPacketDecoder::Encode(Packet, Datagram.Data + RMG_MRMCPacketLayout::FRelayHeader::Size);
+		}
+		else
+		{
+			Datagram.Size = RMG_MRMCPacketDecoder::Encode(Packet, Datagram.Data);
+		}
+	}
+	Checksum += RunDecodeScenario(TEXT("decode mixed, half relayed"), Datagrams);
+
+	UE_LOG(LogRMG_MRMCHeadless, Verbose, TEXT("Decode checksum %f"), Checksum);
+}
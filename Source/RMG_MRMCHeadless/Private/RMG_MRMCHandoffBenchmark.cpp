@@ -0,0 +1,343 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCPacketMailbox.h"
+#include "RMG_MRMCPacketRing.h"
+#include "RMG_MRMCSubjectMapping.h"
+#include "Containers/Queue.h"
+#include "Misc/App.h"
+#include <atomic>
+
+// Engine tick rate of the mailbox comparison, and the hitches: every second one tick takes 100 ms, and once
+// a tick takes longer than the packet ring holds at 1 kHz
+static const double MailboxTickSeconds = 1.0 / 60.0;
+static const double MailboxHitchSeconds = 0.1;
+static const double MailboxLongHitchSeconds = 0.3;
+
+// A datagram handed off the way the receive thread did before the packet ring: a heap copy per datagram
+// through a linked queue, one node allocation plus one buffer allocation each
+struct FRMG_MRMCQueuedDatagram
+{
+	double QueuedSeconds = 0.0;
+	TArray<uint8> Data;
+};
+
+// Runs Produce on a producer thread NumPackets times, IntervalSeconds apart (0 for as fast as it goes),
+// retrying while it returns false, and Consume on this thread until every packet arrived. Consume returns
+// the queue time and index of the packet it took, or false when there was none. Logs the throughput and
+// the handoff latency from queueing to consumption.
+static void RunHandoffScenario(const TCHAR* Name, uint32 NumPackets, double IntervalSeconds,
+	TFunctionRef<bool(uint32 Index, double QueuedSeconds)> Produce, TFunctionRef<bool(double& OutQueuedSeconds, uint32& OutIndex)> Consume)
+{
+	FRMG_MRMCLatencyHistogram Latency;
+	uint64 NumRetries = 0;
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	FRMG_MRMCBenchmarkThread Producer(TEXT("RMG_MRMCHandoffProducer"), [&Produce, &NumRetries, NumPackets, IntervalSeconds, StartSeconds]()
+	{
+		for (uint32 Idx = 0; Idx < NumPackets; Idx++)
+		{
+			if (IntervalSeconds > 0.0)
+			{
+				const double Due = StartSeconds + Idx * IntervalSeconds;
+				while (FPlatformTime::Seconds() < Due)
+				{
+				}
+			}
+			while (!Produce(Idx, FPlatformTime::Seconds()))
+			{
+				NumRetries++;
+				FPlatformProcess::Yield();
+			}
+		}
+	});
+
+	uint32 NextIndex = 0;
+	uint32 NumOutOfOrder = 0;
+	while (NextIndex < NumPackets)
+	{
+		double QueuedSeconds;
+		uint32 Index;
+		if (!Consume(QueuedSeconds, Index))
+		{
+			FPlatformProcess::Yield();
+			continue;
+		}
+		Latency.RecordSeconds(FPlatformTime::Seconds() - QueuedSeconds);
+		NumOutOfOrder += Index != NextIndex;
+		NextIndex++;
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+	Producer.WaitForCompletion();
+
+	RMG_MRMCHeadless::LogResult(Name, NumPackets, Seconds, Latency);
+	if (NumRetries > 0 || NumOutOfOrder > 0)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu pushes into a full ring retried, %u packets out of order"), TEXT(""), NumRetries, NumOutOfOrder);
+	}
+}
+
+void RMG_MRMCBenchmark::RunHandoff(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Handoff: receive thread to consumer, 40 byte datagrams, latency from queueing to consumption"));
+
+	uint8 Datagram[RMG_MRMCPacketDecoder::MaxPacketSize];
+	const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(1.0, 50, ERMG_MRMCPacketVariant::FrameCounter), Datagram);
+
+	struct FScenario
+	{
+		const TCHAR* RingName;
+		const TCHAR* QueueName;
+		uint32 NumPackets;
+		double IntervalSeconds;
+	};
+	const FScenario Scenarios[] =
+	{
+		{ TEXT("ring, 1 kHz"), TEXT("allocating queue, 1 kHz"), 2000u * Scale, 0.001 },
+		{ TEXT("ring, 20 kHz"), TEXT("allocating queue, 20 kHz"), 20000u * Scale, 0.00005 },
+		{ TEXT("ring, saturated"), TEXT("allocating queue, saturated"), 1000000u * Scale, 0.0 },
+	};
+
+	for (const FScenario& Scenario : Scenarios)
+	{
+		// the ring size the source uses
+		FRMG_MRMCPacketRing Ring(256);
+		RunHandoffScenario(Scenario.RingName, Scenario.NumPackets, Scenario.IntervalSeconds,
+			[&Ring, &Datagram, Size](uint32 Index, double QueuedSeconds)
+			{
+				uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+				FMemory::Memcpy(Data, Datagram, Size);
+				RMG_MRMCPacketLayout::TField<uint32, 0>::Write(Index, Data);
+				return Ring.Push(0, Data, Size, QueuedSeconds, QueuedSeconds);
+			},
+			[&Ring](double& OutQueuedSeconds, uint32& OutIndex)
+			{
+				const FRMG_MRMCPacket* Packet = Ring.Peek();
+				if (Packet == nullptr)
+				{
+					return false;
+				}
+				OutQueuedSeconds = Packet->QueuedSeconds;
+				OutIndex = RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Packet->Data);
+				Ring.Pop();
+				return true;
+			});
+
+		TQueue<FRMG_MRMCQueuedDatagram, EQueueMode::Mpsc> Queue;
+		RunHandoffScenario(Scenario.QueueName, Scenario.NumPackets, Scenario.IntervalSeconds,
+			[&Queue, &Datagram, Size](uint32 Index, double QueuedSeconds)
+			{
+				FRMG_MRMCQueuedDatagram Queued;
+				Queued.QueuedSeconds = QueuedSeconds;
+				Queued.Data.Append(Datagram, Size);
+				RMG_MRMCPacketLayout::TField<uint32, 0>::Write(Index, Queued.Data.GetData());
+				return Queue.Enqueue(MoveTemp(Queued));
+			},
+			[&Queue](double& OutQueuedSeconds, uint32& OutIndex)
+			{
+				FRMG_MRMCQueuedDatagram Queued;
+				if (!Queue.Dequeue(Queued))
+				{
+					return false;
+				}
+				OutQueuedSeconds = Queued.QueuedSeconds;
+				OutIndex = RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Queued.Data.GetData());
+				return true;
+			});
+	}
+}
+
+// Publishes 1 kHz datagrams from a producer thread while this thread ticks like the engine for RunSeconds,
+// with hitches, calling Tick once per tick. Tick processes whatever it takes from the handoff and returns
+// the queue time of the newest datagram it processed, or 0. Logs the age of that datagram when the tick is
+// done, which is how old the pose LiveLink shows for the next frame is, and the processing time per tick.
+static void RunConsumerTickScenario(const TCHAR* Name, double RunSeconds, TFunctionRef<void(const uint8* Data, int32 Size, double QueuedSeconds)> Publish,
+	TFunctionRef<double()> Tick)
+{
+	std::atomic<bool> bStop(false);
+	const double StartSeconds = FPlatformTime::Seconds();
+	FRMG_MRMCBenchmarkThread Producer(TEXT("RMG_MRMCMailboxProducer"), [&Publish, &bStop, StartSeconds]()
+	{
+		for (uint32 Idx = 0; !bStop.load(std::memory_order_relaxed); Idx++)
+		{
+			const double Due = StartSeconds + Idx * 0.001;
+			while (FPlatformTime::Seconds() < Due)
+			{
+				FPlatformProcess::Yield();
+			}
+			uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+			const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Idx * 0.001, Idx, ERMG_MRMCPacketVariant::FrameCounter), Data);
+			Publish(Data, Size, FPlatformTime::Seconds());
+		}
+	});
+
+	FRMG_MRMCLatencyHistogram Age;
+	FRMG_MRMCLatencyHistogram TickCost;
+	const int32 NumTicks = FMath::CeilToInt(RunSeconds / MailboxTickSeconds);
+	for (int32 TickIdx = 0; TickIdx < NumTicks; TickIdx++)
+	{
+		double Remaining = StartSeconds + (TickIdx + 1) * MailboxTickSeconds - FPlatformTime::Seconds();
+		if (TickIdx == 150)
+		{
+			Remaining = FMath::Max(Remaining, MailboxLongHitchSeconds);
+		}
+		else if (TickIdx % 60 == 30)
+		{
+			Remaining = FMath::Max(Remaining, MailboxHitchSeconds);
+		}
+		if (Remaining > 0.0)
+		{
+			FPlatformProcess::Sleep(static_cast<float>(Remaining));
+		}
+
+		const double TickStart = FPlatformTime::Seconds();
+		const double NewestQueuedSeconds = Tick();
+		const double TickEnd = FPlatformTime::Seconds();
+		TickCost.RecordSeconds(TickEnd - TickStart);
+		if (NewestQueuedSeconds > 0.0)
+		{
+			Age.RecordSeconds(TickEnd - NewestQueuedSeconds);
+		}
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+	bStop.store(true, std::memory_order_relaxed);
+	Producer.WaitForCompletion();
+
+	RMG_MRMCHeadless::LogResult(Name, Age.GetCount(), Seconds, Age);
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s processing per tick mean %6.0f ns  p99 %7llu  max %8llu ns"),
+		TEXT(""), TickCost.GetMean(), TickCost.GetPercentile(99.0), TickCost.GetMax());
+}
+
+void RMG_MRMCBenchmark::RunMailbox(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Mailbox: 1 kHz stream, 32-subject mapping, consumer ticking at 60 Hz with %.0f ms hitches every second and one of %.0f ms; age of the newest processed datagram per tick"),
+		MailboxHitchSeconds * 1000.0, MailboxLongHitchSeconds * 1000.0);
+
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	verify(FRMG_MRMCCompiledMapping::Compile(RMG_MRMCHeadless::MakeStressMappingJson(32), Mapping, Error));
+	FApp::SetTimecodeFrameRate(FFrameRate(60, 1));
+	const double RunSeconds = 5.0 * Scale;
+
+	{
+		FRMG_MRMCPacketMailbox Mailbox;
+		FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+		FRMG_MRMCCaptureFrameSink Sink;
+		uint64 NumProcessed = 0;
+		RunConsumerTickScenario(TEXT("mailbox"), RunSeconds,
+			[&Mailbox](const uint8* Data, int32 Size, double QueuedSeconds)
+			{
+				Mailbox.Publish(0, Data, Size, QueuedSeconds, QueuedSeconds);
+			},
+			[&Mailbox, &Processor, &Sink, &NumProcessed]()
+			{
+				Sink.Frames.Reset();
+				FRMG_MRMCPacket Packet;
+				uint32 Superseded;
+				if (!Mailbox.Read(Packet, Superseded))
+				{
+					return 0.0;
+				}
+				Processor.AddSuperseded(Superseded);
+				Processor.ProcessPacket(Packet.Data, Packet.GetPayloadSize(), Packet.ReceiveSeconds, Sink);
+				NumProcessed++;
+				return Packet.QueuedSeconds;
+			});
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu datagrams processed, %llu superseded"), TEXT(""), NumProcessed, Mailbox.GetSupersededCount());
+	}
+
+	{
+		// the ring size the source uses, drained every tick as in GameThread mode
+		FRMG_MRMCPacketRing Ring(256);
+		FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+		FRMG_MRMCCaptureFrameSink Sink;
+		uint64 NumProcessed = 0;
+		RunConsumerTickScenario(TEXT("queued ring, drained per tick"), RunSeconds,
+			[&Ring](const uint8* Data, int32 Size, double QueuedSeconds)
+			{
+				Ring.Push(0, Data, Size, QueuedSeconds, QueuedSeconds);
+			},
+			[&Ring, &Processor, &Sink, &NumProcessed]()
+			{
+				Sink.Frames.Reset();
+				double NewestQueuedSeconds = 0.0;
+				while (const FRMG_MRMCPacket* Packet = Ring.Peek())
+				{
+					Processor.ProcessPacket(Packet->Data, Packet->GetPayloadSize(), Packet->ReceiveSeconds, Sink);
+					NewestQueuedSeconds = Packet->QueuedSeconds;
+					NumProcessed++;
+					Ring.Pop();
+				}
+				return NewestQueuedSeconds;
+			});
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu datagrams processed, %llu dropped on overflow"), TEXT(""), NumProcessed, Ring.GetOverflowCount());
+	}
+}
+
+void RMG_MRMCBenchmark::RunPushLatency(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Push latency: 1 kHz stream, built-in mapping, consumer ticking at 60 Hz with %.0f ms hitches every second and one of %.0f ms; age of the newest pushed datagram per tick, then latency from receive to push"),
+		MailboxHitchSeconds * 1000.0, MailboxLongHitchSeconds * 1000.0);
+
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	verify(FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error));
+	FApp::SetTimecodeFrameRate(FFrameRate(60, 1));
+	const double RunSeconds = 5.0 * Scale;
+
+	{
+		// GameThread mode: the receive thread queues, the engine tick drains the ring and pushes
+		FRMG_MRMCPacketRing Ring(256);
+		FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+		FRMG_MRMCCaptureFrameSink Sink;
+		FRMG_MRMCLatencyHistogram ReceiveToPush;
+		RunConsumerTickScenario(TEXT("GameThread mode"), RunSeconds,
+			[&Ring](const uint8* Data, int32 Size, double QueuedSeconds)
+			{
+				Ring.Push(0, Data, Size, QueuedSeconds, QueuedSeconds);
+			},
+			[&Ring, &Processor, &Sink, &ReceiveToPush]()
+			{
+				double NewestQueuedSeconds = 0.0;
+				while (const FRMG_MRMCPacket* Packet = Ring.Peek())
+				{
+					Sink.Frames.Reset();
+					Processor.ProcessPacket(Packet->Data, Packet->GetPayloadSize(), Packet->ReceiveSeconds, Sink);
+					if (Sink.Frames.Num() > 0)
+					{
+						ReceiveToPush.RecordSeconds(FPlatformTime::Seconds() - Packet->ReceiveSeconds);
+						NewestQueuedSeconds = Packet->QueuedSeconds;
+					}
+					Ring.Pop();
+				}
+				return NewestQueuedSeconds;
+			});
+		RMG_MRMCHeadless::LogResult(TEXT("GameThread mode, receive to push"), ReceiveToPush.GetCount(), RunSeconds, ReceiveToPush);
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu dropped on overflow"), TEXT(""), Ring.GetOverflowCount());
+	}
+
+	{
+		// ReceiveThread mode: the receive thread pushes as each datagram arrives, the tick only reads what is newest
+		FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+		FRMG_MRMCCaptureFrameSink Sink;
+		FRMG_MRMCLatencyHistogram ReceiveToPush;
+		std::atomic<double> NewestPushedSeconds(0.0);
+		RunConsumerTickScenario(TEXT("ReceiveThread mode"), RunSeconds,
+			[&Processor, &Sink, &ReceiveToPush, &NewestPushedSeconds](const uint8* Data, int32 Size, double QueuedSeconds)
+			{
+				Sink.Frames.Reset();
+				Processor.ProcessPacket(Data, Size, QueuedSeconds, Sink);
+				if (Sink.Frames.Num() > 0)
+				{
+					ReceiveToPush.RecordSeconds(FPlatformTime::Seconds() - QueuedSeconds);
+					NewestPushedSeconds.store(QueuedSeconds);
+				}
+			},
+			[&NewestPushedSeconds]()
+			{
+				return NewestPushedSeconds.exchange(0.0);
+			});
+		RMG_MRMCHeadless::LogResult(TEXT("ReceiveThread mode, receive to push"), ReceiveToPush.GetCount(), RunSeconds, ReceiveToPush);
+	}
+}
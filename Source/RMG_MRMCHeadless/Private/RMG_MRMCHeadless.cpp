@@ -0,0 +1,200 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RequiredProgramMainCPPInclude.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY(LogRMG_MRMCHeadless);
+
+IMPLEMENT_APPLICATION(RMG_MRMCHeadless, "RMG_MRMCHeadless");
+
+FRMG_MRMCBenchmarkThread::FRMG_MRMCBenchmarkThread(const TCHAR* Name, TFunction<void()> InBody, EThreadPriority Priority, uint64 AffinityMask)
+: Body(MoveTemp(InBody))
+, Thread(nullptr)
+{
+	Thread = FRunnableThread::Create(this, Name, 0, Priority, AffinityMask);
+}
+
+FRMG_MRMCBenchmarkThread::~FRMG_MRMCBenchmarkThread()
+{
+	WaitForCompletion();
+}
+
+void FRMG_MRMCBenchmarkThread::WaitForCompletion()
+{
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FRMG_MRMCBenchmarkThread::Run()
+{
+	Body();
+	return 0;
+}
+
+FRMG_MRMCDecodedPacket RMG_MRMCHeadless::MakeOrbitSample(double Seconds, uint32 FrameCounter, ERMG_MRMCPacketVariant Variant, double Phase)
+{
+	const double T = Seconds + Phase;
+
+	FRMG_MRMCDecodedPacket Packet;
+	Packet.Variant = Variant;
+	Packet.FrameCounter = FrameCounter;
+	Packet.Robot.xv = static_cast<float>(3.0 * FMath::Cos(2.0 * DOUBLE_PI * T / 10.0));
+	Packet.Robot.yv = static_cast<float>(3.0 * FMath::Sin(2.0 * DOUBLE_PI * T / 10.0));
+	Packet.Robot.zv = 1.6f;
+	Packet.Robot.zt = 1.2f;
+	Packet.Robot.roll = static_cast<float>(0.05 * FMath::Sin(2.0 * DOUBLE_PI * T / 7.0));
+	Packet.Robot.focus = static_cast<float>(32767.5 + 32767.5 * FMath::Sin(2.0 * DOUBLE_PI * T / 15.0));
+	Packet.Robot.zoom = static_cast<float>(32767.5 + 32767.5 * FMath::Sin(2.0 * DOUBLE_PI * T / 20.0));
+
+	// 50 fps timecode counted from the sample time
+	const uint32 Frames = static_cast<uint32>(Seconds * 50.0);
+	Packet.Timecode = (Frames / 180000 % 24) << 24 | (Frames / 3000 % 60) << 16 | (Frames / 50 % 60) << 8 | (Frames % 50);
+	return Packet;
+}
+
+FString RMG_MRMCHeadless::MakeStressMappingJson(int32 NumSubjects)
+{
+	FString Json = TEXT("{ \"sources\": [");
+	for (int32 SubjectIdx = 0; SubjectIdx < NumSubjects; SubjectIdx++)
+	{
+		Json += FString::Printf(TEXT("%s{ \"subject\": \"rig_%d\", \"properties\": [\"Focus\", \"Zoom\"], \"propertyIndex\": [7, 8], \"bones\": ["
+			"{ \"name\": \"root\", \"parent\": \"\", \"index\": [-1, -1, -1, -1, -1, -1] },"
+			"{ \"name\": \"camera\", \"parent\": \"root\", \"index\": [0, 1, 2, 6, 4, 5] },"
+			"{ \"name\": \"lens\", \"parent\": \"camera\", \"index\": [0, 1, 2, 3, 4, 5] },"
+			"{ \"name\": \"target\", \"parent\": \"root\", \"index\": [9, 10, 11, -1, -1, -1] }] }"),
+			SubjectIdx > 0 ? TEXT(",") : TEXT(""), SubjectIdx);
+	}
+	Json += TEXT("] }");
+	return Json;
+}
+
+void RMG_MRMCHeadless::LogResult(const TCHAR* Name, uint64 Count, double Seconds, const FRMG_MRMCLatencyHistogram& PerItem)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu in %8.1f ms  %12.0f /s  mean %7.0f ns  p50 %6llu  p90 %6llu  p99 %6llu  p99.9 %7llu  max %8llu ns"),
+		Name, Count, Seconds * 1000.0, Seconds > 0.0 ? Count / Seconds : 0.0, PerItem.GetMean(),
+		PerItem.GetPercentile(50.0), PerItem.GetPercentile(90.0), PerItem.GetPercentile(99.0), PerItem.GetPercentile(99.9), PerItem.GetMax());
+}
+
+// Runs the RMG_MRMC automation tests whose name contains Filter and returns how many failed
+static int32 RunTests(const FString& Filter)
+{
+	FAutomationTestFramework& Framework = FAutomationTestFramework::Get();
+	Framework.SetRequestedTestFilter(EAutomationTestFlags::EngineFilter);
+
+	TArray<FAutomationTestInfo> TestInfos;
+	Framework.GetValidTestNames(TestInfos);
+
+	int32 NumRun = 0;
+	int32 NumFailed = 0;
+	for (const FAutomationTestInfo& TestInfo : TestInfos)
+	{
+		const FString DisplayName = TestInfo.GetDisplayName();
+		if (!DisplayName.StartsWith(TEXT("RMG_MRMC.")) || (!Filter.IsEmpty() && !DisplayName.Contains(Filter)))
+		{
+			continue;
+		}
+
+		Framework.StartTestByName(TestInfo.GetTestName(), 0);
+		FAutomationTestExecutionInfo ExecutionInfo;
+		const bool bPassed = Framework.StopTest(ExecutionInfo);
+		NumRun++;
+
+		for (const FAutomationExecutionEntry& Entry : ExecutionInfo.GetEntries())
+		{
+			if (Entry.Event.Type == EAutomationEventType::Error)
+			{
+				UE_LOG(LogRMG_MRMCHeadless, Error, TEXT("%s: %s"), *DisplayName, *Entry.ToString());
+			}
+			else if (Entry.Event.Type == EAutomationEventType::Info)
+			{
+				UE_LOG(LogRMG_MRMCHeadless, Log, TEXT("%s: %s"), *DisplayName, *Entry.ToString());
+			}
+		}
+		if (!bPassed)
+		{
+			NumFailed++;
+		}
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%s %s"), bPassed ? TEXT("passed") : TEXT("FAILED"), *DisplayName);
+	}
+
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%d of %d tests passed"), NumRun - NumFailed, NumRun);
+	return NumFailed;
+}
+
+// -Test[=Filter] runs the automation tests, -Bench the decode, kernel, lens, handoff, shared memory, relay, mailbox, push latency, mapping and realistic and -Stress the scaling, stress, jitter and recording benchmarks, -Scale=N
+// multiplies the benchmark lengths. Without arguments the tests and the realistic benchmarks run.
+// -EvaluatePredictor=<take> reports the prediction error over stream -Stream=N (0) of a take, predicting
+// -Lead=<ms> (40) ahead with -ProcessNoise= and -MeasurementNoise= as in the source settings.
+// Exits with 1 when a test failed or the take could not be read.
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	GEngineLoop.PreInit(ArgC, ArgV);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FString TestFilter;
+	bool bTest = FParse::Value(CommandLine, TEXT("Test="), TestFilter) || FParse::Param(CommandLine, TEXT("Test"));
+	bool bBench = FParse::Param(CommandLine, TEXT("Bench"));
+	const bool bStress = FParse::Param(CommandLine, TEXT("Stress"));
+	FString TakeFile;
+	const bool bEvaluatePredictor = FParse::Value(CommandLine, TEXT("EvaluatePredictor="), TakeFile);
+	if (!bTest && !bBench && !bStress && !bEvaluatePredictor)
+	{
+		bTest = bBench = true;
+	}
+
+	int32 Scale = 1;
+	FParse::Value(CommandLine, TEXT("Scale="), Scale);
+	Scale = FMath::Max(Scale, 1);
+
+	int32 NumFailed = 0;
+	if (bTest)
+	{
+		NumFailed = RunTests(TestFilter);
+	}
+	if (bBench)
+	{
+		RMG_MRMCBenchmark::RunDecode(Scale);
+		RMG_MRMCBenchmark::RunKernel(Scale);
+		RMG_MRMCBenchmark::RunLens(Scale);
+		RMG_MRMCBenchmark::RunHandoff(Scale);
+		RMG_MRMCBenchmark::RunSharedMemory(Scale);
+		RMG_MRMCBenchmark::RunRelay(Scale);
+		RMG_MRMCBenchmark::RunMailbox(Scale);
+		RMG_MRMCBenchmark::RunPushLatency(Scale);
+		RMG_MRMCBenchmark::RunMapping(Scale);
+		RMG_MRMCBenchmark::RunRealistic(Scale);
+	}
+	if (bStress)
+	{
+		RMG_MRMCBenchmark::RunScaling(Scale);
+		RMG_MRMCBenchmark::RunStress(Scale);
+		RMG_MRMCBenchmark::RunJitter(Scale);
+		RMG_MRMCBenchmark::RunRecording(Scale);
+	}
+	if (bEvaluatePredictor)
+	{
+		FRMG_MRMCProcessingOptions Options;
+		Options.PredictionLeadMs = 40.0f;
+		FParse::Value(CommandLine, TEXT("Lead="), Options.PredictionLeadMs);
+		FParse::Value(CommandLine, TEXT("ProcessNoise="), Options.PredictionProcessNoise);
+		FParse::Value(CommandLine, TEXT("MeasurementNoise="), Options.PredictionMeasurementNoise);
+		int32 Stream = 0;
+		FParse::Value(CommandLine, TEXT("Stream="), Stream);
+		if (!RMG_MRMCBenchmark::RunPredictorEvaluation(TakeFile, Stream, Options))
+		{
+			NumFailed++;
+		}
+	}
+
+	FEngineLoop::AppPreExit();
+	FEngineLoop::AppExit();
+	return NumFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCPacketDecoder.h"
+#include "RMG_MRMCStats.h"
+#include "RMG_MRMCStreamProcessor.h"
+#include "HAL/PlatformAffinity.h"
+#include "HAL/Runnable.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogRMG_MRMCHeadless, Log, All);
+
+// One accepted sample of a take, converted to channels
+struct FRMG_MRMCTakeSample
+{
+	double Seconds;
+	float Values[RMG_MRMCChannel::Num];
+};
+
+// Error of the predictor against what the robot reported at each predicted time, per channel. Held is the
+// error of pushing the newest sample unpredicted, the baseline prediction has to beat.
+struct FRMG_MRMCPredictionError
+{
+	int32 NumScored = 0;
+	float PredictedRms[RMG_MRMCChannel::Num] = {};
+	float HeldRms[RMG_MRMCChannel::Num] = {};
+	float PredictedMax[RMG_MRMCChannel::Num] = {};
+};
+
+// One received datagram, encoded up front so only processing is timed
+struct FRMG_MRMCBenchmarkDatagram
+{
+	double ReceiveSeconds;
+	int32 Stream;
+	int32 Size;
+	uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+};
+
+// Runs Body on a thread of its own from construction, for the producer side of handoff tests and benchmarks,
+// at Priority on the cores of AffinityMask
+class FRMG_MRMCBenchmarkThread : public FRunnable
+{
+public:
+
+	FRMG_MRMCBenchmarkThread(const TCHAR* Name, TFunction<void()> InBody, EThreadPriority Priority = TPri_Normal, uint64 AffinityMask = FPlatformAffinity::GetNoAffinityMask());
+	virtual ~FRMG_MRMCBenchmarkThread();
+
+	// Returns once Body has returned
+	void WaitForCompletion();
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	// End FRunnable Interface
+
+private:
+
+	TFunction<void()> Body;
+	class FRunnableThread* Thread;
+};
+
+// The per-frame evaluation compiled mappings replaced, kept to check and time the compiled plan against:
+// subjects found by name in a map every frame and copied by value, bones with string names and raw
+// channel indices bounds checked per frame, and properties with a bad index dropped.
+class FRMG_MRMCReferenceMapping
+{
+public:
+
+	explicit FRMG_MRMCReferenceMapping(const FRMG_MRMCCompiledMapping& Mapping);
+
+	// Pushes one animation frame per subject, the way the source did before mappings were compiled
+	void PushFrames(const TArray<float> Values, double WorldSeconds, IRMG_MRMCFrameSink& Sink) const;
+
+private:
+
+	struct FBone
+	{
+		FString Name;
+		FString ParentName;
+		int32 Index[6];
+	};
+
+	struct FProperty
+	{
+		FString Name;
+		int32 Index;
+	};
+
+	struct FSubject
+	{
+		FName SubjectName;
+		TArray<FBone> Bones;
+		TArray<FProperty> Properties;
+	};
+
+	TArray<FName> SubjectOrder;
+	TMap<FName, FSubject> Subjects;
+};
+
+namespace RMG_MRMCHeadless
+{
+	// Sample of the simulator's orbit move: a 3 m circle around the target every 10 s with roll, focus and
+	// zoom sweeping. Phase offsets the move so several streams do not send identical data.
+	FRMG_MRMCDecodedPacket MakeOrbitSample(double Seconds, uint32 FrameCounter, ERMG_MRMCPacketVariant Variant, double Phase = 0.0);
+
+	// Mapping with NumSubjects copies of a four-bone rig: root, camera rotated by the raw roll, a lens child
+	// rotated by the roll, tilt and pan channels, and the target, plus two properties each
+	FString MakeStressMappingJson(int32 NumSubjects);
+
+	// Conversion the pose kernel replaced, one sample at a time through FVector and the C library atan2,
+	// to check and time the kernel against. Writes RMG_MRMCChannel::Num values.
+	void ConvertSampleScalar(const RobotData& Sample, float* OutValues);
+
+	// Logs one result line: Count items in Seconds of wall time, and the percentiles of the per-item cost
+	void LogResult(const TCHAR* Name, uint64 Count, double Seconds, const FRMG_MRMCLatencyHistogram& PerItem);
+
+	// Reads the datagrams of one stream from a recorded take, dropping duplicates and reordered ones
+	bool LoadTakeSamples(const FString& Filename, int32 Stream, TArray<FRMG_MRMCTakeSample>& OutSamples, FString& OutError);
+
+	// Replays Samples through an FRMG_MRMCPredictor configured from the prediction options and scores every
+	// prediction against the samples around its target time
+	void EvaluatePredictor(const TArray<FRMG_MRMCTakeSample>& Samples, const FRMG_MRMCProcessingOptions& Options, FRMG_MRMCPredictionError& OutError);
+}
+
+// Benchmarks run by -Bench and -Stress, and the -EvaluatePredictor report. Scale multiplies the amount of
+// work, for longer and steadier runs.
+namespace RMG_MRMCBenchmark
+{
+	// One 50 Hz stream with the built-in mapping, as a Bolt sends it, through each processing mode
+	void RunRealistic(int32 Scale);
+
+	// Relay header check and decode of each datagram variant, alone and mixed
+	void RunDecode(int32 Scale);
+
+	// Bulk, single-sample and scalar pose conversion
+	void RunKernel(int32 Scale);
+
+	// Lens table lookup against direct evaluation of the calibration curve it samples
+	void RunLens(int32 Scale);
+
+	// Frame assembly through the compiled plan and through the per-frame reference evaluation
+	void RunMapping(int32 Scale);
+
+	// Receive thread to consumer handoff through the packet ring and through the allocating queue it replaced
+	void RunHandoff(int32 Scale);
+
+	// Same-machine producer to a sleeping reader through the shared-memory ring and through loopback UDP
+	void RunSharedMemory(int32 Scale);
+
+	// Relay to 1, 8 and 32 loopback subscribers: the cost of forwarding and the latency to each subscriber
+	void RunRelay(int32 Scale);
+
+	// 1 to 32 clean 1 kHz streams on one thread, reporting the share of a core each stream costs
+	void RunScaling(int32 Scale);
+
+	// Latest-wins mailbox against the per-tick drained packet ring, with an engine tick that hitches
+	void RunMailbox(int32 Scale);
+
+	// Receive to LiveLink push in GameThread mode, drained by a hitching engine tick, and in ReceiveThread mode
+	void RunPushLatency(int32 Scale);
+
+	// Take recorder appends over ten hours of one 50 Hz stream and ten minutes of sixteen 1 kHz streams
+	void RunRecording(int32 Scale);
+
+	// Sixteen 1 kHz streams with a 32-subject mapping, lossy, reordered and duplicated, stats on
+	void RunStress(int32 Scale);
+
+	// Receive jitter of a 1 kHz loopback stream with every core loaded, per receive thread priority, affinity and busy poll
+	void RunJitter(int32 Scale);
+
+	// Logs the per-channel prediction error over one stream of a take, for tuning the lead time and noise
+	bool RunPredictorEvaluation(const FString& Filename, int32 Stream, const FRMG_MRMCProcessingOptions& Options);
+}
@@ -0,0 +1,195 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/PlatformAffinity.h"
+#include "HAL/RunnableThread.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include <atomic>
+
+#if PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// The receive thread set up as the source's ThreadPriority, AffinityMask, BusyPollUs and RealtimePriority do
+struct FRMG_MRMCJitterSetting
+{
+	const TCHAR* Name;
+	EThreadPriority Priority;
+	// pinned to the last core, with the load kept off it; otherwise on the pool cores as by default
+	bool bOwnCore;
+	// spins on non-blocking reads instead of waiting in the socket
+	bool bBusyPoll;
+	// SCHED_FIFO priority, applied from the thread as the source's Init() does, 0 for none
+	int32 RealtimePriority;
+	bool bLoad;
+};
+
+// Sends NumPackets datagrams to a loopback socket, IntervalSeconds apart, while a receive thread set up as
+// Setting reads them and one spinning worker per logical core keeps every core busy. Logs the latency from
+// each send to its read; the send time is taken right before the send, so a late sender does not count.
+static void RunJitterScenario(const FRMG_MRMCJitterSetting& Setting, uint32 NumPackets, double IntervalSeconds)
+{
+	const int32 NumCores = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1, 64);
+	const uint64 AllCores = NumCores == 64 ? ~uint64(0) : (uint64(1) << NumCores) - 1;
+	const uint64 ReceiveCore = uint64(1) << (NumCores - 1);
+	if (Setting.bOwnCore && NumCores < 2)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s skipped, a core of its own needs two"), Setting.Name);
+		return;
+	}
+
+	FSocket* Receiver = FUdpSocketBuilder(TEXT("RMG_MRMCJitterReceiver")).AsNonBlocking().BoundToAddress(FIPv4Address(127, 0, 0, 1)).BoundToPort(0)
+		.WithReceiveBufferSize(1024 * 1024);
+	FSocket* Sender = FUdpSocketBuilder(TEXT("RMG_MRMCJitterSender")).AsNonBlocking().BoundToAddress(FIPv4Address(127, 0, 0, 1)).BoundToPort(0);
+	if (Receiver == nullptr || Sender == nullptr)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Error, TEXT("%s: cannot open loopback sockets"), Setting.Name);
+	}
+	else
+	{
+		const TSharedRef<FInternetAddr> Target = FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), static_cast<uint16>(Receiver->GetPortNo())).ToInternetAddr();
+
+		std::atomic<bool> bStopLoad(false);
+		TArray<TUniquePtr<FRMG_MRMCBenchmarkThread>> Load;
+		if (Setting.bLoad)
+		{
+			for (int32 Idx = 0; Idx < NumCores; Idx++)
+			{
+				Load.Add(MakeUnique<FRMG_MRMCBenchmarkThread>(TEXT("RMG_MRMCJitterLoad"), [&bStopLoad]()
+				{
+					uint64 State = 1;
+					while (!bStopLoad.load(std::memory_order_relaxed))
+					{
+						for (int32 Step = 0; Step < 1000; Step++)
+						{
+							State = State * 6364136223846793005ull + 1442695040888963407ull;
+						}
+					}
+					volatile uint64 Result = State;
+					(void)Result;
+				}, TPri_Normal, Setting.bOwnCore ? AllCores & ~ReceiveCore : FPlatformAffinity::GetPoolThreadMask()));
+			}
+		}
+
+		// written before each send, read once the datagram is through the socket
+		TArray<double> SentSeconds;
+		SentSeconds.SetNumZeroed(NumPackets);
+
+		FRMG_MRMCLatencyHistogram Latency;
+		uint32 NumReceived = 0;
+		bool bRealtimeRefused = false;
+		std::atomic<bool> bSent(false);
+		FRMG_MRMCBenchmarkThread ReceiveThread(TEXT("RMG_MRMCJitterReceiver"), [&Setting, Receiver, &SentSeconds, &Latency, &NumReceived, &bRealtimeRefused, &bSent, NumPackets]()
+		{
+#if PLATFORM_LINUX
+			if (Setting.RealtimePriority > 0)
+			{
+				sched_param Param = {};
+				Param.sched_priority = FMath::Clamp(Setting.RealtimePriority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+				bRealtimeRefused = pthread_setschedparam(pthread_self(), SCHED_FIFO, &Param) != 0;
+			}
+#endif
+			// once everything is sent, an empty wait or poll means everything that will arrive has
+			for (;;)
+			{
+				const bool bWasSent = bSent;
+				if (!Setting.bBusyPoll && !Receiver->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(100)))
+				{
+					if (bWasSent)
+					{
+						break;
+					}
+					continue;
+				}
+
+				int32 NumRead = 0;
+				uint8 Data[64];
+				int32 BytesRead = 0;
+				while (Receiver->Recv(Data, sizeof(Data), BytesRead) && BytesRead > 0)
+				{
+					const double ReadSeconds = FPlatformTime::Seconds();
+					const uint32 Index = BytesRead >= int32(sizeof(uint32)) ? RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Data) : NumPackets;
+					if (Index < NumPackets)
+					{
+						Latency.RecordSeconds(ReadSeconds - SentSeconds[Index]);
+						NumReceived++;
+					}
+					NumRead++;
+				}
+				if (Setting.bBusyPoll && NumRead == 0 && bWasSent)
+				{
+					break;
+				}
+			}
+		}, Setting.Priority, Setting.bOwnCore ? ReceiveCore : FPlatformAffinity::GetPoolThreadMask());
+
+		// the stream's own pacing, as a robot controller on another machine would send it
+		const double StartSeconds = FPlatformTime::Seconds();
+		for (uint32 Idx = 0; Idx < NumPackets; Idx++)
+		{
+			const double Due = StartSeconds + Idx * IntervalSeconds;
+			while (FPlatformTime::Seconds() < Due)
+			{
+				FPlatformProcess::Yield();
+			}
+			uint8 Data[sizeof(uint32)];
+			RMG_MRMCPacketLayout::TField<uint32, 0>::Write(Idx, Data);
+			int32 BytesSent = 0;
+			SentSeconds[Idx] = FPlatformTime::Seconds();
+			Sender->SendTo(Data, sizeof(Data), BytesSent, *Target);
+		}
+		bSent = true;
+		ReceiveThread.WaitForCompletion();
+		const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+		bStopLoad = true;
+		Load.Reset();
+
+		RMG_MRMCHeadless::LogResult(Setting.Name, NumReceived, Seconds, Latency);
+		if (NumReceived < NumPackets)
+		{
+			UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10u datagrams lost"), TEXT(""), NumPackets - NumReceived);
+		}
+		if (bRealtimeRefused)
+		{
+			UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s SCHED_FIFO refused, needs CAP_SYS_NICE or an rtprio limit; ran at TimeCritical"), TEXT(""));
+		}
+	}
+
+	if (Receiver != nullptr)
+	{
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Receiver);
+	}
+	if (Sender != nullptr)
+	{
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Sender);
+	}
+}
+
+void RMG_MRMCBenchmark::RunJitter(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Jitter: 1 kHz loopback stream read by a receive thread while a spinning worker per logical core (%d) loads the machine; latency from send to read per receive thread setup"),
+		FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+
+	const FRMG_MRMCJitterSetting Settings[] =
+	{
+		{ TEXT("AboveNormal, no load"), TPri_AboveNormal, false, false, 0, false },
+		{ TEXT("AboveNormal"), TPri_AboveNormal, false, false, 0, true },
+		{ TEXT("TimeCritical"), TPri_TimeCritical, false, false, 0, true },
+		{ TEXT("TimeCritical, own core"), TPri_TimeCritical, true, false, 0, true },
+		{ TEXT("TimeCritical, busy poll"), TPri_TimeCritical, false, true, 0, true },
+		{ TEXT("TimeCritical, own core, busy poll"), TPri_TimeCritical, true, true, 0, true },
+#if PLATFORM_LINUX
+		// never with busy poll: a SCHED_FIFO thread that spins starves everything else on its core
+		{ TEXT("SCHED_FIFO 50"), TPri_TimeCritical, false, false, 50, true },
+		{ TEXT("SCHED_FIFO 50, own core"), TPri_TimeCritical, true, false, 50, true },
+#endif
+	};
+
+	for (const FRMG_MRMCJitterSetting& Setting : Settings)
+	{
+		RunJitterScenario(Setting, 2000u * Scale, 0.001);
+	}
+}
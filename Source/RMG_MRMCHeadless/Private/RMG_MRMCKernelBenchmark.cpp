@@ -0,0 +1,129 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPoseKernel.h"
+
+// Samples per timed batch, also the block the bulk conversion gets at a time
+static const int32 KernelBenchmarkBatch = 1024;
+
+void RMG_MRMCHeadless::ConvertSampleScalar(const RobotData& Sample, float* OutValues)
+{
+	const float METER2CENT = 100.0f;
+
+	// adjust Robot_data for different coord system, flip Y axis
+	const FVector CameraPose(Sample.xv * METER2CENT, -Sample.yv * METER2CENT, Sample.zv * METER2CENT);
+	const FVector CameraTarget(Sample.xt * METER2CENT, -Sample.yt * METER2CENT, Sample.zt * METER2CENT);
+	const FVector LookAt = CameraTarget - CameraPose;
+	const float Pan = FMath::RadiansToDegrees(atan2f(LookAt.Y, LookAt.X));
+	const float Tilt = FMath::RadiansToDegrees(atan2f(LookAt.Z, FVector(LookAt.X, LookAt.Y, 0.0f).Size()));
+
+	OutValues[RMG_MRMCChannel::CameraPoseX] = CameraPose.X;
+	OutValues[RMG_MRMCChannel::CameraPoseY] = CameraPose.Y;
+	OutValues[RMG_MRMCChannel::CameraPoseZ] = CameraPose.Z;
+	OutValues[RMG_MRMCChannel::RollDegrees] = FMath::RadiansToDegrees(-Sample.roll);
+	OutValues[RMG_MRMCChannel::Tilt] = Tilt;
+	OutValues[RMG_MRMCChannel::Pan] = Pan;
+	OutValues[RMG_MRMCChannel::Roll] = Sample.roll;
+	OutValues[RMG_MRMCChannel::Focus] = LookAt.Size();
+	OutValues[RMG_MRMCChannel::Zoom] = Sample.zoom;
+	OutValues[RMG_MRMCChannel::CameraTargetX] = CameraTarget.X;
+	OutValues[RMG_MRMCChannel::CameraTargetY] = CameraTarget.Y;
+	OutValues[RMG_MRMCChannel::CameraTargetZ] = CameraTarget.Z;
+	OutValues[RMG_MRMCChannel::DistortionK1] = 0.0f;
+	OutValues[RMG_MRMCChannel::DistortionK2] = 0.0f;
+}
+
+// Converts every sample in batches, through Convert(First, Count), and logs the batch means per sample
+static void RunKernelScenario(const TCHAR* Name, int32 NumSamples, TFunctionRef<void(int32, int32)> Convert)
+{
+	FRMG_MRMCLatencyHistogram PerSample;
+	double Seconds = 0.0;
+	for (int32 First = 0; First < NumSamples; First += KernelBenchmarkBatch)
+	{
+		const int32 Count = FMath::Min(KernelBenchmarkBatch, NumSamples - First);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Convert(First, Count);
+		const double BatchSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		PerSample.RecordSeconds(BatchSeconds / Count);
+		Seconds += BatchSeconds;
+	}
+	RMG_MRMCHeadless::LogResult(Name, NumSamples, Seconds, PerSample);
+}
+
+void RMG_MRMCBenchmark::RunKernel(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Kernel: robot samples to channels, per-sample times are batch means"));
+
+	const int32 NumSamples = 1000000 * Scale;
+	TArray<RobotData> Samples;
+	Samples.SetNumUninitialized(NumSamples);
+	for (int32 Idx = 0; Idx < NumSamples; Idx++)
+	{
+		Samples[Idx] = RMG_MRMCHeadless::MakeOrbitSample(Idx / 50.0, Idx, ERMG_MRMCPacketVariant::Basic).Robot;
+	}
+
+	// planes in and out for the bulk conversion, frame value buffers for the others
+	TArray<float> InPlanes[9];
+	for (TArray<float>& Plane : InPlanes)
+	{
+		Plane.SetNumUninitialized(NumSamples);
+	}
+	for (int32 Idx = 0; Idx < NumSamples; Idx++)
+	{
+		const float* Fields = &Samples[Idx].xv;
+		for (int32 Field = 0; Field < UE_ARRAY_COUNT(InPlanes); Field++)
+		{
+			InPlanes[Field][Idx] = Fields[Field];
+		}
+	}
+	TArray<float> OutPlanes[RMG_MRMCChannel::Num];
+	for (TArray<float>& Plane : OutPlanes)
+	{
+		Plane.SetNumUninitialized(KernelBenchmarkBatch);
+	}
+	TArray<float> Values;
+	Values.SetNumUninitialized(KernelBenchmarkBatch * RMG_MRMC_FRAME_VALUE_COUNT);
+	float Checksum = 0.0f;
+
+	RunKernelScenario(TEXT("bulk, vector"), NumSamples, [&](int32 First, int32 Count)
+	{
+		FRMG_MRMCRobotSamples Block;
+		Block.Xv = InPlanes[0].GetData() + First;
+		Block.Yv = InPlanes[1].GetData() + First;
+		Block.Zv = InPlanes[2].GetData() + First;
+		Block.Xt = InPlanes[3].GetData() + First;
+		Block.Yt = InPlanes[4].GetData() + First;
+		Block.Zt = InPlanes[5].GetData() + First;
+		Block.Roll = InPlanes[6].GetData() + First;
+		Block.Focus = InPlanes[7].GetData() + First;
+		Block.Zoom = InPlanes[8].GetData() + First;
+		Block.Num = Count;
+		FRMG_MRMCChannelPlanes Planes;
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			Planes.Channels[Channel] = OutPlanes[Channel].GetData();
+		}
+		RMG_MRMCPoseKernel::ConvertSamples(Block, Planes);
+		Checksum += OutPlanes[RMG_MRMCChannel::Pan][Count - 1];
+	});
+
+	RunKernelScenario(TEXT("single sample, vector"), NumSamples, [&](int32 First, int32 Count)
+	{
+		for (int32 Idx = 0; Idx < Count; Idx++)
+		{
+			RMG_MRMCPoseKernel::ConvertSample(Samples[First + Idx], Values.GetData() + Idx * RMG_MRMC_FRAME_VALUE_COUNT);
+		}
+		Checksum += Values[RMG_MRMCChannel::Pan];
+	});
+
+	RunKernelScenario(TEXT("single sample, scalar"), NumSamples, [&](int32 First, int32 Count)
+	{
+		for (int32 Idx = 0; Idx < Count; Idx++)
+		{
+			RMG_MRMCHeadless::ConvertSampleScalar(Samples[First + Idx], Values.GetData() + Idx * RMG_MRMC_FRAME_VALUE_COUNT);
+		}
+		Checksum += Values[RMG_MRMCChannel::Pan];
+	});
+
+	UE_LOG(LogRMG_MRMCHeadless, Verbose, TEXT("Kernel checksum %f"), Checksum);
+}
@@ -0,0 +1,76 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCLensProfile.h"
+#include "Math/RandomStream.h"
+
+// A lookup takes a few nanoseconds, less than a cycle counter read, so lookups are timed in batches and
+// each batch records its mean per lookup
+static const int32 LensBenchmarkBatch = 1024;
+
+// Runs Evaluator over every input; returns a checksum so the work cannot be optimised away
+template <typename EvaluatorType>
+static float RunLensScenario(const TCHAR* Name, const TArray<float>& Inputs, const EvaluatorType& Evaluator)
+{
+	FRMG_MRMCLatencyHistogram PerLookup;
+	float Checksum = 0.0f;
+	double Seconds = 0.0;
+
+	for (int32 First = 0; First < Inputs.Num(); First += LensBenchmarkBatch)
+	{
+		const int32 Last = FMath::Min(First + LensBenchmarkBatch, Inputs.Num());
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Idx = First; Idx < Last; Idx++)
+		{
+			Checksum += Evaluator.Evaluate(Inputs[Idx]);
+		}
+		const double BatchSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		PerLookup.RecordSeconds(BatchSeconds / (Last - First));
+		Seconds += BatchSeconds;
+	}
+
+	RMG_MRMCHeadless::LogResult(Name, Inputs.Num(), Seconds, PerLookup);
+	return Checksum;
+}
+
+void RMG_MRMCBenchmark::RunLens(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Lens: table lookup against direct curve evaluation, per-lookup times are batch means"));
+
+	// a zoom lens calibrated at 8 and at 32 encoder positions, focal length rising ever faster towards the long end
+	const int32 NumPoints[] = { 8, 32 };
+	const TCHAR* const LutNames[] = { TEXT("lens table, 8 point curve"), TEXT("lens table, 32 point curve") };
+	const TCHAR* const CurveNames[] = { TEXT("lens curve, 8 points"), TEXT("lens curve, 32 points") };
+
+	// random encoder values, so the curve's search is as unpredictable as a live zoom
+	FRandomStream Random(0x4c454e53);
+	TArray<float> Inputs;
+	Inputs.SetNumUninitialized(1000000 * Scale);
+	for (float& Input : Inputs)
+	{
+		Input = Random.FRandRange(0.0f, 65535.0f);
+	}
+
+	float Checksum = 0.0f;
+	for (int32 CurveIdx = 0; CurveIdx < UE_ARRAY_COUNT(NumPoints); CurveIdx++)
+	{
+		TArray<FVector2D> Points;
+		for (int32 Idx = 0; Idx < NumPoints[CurveIdx]; Idx++)
+		{
+			const float Fraction = static_cast<float>(Idx) / (NumPoints[CurveIdx] - 1);
+			Points.Add(FVector2D(65535.0f * Fraction, 7.4f * FMath::Pow(137.0f / 7.4f, Fraction * Fraction)));
+		}
+
+		FRMG_MRMCLensCurve Curve;
+		FString Error;
+		Curve.Set(Points, Error);
+		FRMG_MRMCLensLut Lut;
+		const float LutError = Lut.Build(Curve, 1e-4f);
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%d point curve: %d table entries, largest error %.2g of value"), NumPoints[CurveIdx], Lut.Num(), LutError);
+
+		Checksum += RunLensScenario(LutNames[CurveIdx], Inputs, Lut);
+		Checksum += RunLensScenario(CurveNames[CurveIdx], Inputs, Curve);
+	}
+
+	UE_LOG(LogRMG_MRMCHeadless, Verbose, TEXT("Lens checksum %f"), Checksum);
+}
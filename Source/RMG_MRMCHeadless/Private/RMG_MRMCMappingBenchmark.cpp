@@ -0,0 +1,174 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCPoseKernel.h"
+#include "RMG_MRMCStreamProcessor.h"
+#include "RMG_MRMCSubjectMapping.h"
+#include "Misc/App.h"
+
+// Packets per timed batch; the capture sink is emptied between batches, outside the timed region
+static const int32 MappingBenchmarkBatch = 1024;
+
+FRMG_MRMCReferenceMapping::FRMG_MRMCReferenceMapping(const FRMG_MRMCCompiledMapping& Mapping)
+{
+	// compiled indices of unmapped channels point at the zero channel, raw mappings had -1 there
+	const auto ToRawIndex = [](int32 Channel)
+	{
+		return Channel == RMG_MRMCChannel::Zero ? -1 : Channel;
+	};
+
+	for (int32 SubjectIdx = 0; SubjectIdx < Mapping.NumSubjects(); SubjectIdx++)
+	{
+		FSubject Subject;
+		Subject.SubjectName = Mapping.SubjectNames[SubjectIdx];
+
+		const int32 FirstBone = Mapping.SubjectFirstBone[SubjectIdx];
+		for (int32 Bone = FirstBone; Bone < FirstBone + Mapping.SubjectNumBones[SubjectIdx]; Bone++)
+		{
+			FBone& Raw = Subject.Bones.AddDefaulted_GetRef();
+			Raw.Name = Mapping.BoneNames[Bone].ToString();
+			const int32 Parent = Mapping.BoneParents[Bone];
+			Raw.ParentName = Parent != INDEX_NONE ? Mapping.BoneNames[FirstBone + Parent].ToString() : FString();
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				Raw.Index[Axis] = ToRawIndex(Mapping.LocationChannels[Bone * 3 + Axis]);
+				Raw.Index[3 + Axis] = Mapping.BoneHasRotation[Bone] ? ToRawIndex(Mapping.RotationChannels[Bone * 3 + Axis]) : -1;
+			}
+		}
+
+		const int32 FirstProperty = Mapping.SubjectFirstProperty[SubjectIdx];
+		for (int32 Property = FirstProperty; Property < FirstProperty + Mapping.SubjectNumProperties[SubjectIdx]; Property++)
+		{
+			FProperty& Raw = Subject.Properties.AddDefaulted_GetRef();
+			Raw.Name = Mapping.PropertyNames[Property].ToString();
+			Raw.Index = ToRawIndex(Mapping.PropertyChannels[Property]);
+		}
+
+		SubjectOrder.Add(Subject.SubjectName);
+		Subjects.Add(Subject.SubjectName, MoveTemp(Subject));
+	}
+}
+
+void FRMG_MRMCReferenceMapping::PushFrames(const TArray<float> Values, double WorldSeconds, IRMG_MRMCFrameSink& Sink) const
+{
+	const int32 ValueSize = Values.Num();
+	for (const FName& SubjectName : SubjectOrder)
+	{
+		const FSubject Subject = Subjects.FindChecked(SubjectName);
+
+		FRMG_MRMCSubjectFrame Frame;
+		Frame.SubjectName = Subject.SubjectName;
+		Frame.WorldSeconds = WorldSeconds;
+		Frame.Transforms.Reserve(Subject.Bones.Num());
+		for (const FBone Bone : Subject.Bones)
+		{
+			FVector Location(0.0f, 0.0f, 0.0f);
+			FVector Rotation(0.0f, 0.0f, 0.0f);
+			const int32* Index = Bone.Index;
+			if (Index[0] > -1 && Index[1] > -1 && Index[2] > -1 && Index[0] < ValueSize && Index[1] < ValueSize && Index[2] < ValueSize)
+			{
+				Location.Set(Values[Index[0]], Values[Index[1]], Values[Index[2]]);
+			}
+			if (Index[3] > -1 && Index[4] > -1 && Index[5] > -1 && Index[3] < ValueSize && Index[4] < ValueSize && Index[5] < ValueSize)
+			{
+				Rotation.Set(Values[Index[3]], Values[Index[4]], Values[Index[5]]);
+			}
+
+			FTransform Trans;
+			Trans.SetLocation(Location);
+			if (Rotation.Size() > 0)
+			{
+				Trans.SetRotation(FQuat::MakeFromEuler(Rotation));
+			}
+			Frame.Transforms.Add(Trans);
+		}
+		for (const FProperty Property : Subject.Properties)
+		{
+			if (Property.Index > -1 && Property.Index < ValueSize)
+			{
+				Frame.PropertyValues.Add(Values[Property.Index]);
+			}
+		}
+		Sink.PushFrame(MoveTemp(Frame));
+	}
+}
+
+// Times the compiled path, a stream processor per packet, against decoding, converting and assembling
+// with the reference evaluation. Both decode and convert the same way, so the difference is assembly;
+// the processor also tracks sequence and scene time, which only counts against it.
+static void RunMappingScenario(const TCHAR* Name, const FRMG_MRMCCompiledMapping& Mapping, int32 NumPackets)
+{
+	TArray<FRMG_MRMCBenchmarkDatagram> Datagrams;
+	Datagrams.SetNumUninitialized(NumPackets);
+	for (int32 Idx = 0; Idx < NumPackets; Idx++)
+	{
+		FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Idx];
+		const double Seconds = Idx / 1000.0;
+		Datagram.ReceiveSeconds = 1000.0 + Seconds;
+		Datagram.Stream = 0;
+		Datagram.Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Seconds, Idx, ERMG_MRMCPacketVariant::FrameCounter), Datagram.Data);
+	}
+
+	FRMG_MRMCCaptureFrameSink Sink;
+	FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+	const FRMG_MRMCReferenceMapping Reference(Mapping);
+
+	for (int32 Path = 0; Path < 2; Path++)
+	{
+		const bool bCompiled = Path == 0;
+		FRMG_MRMCLatencyHistogram PerPacket;
+		double Seconds = 0.0;
+		uint64 NumFrames = 0;
+		for (int32 First = 0; First < NumPackets; First += MappingBenchmarkBatch)
+		{
+			const int32 Last = FMath::Min(First + MappingBenchmarkBatch, NumPackets);
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 Idx = First; Idx < Last; Idx++)
+			{
+				const FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Idx];
+				if (bCompiled)
+				{
+					Processor.ProcessPacket(Datagram.Data, Datagram.Size, Datagram.ReceiveSeconds, Sink);
+				}
+				else
+				{
+					FRMG_MRMCDecodedPacket Packet;
+					if (RMG_MRMCPacketDecoder::Decode(Datagram.Data, Datagram.Size, Packet))
+					{
+						// the frame value list was filled afresh per packet, without the trailing zero channel
+						float Converted[RMG_MRMC_FRAME_VALUE_COUNT];
+						RMG_MRMCPoseKernel::ConvertSample(Packet.Robot, Converted);
+						TArray<float> Values;
+						Values.Append(Converted, RMG_MRMCChannel::Num);
+						Reference.PushFrames(Values, Datagram.ReceiveSeconds, Sink);
+					}
+				}
+			}
+			const double BatchSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+			PerPacket.RecordSeconds(BatchSeconds / (Last - First));
+			Seconds += BatchSeconds;
+			NumFrames += Sink.Frames.Num();
+			Sink.Frames.Reset();
+		}
+
+		const FString ResultName = FString::Printf(TEXT("%s, %s"), Name, bCompiled ? TEXT("compiled") : TEXT("reference"));
+		RMG_MRMCHeadless::LogResult(*ResultName, NumPackets, Seconds, PerPacket);
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu subject frames, %.0f ns per frame"),
+			TEXT(""), NumFrames, NumFrames > 0 ? Seconds * 1e9 / NumFrames : 0.0);
+	}
+}
+
+void RMG_MRMCBenchmark::RunMapping(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Mapping: 1 kHz frame counter datagrams, decode, convert and assemble, per-packet times are batch means"));
+	FApp::SetTimecodeFrameRate(FFrameRate(1000, 1));
+
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	verify(FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error));
+	RunMappingScenario(TEXT("built-in mapping"), Mapping, 100000 * Scale);
+
+	verify(FRMG_MRMCCompiledMapping::Compile(RMG_MRMCHeadless::MakeStressMappingJson(32), Mapping, Error));
+	RunMappingScenario(TEXT("32 subject mapping"), Mapping, 10000 * Scale);
+}
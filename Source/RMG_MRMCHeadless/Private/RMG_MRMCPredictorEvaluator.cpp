@@ -0,0 +1,189 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPoseKernel.h"
+#include "RMG_MRMCPredictor.h"
+#include "RMG_MRMCSequenceTracker.h"
+#include "RMG_MRMCTakeFormat.h"
+#include "Misc/FileHelper.h"
+
+// Predictions made before the filter has seen this many samples of a run are not scored, its velocity
+// and acceleration are still settling
+static const int32 EvaluatorWarmUpSamples = 10;
+
+// The truth at a target time is interpolated between the two samples around it; across a longer hole in
+// the take it is unknown and the prediction is not scored
+static const double EvaluatorMaxSampleSpan = 0.25;
+
+static const TCHAR* const EvaluatorChannelNames[RMG_MRMCChannel::Num] =
+{
+	TEXT("CameraPoseX cm"), TEXT("CameraPoseY cm"), TEXT("CameraPoseZ cm"),
+	TEXT("RollDegrees deg"), TEXT("Tilt deg"), TEXT("Pan deg"),
+	TEXT("Roll rad"), TEXT("Focus"), TEXT("Zoom"),
+	TEXT("CameraTargetX cm"), TEXT("CameraTargetY cm"), TEXT("CameraTargetZ cm"),
+	TEXT("DistortionK1"), TEXT("DistortionK2"),
+};
+
+bool RMG_MRMCHeadless::LoadTakeSamples(const FString& Filename, int32 Stream, TArray<FRMG_MRMCTakeSample>& OutSamples, FString& OutError)
+{
+	OutSamples.Reset();
+
+	// a take may still be recording, so share it with the writer
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename, FILEREAD_AllowWrite))
+	{
+		OutError = FString::Printf(TEXT("cannot read %s"), *Filename);
+		return false;
+	}
+
+	FRMG_MRMCTakeHeader Header;
+	if (Bytes.Num() < static_cast<int32>(sizeof(Header)))
+	{
+		OutError = FString::Printf(TEXT("%s is not a take file"), *Filename);
+		return false;
+	}
+	FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(Header));
+	if (Header.Magic != RMG_MRMC_TAKE_MAGIC || Header.RecordSize != sizeof(FRMG_MRMCTakeRecord) || Header.RecordOffset > uint64(Bytes.Num()))
+	{
+		OutError = FString::Printf(TEXT("%s is not a take file"), *Filename);
+		return false;
+	}
+	if (Header.Version != RMG_MRMC_TAKE_VERSION)
+	{
+		OutError = FString::Printf(TEXT("%s is take version %u, expected %d"), *Filename, Header.Version, RMG_MRMC_TAKE_VERSION);
+		return false;
+	}
+
+	// a take that was not finalized may claim more records than the file holds
+	const uint64 NumRecords = FMath::Min<uint64>(Header.RecordCount, (Bytes.Num() - Header.RecordOffset) / sizeof(FRMG_MRMCTakeRecord));
+
+	// duplicates and reordered datagrams are dropped the way the source drops them
+	FRMG_MRMCSequenceTracker Tracker;
+	int32 NumUnreadable = 0;
+	for (uint64 RecordIdx = 0; RecordIdx < NumRecords; RecordIdx++)
+	{
+		FRMG_MRMCTakeRecord Record;
+		FMemory::Memcpy(&Record, Bytes.GetData() + Header.RecordOffset + RecordIdx * sizeof(Record), sizeof(Record));
+		if (Record.Stream != Stream)
+		{
+			continue;
+		}
+
+		// only the first RMG_MRMC_TAKE_PAYLOAD_SIZE bytes are kept, so a relayed 40 or 44 byte datagram is cut off
+		const uint8* Data = Record.Data;
+		int32 Size = Record.Size;
+		int64 ReceiveUnixNs;
+		RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, ReceiveUnixNs);
+		FRMG_MRMCDecodedPacket Packet;
+		if (Data + Size > Record.Data + RMG_MRMC_TAKE_PAYLOAD_SIZE || !RMG_MRMCPacketDecoder::Decode(Data, Size, Packet))
+		{
+			NumUnreadable++;
+			continue;
+		}
+
+		int32 LostChange;
+		if (Tracker.Check(Data, Size, Packet, Record.ReceiveSeconds, LostChange) != ERMG_MRMCSequenceVerdict::Accept)
+		{
+			continue;
+		}
+
+		FRMG_MRMCTakeSample& Sample = OutSamples.AddDefaulted_GetRef();
+		Sample.Seconds = Record.ReceiveSeconds;
+		float Values[RMG_MRMC_FRAME_VALUE_COUNT];
+		RMG_MRMCPoseKernel::ConvertSample(Packet.Robot, Values);
+		FMemory::Memcpy(Sample.Values, Values, sizeof(Sample.Values));
+	}
+
+	if (NumUnreadable > 0)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Warning, TEXT("%s: %d records of stream %d could not be decoded"), *Filename, NumUnreadable, Stream);
+	}
+	if (OutSamples.Num() < 2)
+	{
+		OutError = FString::Printf(TEXT("%s has %d usable samples on stream %d"), *Filename, OutSamples.Num(), Stream);
+		return false;
+	}
+	return true;
+}
+
+void RMG_MRMCHeadless::EvaluatePredictor(const TArray<FRMG_MRMCTakeSample>& Samples, const FRMG_MRMCProcessingOptions& Options, FRMG_MRMCPredictionError& OutError)
+{
+	OutError = FRMG_MRMCPredictionError();
+
+	const double LeadSeconds = Options.PredictionLeadMs * 0.001;
+	FRMG_MRMCPredictor Predictor(Options.PredictionLeadMs * 0.001f, Options.PredictionProcessNoise, Options.PredictionMeasurementNoise);
+	double PredictedSquared[RMG_MRMCChannel::Num] = {};
+	double HeldSquared[RMG_MRMCChannel::Num] = {};
+
+	// index of the last sample at or before the current target time; targets only move forwards
+	int32 Before = 0;
+	for (int32 SampleIdx = 0; SampleIdx < Samples.Num(); SampleIdx++)
+	{
+		const FRMG_MRMCTakeSample& Sample = Samples[SampleIdx];
+		float Predicted[RMG_MRMCChannel::Num];
+		FMemory::Memcpy(Predicted, Sample.Values, sizeof(Predicted));
+		Predictor.Process(Sample.Seconds, Predicted);
+
+		const double TargetSeconds = Sample.Seconds + LeadSeconds;
+		while (Before + 1 < Samples.Num() && Samples[Before + 1].Seconds <= TargetSeconds)
+		{
+			Before++;
+		}
+		if (Before + 1 >= Samples.Num())
+		{
+			break;
+		}
+
+		const FRMG_MRMCTakeSample& From = Samples[Before];
+		const FRMG_MRMCTakeSample& To = Samples[Before + 1];
+		const double Span = To.Seconds - From.Seconds;
+		if (Predictor.GetNumSamples() <= EvaluatorWarmUpSamples || Span <= 0.0 || Span > EvaluatorMaxSampleSpan)
+		{
+			continue;
+		}
+
+		const float Alpha = static_cast<float>((TargetSeconds - From.Seconds) / Span);
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			const float Truth = From.Values[Channel] + Alpha * FRMG_MRMCPredictor::WrapDifference(Channel, To.Values[Channel] - From.Values[Channel]);
+			const float PredictedError = FMath::Abs(FRMG_MRMCPredictor::WrapDifference(Channel, Predicted[Channel] - Truth));
+			const float HeldError = FMath::Abs(FRMG_MRMCPredictor::WrapDifference(Channel, Sample.Values[Channel] - Truth));
+			PredictedSquared[Channel] += PredictedError * PredictedError;
+			HeldSquared[Channel] += HeldError * HeldError;
+			OutError.PredictedMax[Channel] = FMath::Max(OutError.PredictedMax[Channel], PredictedError);
+		}
+		OutError.NumScored++;
+	}
+
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		OutError.PredictedRms[Channel] = OutError.NumScored > 0 ? static_cast<float>(FMath::Sqrt(PredictedSquared[Channel] / OutError.NumScored)) : 0.0f;
+		OutError.HeldRms[Channel] = OutError.NumScored > 0 ? static_cast<float>(FMath::Sqrt(HeldSquared[Channel] / OutError.NumScored)) : 0.0f;
+	}
+}
+
+bool RMG_MRMCBenchmark::RunPredictorEvaluation(const FString& Filename, int32 Stream, const FRMG_MRMCProcessingOptions& Options)
+{
+	TArray<FRMG_MRMCTakeSample> Samples;
+	FString Error;
+	if (!RMG_MRMCHeadless::LoadTakeSamples(Filename, Stream, Samples, Error))
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Error, TEXT("%s"), *Error);
+		return false;
+	}
+
+	FRMG_MRMCPredictionError Result;
+	RMG_MRMCHeadless::EvaluatePredictor(Samples, Options, Result);
+
+	const double Duration = Samples.Last().Seconds - Samples[0].Seconds;
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Predictor: %s stream %d, %d samples over %.1f s (%.1f Hz), lead %.1f ms, process noise %g, measurement noise %g, %d predictions scored"),
+		*Filename, Stream, Samples.Num(), Duration, Duration > 0.0 ? (Samples.Num() - 1) / Duration : 0.0,
+		Options.PredictionLeadMs, Options.PredictionProcessNoise, Options.PredictionMeasurementNoise, Result.NumScored);
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-18s %14s %14s %14s"), TEXT("channel"), TEXT("predicted rms"), TEXT("held rms"), TEXT("predicted max"));
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-18s %14.5g %14.5g %14.5g"),
+			EvaluatorChannelNames[Channel], Result.PredictedRms[Channel], Result.HeldRms[Channel], Result.PredictedMax[Channel]);
+	}
+	return true;
+}
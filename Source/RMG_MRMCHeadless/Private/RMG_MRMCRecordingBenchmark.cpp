@@ -0,0 +1,70 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCTakeRecorder.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+// Distinct datagrams cycled through; what is appended does not change the cost, only that it is not constant
+static const int32 RecordingBenchmarkDatagrams = 4096;
+
+// Records NumRecords datagrams from NumStreams streams at Rate each, unpaced, into a fresh take sized for
+// them, timing every Append() as the receive thread would see it
+static void RunRecordingScenario(const TCHAR* Name, int32 NumStreams, double Rate, uint64 NumRecords)
+{
+	TArray<FRMG_MRMCBenchmarkDatagram> Datagrams;
+	Datagrams.SetNumUninitialized(RecordingBenchmarkDatagrams);
+	for (int32 Idx = 0; Idx < RecordingBenchmarkDatagrams; Idx++)
+	{
+		FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Idx];
+		Datagram.Stream = Idx % NumStreams;
+		Datagram.Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Idx / (Rate * NumStreams), Idx / NumStreams, ERMG_MRMCPacketVariant::FrameCounter, Datagram.Stream), Datagram.Data);
+	}
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("RMG_MRMCHeadless") / TEXT("RecordingBenchmark.take");
+
+	const double OpenStart = FPlatformTime::Seconds();
+	TUniquePtr<FRMG_MRMCTakeRecorder> Recorder = FRMG_MRMCTakeRecorder::Open(Filename, NumRecords, NumStreams);
+	const double OpenSeconds = FPlatformTime::Seconds() - OpenStart;
+	if (!Recorder.IsValid())
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Error, TEXT("%s: cannot open %s"), Name, *Filename);
+		return;
+	}
+
+	FRMG_MRMCLatencyHistogram PerAppend;
+	double Seconds = 0.0;
+	const double ReceiveStart = FPlatformTime::Seconds();
+	for (uint64 Idx = 0; Idx < NumRecords; Idx++)
+	{
+		const FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Idx % RecordingBenchmarkDatagrams];
+		const double ReceiveSeconds = ReceiveStart + Idx / (Rate * NumStreams);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Recorder->Append(Datagram.Stream, Datagram.Data, Datagram.Size, ReceiveSeconds);
+		const double AppendSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		PerAppend.RecordSeconds(AppendSeconds);
+		Seconds += AppendSeconds;
+	}
+	const uint64 NumDropped = Recorder->GetDroppedCount();
+
+	const double CloseStart = FPlatformTime::Seconds();
+	Recorder.Reset();
+	const double CloseSeconds = FPlatformTime::Seconds() - CloseStart;
+
+	RMG_MRMCHeadless::LogResult(Name, NumRecords, Seconds, PerAppend);
+	const int64 FileSize = IFileManager::Get().FileSize(*Filename);
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %.1f hours of stream, %.1f MB on disk (%.1f MB per hour), open %.0f ms, close %.0f ms, %llu dropped"),
+		Name, NumRecords / (Rate * NumStreams) / 3600.0, FileSize / 1048576.0, FileSize / 1048576.0 / (NumRecords / (Rate * NumStreams) / 3600.0),
+		OpenSeconds * 1000.0, CloseSeconds * 1000.0, NumDropped);
+
+	IFileManager::Get().Delete(*Filename);
+}
+
+void RMG_MRMCBenchmark::RunRecording(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Recording: take recorder appends, unpaced, each timed; open faults the whole file in, close flushes and trims it"));
+
+	// ten hours of one robot, and ten minutes of the stress run's sixteen 1 kHz streams
+	RunRecordingScenario(TEXT("record 1 x 50 Hz, 10 hours"), 1, 50.0, uint64(50 * 3600 * 10) * Scale);
+	RunRecordingScenario(TEXT("record 16 x 1 kHz, 10 minutes"), 16, 1000.0, uint64(16 * 1000 * 600) * Scale);
+}
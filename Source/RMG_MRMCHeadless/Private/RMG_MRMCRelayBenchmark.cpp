@@ -0,0 +1,129 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCRelay.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include <atomic>
+
+// Receive buffer of each subscriber, what a render node's source asks for
+static const int32 RelayBenchmarkReceiveBufferSize = 1024 * 1024;
+
+// Forwards NumPackets datagrams with timestamps to NumSubscribers loopback sockets, IntervalSeconds apart (0 for
+// as fast as it goes), while a subscriber thread drains them all. Logs the cost of Forward() on the receive
+// thread, and the latency from the receive time in the relay header to each subscriber reading the datagram.
+static void RunRelayScenario(const TCHAR* ForwardName, const TCHAR* DeliveryName, int32 NumSubscribers, uint32 NumPackets, double IntervalSeconds)
+{
+	TArray<FSocket*> Sockets;
+	TArray<FIPv4Endpoint> Targets;
+	for (int32 Idx = 0; Idx < NumSubscribers; Idx++)
+	{
+		FSocket* Socket = FUdpSocketBuilder(TEXT("RMG_MRMCRelaySubscriber")).AsNonBlocking().BoundToAddress(FIPv4Address(127, 0, 0, 1)).BoundToPort(0)
+			.WithReceiveBufferSize(RelayBenchmarkReceiveBufferSize);
+		if (Socket == nullptr)
+		{
+			break;
+		}
+		Sockets.Add(Socket);
+		Targets.Add(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), static_cast<uint16>(Socket->GetPortNo())));
+	}
+
+	TUniquePtr<FRMG_MRMCRelay> Relay;
+	if (Sockets.Num() == NumSubscribers)
+	{
+		Relay = FRMG_MRMCRelay::Create(TArray<FIPv4Endpoint>(), Targets, true, 1);
+	}
+	if (!Relay.IsValid())
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Error, TEXT("%s: cannot open the relay or %d subscriber sockets"), ForwardName, NumSubscribers);
+	}
+	else
+	{
+		// the relay sends to every target in order, so once the last has data the others have theirs
+		FRMG_MRMCLatencyHistogram Delivery;
+		uint64 NumDelivered = 0;
+		std::atomic<bool> bForwarded(false);
+		FRMG_MRMCBenchmarkThread Subscribers(TEXT("RMG_MRMCRelaySubscribers"), [&Sockets, &Delivery, &NumDelivered, &bForwarded]()
+		{
+			for (;;)
+			{
+				const bool bWasForwarded = bForwarded;
+				Sockets.Last()->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(10));
+				for (FSocket* Socket : Sockets)
+				{
+					uint8 Received[RMG_MRMCPacketLayout::FRelayHeader::Size + RMG_MRMCPacketDecoder::MaxPacketSize];
+					int32 BytesRead = 0;
+					while (Socket->Recv(Received, sizeof(Received), BytesRead) && BytesRead > 0)
+					{
+						const uint8* Data = Received;
+						int32 Size = BytesRead;
+						int64 ReceiveUnixNs = 0;
+						if (RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, ReceiveUnixNs))
+						{
+							Delivery.RecordSeconds(FPlatformTime::Seconds() - FRMG_MRMCRelay::FromUnixNs(ReceiveUnixNs));
+							NumDelivered++;
+						}
+					}
+				}
+				if (bWasForwarded)
+				{
+					break;
+				}
+			}
+		});
+
+		uint8 Datagram[RMG_MRMCPacketDecoder::MaxPacketSize];
+		const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(1.0, 50, ERMG_MRMCPacketVariant::FrameCounter), Datagram);
+
+		FRMG_MRMCLatencyHistogram PerForward;
+		double Seconds = 0.0;
+		const double StartSeconds = FPlatformTime::Seconds();
+		for (uint32 Idx = 0; Idx < NumPackets; Idx++)
+		{
+			if (IntervalSeconds > 0.0)
+			{
+				const double Due = StartSeconds + Idx * IntervalSeconds;
+				while (FPlatformTime::Seconds() < Due)
+				{
+					FPlatformProcess::Yield();
+				}
+			}
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Relay->Forward(Datagram, Size, FPlatformTime::Seconds());
+			const double ForwardSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+			PerForward.RecordSeconds(ForwardSeconds);
+			Seconds += ForwardSeconds;
+		}
+		bForwarded = true;
+		Subscribers.WaitForCompletion();
+		const double WallSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		RMG_MRMCHeadless::LogResult(ForwardName, NumPackets, Seconds, PerForward);
+		RMG_MRMCHeadless::LogResult(DeliveryName, NumDelivered, WallSeconds, Delivery);
+		// every datagram sent is delivered or lost, sends that failed never left
+		const uint64 NumSent = uint64(NumPackets) * NumSubscribers - Relay->GetFailed();
+		if (Relay->GetFailed() > 0 || NumDelivered < NumSent)
+		{
+			UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu sends failed on a full send buffer, %llu datagrams lost on the way"),
+				TEXT(""), Relay->GetFailed(), NumSent - NumDelivered);
+		}
+	}
+
+	for (FSocket* Socket : Sockets)
+	{
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+	}
+}
+
+void RMG_MRMCBenchmark::RunRelay(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Relay: datagrams with receive timestamps forwarded to loopback subscribers; Forward() cost on the receive thread, then latency from the relay's receive time to each subscriber"));
+
+	const int32 NumSubscribers[] = { 1, 8, 32 };
+	for (const int32 Num : NumSubscribers)
+	{
+		RunRelayScenario(*FString::Printf(TEXT("relay to %d, 1 kHz, Forward()"), Num), *FString::Printf(TEXT("relay to %d, 1 kHz, delivered"), Num), Num, 2000u * Scale, 0.001);
+		RunRelayScenario(*FString::Printf(TEXT("relay to %d, saturated, Forward()"), Num), *FString::Printf(TEXT("relay to %d, saturated, delivered"), Num), Num, 20000u * Scale, 0.0);
+	}
+}
@@ -0,0 +1,227 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCSharedMemoryRing.h"
+#include <atomic>
+
+#if PLATFORM_LINUX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Datagrams taken per recvmmsg call, as the RecvMmsg backend does
+static const int32 SharedMemoryBenchmarkBatch = 64;
+
+// Sends NumPackets datagrams from a producer thread, IntervalSeconds apart (0 for as fast as it goes), while
+// this thread blocks in Receive as the receive thread does, for up to WaitSeconds per call, handing what
+// arrived to Sink. Logs the latency from sending to the sink, and the datagrams lost on the way.
+static void RunSharedMemoryScenario(const TCHAR* Name, uint32 NumPackets, double IntervalSeconds,
+	TFunctionRef<void(const uint8* Data, int32 Size)> Send,
+	TFunctionRef<int32(double WaitSeconds, TFunctionRef<void(const uint8* Data, int32 Size)> Sink)> Receive)
+{
+	uint8 Datagram[RMG_MRMCPacketDecoder::MaxPacketSize];
+	const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(1.0, 50, ERMG_MRMCPacketVariant::FrameCounter), Datagram);
+
+	// written before each send, read once the datagram is through the ring or the socket
+	TArray<double> SentSeconds;
+	SentSeconds.SetNumZeroed(NumPackets);
+
+	std::atomic<bool> bSent(false);
+	const double StartSeconds = FPlatformTime::Seconds();
+	FRMG_MRMCBenchmarkThread Producer(TEXT("RMG_MRMCSharedMemoryProducer"), [&Send, &SentSeconds, &bSent, &Datagram, Size, NumPackets, IntervalSeconds, StartSeconds]()
+	{
+		for (uint32 Idx = 0; Idx < NumPackets; Idx++)
+		{
+			if (IntervalSeconds > 0.0)
+			{
+				const double Due = StartSeconds + Idx * IntervalSeconds;
+				while (FPlatformTime::Seconds() < Due)
+				{
+					FPlatformProcess::Yield();
+				}
+			}
+			uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+			FMemory::Memcpy(Data, Datagram, Size);
+			RMG_MRMCPacketLayout::TField<uint32, 0>::Write(Idx, Data);
+			SentSeconds[Idx] = FPlatformTime::Seconds();
+			Send(Data, Size);
+		}
+		bSent = true;
+	});
+
+	FRMG_MRMCLatencyHistogram Latency;
+	uint32 NumReceived = 0;
+	uint32 NumOutOfOrder = 0;
+	uint32 NextIndex = 0;
+	auto Sink = [&SentSeconds, &Latency, &NumReceived, &NumOutOfOrder, &NextIndex, NumPackets](const uint8* Data, int32 DataSize)
+	{
+		const uint32 Index = RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Data);
+		if (Index < NumPackets)
+		{
+			Latency.RecordSeconds(FPlatformTime::Seconds() - SentSeconds[Index]);
+			NumOutOfOrder += Index < NextIndex;
+			NextIndex = Index + 1;
+			NumReceived++;
+		}
+	};
+
+	// once everything is sent, an empty wait means everything that will arrive has
+	for (;;)
+	{
+		const bool bWasSent = bSent;
+		if (Receive(0.1, Sink) == 0 && bWasSent)
+		{
+			break;
+		}
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+	Producer.WaitForCompletion();
+
+	RMG_MRMCHeadless::LogResult(Name, NumReceived, Seconds, Latency);
+	if (NumReceived < NumPackets || NumOutOfOrder > 0)
+	{
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10u datagrams lost, %u out of order"), TEXT(""), NumPackets - NumReceived, NumOutOfOrder);
+	}
+}
+
+void RMG_MRMCBenchmark::RunSharedMemory(int32 Scale)
+{
+#if PLATFORM_LINUX
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Shared memory: same-machine producer to a sleeping reader, shared-memory ring with a futex wake against loopback UDP with poll and recvmmsg; latency from send to hand-over"));
+
+	struct FScenario
+	{
+		const TCHAR* RingName;
+		const TCHAR* UdpName;
+		uint32 NumPackets;
+		double IntervalSeconds;
+	};
+	const FScenario Scenarios[] =
+	{
+		{ TEXT("shared memory, 1 kHz"), TEXT("loopback UDP, 1 kHz"), 2000u * Scale, 0.001 },
+		{ TEXT("shared memory, 20 kHz"), TEXT("loopback UDP, 20 kHz"), 20000u * Scale, 0.00005 },
+		{ TEXT("shared memory, saturated"), TEXT("loopback UDP, saturated"), 200000u * Scale, 0.0 },
+	};
+
+	for (const FScenario& Scenario : Scenarios)
+	{
+		{
+			// in this process rather than /dev/shm; the slots, the seqlock and the futex are the same
+			TUniquePtr<RMG_MRMCSharedMemory::FRing> Ring = MakeUnique<RMG_MRMCSharedMemory::FRing>();
+			RMG_MRMCSharedMemory::Initialize(*Ring);
+			RMG_MRMCSharedMemory::FReader Reader;
+			Reader.Open(*Ring);
+			std::atomic<uint32> NumWakes(0);
+
+			RunSharedMemoryScenario(Scenario.RingName, Scenario.NumPackets, Scenario.IntervalSeconds,
+				[&Ring, &NumWakes](const uint8* Data, int32 Size)
+				{
+					if (RMG_MRMCSharedMemory::Write(*Ring, 0, Data, Size, 0))
+					{
+						RMG_MRMCSharedMemory::WakeReader(*Ring);
+						NumWakes.fetch_add(1, std::memory_order_relaxed);
+					}
+				},
+				[&Ring, &Reader](double WaitSeconds, TFunctionRef<void(const uint8* Data, int32 Size)> Sink)
+				{
+					auto RingSink = [&Sink](uint16_t Stream, const uint8_t* Data, uint32_t Size, int64_t WriteUnixNs)
+					{
+						Sink(Data, Size);
+					};
+					int32 Received = Reader.Drain(*Ring, RingSink);
+					if (Received > 0)
+					{
+						return Received;
+					}
+
+					// the sleep of the shared-memory receive backend
+					Ring->ReaderWaiting.store(1);
+					const uint32 ExpectedWakeCount = Ring->WakeCount.load();
+					if (!Reader.HasPending(*Ring))
+					{
+						RMG_MRMCSharedMemory::WaitForWake(*Ring, ExpectedWakeCount, WaitSeconds);
+					}
+					Ring->ReaderWaiting.store(0, std::memory_order_relaxed);
+					return static_cast<int32>(Reader.Drain(*Ring, RingSink));
+				});
+			UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10u wake calls, %llu datagrams overwritten"), TEXT(""), NumWakes.load(), static_cast<uint64>(Reader.Overruns));
+		}
+
+		{
+			const int ReceiveFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			const int SendFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+			sockaddr_in Address;
+			FMemory::Memzero(Address);
+			Address.sin_family = AF_INET;
+			Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			socklen_t AddressLength = sizeof(Address);
+			if (ReceiveFd < 0 || SendFd < 0 || bind(ReceiveFd, reinterpret_cast<sockaddr*>(&Address), sizeof(Address)) != 0
+				|| getsockname(ReceiveFd, reinterpret_cast<sockaddr*>(&Address), &AddressLength) != 0
+				|| connect(SendFd, reinterpret_cast<sockaddr*>(&Address), sizeof(Address)) != 0)
+			{
+				UE_LOG(LogRMG_MRMCHeadless, Error, TEXT("%s: cannot open loopback sockets"), Scenario.UdpName);
+			}
+			else
+			{
+				RunSharedMemoryScenario(Scenario.UdpName, Scenario.NumPackets, Scenario.IntervalSeconds,
+					[SendFd](const uint8* Data, int32 Size)
+					{
+						send(SendFd, Data, Size, 0);
+					},
+					[ReceiveFd](double WaitSeconds, TFunctionRef<void(const uint8* Data, int32 Size)> Sink)
+					{
+						uint8 Buffers[SharedMemoryBenchmarkBatch][RMG_MRMCPacketDecoder::MaxPacketSize];
+						iovec Vectors[SharedMemoryBenchmarkBatch];
+						mmsghdr Messages[SharedMemoryBenchmarkBatch];
+						FMemory::Memzero(Messages);
+						for (int32 Idx = 0; Idx < SharedMemoryBenchmarkBatch; Idx++)
+						{
+							Vectors[Idx].iov_base = Buffers[Idx];
+							Vectors[Idx].iov_len = sizeof(Buffers[Idx]);
+							Messages[Idx].msg_hdr.msg_iov = &Vectors[Idx];
+							Messages[Idx].msg_hdr.msg_iovlen = 1;
+						}
+
+						pollfd Poll;
+						Poll.fd = ReceiveFd;
+						Poll.events = POLLIN;
+						Poll.revents = 0;
+						if (poll(&Poll, 1, static_cast<int>(WaitSeconds * 1000.0)) <= 0)
+						{
+							return 0;
+						}
+
+						int32 Received = 0;
+						for (;;)
+						{
+							const int NumMessages = recvmmsg(ReceiveFd, Messages, SharedMemoryBenchmarkBatch, MSG_DONTWAIT, nullptr);
+							if (NumMessages <= 0)
+							{
+								break;
+							}
+							for (int Idx = 0; Idx < NumMessages; Idx++)
+							{
+								Sink(Buffers[Idx], Messages[Idx].msg_len);
+							}
+							Received += NumMessages;
+						}
+						return Received;
+					});
+			}
+			if (ReceiveFd >= 0)
+			{
+				close(ReceiveFd);
+			}
+			if (SendFd >= 0)
+			{
+				close(SendFd);
+			}
+		}
+	}
+#else
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Shared memory: skipped, the comparison needs the futex and sockets of Linux"));
+#endif
+}
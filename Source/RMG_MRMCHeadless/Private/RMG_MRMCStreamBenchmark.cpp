@@ -0,0 +1,226 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFaultInjector.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCStreamProcessor.h"
+#include "RMG_MRMCSubjectMapping.h"
+#include "Misc/App.h"
+
+// Receive time of the first packet; the processors treat 0 as "nothing received yet"
+static const double BenchmarkStartSeconds = 1000.0;
+
+// The capture sink is emptied this often, outside the timed region, so it does not grow over the run
+static const int32 BenchmarkSinkResetPackets = 1024;
+
+// Feeds Datagrams through one processor per stream twice: untimed for throughput, then timing every
+// packet for the distribution. Interpolated processors also push one resampled frame per packet,
+// a period behind, the way the engine evaluates them. Stats collects as in the source and is left
+// holding the second pass. Returns the untimed pass's processing time.
+static double RunStreamScenario(const TCHAR* Name, const FRMG_MRMCCompiledMapping& Mapping, const FRMG_MRMCProcessingOptions& Options, int32 NumStreams, const TArray<FRMG_MRMCBenchmarkDatagram>& Datagrams, FRMG_MRMCStats* Stats)
+{
+	const double Period = Options.SampleRate.AsInterval();
+	FRMG_MRMCCaptureFrameSink Sink;
+	FRMG_MRMCLatencyHistogram PerPacket;
+	double ThroughputSeconds = 0.0;
+	uint64 NumFrames = 0;
+
+	for (int32 Pass = 0; Pass < 2; Pass++)
+	{
+		const bool bTimed = Pass == 1;
+		TArray<TUniquePtr<FRMG_MRMCStreamProcessor>> Processors;
+		for (int32 Stream = 0; Stream < NumStreams; Stream++)
+		{
+			Processors.Add(MakeUnique<FRMG_MRMCStreamProcessor>(Mapping, Options));
+			Processors.Last()->SetStats(Stats);
+			Processors.Last()->PushStaticData(Sink);
+		}
+		Sink.Reset();
+		if (Stats != nullptr)
+		{
+			Stats->Reset();
+		}
+
+		double Seconds = 0.0;
+		for (int32 First = 0; First < Datagrams.Num(); First += BenchmarkSinkResetPackets)
+		{
+			const int32 Last = FMath::Min(First + BenchmarkSinkResetPackets, Datagrams.Num());
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 Idx = First; Idx < Last; Idx++)
+			{
+				const FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Idx];
+				FRMG_MRMCStreamProcessor& Processor = *Processors[Datagram.Stream];
+				const uint64 PacketCycles = bTimed ? FPlatformTime::Cycles64() : 0;
+
+				Processor.ProcessPacket(Datagram.Data, Datagram.Size, Datagram.ReceiveSeconds, Sink);
+				if (Options.bInterpolate)
+				{
+					const double EvaluationSeconds = Datagram.ReceiveSeconds - Period;
+					const FQualifiedFrameTime SceneTime(Options.SampleRate.AsFrameTime(EvaluationSeconds - BenchmarkStartSeconds), Options.SampleRate);
+					Processor.PushInterpolatedFrame(EvaluationSeconds, SceneTime, Sink);
+				}
+
+				if (bTimed)
+				{
+					PerPacket.RecordSeconds(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - PacketCycles));
+				}
+			}
+			Seconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+			if (!bTimed)
+			{
+				NumFrames += Sink.Frames.Num();
+			}
+			Sink.Frames.Reset();
+		}
+
+		if (!bTimed)
+		{
+			ThroughputSeconds = Seconds;
+		}
+	}
+
+	RMG_MRMCHeadless::LogResult(Name, Datagrams.Num(), ThroughputSeconds, PerPacket);
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %10llu subject frames, %.0f ns per frame"),
+		TEXT(""), NumFrames, NumFrames > 0 ? ThroughputSeconds * 1e9 / NumFrames : 0.0);
+	return ThroughputSeconds;
+}
+
+void RMG_MRMCBenchmark::RunRealistic(int32 Scale)
+{
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Realistic: one 50 Hz stream, frame counter datagrams, built-in mapping, 50 fps timecode"));
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Per-packet times include about %.0f ns of timing overhead"), FRMG_MRMCStats::MeasureRecordOverheadNs());
+
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	verify(FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error));
+	FApp::SetTimecodeFrameRate(FFrameRate(50, 1));
+
+	// ten minutes of a move per scale step
+	const int32 NumPackets = 30000 * Scale;
+	TArray<FRMG_MRMCBenchmarkDatagram> Datagrams;
+	Datagrams.SetNumUninitialized(NumPackets);
+	for (int32 Idx = 0; Idx < NumPackets; Idx++)
+	{
+		FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Idx];
+		const double Seconds = Idx / 50.0;
+		Datagram.ReceiveSeconds = BenchmarkStartSeconds + Seconds;
+		Datagram.Stream = 0;
+		Datagram.Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Seconds, Idx, ERMG_MRMCPacketVariant::FrameCounter), Datagram.Data);
+	}
+
+	FRMG_MRMCStats Stats;
+	FRMG_MRMCProcessingOptions Options;
+	RunStreamScenario(TEXT("per packet"), Mapping, Options, 1, Datagrams, &Stats);
+
+	FRMG_MRMCProcessingOptions CameraOptions;
+	CameraOptions.bCameraRole = true;
+	RunStreamScenario(TEXT("camera role"), Mapping, CameraOptions, 1, Datagrams, &Stats);
+
+	FRMG_MRMCProcessingOptions PredictionOptions;
+	PredictionOptions.PredictionLeadMs = 40.0f;
+	RunStreamScenario(TEXT("prediction 40 ms"), Mapping, PredictionOptions, 1, Datagrams, &Stats);
+
+	FRMG_MRMCProcessingOptions InterpolateOptions;
+	InterpolateOptions.bInterpolate = true;
+	RunStreamScenario(TEXT("interpolated"), Mapping, InterpolateOptions, 1, Datagrams, &Stats);
+}
+
+void RMG_MRMCBenchmark::RunStress(int32 Scale)
+{
+	const int32 NumStreams = 16;
+	const int32 NumSubjects = 32;
+	const int32 Rate = 1000;
+
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Stress: %d streams at %d Hz, %d subjects of 4 bones, 1%% loss, 1%% reordering, 0.5%% duplication, stats on"),
+		NumStreams, Rate, NumSubjects);
+
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	verify(FRMG_MRMCCompiledMapping::Compile(RMG_MRMCHeadless::MakeStressMappingJson(NumSubjects), Mapping, Error));
+
+	// timecode at the stream rate, so every accepted sample is pushed: the most work per packet
+	FApp::SetTimecodeFrameRate(FFrameRate(Rate, 1));
+
+	FRMG_MRMCFaultOptions FaultOptions;
+	FaultOptions.Loss = 0.01f;
+	FaultOptions.Reorder = 0.01f;
+	FaultOptions.Duplicate = 0.005f;
+	FaultOptions.Seed = 1;
+	FRMG_MRMCFaultInjector Faults(FaultOptions, NumStreams);
+
+	// ten seconds of all streams per scale step, interleaved the way a receive thread would see them
+	const int32 NumSamples = 10 * Rate * Scale;
+	TArray<FRMG_MRMCBenchmarkDatagram> Datagrams;
+	Datagrams.Reserve(NumSamples * NumStreams * 11 / 10);
+	for (int32 Sample = 0; Sample < NumSamples; Sample++)
+	{
+		const double Seconds = double(Sample) / Rate;
+		for (int32 Stream = 0; Stream < NumStreams; Stream++)
+		{
+			uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+			const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Seconds, Sample, ERMG_MRMCPacketVariant::FrameCounter, Stream * 0.37), Data);
+			Faults.Process(Stream, Data, Size, BenchmarkStartSeconds + Seconds + Stream * 1e-6, [&Datagrams](int32 InStream, const uint8* InData, int32 InSize, double ReceiveSeconds)
+			{
+				FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams.AddDefaulted_GetRef();
+				Datagram.ReceiveSeconds = ReceiveSeconds;
+				Datagram.Stream = InStream;
+				Datagram.Size = InSize;
+				FMemory::Memcpy(Datagram.Data, InData, InSize);
+			});
+		}
+	}
+
+	FRMG_MRMCStats Stats;
+	FRMG_MRMCProcessingOptions Options;
+	Options.SampleRate = FFrameRate(Rate, 1);
+	RunStreamScenario(TEXT("16 x 1 kHz, 32 subjects"), Mapping, Options, NumStreams, Datagrams, &Stats);
+
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Injected %llu lost, %llu duplicated, %llu reordered; tracked %llu lost in %llu gaps, %llu duplicate, %llu stale"),
+		Faults.GetDropped(), Faults.GetDuplicated(), Faults.GetReordered(),
+		Stats.FramesLost.load(), Stats.Gaps.load(), Stats.PacketsDuplicate.load(), Stats.PacketsStale.load());
+	for (const RMG_MRMCStage::Type Stage : { RMG_MRMCStage::Decode, RMG_MRMCStage::Push })
+	{
+		const FRMG_MRMCLatencyHistogram& Histogram = Stats.Stages[Stage];
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-8s mean %6.0f ns  p50 %6llu  p99 %6llu  p99.9 %7llu  max %8llu ns"),
+			RMG_MRMCStage::GetName(Stage), Histogram.GetMean(), Histogram.GetPercentile(50.0), Histogram.GetPercentile(99.0), Histogram.GetPercentile(99.9), Histogram.GetMax());
+	}
+}
+
+void RMG_MRMCBenchmark::RunScaling(int32 Scale)
+{
+	const int32 Rate = 1000;
+	UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("Scaling: 1 to 32 streams at %d Hz, built-in mapping each, one processor per stream on one thread"), Rate);
+
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	verify(FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error));
+	FApp::SetTimecodeFrameRate(FFrameRate(Rate, 1));
+
+	FRMG_MRMCProcessingOptions Options;
+	Options.SampleRate = FFrameRate(Rate, 1);
+
+	// ten seconds of every stream per scale step, interleaved as the receive thread drains its sockets
+	const int32 NumSamples = 10 * Rate * Scale;
+	const double StreamSeconds = double(NumSamples) / Rate;
+	TArray<FRMG_MRMCBenchmarkDatagram> Datagrams;
+	for (int32 NumStreams = 1; NumStreams <= 32; NumStreams *= 2)
+	{
+		Datagrams.SetNumUninitialized(NumSamples * NumStreams);
+		for (int32 Sample = 0; Sample < NumSamples; Sample++)
+		{
+			const double Seconds = double(Sample) / Rate;
+			for (int32 Stream = 0; Stream < NumStreams; Stream++)
+			{
+				FRMG_MRMCBenchmarkDatagram& Datagram = Datagrams[Sample * NumStreams + Stream];
+				Datagram.ReceiveSeconds = BenchmarkStartSeconds + Seconds + Stream * 1e-6;
+				Datagram.Stream = Stream;
+				Datagram.Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Seconds, Sample, ERMG_MRMCPacketVariant::FrameCounter, Stream * 0.37), Datagram.Data);
+			}
+		}
+
+		const FString Name = FString::Printf(TEXT("%d stream%s"), NumStreams, NumStreams > 1 ? TEXT("s") : TEXT(""));
+		const double Seconds = RunStreamScenario(*Name, Mapping, Options, NumStreams, Datagrams, nullptr);
+		UE_LOG(LogRMG_MRMCHeadless, Display, TEXT("%-40s %9.3f%% of a core per stream"), TEXT(""), Seconds * 100.0 / (StreamSeconds * NumStreams));
+	}
+}
@@ -0,0 +1,76 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCPoseKernel.h"
+#include "RMG_MRMCStreamProcessor.h"
+#include "RMG_MRMCSubjectMapping.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCCompiledPlanTest, "RMG_MRMC.Mapping.CompiledPlan", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCCompiledPlanTest::RunTest(const FString& Parameters)
+{
+	// one frame per packet
+	FApp::SetTimecodeFrameRate(FFrameRate(1000, 1));
+
+	const FString MappingJsons[] = { FString(), RMG_MRMCHeadless::MakeStressMappingJson(3) };
+	for (const FString& MappingJson : MappingJsons)
+	{
+		const TCHAR* MappingName = MappingJson.IsEmpty() ? TEXT("built-in") : TEXT("stress");
+		FRMG_MRMCCompiledMapping Mapping;
+		FString Error;
+		if (!TestTrue(FString::Printf(TEXT("%s mapping compiles"), MappingName), FRMG_MRMCCompiledMapping::Compile(MappingJson, Mapping, Error)))
+		{
+			continue;
+		}
+
+		FRMG_MRMCCaptureFrameSink Compiled;
+		FRMG_MRMCCaptureFrameSink Reference;
+		FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+		const FRMG_MRMCReferenceMapping ReferenceMapping(Mapping);
+
+		// 20 s of the orbit, so pan goes all the way round
+		for (int32 Idx = 0; Idx < 2000; Idx++)
+		{
+			const double Seconds = Idx * 0.01;
+			const FRMG_MRMCDecodedPacket Packet = RMG_MRMCHeadless::MakeOrbitSample(Seconds, Idx, ERMG_MRMCPacketVariant::FrameCounter);
+			uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+			const int32 Size = RMG_MRMCPacketDecoder::Encode(Packet, Data);
+			Processor.ProcessPacket(Data, Size, 100.0 + Idx * 0.001, Compiled);
+
+			float Converted[RMG_MRMC_FRAME_VALUE_COUNT];
+			RMG_MRMCPoseKernel::ConvertSample(Packet.Robot, Converted);
+			TArray<float> Values;
+			Values.Append(Converted, RMG_MRMCChannel::Num);
+			ReferenceMapping.PushFrames(Values, 100.0 + Idx * 0.001, Reference);
+		}
+
+		if (!TestEqual(FString::Printf(TEXT("%s frames"), MappingName), Compiled.Frames.Num(), Reference.Frames.Num()))
+		{
+			continue;
+		}
+
+		// the same arithmetic in a different order of lookups, so the frames match exactly
+		int32 NumMismatches = 0;
+		for (int32 FrameIdx = 0; FrameIdx < Compiled.Frames.Num(); FrameIdx++)
+		{
+			const FRMG_MRMCSubjectFrame& A = Compiled.Frames[FrameIdx];
+			const FRMG_MRMCSubjectFrame& B = Reference.Frames[FrameIdx];
+			bool bSame = A.SubjectName == B.SubjectName && A.Transforms.Num() == B.Transforms.Num() && A.PropertyValues == B.PropertyValues;
+			for (int32 Bone = 0; bSame && Bone < A.Transforms.Num(); Bone++)
+			{
+				bSame = A.Transforms[Bone].GetLocation().Equals(B.Transforms[Bone].GetLocation(), 0.0f)
+					&& A.Transforms[Bone].GetRotation().Equals(B.Transforms[Bone].GetRotation(), 0.0f);
+			}
+			NumMismatches += bSame ? 0 : 1;
+		}
+		TestEqual(FString::Printf(TEXT("%s frames differing from the reference evaluation"), MappingName), NumMismatches, 0);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
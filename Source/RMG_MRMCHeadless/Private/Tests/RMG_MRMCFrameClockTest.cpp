@@ -0,0 +1,133 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameClock.h"
+#include "RMG_MRMCSequenceTracker.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Timecode rates a 50 Hz robot is shot against
+static const FFrameRate FrameClockTestRates[] = {
+	FFrameRate(24000, 1001), FFrameRate(24, 1), FFrameRate(25, 1), FFrameRate(30000, 1001),
+	FFrameRate(30, 1), FFrameRate(50, 1), FFrameRate(60000, 1001), FFrameRate(60, 1) };
+
+// 10.01 hours: a whole number of frames at every rate above, 1001 ones included
+static const int64 FrameClockTestSeconds = 36036;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCFrameClockCountTest, "RMG_MRMC.FrameClock.Count", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCFrameClockCountTest::RunTest(const FString& Parameters)
+{
+	const FFrameRate SampleRate(50, 1);
+	const int64 Count = FrameClockTestSeconds * 50;
+	for (const FFrameRate& Rate : FrameClockTestRates)
+	{
+		const FString RateName = FString::Printf(TEXT("%.3f fps"), Rate.AsDecimal());
+		const FFrameTime End = FRMG_MRMCFrameClock::CountToFrames(Count, SampleRate, Rate);
+		const int64 Expected = FrameClockTestSeconds * Rate.Numerator / Rate.Denominator;
+		TestEqual(FString::Printf(TEXT("%s: frame after 10.01 hours"), *RateName), int64(End.GetFrame().Value), Expected);
+		TestEqual(FString::Printf(TEXT("%s: subframe after 10.01 hours"), *RateName), End.GetSubFrame(), 0.0f);
+
+		// one sample short of the end sits exactly one sample period before it
+		const FFrameTime Before = FRMG_MRMCFrameClock::CountToFrames(Count - 1, SampleRate, Rate);
+		TestEqual(FString::Printf(TEXT("%s: one sample before the end"), *RateName), (End - Before).AsDecimal(), Rate.AsDecimal() / 50.0, 1e-6);
+	}
+
+	// before the anchor counts down, never rounding towards it
+	const FFrameTime Negative = FRMG_MRMCFrameClock::CountToFrames(-1, SampleRate, FFrameRate(24, 1));
+	TestEqual(TEXT("one sample before the anchor, frame"), Negative.GetFrame().Value, -1);
+	TestEqual(TEXT("one sample before the anchor, subframe"), Negative.GetSubFrame(), 0.52f, 1e-6f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCFrameClockHoursTest, "RMG_MRMC.FrameClock.Hours", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCFrameClockHoursTest::RunTest(const FString& Parameters)
+{
+	// every sample of 10.01 hours through Evaluate(), with a receive-time reference that jitters by up to
+	// two frames; only the first sample anchors, so none of that jitter may show
+	const int64 Count = FrameClockTestSeconds * 50;
+	const FFrameNumber AnchorFrame(1000);
+	for (const FFrameRate& Rate : FrameClockTestRates)
+	{
+		const FString RateName = FString::Printf(TEXT("%.3f fps"), Rate.AsDecimal());
+		FRMG_MRMCFrameClock Clock;
+		FRandomStream Random(0x484f5552);
+		FFrameTime Last;
+		bool bBackwards = false;
+		for (int64 Idx = 0; Idx <= Count; Idx++)
+		{
+			const FFrameTime Reference = Idx == 0 ? FFrameTime(AnchorFrame) : FFrameTime(AnchorFrame + FFrameNumber(static_cast<int32>(Idx * Rate.Numerator / (50 * Rate.Denominator)) + Random.RandRange(-2, 2)));
+			const FQualifiedFrameTime Time = Clock.Evaluate(static_cast<uint32>(Idx), Reference, Rate, false);
+			bBackwards |= Idx > 0 && Time.Time <= Last;
+			Last = Time.Time;
+		}
+
+		TestFalse(FString::Printf(TEXT("%s: time ran backwards or stood still"), *RateName), bBackwards);
+		TestEqual(FString::Printf(TEXT("%s: re-anchors"), *RateName), Clock.GetReanchorCount(), 0);
+		TestEqual(FString::Printf(TEXT("%s: frame after 10.01 hours"), *RateName), int64(Last.GetFrame().Value), AnchorFrame.Value + FrameClockTestSeconds * Rate.Numerator / Rate.Denominator);
+		TestEqual(FString::Printf(TEXT("%s: subframe after 10.01 hours"), *RateName), Last.GetSubFrame(), 0.0f);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCFrameClockWrapTest, "RMG_MRMC.FrameClock.Wrap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCFrameClockWrapTest::RunTest(const FString& Parameters)
+{
+	// 50 Hz at 25 fps across the 32-bit wrap: two samples a frame, straight through
+	const FFrameRate Rate(25, 1);
+	FRMG_MRMCFrameClock Clock;
+	const uint32 FirstCounter = 0xffffff00;
+	FQualifiedFrameTime Time;
+	for (uint32 Idx = 0; Idx < 1000; Idx++)
+	{
+		Time = Clock.Evaluate(FirstCounter + Idx, FFrameTime(FFrameNumber(static_cast<int32>(Idx / 2))), Rate, false);
+	}
+	TestEqual(TEXT("re-anchors across the wrap"), Clock.GetReanchorCount(), 0);
+	TestEqual(TEXT("frame after the wrap"), Time.Time.GetFrame().Value, 499);
+	TestEqual(TEXT("subframe after the wrap"), Time.Time.GetSubFrame(), 0.5f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCFrameClockReanchorTest, "RMG_MRMC.FrameClock.Reanchor", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCFrameClockReanchorTest::RunTest(const FString& Parameters)
+{
+	const FFrameRate Rate(25, 1);
+	FRMG_MRMCFrameClock Clock;
+	uint32 Counter = 100;
+
+	// timecode that agrees with the count to within the anchor's place in its frame keeps the anchor
+	for (int32 Idx = 0; Idx < 50; Idx++, Counter++)
+	{
+		Clock.Evaluate(Counter, FFrameTime(FFrameNumber(500 + Idx / 2)), Rate, true);
+	}
+	TestEqual(TEXT("re-anchors with agreeing timecode"), Clock.GetReanchorCount(), 0);
+
+	// re-jammed a hundred frames ahead: the sent timecode wins and counting continues from it
+	FQualifiedFrameTime Time = Clock.Evaluate(Counter++, FFrameTime(FFrameNumber(625)), Rate, true);
+	TestEqual(TEXT("re-anchors after a re-jam"), Clock.GetReanchorCount(), 1);
+	TestEqual(TEXT("frame after a re-jam"), Time.Time.GetFrame().Value, 625);
+	Time = Clock.Evaluate(Counter++, FFrameTime(FFrameNumber(625)), Rate, true);
+	TestEqual(TEXT("counted on from the re-jam"), Time.Time.AsDecimal(), 625.5, 1e-6);
+	TestEqual(TEXT("re-anchors counting on from a re-jam"), Clock.GetReanchorCount(), 1);
+
+	// project rate changed to 30 fps: anchored afresh at the new rate
+	Time = Clock.Evaluate(Counter++, FFrameTime(FFrameNumber(900)), FFrameRate(30, 1), false);
+	TestEqual(TEXT("re-anchors after a rate change"), Clock.GetReanchorCount(), 2);
+	TestTrue(TEXT("rate after a rate change"), Time.Rate == FFrameRate(30, 1));
+	TestEqual(TEXT("frame after a rate change"), Time.Time.GetFrame().Value, 900);
+	Time = Clock.Evaluate(Counter++, FFrameTime(FFrameNumber(0)), FFrameRate(30, 1), false);
+	TestEqual(TEXT("counted on at the new rate"), Time.Time.AsDecimal(), 900.6, 1e-6);
+
+	// robot restarted: the counter jumps back and the receive time anchors again
+	Time = Clock.Evaluate(Counter - RMG_MRMC_SEQUENCE_RESYNC - 10, FFrameTime(FFrameNumber(2000)), FFrameRate(30, 1), false);
+	TestEqual(TEXT("re-anchors after a counter jump"), Clock.GetReanchorCount(), 3);
+	TestEqual(TEXT("frame after a counter jump"), Time.Time.GetFrame().Value, 2000);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
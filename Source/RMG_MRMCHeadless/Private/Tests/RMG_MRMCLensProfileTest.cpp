@@ -0,0 +1,193 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCLensProfile.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Calibrations shaped like real ones: a zoom lens' focal length, rising ever faster; focus distance, from
+// 60 cm to near infinity; and k1 crossing zero from barrel to pincushion
+static const TArray<FVector2D>& LensTestFocalLength()
+{
+	static const TArray<FVector2D> Points = { FVector2D(0, 7.4f), FVector2D(8000, 9.1f), FVector2D(16000, 11.6f), FVector2D(24000, 15.2f),
+		FVector2D(32000, 20.5f), FVector2D(40000, 28.8f), FVector2D(48000, 42.0f), FVector2D(56000, 66.0f), FVector2D(62000, 102.0f), FVector2D(65535, 137.0f) };
+	return Points;
+}
+
+static const TArray<FVector2D>& LensTestFocusDistance()
+{
+	static const TArray<FVector2D> Points = { FVector2D(0, 60.0f), FVector2D(10000, 75.0f), FVector2D(25000, 120.0f), FVector2D(40000, 250.0f),
+		FVector2D(52000, 700.0f), FVector2D(60000, 3000.0f), FVector2D(65535, 100000.0f) };
+	return Points;
+}
+
+static const TArray<FVector2D>& LensTestK1()
+{
+	static const TArray<FVector2D> Points = { FVector2D(0, -0.08f), FVector2D(20000, -0.03f), FVector2D(35000, 0.0f), FVector2D(50000, 0.012f), FVector2D(65535, 0.01f) };
+	return Points;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCLensProfileMonotoneTest, "RMG_MRMC.LensProfile.Monotone", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCLensProfileMonotoneTest::RunTest(const FString& Parameters)
+{
+	// a peak at 40000, a shallow dip to 50000 and a plateau: a plain cubic spline rings around all three
+	const TArray<FVector2D> Points = { FVector2D(0, 7.4f), FVector2D(10000, 20.0f), FVector2D(30000, 60.0f), FVector2D(40000, 62.0f),
+		FVector2D(50000, 40.0f), FVector2D(60000, 40.0f), FVector2D(65535, 39.0f) };
+	FRMG_MRMCLensCurve Curve;
+	FString Error;
+	TestTrue(TEXT("curve accepted"), Curve.Set(Points, Error));
+
+	for (const FVector2D& Point : Points)
+	{
+		TestEqual(FString::Printf(TEXT("passes through the point at %g"), Point.X), Curve.Evaluate(Point.X), Point.Y, 1e-4f);
+	}
+
+	// every encoder value: each segment stays between its ends and moves one way only
+	int32 NumOutside = 0;
+	int32 NumReversed = 0;
+	for (int32 Seg = 0; Seg + 1 < Points.Num(); Seg++)
+	{
+		const FVector2D& Low = Points[Seg];
+		const FVector2D& High = Points[Seg + 1];
+		const float Tolerance = 1e-5f * FMath::Max(FMath::Abs(Low.Y), FMath::Abs(High.Y));
+		const float Direction = FMath::Sign(High.Y - Low.Y);
+		float Last = Low.Y;
+		for (int32 Input = static_cast<int32>(Low.X) + 1; Input <= static_cast<int32>(High.X); Input++)
+		{
+			const float Value = Curve.Evaluate(static_cast<float>(Input));
+			NumOutside += Value < FMath::Min(Low.Y, High.Y) - Tolerance || Value > FMath::Max(Low.Y, High.Y) + Tolerance;
+			NumReversed += (Value - Last) * Direction < -Tolerance || (Direction == 0.0f && FMath::Abs(Value - Last) > Tolerance);
+			Last = Value;
+		}
+	}
+	TestEqual(TEXT("encoder values outside their segment's ends"), NumOutside, 0);
+	TestEqual(TEXT("encoder values moving against their segment"), NumReversed, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCLensProfileLutErrorTest, "RMG_MRMC.LensProfile.LutError", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCLensProfileLutErrorTest::RunTest(const FString& Parameters)
+{
+	const TArray<FVector2D>* Curves[] = { &LensTestFocalLength(), &LensTestFocusDistance(), &LensTestK1() };
+	const TCHAR* const Names[] = { TEXT("focal length"), TEXT("focus distance"), TEXT("k1") };
+	for (int32 CurveIdx = 0; CurveIdx < UE_ARRAY_COUNT(Curves); CurveIdx++)
+	{
+		FRMG_MRMCLensCurve Curve;
+		FString Error;
+		Curve.Set(*Curves[CurveIdx], Error);
+		FRMG_MRMCLensLut Lut;
+		const float BuildError = Lut.Build(Curve, 1e-4f);
+
+		// relative to the value, or to a hundredth of the range near zero, as the table is built
+		float MinValue = MAX_flt;
+		float MaxValue = -MAX_flt;
+		for (const FVector2D& Point : *Curves[CurveIdx])
+		{
+			MinValue = FMath::Min(MinValue, Point.Y);
+			MaxValue = FMath::Max(MaxValue, Point.Y);
+		}
+		const float Floor = (MaxValue - MinValue) * 0.01f;
+
+		// every encoder value and random ones between them, not just the midpoints Build() checks
+		FRandomStream Random(0x4c555421);
+		float WorstError = 0.0f;
+		for (int32 Idx = 0; Idx <= 2 * 65535; Idx++)
+		{
+			const float Input = Idx <= 65535 ? static_cast<float>(Idx) : Random.FRandRange(0.0f, 65535.0f);
+			const float Expected = Curve.Evaluate(Input);
+			WorstError = FMath::Max(WorstError, FMath::Abs(Lut.Evaluate(Input) - Expected) / FMath::Max(FMath::Abs(Expected), Floor));
+		}
+		AddInfo(FString::Printf(TEXT("%s: %d entries, error %.3g when built, %.3g over every encoder value"), Names[CurveIdx], Lut.Num(), BuildError, WorstError));
+		TestTrue(FString::Printf(TEXT("%s: error when built within 1e-4"), Names[CurveIdx]), BuildError <= 1e-4f);
+		TestTrue(FString::Printf(TEXT("%s: error over every encoder value within 1e-4"), Names[CurveIdx]), WorstError <= 1e-4f);
+	}
+
+	FRMG_MRMCLensProfile Profile;
+	FString Error;
+	TestTrue(TEXT("profile compiled"), FRMG_MRMCLensProfile::Compile(TEXT("{ \"name\": \"test\", \"zoom\": { \"focalLength\": [[0, 7.4], [32000, 20.5], [65535, 137]], \"k1\": [[0, -0.08], [35000, 0], [65535, 0.01]] },")
+		TEXT(" \"focus\": { \"distance\": [[0, 60], [52000, 700], [65535, 100000]] } }"), Profile, Error));
+	TestTrue(TEXT("profile error within 1e-4"), Profile.GetLutError() <= 1e-4f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCLensProfileClampTest, "RMG_MRMC.LensProfile.Clamp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCLensProfileClampTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCLensCurve Curve;
+	FString Error;
+	Curve.Set(LensTestFocalLength(), Error);
+	FRMG_MRMCLensLut Lut;
+	Lut.Build(Curve, 1e-4f);
+
+	// encoders outside the calibration clamp to its ends; NaN from a broken packet lands on the first point
+	const float Inputs[] = { -1.0f, -1e30f, -INFINITY, 65536.0f, 1e30f, INFINITY, NAN };
+	const float Expected[] = { 7.4f, 7.4f, 7.4f, 137.0f, 137.0f, 137.0f, 7.4f };
+	for (int32 Idx = 0; Idx < UE_ARRAY_COUNT(Inputs); Idx++)
+	{
+		TestEqual(FString::Printf(TEXT("curve at %g"), Inputs[Idx]), Curve.Evaluate(Inputs[Idx]), Expected[Idx]);
+		TestEqual(FString::Printf(TEXT("table at %g"), Inputs[Idx]), Lut.Evaluate(Inputs[Idx]), Expected[Idx], 1e-4f);
+	}
+
+	// a single point is a constant
+	FRMG_MRMCLensCurve Constant;
+	Constant.Set({ FVector2D(1000, 50.0f) }, Error);
+	FRMG_MRMCLensLut ConstantLut;
+	ConstantLut.Build(Constant, 1e-4f);
+	TestEqual(TEXT("single point table below"), ConstantLut.Evaluate(0.0f), 50.0f);
+	TestEqual(TEXT("single point table above"), ConstantLut.Evaluate(65535.0f), 50.0f);
+	TestEqual(TEXT("single point table at NaN"), ConstantLut.Evaluate(NAN), 50.0f);
+
+	// through the profile, channels without a curve keep their converted value
+	FRMG_MRMCLensProfile Profile;
+	TestTrue(TEXT("profile compiled"), FRMG_MRMCLensProfile::Compile(TEXT("{ \"zoom\": { \"focalLength\": [[0, 7.4], [65535, 137]] } }"), Profile, Error));
+	RobotData Sample;
+	Sample.zoom = NAN;
+	Sample.focus = NAN;
+	float Values[RMG_MRMC_FRAME_VALUE_COUNT] = {};
+	Values[RMG_MRMCChannel::Focus] = 3.0f;
+	Profile.Apply(Sample, Values);
+	TestEqual(TEXT("focal length from a NaN zoom encoder"), Values[RMG_MRMCChannel::Zoom], 7.4f, 1e-4f);
+	TestEqual(TEXT("focus without a curve"), Values[RMG_MRMCChannel::Focus], 3.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCLensProfileBadJsonTest, "RMG_MRMC.LensProfile.BadJson", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCLensProfileBadJsonTest::RunTest(const FString& Parameters)
+{
+	const TCHAR* const Rejected[] = {
+		TEXT("zoom 0 7.4"),
+		TEXT("{ \"zoom\": { \"focalLength\": [[0, 7.4], [65535, 137]] }"),
+		TEXT("{ \"name\": \"no curves\" }"),
+		TEXT("{ \"zoom\": { \"focalLength\": [] } }"),
+		TEXT("{ \"zoom\": [[0, 7.4], [65535, 137]] }"),
+		TEXT("{ \"zoom\": { \"focalLength\": \"wide\" } }"),
+		TEXT("{ \"zoom\": { \"focalLength\": [[0, 7.4, 1], [65535, 137]] } }"),
+		TEXT("{ \"zoom\": { \"focalLength\": [[0, \"7.4\"], [65535, 137]] } }"),
+		TEXT("{ \"zoom\": { \"focalLength\": [[65535, 137], [0, 7.4]] } }"),
+		TEXT("{ \"zoom\": { \"focalLength\": [[0, 7.4], [0, 8], [65535, 137]] } }"),
+		TEXT("{ \"zoom\": { \"focalLength\": [[0, 7.4], [65535, 137]] }, \"focus\": { \"distance\": [[0, 60], [0, 100000]] } }"),
+	};
+	for (const TCHAR* Json : Rejected)
+	{
+		FRMG_MRMCLensProfile Profile;
+		FString Error;
+		const bool bCompiled = FRMG_MRMCLensProfile::Compile(Json, Profile, Error);
+		TestFalse(FString::Printf(TEXT("compiled %s"), Json), bCompiled);
+		TestFalse(FString::Printf(TEXT("no reason given for %s"), Json), Error.IsEmpty());
+		TestTrue(FString::Printf(TEXT("profile left empty by %s"), Json), Profile.IsEmpty());
+	}
+
+	FRMG_MRMCLensProfile Profile;
+	FString Error;
+	TestTrue(TEXT("focus alone accepted"), FRMG_MRMCLensProfile::Compile(TEXT("{ \"focus\": { \"distance\": [[0, 60], [65535, 100000]] } }"), Profile, Error));
+	TestFalse(TEXT("focus alone has no focal length"), Profile.HasFocalLength());
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
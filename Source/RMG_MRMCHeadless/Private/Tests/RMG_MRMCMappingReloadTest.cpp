@@ -0,0 +1,85 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCStreamProcessor.h"
+#include "RMG_MRMCSubjectMapping.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// The built-in robot_camera rig with the given "camera" object and rotation channels, plus camera_target
+// unless bWithTarget is false
+static FString MakeReloadMappingJson(const TCHAR* CameraObject, const TCHAR* RotationIndex, bool bWithTarget = true)
+{
+	FString Json = FString::Printf(TEXT("{ \"sources\": [{ \"subject\": \"robot_camera\", \"camera\": %s,"
+		" \"properties\": [\"Roll\", \"Focus\", \"Zoom\"], \"propertyIndex\": [6, 7, 8], \"bones\": ["
+		"{ \"name\": \"top\", \"parent\": \"\", \"index\": [-1, -1, -1, -1, -1, -1] },"
+		"{ \"name\": \"CameraPose\", \"parent\": \"top\", \"index\": [0, 1, 2, %s] }] }"), CameraObject, RotationIndex);
+	if (bWithTarget)
+	{
+		Json += TEXT(", { \"subject\": \"camera_target\", \"bones\": ["
+			"{ \"name\": \"top\", \"parent\": \"\", \"index\": [-1, -1, -1, -1, -1, -1] },"
+			"{ \"name\": \"CameraTarget\", \"parent\": \"top\", \"index\": [9, 10, 11, -1, -1, -1] }] }");
+	}
+	return Json + TEXT("] }");
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCMappingReloadTest, "RMG_MRMC.Mapping.Reload", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCMappingReloadTest::RunTest(const FString& Parameters)
+{
+	FString Error;
+	FRMG_MRMCCompiledMapping Initial;
+	FRMG_MRMCCompiledMapping Rechanneled;
+	FRMG_MRMCCompiledMapping NoFocusDistance;
+	FRMG_MRMCCompiledMapping FocalLengthChannel;
+	FRMG_MRMCCompiledMapping Filmback;
+	FRMG_MRMCCompiledMapping NoTarget;
+	if (!TestTrue(TEXT("initial mapping compiles"), FRMG_MRMCCompiledMapping::Compile(MakeReloadMappingJson(TEXT("{}"), TEXT("3, 4, 5")), Initial, Error))
+		|| !TestTrue(TEXT("rechanneled mapping compiles"), FRMG_MRMCCompiledMapping::Compile(MakeReloadMappingJson(TEXT("{}"), TEXT("6, 4, 5")), Rechanneled, Error))
+		|| !TestTrue(TEXT("mapping without focus distance compiles"), FRMG_MRMCCompiledMapping::Compile(MakeReloadMappingJson(TEXT("{ \"focusDistanceIndex\": -1 }"), TEXT("3, 4, 5")), NoFocusDistance, Error))
+		|| !TestTrue(TEXT("mapping with a converted focal length compiles"), FRMG_MRMCCompiledMapping::Compile(MakeReloadMappingJson(TEXT("{ \"focalLengthIndex\": 12 }"), TEXT("3, 4, 5")), FocalLengthChannel, Error))
+		|| !TestTrue(TEXT("mapping with another filmback compiles"), FRMG_MRMCCompiledMapping::Compile(MakeReloadMappingJson(TEXT("{ \"filmback\": [36, 24] }"), TEXT("3, 4, 5")), Filmback, Error))
+		|| !TestTrue(TEXT("mapping without camera_target compiles"), FRMG_MRMCCompiledMapping::Compile(MakeReloadMappingJson(TEXT("{}"), TEXT("3, 4, 5"), false), NoTarget, Error)))
+	{
+		AddError(Error);
+		return false;
+	}
+
+	FRMG_MRMCProcessingOptions Options;
+	Options.bCameraRole = true;
+	FRMG_MRMCCaptureFrameSink Sink;
+	FRMG_MRMCStreamProcessor Processor(Initial, Options);
+	Processor.PushStaticData(Sink);
+
+	// other channels feeding the same layout keep the subject streaming
+	TestEqual(TEXT("subjects pushed after changing a rotation channel"), Processor.SetMapping(Rechanneled, Sink), 0);
+
+	// unmapping the focus distance changes what the camera static data reports
+	TestEqual(TEXT("subjects pushed after unmapping the focus distance"), Processor.SetMapping(NoFocusDistance, Sink), 1);
+	const FRMG_MRMCSubjectStaticData* CameraStatic = Sink.StaticData.Find(TEXT("robot_camera"));
+	TestTrue(TEXT("static data without a focus distance"), CameraStatic != nullptr && !CameraStatic->bHasFocusDistance);
+	TestEqual(TEXT("subjects pushed after mapping the focus distance again"), Processor.SetMapping(Initial, Sink), 1);
+	CameraStatic = Sink.StaticData.Find(TEXT("robot_camera"));
+	TestTrue(TEXT("static data with a focus distance"), CameraStatic != nullptr && CameraStatic->bHasFocusDistance);
+
+	// the raw zoom encoder is no focal length without a lens profile, any other channel is
+	TestEqual(TEXT("subjects pushed after moving the focal length off zoom"), Processor.SetMapping(FocalLengthChannel, Sink), 1);
+	CameraStatic = Sink.StaticData.Find(TEXT("robot_camera"));
+	TestTrue(TEXT("static data with a focal length"), CameraStatic != nullptr && CameraStatic->bHasFocalLength);
+
+	TestEqual(TEXT("subjects pushed after changing the filmback"), Processor.SetMapping(Filmback, Sink), 1);
+	CameraStatic = Sink.StaticData.Find(TEXT("robot_camera"));
+	TestTrue(TEXT("static data with the new filmback"), CameraStatic != nullptr && CameraStatic->Filmback == FVector2D(36.0f, 24.0f));
+
+	TestEqual(TEXT("subjects pushed after restoring the filmback"), Processor.SetMapping(Initial, Sink), 1);
+
+	TestEqual(TEXT("subjects pushed after removing camera_target"), Processor.SetMapping(NoTarget, Sink), 0);
+	TestFalse(TEXT("camera_target removed"), Sink.StaticData.Contains(TEXT("camera_target")));
+	TestEqual(TEXT("subjects pushed after adding camera_target back"), Processor.SetMapping(Initial, Sink), 1);
+	TestTrue(TEXT("camera_target set up again"), Sink.StaticData.Contains(TEXT("camera_target")));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
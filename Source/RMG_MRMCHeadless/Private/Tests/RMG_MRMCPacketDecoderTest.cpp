@@ -0,0 +1,227 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPacketDecoder.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const ERMG_MRMCPacketVariant DecoderTestVariants[] = { ERMG_MRMCPacketVariant::Basic, ERMG_MRMCPacketVariant::FrameCounter, ERMG_MRMCPacketVariant::Timecode };
+
+static bool IsSameSample(const RobotData& A, const RobotData& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(RobotData)) == 0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketDecoderRoundTripTest, "RMG_MRMC.Decoder.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketDecoderRoundTripTest::RunTest(const FString& Parameters)
+{
+	const int32 ExpectedSizes[] = { 36, 40, 44 };
+	for (int32 VariantIdx = 0; VariantIdx < UE_ARRAY_COUNT(DecoderTestVariants); VariantIdx++)
+	{
+		const ERMG_MRMCPacketVariant Variant = DecoderTestVariants[VariantIdx];
+		FRMG_MRMCDecodedPacket Packet = RMG_MRMCHeadless::MakeOrbitSample(4321.77, 0xfffffffe, Variant);
+		Packet.Robot.xt = -0.0f;
+		Packet.Robot.yt = 1.0e-40f;
+
+		uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+		const int32 Size = RMG_MRMCPacketDecoder::Encode(Packet, Data);
+		TestEqual(FString::Printf(TEXT("variant %d size"), VariantIdx), Size, ExpectedSizes[VariantIdx]);
+
+		FRMG_MRMCDecodedPacket Decoded;
+		if (!TestTrue(FString::Printf(TEXT("variant %d decodes"), VariantIdx), RMG_MRMCPacketDecoder::Decode(Data, Size, Decoded)))
+		{
+			continue;
+		}
+		TestTrue(FString::Printf(TEXT("variant %d selected by size"), VariantIdx), Decoded.Variant == Variant);
+		TestTrue(FString::Printf(TEXT("variant %d sample bits"), VariantIdx), IsSameSample(Decoded.Robot, Packet.Robot));
+		TestEqual(FString::Printf(TEXT("variant %d frame counter"), VariantIdx), Decoded.FrameCounter, Variant == ERMG_MRMCPacketVariant::Basic ? 0u : Packet.FrameCounter);
+		TestEqual(FString::Printf(TEXT("variant %d timecode"), VariantIdx), Decoded.Timecode, Variant == ERMG_MRMCPacketVariant::Timecode ? Packet.Timecode : 0u);
+	}
+
+	// the wire format is little endian whatever the host: 1.0f is 0x3f800000, the counter follows the nine floats
+	FRMG_MRMCDecodedPacket Packet;
+	Packet.Variant = ERMG_MRMCPacketVariant::Timecode;
+	Packet.Robot.xv = 1.0f;
+	Packet.FrameCounter = 0x11223344;
+	Packet.Timecode = 0x0a0b0c0d;
+	uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+	RMG_MRMCPacketDecoder::Encode(Packet, Data);
+	const uint8 ExpectedX[] = { 0x00, 0x00, 0x80, 0x3f };
+	const uint8 ExpectedCounter[] = { 0x44, 0x33, 0x22, 0x11 };
+	const uint8 ExpectedTimecode[] = { 0x0d, 0x0c, 0x0b, 0x0a };
+	TestTrue(TEXT("camera x little endian at offset 0"), FMemory::Memcmp(Data, ExpectedX, 4) == 0);
+	TestTrue(TEXT("frame counter little endian at offset 36"), FMemory::Memcmp(Data + 36, ExpectedCounter, 4) == 0);
+	TestTrue(TEXT("timecode little endian at offset 40"), FMemory::Memcmp(Data + 40, ExpectedTimecode, 4) == 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketDecoderEndianTest, "RMG_MRMC.Decoder.Endianness", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketDecoderEndianTest::RunTest(const FString& Parameters)
+{
+	using namespace RMG_MRMCPacketLayout;
+
+	uint8 Data[8] = {};
+	TField<uint32, 0, EEndian::Little>::Write(0x01020304, Data);
+	TField<uint32, 4, EEndian::Big>::Write(0x01020304, Data);
+	const uint8 Expected[] = { 0x04, 0x03, 0x02, 0x01, 0x01, 0x02, 0x03, 0x04 };
+	TestTrue(TEXT("little and big endian byte order"), FMemory::Memcmp(Data, Expected, sizeof(Expected)) == 0);
+	TestEqual(TEXT("little endian read"), TField<uint32, 0, EEndian::Little>::Read(Data), 0x01020304u);
+	TestEqual(TEXT("big endian read"), TField<uint32, 4, EEndian::Big>::Read(Data), 0x01020304u);
+	TestEqual(TEXT("same bytes read the other way"), TField<uint32, 4, EEndian::Little>::Read(Data), 0x04030201u);
+
+	const float Values[] = { 0.0f, -0.0f, 1.5f, -3.0e38f, 1.0e-40f, PI };
+	for (const float Value : Values)
+	{
+		TField<float, 0, EEndian::Big>::Write(Value, Data);
+		const float Big = TField<float, 0, EEndian::Big>::Read(Data);
+		TField<float, 4, EEndian::Little>::Write(Value, Data);
+		const float Little = TField<float, 4, EEndian::Little>::Read(Data);
+		TestTrue(FString::Printf(TEXT("%g round trips bit exact"), Value), FMemory::Memcmp(&Big, &Value, 4) == 0 && FMemory::Memcmp(&Little, &Value, 4) == 0);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketDecoderSizeTest, "RMG_MRMC.Decoder.Sizes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketDecoderSizeTest::RunTest(const FString& Parameters)
+{
+	uint8 Data[128];
+	FMemory::Memset(Data, 0x5a, sizeof(Data));
+
+	for (int32 Size = 0; Size <= UE_ARRAY_COUNT(Data); Size++)
+	{
+		FRMG_MRMCDecodedPacket Packet;
+		Packet.Variant = ERMG_MRMCPacketVariant::Timecode;
+		Packet.FrameCounter = 7;
+		const bool bDecoded = RMG_MRMCPacketDecoder::Decode(Data, Size, Packet);
+		const bool bKnownSize = Size == 36 || Size == 40 || Size == 44;
+		TestEqual(FString::Printf(TEXT("%d bytes accepted"), Size), bDecoded, bKnownSize);
+		if (!bKnownSize)
+		{
+			TestTrue(FString::Printf(TEXT("%d bytes leave the packet untouched"), Size), Packet.Variant == ERMG_MRMCPacketVariant::Timecode && Packet.FrameCounter == 7);
+		}
+	}
+	FRMG_MRMCDecodedPacket Packet;
+	TestFalse(TEXT("negative size rejected"), RMG_MRMCPacketDecoder::Decode(Data, -36, Packet));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketDecoderRelayTest, "RMG_MRMC.Decoder.RelayHeader", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketDecoderRelayTest::RunTest(const FString& Parameters)
+{
+	using namespace RMG_MRMCPacketLayout;
+
+	// past 2^32 ns so both header words matter
+	const int64 ReceiveUnixNs = 1760000000123456789ll;
+
+	for (int32 VariantIdx = 0; VariantIdx < UE_ARRAY_COUNT(DecoderTestVariants); VariantIdx++)
+	{
+		uint8 Buffer[FRelayHeader::Size + RMG_MRMCPacketDecoder::MaxPacketSize];
+		RMG_MRMCPacketDecoder::WriteRelayHeader(ReceiveUnixNs, Buffer);
+		const FRMG_MRMCDecodedPacket Packet = RMG_MRMCHeadless::MakeOrbitSample(12.34, 617, DecoderTestVariants[VariantIdx]);
+		const int32 PayloadSize = RMG_MRMCPacketDecoder::Encode(Packet, Buffer + FRelayHeader::Size);
+
+		const uint8* Data = Buffer;
+		int32 Size = FRelayHeader::Size + PayloadSize;
+		int64 StrippedNs = 0;
+		TestTrue(FString::Printf(TEXT("%d byte relayed datagram stripped"), Size), RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, StrippedNs));
+		TestEqual(TEXT("receive time"), StrippedNs, ReceiveUnixNs);
+		TestTrue(TEXT("payload follows the header"), Data == Buffer + FRelayHeader::Size && Size == PayloadSize);
+
+		FRMG_MRMCDecodedPacket Decoded;
+		TestTrue(TEXT("relayed payload decodes"), RMG_MRMCPacketDecoder::Decode(Data, Size, Decoded) && Decoded.Variant == Packet.Variant && IsSameSample(Decoded.Robot, Packet.Robot));
+	}
+
+	// a plain datagram whose first float happens to read as the magic is never stripped: it is shorter
+	// than a header plus the smallest sample
+	uint8 Plain[FRelayHeader::Size + RMG_MRMCPacketDecoder::MaxPacketSize] = {};
+	RMG_MRMCPacketDecoder::WriteRelayHeader(ReceiveUnixNs, Plain);
+	for (int32 Size = 0; Size < FRelayHeader::Size + FBasic::Size; Size++)
+	{
+		const uint8* Data = Plain;
+		int32 StrippedSize = Size;
+		int64 StrippedNs = 0;
+		TestFalse(FString::Printf(TEXT("%d bytes not stripped"), Size), RMG_MRMCPacketDecoder::StripRelayHeader(Data, StrippedSize, StrippedNs));
+		TestTrue(TEXT("unstripped datagram untouched"), Data == Plain && StrippedSize == Size);
+	}
+
+	const uint8* Data = Plain;
+	int32 Size = FRelayHeader::Size + FBasic::Size;
+	int64 StrippedNs = 0;
+	FRelayHeader::Version::Write(FRelayHeader::VersionValue + 1, Plain);
+	TestFalse(TEXT("unknown header version not stripped"), RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, StrippedNs));
+	FRelayHeader::Version::Write(FRelayHeader::VersionValue, Plain);
+	FRelayHeader::Magic::Write(FRelayHeader::MagicValue ^ 1, Plain);
+	TestFalse(TEXT("wrong magic not stripped"), RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, StrippedNs));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketDecoderFuzzTest, "RMG_MRMC.Decoder.Fuzz", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketDecoderFuzzTest::RunTest(const FString& Parameters)
+{
+	using namespace RMG_MRMCPacketLayout;
+
+	// fixed seed, so a failure reproduces
+	FRandomStream Random(0x524d4746);
+	const int32 MaxFuzzSize = 96;
+	uint8 Buffer[MaxFuzzSize];
+	int32 NumMismatches = 0;
+	int32 NumOutOfBounds = 0;
+
+	for (int32 Iteration = 0; Iteration < 200000; Iteration++)
+	{
+		int32 Size;
+		if (Iteration % 2 == 0)
+		{
+			// random bytes, sometimes behind a valid relay header
+			Size = Random.RandRange(0, MaxFuzzSize);
+			for (int32 Idx = 0; Idx < Size; Idx++)
+			{
+				Buffer[Idx] = static_cast<uint8>(Random.RandRange(0, 255));
+			}
+			if (Size >= FRelayHeader::Size && Random.RandRange(0, 3) == 0)
+			{
+				RMG_MRMCPacketDecoder::WriteRelayHeader(Random.GetUnsignedInt(), Buffer);
+			}
+		}
+		else
+		{
+			// a valid datagram with flipped bits and a size off by a little
+			const FRMG_MRMCDecodedPacket Packet = RMG_MRMCHeadless::MakeOrbitSample(Iteration * 0.02, Iteration, DecoderTestVariants[Iteration / 2 % 3]);
+			Size = RMG_MRMCPacketDecoder::Encode(Packet, Buffer) + Random.RandRange(-5, 5);
+			for (int32 Flip = Random.RandRange(0, 4); Flip > 0; Flip--)
+			{
+				Buffer[Random.RandRange(0, MaxFuzzSize - 1)] ^= static_cast<uint8>(1 << Random.RandRange(0, 7));
+			}
+		}
+
+		const uint8* Data = Buffer;
+		int32 DataSize = Size;
+		int64 ReceiveUnixNs = 0;
+		RMG_MRMCPacketDecoder::StripRelayHeader(Data, DataSize, ReceiveUnixNs);
+		if (Data < Buffer || DataSize < 0 || Data + DataSize != Buffer + Size)
+		{
+			NumOutOfBounds++;
+			continue;
+		}
+
+		FRMG_MRMCDecodedPacket Decoded;
+		const bool bDecoded = RMG_MRMCPacketDecoder::Decode(Data, DataSize, Decoded);
+		if (bDecoded != (DataSize == 36 || DataSize == 40 || DataSize == 44))
+		{
+			NumMismatches++;
+		}
+	}
+
+	TestEqual(TEXT("relay strips leaving the buffer"), NumOutOfBounds, 0);
+	TestEqual(TEXT("datagrams accepted other than by size"), NumMismatches, 0);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
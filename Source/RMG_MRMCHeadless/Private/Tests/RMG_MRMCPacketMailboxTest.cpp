@@ -0,0 +1,93 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPacketMailbox.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Publishes a 40 byte datagram carrying Index in its first and last words, so a torn read shows
+static void PublishMailboxTestPacket(FRMG_MRMCPacketMailbox& Mailbox, uint32 Index)
+{
+	uint8 Data[40] = {};
+	RMG_MRMCPacketLayout::TField<uint32, 0>::Write(Index, Data);
+	RMG_MRMCPacketLayout::TField<uint32, 36>::Write(Index, Data);
+	Mailbox.Publish(1, Data, sizeof(Data), Index * 0.001, Index * 0.001 + 0.0001);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketMailboxLatestTest, "RMG_MRMC.PacketMailbox.LatestWins", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketMailboxLatestTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCPacketMailbox Mailbox;
+	FRMG_MRMCPacket Packet;
+	uint32 Superseded = 0;
+	TestFalse(TEXT("nothing to read before the first publish"), Mailbox.Read(Packet, Superseded));
+
+	for (uint32 Idx = 0; Idx < 5; Idx++)
+	{
+		PublishMailboxTestPacket(Mailbox, Idx);
+	}
+	TestTrue(TEXT("read after five publishes"), Mailbox.Read(Packet, Superseded));
+	TestEqual(TEXT("newest datagram read"), RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Packet.Data), 4u);
+	TestEqual(TEXT("stream"), Packet.Stream, 1);
+	TestEqual(TEXT("size"), Packet.Size, 40);
+	TestEqual(TEXT("receive time"), Packet.ReceiveSeconds, 0.004);
+	TestEqual(TEXT("superseded"), Superseded, 4u);
+	TestFalse(TEXT("the same datagram is not read twice"), Mailbox.Read(Packet, Superseded));
+
+	PublishMailboxTestPacket(Mailbox, 5);
+	TestTrue(TEXT("read after one publish"), Mailbox.Read(Packet, Superseded));
+	TestEqual(TEXT("nothing superseded"), Superseded, 0u);
+	TestEqual(TEXT("superseded total"), Mailbox.GetSupersededCount(), 4ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketMailboxThreadTest, "RMG_MRMC.PacketMailbox.Threaded", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketMailboxThreadTest::RunTest(const FString& Parameters)
+{
+	// a producer thread publishing as fast as it can and the test thread reading whenever it gets to:
+	// reads only go forward, are never torn, and every datagram is either read or counted as superseded
+	const uint32 NumPackets = 1000000;
+	FRMG_MRMCPacketMailbox Mailbox;
+	FRMG_MRMCBenchmarkThread Producer(TEXT("RMG_MRMCMailboxTestProducer"), [&Mailbox, NumPackets]()
+	{
+		for (uint32 Idx = 0; Idx < NumPackets; Idx++)
+		{
+			PublishMailboxTestPacket(Mailbox, Idx);
+		}
+	});
+
+	FRMG_MRMCPacket Packet;
+	uint64 NumRead = 0;
+	uint64 NumSuperseded = 0;
+	int32 NumTorn = 0;
+	int32 NumBackwards = 0;
+	int64 LastIndex = -1;
+	while (LastIndex < NumPackets - 1)
+	{
+		uint32 Superseded;
+		if (!Mailbox.Read(Packet, Superseded))
+		{
+			FPlatformProcess::Yield();
+			continue;
+		}
+		const uint32 Index = RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Packet.Data);
+		NumTorn += Index != RMG_MRMCPacketLayout::TField<uint32, 36>::Read(Packet.Data) || Packet.ReceiveSeconds != Index * 0.001 ? 1 : 0;
+		NumBackwards += int64(Index) <= LastIndex ? 1 : 0;
+		LastIndex = Index;
+		NumRead++;
+		NumSuperseded += Superseded;
+	}
+	Producer.WaitForCompletion();
+
+	TestEqual(TEXT("torn reads"), NumTorn, 0);
+	TestEqual(TEXT("reads going backwards"), NumBackwards, 0);
+	TestEqual(TEXT("every datagram read or superseded"), NumRead + NumSuperseded, uint64(NumPackets));
+	TestEqual(TEXT("superseded total"), Mailbox.GetSupersededCount(), NumSuperseded);
+	AddInfo(FString::Printf(TEXT("%llu of %u datagrams read"), NumRead, NumPackets));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
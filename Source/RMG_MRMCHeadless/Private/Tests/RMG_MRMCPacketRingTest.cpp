@@ -0,0 +1,138 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPacketRing.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Pushes a datagram whose first four bytes are Index, little endian, padded to Size
+static bool PushRingTestPacket(FRMG_MRMCPacketRing& Ring, uint32 Index, int32 Size = 36)
+{
+	uint8 Data[RMG_MRMC_PACKET_SLOT_SIZE * 2] = {};
+	RMG_MRMCPacketLayout::TField<uint32, 0>::Write(Index, Data);
+	return Ring.Push(Index % 3, Data, Size, Index * 0.02, Index * 0.02 + 0.001);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketRingWrapTest, "RMG_MRMC.PacketRing.Wrap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketRingWrapTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("capacity rounded up to a power of two"), FRMG_MRMCPacketRing(5).GetCapacity(), 8u);
+	TestEqual(TEXT("capacity at least two"), FRMG_MRMCPacketRing(0).GetCapacity(), 2u);
+
+	FRMG_MRMCPacketRing Ring(8);
+	TestTrue(TEXT("empty ring has nothing to peek"), Ring.Peek() == nullptr);
+
+	// keep the ring between empty and nearly full for many laps, so head and tail wrap the slots many times
+	uint32 NextPush = 0;
+	uint32 NextPop = 0;
+	int32 NumOutOfOrder = 0;
+	for (int32 Round = 0; Round < 1000; Round++)
+	{
+		const uint32 ToPush = FMath::Min<uint32>(1 + Round % 7, Ring.GetCapacity() - Ring.Num());
+		for (uint32 Idx = 0; Idx < ToPush; Idx++)
+		{
+			PushRingTestPacket(Ring, NextPush++);
+		}
+		const uint32 ToPop = Round % 2 == 0 ? Ring.Num() : Ring.Num() / 2;
+		for (uint32 Idx = 0; Idx < ToPop; Idx++)
+		{
+			const FRMG_MRMCPacket* Packet = Ring.Peek();
+			if (Packet == nullptr || RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Packet->Data) != NextPop
+				|| Packet->Stream != int32(NextPop % 3) || Packet->ReceiveSeconds != NextPop * 0.02)
+			{
+				NumOutOfOrder++;
+			}
+			Ring.Pop();
+			NextPop++;
+		}
+	}
+	TestEqual(TEXT("packets out of order or changed"), NumOutOfOrder, 0);
+	TestEqual(TEXT("queued"), Ring.Num(), NextPush - NextPop);
+	TestEqual(TEXT("no overflow within capacity"), Ring.GetOverflowCount(), 0ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketRingOverflowTest, "RMG_MRMC.PacketRing.Overflow", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketRingOverflowTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCPacketRing Ring(4);
+	for (uint32 Idx = 0; Idx < 4; Idx++)
+	{
+		TestTrue(FString::Printf(TEXT("push %u fits"), Idx), PushRingTestPacket(Ring, Idx));
+	}
+
+	// a full ring drops the newest datagram and keeps what is queued
+	TestFalse(TEXT("push into a full ring"), PushRingTestPacket(Ring, 4));
+	TestFalse(TEXT("second push into a full ring"), PushRingTestPacket(Ring, 5));
+	TestEqual(TEXT("overflows"), Ring.GetOverflowCount(), 2ull);
+	TestEqual(TEXT("still full"), Ring.Num(), 4u);
+	TestEqual(TEXT("oldest kept"), RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Ring.Peek()->Data), 0u);
+
+	Ring.Pop();
+	TestTrue(TEXT("push after a pop"), PushRingTestPacket(Ring, 6));
+	uint32 Expected[] = { 1, 2, 3, 6 };
+	for (const uint32 Index : Expected)
+	{
+		TestEqual(TEXT("order after overflow"), RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Ring.Peek()->Data), Index);
+		Ring.Pop();
+	}
+	TestTrue(TEXT("drained"), Ring.Peek() == nullptr);
+
+	// an oversized datagram keeps its wire size and the first slot's worth of bytes
+	TestTrue(TEXT("oversized push"), PushRingTestPacket(Ring, 7, RMG_MRMC_PACKET_SLOT_SIZE + 20));
+	TestEqual(TEXT("truncations"), Ring.GetTruncatedCount(), 1ull);
+	TestEqual(TEXT("wire size kept"), Ring.Peek()->Size, RMG_MRMC_PACKET_SLOT_SIZE + 20);
+	TestEqual(TEXT("payload clamped to the slot"), Ring.Peek()->GetPayloadSize(), RMG_MRMC_PACKET_SLOT_SIZE);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPacketRingThreadTest, "RMG_MRMC.PacketRing.Threaded", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPacketRingThreadTest::RunTest(const FString& Parameters)
+{
+	// a producer thread pushing as fast as it can into a small ring, retrying when full, and the test
+	// thread draining it: every packet must arrive once, in order, intact
+	const uint32 NumPackets = 1000000;
+	FRMG_MRMCPacketRing Ring(16);
+	uint32 NumRetries = 0;
+	FRMG_MRMCBenchmarkThread Producer(TEXT("RMG_MRMCRingTestProducer"), [&Ring, &NumRetries, NumPackets]()
+	{
+		for (uint32 Idx = 0; Idx < NumPackets; Idx++)
+		{
+			while (!PushRingTestPacket(Ring, Idx))
+			{
+				NumRetries++;
+				FPlatformProcess::Yield();
+			}
+		}
+	});
+
+	uint32 NextPop = 0;
+	int32 NumOutOfOrder = 0;
+	while (NextPop < NumPackets)
+	{
+		const FRMG_MRMCPacket* Packet = Ring.Peek();
+		if (Packet == nullptr)
+		{
+			FPlatformProcess::Yield();
+			continue;
+		}
+		if (RMG_MRMCPacketLayout::TField<uint32, 0>::Read(Packet->Data) != NextPop || Packet->Size != 36 || Packet->QueuedSeconds != NextPop * 0.02 + 0.001)
+		{
+			NumOutOfOrder++;
+		}
+		Ring.Pop();
+		NextPop++;
+	}
+	Producer.WaitForCompletion();
+
+	TestEqual(TEXT("packets out of order or torn"), NumOutOfOrder, 0);
+	TestEqual(TEXT("every failed push counted as an overflow"), Ring.GetOverflowCount(), uint64(NumRetries));
+	TestTrue(TEXT("drained"), Ring.Peek() == nullptr);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
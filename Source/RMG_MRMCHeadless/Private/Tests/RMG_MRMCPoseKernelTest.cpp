@@ -0,0 +1,199 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPoseKernel.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Awkward samples first: camera on its target, straight up and down, looking backwards either side of the
+// pan wrap and centimeters away, then positions across a 20 m stage with any roll
+static void MakePoseKernelTestSamples(TArray<RobotData>& OutSamples)
+{
+	const auto Add = [&OutSamples](float Xv, float Yv, float Zv, float Xt, float Yt, float Zt, float Roll)
+	{
+		RobotData& Sample = OutSamples.AddDefaulted_GetRef();
+		Sample.xv = Xv;
+		Sample.yv = Yv;
+		Sample.zv = Zv;
+		Sample.xt = Xt;
+		Sample.yt = Yt;
+		Sample.zt = Zt;
+		Sample.roll = Roll;
+		Sample.focus = 2.0f;
+		Sample.zoom = 35.0f;
+	};
+	Add(1.0f, 2.0f, 1.5f, 1.0f, 2.0f, 1.5f, 0.0f);
+	Add(1.0f, 2.0f, 1.5f, 1.0f, 2.0f, 4.5f, 0.3f);
+	Add(1.0f, 2.0f, 1.5f, 1.0f, 2.0f, -1.5f, -0.3f);
+	Add(3.0f, 0.0f, 1.5f, 0.0f, 0.0f, 1.5f, 0.0f);
+	Add(3.0f, 0.0f, 1.5f, 0.0f, 1e-4f, 1.5f, 0.0f);
+	Add(3.0f, 0.0f, 1.5f, 0.0f, -1e-4f, 1.5f, 0.0f);
+	Add(0.0f, 0.0f, 1.5f, 0.0f, 0.01f, 1.5f, PI);
+	Add(0.0f, 0.0f, 1.5f, -0.01f, 0.0f, 1.49f, -PI);
+
+	FRandomStream Random(0x4b45524e);
+	for (int32 Idx = 0; Idx < 10000; Idx++)
+	{
+		Add(Random.FRandRange(-10.0f, 10.0f), Random.FRandRange(-10.0f, 10.0f), Random.FRandRange(0.0f, 5.0f),
+			Random.FRandRange(-10.0f, 10.0f), Random.FRandRange(-10.0f, 10.0f), Random.FRandRange(0.0f, 5.0f),
+			Random.FRandRange(-PI, PI));
+	}
+}
+
+// Converts Samples in one bulk call, plus a tail of up to three samples
+static void ConvertPoseKernelTestSamples(const TArray<RobotData>& Samples, TArray<float> (&OutPlanes)[RMG_MRMCChannel::Num])
+{
+	TArray<float> InPlanes[9];
+	for (TArray<float>& Plane : InPlanes)
+	{
+		Plane.SetNumUninitialized(Samples.Num());
+	}
+	for (int32 Idx = 0; Idx < Samples.Num(); Idx++)
+	{
+		const float* Fields = &Samples[Idx].xv;
+		for (int32 Field = 0; Field < UE_ARRAY_COUNT(InPlanes); Field++)
+		{
+			InPlanes[Field][Idx] = Fields[Field];
+		}
+	}
+
+	FRMG_MRMCRobotSamples Bulk;
+	Bulk.Xv = InPlanes[0].GetData();
+	Bulk.Yv = InPlanes[1].GetData();
+	Bulk.Zv = InPlanes[2].GetData();
+	Bulk.Xt = InPlanes[3].GetData();
+	Bulk.Yt = InPlanes[4].GetData();
+	Bulk.Zt = InPlanes[5].GetData();
+	Bulk.Roll = InPlanes[6].GetData();
+	Bulk.Focus = InPlanes[7].GetData();
+	Bulk.Zoom = InPlanes[8].GetData();
+	Bulk.Num = Samples.Num();
+
+	FRMG_MRMCChannelPlanes Planes;
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		OutPlanes[Channel].SetNumUninitialized(Samples.Num());
+		Planes.Channels[Channel] = OutPlanes[Channel].GetData();
+	}
+	RMG_MRMCPoseKernel::ConvertSamples(Bulk, Planes);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPoseKernelScalarTest, "RMG_MRMC.PoseKernel.Scalar", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPoseKernelScalarTest::RunTest(const FString& Parameters)
+{
+	TArray<RobotData> Samples;
+	MakePoseKernelTestSamples(Samples);
+	// 10008 samples is a whole number of blocks, so drop one for the tail
+	Samples.Pop();
+	TArray<float> Planes[RMG_MRMCChannel::Num];
+	ConvertPoseKernelTestSamples(Samples, Planes);
+
+	float MaxError[RMG_MRMCChannel::Num] = {};
+	int32 NumSingleMismatches = 0;
+	for (int32 Idx = 0; Idx < Samples.Num(); Idx++)
+	{
+		float Scalar[RMG_MRMCChannel::Num];
+		RMG_MRMCHeadless::ConvertSampleScalar(Samples[Idx], Scalar);
+		float Single[RMG_MRMC_FRAME_VALUE_COUNT];
+		RMG_MRMCPoseKernel::ConvertSample(Samples[Idx], Single);
+
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			const float Value = Planes[Channel][Idx];
+			NumSingleMismatches += Single[Channel] != Value ? 1 : 0;
+
+			float Error = FMath::Abs(Value - Scalar[Channel]);
+			if (Channel == RMG_MRMCChannel::Pan)
+			{
+				Error = FMath::Abs(FMath::UnwindDegrees(Value - Scalar[Channel]));
+			}
+			else if (Channel == RMG_MRMCChannel::Focus)
+			{
+				Error /= FMath::Max(Scalar[Channel], 1.0f);
+			}
+			MaxError[Channel] = FMath::Max(MaxError[Channel], Error);
+		}
+	}
+
+	TestEqual(TEXT("single samples differing from the bulk conversion"), NumSingleMismatches, 0);
+
+	// positions are the same multiplications; angles carry the polynomial atan2 and focus the refined
+	// reciprocal square root
+	const int32 ExactChannels[] =
+	{
+		RMG_MRMCChannel::CameraPoseX, RMG_MRMCChannel::CameraPoseY, RMG_MRMCChannel::CameraPoseZ,
+		RMG_MRMCChannel::CameraTargetX, RMG_MRMCChannel::CameraTargetY, RMG_MRMCChannel::CameraTargetZ,
+		RMG_MRMCChannel::Roll, RMG_MRMCChannel::Zoom, RMG_MRMCChannel::DistortionK1, RMG_MRMCChannel::DistortionK2
+	};
+	for (int32 Channel : ExactChannels)
+	{
+		TestEqual(FString::Printf(TEXT("largest error of channel %d"), Channel), MaxError[Channel], 0.0f);
+	}
+	TestTrue(FString::Printf(TEXT("roll within 1e-4 degrees of scalar, largest error %g"), MaxError[RMG_MRMCChannel::RollDegrees]), MaxError[RMG_MRMCChannel::RollDegrees] <= 1e-4f);
+	TestTrue(FString::Printf(TEXT("tilt within 1e-4 degrees of scalar, largest error %g"), MaxError[RMG_MRMCChannel::Tilt]), MaxError[RMG_MRMCChannel::Tilt] <= 1e-4f);
+	TestTrue(FString::Printf(TEXT("pan within 1e-4 degrees of scalar, largest error %g"), MaxError[RMG_MRMCChannel::Pan]), MaxError[RMG_MRMCChannel::Pan] <= 1e-4f);
+	TestTrue(FString::Printf(TEXT("focus within 1e-6 of scalar, largest relative error %g"), MaxError[RMG_MRMCChannel::Focus]), MaxError[RMG_MRMCChannel::Focus] <= 1e-6f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPoseKernelRotationTest, "RMG_MRMC.PoseKernel.Rotation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPoseKernelRotationTest::RunTest(const FString& Parameters)
+{
+	TArray<RobotData> Samples;
+	MakePoseKernelTestSamples(Samples);
+	TArray<float> Planes[RMG_MRMCChannel::Num];
+	ConvertPoseKernelTestSamples(Samples, Planes);
+
+	// the rotation a bone gets from the kernel's channels against the one the scalar angles gave through FRotator
+	int32 NumMismatches = 0;
+	for (int32 Idx = 0; Idx < Samples.Num(); Idx++)
+	{
+		float Scalar[RMG_MRMCChannel::Num];
+		RMG_MRMCHeadless::ConvertSampleScalar(Samples[Idx], Scalar);
+		const FQuat Expected = FRotator(Scalar[RMG_MRMCChannel::Tilt], Scalar[RMG_MRMCChannel::Pan], Scalar[RMG_MRMCChannel::RollDegrees]).Quaternion();
+		const FQuat Kernel = FQuat::MakeFromEuler(FVector(Planes[RMG_MRMCChannel::RollDegrees][Idx], Planes[RMG_MRMCChannel::Tilt][Idx], Planes[RMG_MRMCChannel::Pan][Idx]));
+		if (!Kernel.Equals(Expected, 1e-5f))
+		{
+			if (NumMismatches == 0)
+			{
+				AddError(FString::Printf(TEXT("sample %d: kernel rotation (%g, %g, %g, %g), FRotator (%g, %g, %g, %g)"), Idx,
+					Kernel.X, Kernel.Y, Kernel.Z, Kernel.W, Expected.X, Expected.Y, Expected.Z, Expected.W));
+			}
+			NumMismatches++;
+		}
+	}
+	TestEqual(TEXT("rotations differing from the FRotator path"), NumMismatches, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPoseKernelATan2Test, "RMG_MRMC.PoseKernel.ATan2", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPoseKernelATan2Test::RunTest(const FString& Parameters)
+{
+	// every direction at a few magnitudes, plus the axes and signed zeros exactly
+	double MaxError = 0.0;
+	const float Magnitudes[] = { 1e-3f, 1.0f, 1e4f };
+	for (float Magnitude : Magnitudes)
+	{
+		for (int32 Step = 0; Step < 36000; Step++)
+		{
+			const double Angle = -PI + Step * (2.0 * PI / 36000);
+			const float Y = static_cast<float>(Magnitude * FMath::Sin(Angle));
+			const float X = static_cast<float>(Magnitude * FMath::Cos(Angle));
+			MaxError = FMath::Max(MaxError, FMath::Abs(RMG_MRMCPoseKernel::ATan2(Y, X) - atan2(double(Y), double(X))));
+		}
+	}
+	const float Axes[][2] = { { 0.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, -1.0f }, { -1.0f, 0.0f }, { -0.0f, -1.0f }, { 0.0f, 0.0f } };
+	for (const float (&Axis)[2] : Axes)
+	{
+		MaxError = FMath::Max(MaxError, FMath::Abs(RMG_MRMCPoseKernel::ATan2(Axis[0], Axis[1]) - atan2(double(Axis[0]), double(Axis[1]))));
+	}
+	TestTrue(FString::Printf(TEXT("atan2 within 5e-7 rad, largest error %g"), MaxError), MaxError < 5e-7);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
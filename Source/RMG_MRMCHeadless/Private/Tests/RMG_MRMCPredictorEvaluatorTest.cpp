@@ -0,0 +1,120 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPoseKernel.h"
+#include "RMG_MRMCTakeFormat.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Appends one take record holding Packet, received on Stream at ReceiveSeconds
+static void AddPredictorTestRecord(TArray<uint8>& Take, uint16 Stream, double ReceiveSeconds, const FRMG_MRMCDecodedPacket& Packet)
+{
+	FRMG_MRMCTakeRecord Record;
+	FMemory::Memzero(Record);
+	Record.ReceiveSeconds = ReceiveSeconds;
+	Record.Stream = Stream;
+	Record.Size = static_cast<uint16>(RMG_MRMCPacketDecoder::Encode(Packet, Record.Data));
+	Take.Append(reinterpret_cast<const uint8*>(&Record), sizeof(Record));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPredictorEvaluatorTakeTest, "RMG_MRMC.Predictor.LoadTake", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPredictorEvaluatorTakeTest::RunTest(const FString& Parameters)
+{
+	// two interleaved streams, stream 1 with one datagram duplicated and one reordered
+	TArray<uint8> Take;
+	Take.SetNumZeroed(sizeof(FRMG_MRMCTakeHeader));
+	const int32 NumFrames = 100;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		const double Seconds = Frame * 0.02;
+		AddPredictorTestRecord(Take, 0, 10.0 + Seconds, RMG_MRMCHeadless::MakeOrbitSample(Seconds, Frame, ERMG_MRMCPacketVariant::FrameCounter));
+		if (Frame == 50)
+		{
+			continue;
+		}
+		AddPredictorTestRecord(Take, 1, 10.0 + Seconds, RMG_MRMCHeadless::MakeOrbitSample(Seconds, Frame, ERMG_MRMCPacketVariant::FrameCounter, 1.0));
+		if (Frame == 20 || Frame == 51)
+		{
+			AddPredictorTestRecord(Take, 1, 10.0 + Seconds, RMG_MRMCHeadless::MakeOrbitSample(Frame == 20 ? Seconds : 1.0, Frame == 20 ? Frame : 50, ERMG_MRMCPacketVariant::FrameCounter, 1.0));
+		}
+	}
+
+	FRMG_MRMCTakeHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = RMG_MRMC_TAKE_MAGIC;
+	Header.Version = RMG_MRMC_TAKE_VERSION;
+	Header.HeaderSize = sizeof(FRMG_MRMCTakeHeader);
+	Header.RecordSize = sizeof(FRMG_MRMCTakeRecord);
+	Header.PayloadSize = RMG_MRMC_TAKE_PAYLOAD_SIZE;
+	Header.IndexStride = RMG_MRMC_TAKE_INDEX_STRIDE;
+	Header.NumStreams = 2;
+	Header.RecordOffset = sizeof(FRMG_MRMCTakeHeader);
+	Header.RecordCapacity = Header.RecordCount = (Take.Num() - sizeof(FRMG_MRMCTakeHeader)) / sizeof(FRMG_MRMCTakeRecord);
+	FMemory::Memcpy(Take.GetData(), &Header, sizeof(Header));
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("RMG_MRMCPredictorTest.take");
+	if (!TestTrue(TEXT("take written"), FFileHelper::SaveArrayToFile(Take, *Filename)))
+	{
+		return false;
+	}
+
+	TArray<FRMG_MRMCTakeSample> Samples;
+	FString Error;
+	TestTrue(TEXT("stream 0 loads"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 0, Samples, Error));
+	TestEqual(TEXT("stream 0 samples"), Samples.Num(), NumFrames);
+	TestTrue(TEXT("stream 1 loads"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 1, Samples, Error));
+	TestEqual(TEXT("stream 1 drops the duplicate and the late frame"), Samples.Num(), NumFrames - 1);
+	TestFalse(TEXT("stream 2 has no samples"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 2, Samples, Error));
+
+	const int32 Version = RMG_MRMC_TAKE_VERSION + 1;
+	FMemory::Memcpy(Take.GetData() + STRUCT_OFFSET(FRMG_MRMCTakeHeader, Version), &Version, sizeof(Version));
+	FFileHelper::SaveArrayToFile(Take, *Filename);
+	TestFalse(TEXT("unknown take version rejected"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 0, Samples, Error));
+
+	IFileManager::Get().Delete(*Filename);
+	TestFalse(TEXT("missing take rejected"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 0, Samples, Error));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPredictorEvaluatorErrorTest, "RMG_MRMC.Predictor.Evaluate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPredictorEvaluatorErrorTest::RunTest(const FString& Parameters)
+{
+	// a minute of the orbit at 50 Hz, straight from the kernel
+	TArray<FRMG_MRMCTakeSample> Samples;
+	for (int32 Frame = 0; Frame < 3000; Frame++)
+	{
+		FRMG_MRMCTakeSample& Sample = Samples.AddDefaulted_GetRef();
+		Sample.Seconds = Frame * 0.02;
+		float Values[RMG_MRMC_FRAME_VALUE_COUNT];
+		RMG_MRMCPoseKernel::ConvertSample(RMG_MRMCHeadless::MakeOrbitSample(Sample.Seconds, Frame, ERMG_MRMCPacketVariant::Basic).Robot, Values);
+		FMemory::Memcpy(Sample.Values, Values, sizeof(Sample.Values));
+	}
+
+	FRMG_MRMCProcessingOptions Options;
+	Options.PredictionLeadMs = 40.0f;
+	FRMG_MRMCPredictionError Result;
+	RMG_MRMCHeadless::EvaluatePredictor(Samples, Options, Result);
+	TestTrue(TEXT("predictions scored"), Result.NumScored > 2900);
+
+	// a smooth move is predicted far better than it is held, including pan across its wrap at 180 degrees
+	const int32 Channels[] = { RMG_MRMCChannel::CameraPoseX, RMG_MRMCChannel::CameraPoseY, RMG_MRMCChannel::Pan, RMG_MRMCChannel::Zoom };
+	for (const int32 Channel : Channels)
+	{
+		AddInfo(FString::Printf(TEXT("channel %d: predicted rms %g, held rms %g"), Channel, Result.PredictedRms[Channel], Result.HeldRms[Channel]));
+		TestTrue(FString::Printf(TEXT("channel %d predicted better than held"), Channel), Result.PredictedRms[Channel] < 0.1f * Result.HeldRms[Channel]);
+	}
+
+	// with no lead the prediction is the filtered sample, which stays close to the held one
+	Options.PredictionLeadMs = 0.0f;
+	RMG_MRMCHeadless::EvaluatePredictor(Samples, Options, Result);
+	TestEqual(TEXT("nothing to hold over without lead"), Result.HeldRms[RMG_MRMCChannel::CameraPoseX], 0.0f, 1e-3f);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
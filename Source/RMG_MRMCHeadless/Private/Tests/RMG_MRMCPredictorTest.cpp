@@ -0,0 +1,47 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCPredictor.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCPredictorCovarianceTest, "RMG_MRMC.Predictor.Covariance", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCPredictorCovarianceTest::RunTest(const FString& Parameters)
+{
+	// precise measurements and a jittery, sometimes stalling stream: the process noise then dominates
+	// the covariance, and any direction it adds negative variance in shows up as a negative eigenvalue
+	const float ProcessNoises[] = { 1.0f, 1000.0f };
+	const float MeasurementNoises[] = { 1e-6f, 1e-2f };
+	for (float ProcessNoise : ProcessNoises)
+	{
+		for (float MeasurementNoise : MeasurementNoises)
+		{
+			FRMG_MRMCPredictor Predictor(0.04f, ProcessNoise, MeasurementNoise);
+			FRandomStream Random(0x50534421);
+			double Seconds = 100.0;
+			int32 FirstInvalid = INDEX_NONE;
+			for (int32 Idx = 0; Idx < 20000 && FirstInvalid == INDEX_NONE; Idx++)
+			{
+				// mostly 1 kHz to 50 Hz, now and then a stall just short of the restart gap
+				Seconds += Random.FRand() < 0.02f ? Random.FRandRange(0.1f, 0.49f) : Random.FRandRange(0.001f, 0.02f);
+				float Values[RMG_MRMC_FRAME_VALUE_COUNT] = {};
+				for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+				{
+					Values[Channel] = static_cast<float>(FMath::Sin(Seconds * (1.0 + Channel)) * 50.0) + Random.FRandRange(-0.01f, 0.01f);
+				}
+				Predictor.Process(Seconds, Values);
+				if (!Predictor.IsCovarianceValid())
+				{
+					FirstInvalid = Idx;
+				}
+			}
+			TestEqual(FString::Printf(TEXT("first sample with an indefinite covariance, process noise %g, measurement noise %g"), ProcessNoise, MeasurementNoise), FirstInvalid, int32(INDEX_NONE));
+		}
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,129 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCRelay.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Misc/AutomationTest.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Render nodes of the header test, each a loopback socket on a port of its own
+static const int32 RelayTestNumTargets = 3;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCRelaySelfTargetsTest, "RMG_MRMC.Relay.SelfTargets", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCRelaySelfTargetsTest::RunTest(const FString& Parameters)
+{
+	// a source on every interface, one on a multicast group and one on a single address
+	TArray<FIPv4Endpoint> ReceiveEndpoints;
+	ReceiveEndpoints.Add(FIPv4Endpoint(FIPv4Address::Any, 47001));
+	ReceiveEndpoints.Add(FIPv4Endpoint(FIPv4Address(239, 0, 0, 1), 47002));
+	ReceiveEndpoints.Add(FIPv4Endpoint(FIPv4Address(192, 168, 1, 10), 47003));
+
+	TArray<FIPv4Endpoint> SelfTargets;
+	SelfTargets.Add(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), 47001));
+	SelfTargets.Add(FIPv4Endpoint(FIPv4Address(127, 1, 2, 3), 47001));
+	SelfTargets.Add(FIPv4Endpoint(FIPv4Address(239, 0, 0, 1), 47002));
+	SelfTargets.Add(FIPv4Endpoint(FIPv4Address(192, 168, 1, 10), 47003));
+	TestNull(TEXT("relay with only self-targets"), FRMG_MRMCRelay::Create(ReceiveEndpoints, SelfTargets, false, 1).Get());
+
+	// another machine on the source's port, the group on another port, and loopback to an endpoint bound
+	// to a single address are all someone else
+	TArray<FIPv4Endpoint> Targets = SelfTargets;
+	Targets.Add(FIPv4Endpoint(FIPv4Address(192, 168, 1, 20), 47001));
+	Targets.Add(FIPv4Endpoint(FIPv4Address(239, 0, 0, 1), 47004));
+	Targets.Add(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), 47003));
+	TUniquePtr<FRMG_MRMCRelay> Relay = FRMG_MRMCRelay::Create(ReceiveEndpoints, Targets, false, 1);
+	if (TestNotNull(TEXT("relay with other targets"), Relay.Get()))
+	{
+		TestEqual(TEXT("targets left"), Relay->GetNumTargets(), 3);
+	}
+
+	// nothing to filter against
+	TUniquePtr<FRMG_MRMCRelay> Unfiltered = FRMG_MRMCRelay::Create(TArray<FIPv4Endpoint>(), SelfTargets, false, 1);
+	if (TestNotNull(TEXT("relay without receive endpoints"), Unfiltered.Get()))
+	{
+		TestEqual(TEXT("targets without receive endpoints"), Unfiltered->GetNumTargets(), SelfTargets.Num());
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCRelayHeaderTest, "RMG_MRMC.Relay.Header", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCRelayHeaderTest::RunTest(const FString& Parameters)
+{
+	// receive times on the FPlatformTime::Seconds() clock survive the trip through Unix nanoseconds
+	const double Now = FPlatformTime::Seconds();
+	TestEqual(TEXT("receive time through Unix time"), FRMG_MRMCRelay::FromUnixNs(FRMG_MRMCRelay::ToUnixNs(Now)), Now, 1e-6);
+	TestEqual(TEXT("Unix time of now"), double(FRMG_MRMCRelay::ToUnixNs(Now)) * 1e-9, double((FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTicks()) * 1e-7, 1.0);
+
+	TArray<FSocket*> Sockets;
+	TArray<FIPv4Endpoint> Targets;
+	for (int32 Idx = 0; Idx < RelayTestNumTargets; Idx++)
+	{
+		FSocket* Socket = FUdpSocketBuilder(TEXT("RMG_MRMCRelayTest")).AsNonBlocking().BoundToAddress(FIPv4Address(127, 0, 0, 1)).BoundToPort(0);
+		if (Socket != nullptr)
+		{
+			Sockets.Add(Socket);
+			Targets.Add(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), static_cast<uint16>(Socket->GetPortNo())));
+		}
+	}
+
+	if (TestEqual(TEXT("loopback sockets"), Sockets.Num(), RelayTestNumTargets))
+	{
+		for (const bool bAddTimestamp : { true, false })
+		{
+			TUniquePtr<FRMG_MRMCRelay> Relay = FRMG_MRMCRelay::Create(TArray<FIPv4Endpoint>(), Targets, bAddTimestamp, 1);
+			if (!TestNotNull(TEXT("relay"), Relay.Get()))
+			{
+				break;
+			}
+			const TCHAR* Mode = bAddTimestamp ? TEXT("with timestamps") : TEXT("without timestamps");
+
+			// every datagram variant, forwarded as it lies in the receive buffer, reaches every target unchanged
+			const ERMG_MRMCPacketVariant Variants[] = { ERMG_MRMCPacketVariant::Basic, ERMG_MRMCPacketVariant::FrameCounter, ERMG_MRMCPacketVariant::Timecode };
+			for (int32 VariantIdx = 0; VariantIdx < UE_ARRAY_COUNT(Variants); VariantIdx++)
+			{
+				uint8 Datagram[RMG_MRMCPacketDecoder::MaxPacketSize];
+				const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(VariantIdx * 0.02, VariantIdx, Variants[VariantIdx]), Datagram);
+				const double ReceiveSeconds = FPlatformTime::Seconds();
+				TestEqual(FString::Printf(TEXT("%s: targets failed"), Mode), Relay->Forward(Datagram, Size, ReceiveSeconds), 0);
+
+				for (FSocket* Socket : Sockets)
+				{
+					uint8 Received[RMG_MRMCPacketLayout::FRelayHeader::Size + RMG_MRMCPacketDecoder::MaxPacketSize + 1];
+					int32 BytesRead = 0;
+					if (!TestTrue(FString::Printf(TEXT("%s: %d byte datagram arrived"), Mode, Size), Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(1.0))
+						&& Socket->Recv(Received, sizeof(Received), BytesRead)))
+					{
+						continue;
+					}
+
+					const uint8* Data = Received;
+					int32 DataSize = BytesRead;
+					int64 ReceiveUnixNs = 0;
+					const bool bStripped = RMG_MRMCPacketDecoder::StripRelayHeader(Data, DataSize, ReceiveUnixNs);
+					TestEqual(FString::Printf(TEXT("%s: relay header"), Mode), bStripped, bAddTimestamp);
+					TestTrue(FString::Printf(TEXT("%s: %d byte payload unchanged"), Mode, Size), DataSize == Size && FMemory::Memcmp(Data, Datagram, Size) == 0);
+					if (bStripped)
+					{
+						TestEqual(FString::Printf(TEXT("%s: receive time in the header"), Mode), FRMG_MRMCRelay::FromUnixNs(ReceiveUnixNs), ReceiveSeconds, 1e-6);
+					}
+				}
+			}
+
+			TestEqual(FString::Printf(TEXT("%s: forwarded"), Mode), Relay->GetForwarded(), uint64(UE_ARRAY_COUNT(Variants)));
+			TestEqual(FString::Printf(TEXT("%s: failed"), Mode), Relay->GetFailed(), uint64(0));
+		}
+	}
+
+	for (FSocket* Socket : Sockets)
+	{
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,187 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameClock.h"
+#include "RMG_MRMCSampleHistory.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Adds a sample whose first channel is Value
+static void AddHistoryValue(FRMG_MRMCSampleHistory& History, double Seconds, float Value)
+{
+	float Values[RMG_MRMC_FRAME_VALUE_COUNT] = {};
+	Values[0] = Value;
+	History.Add(Seconds, Values);
+}
+
+// First channel resampled at Seconds the way the stream processor blends it
+static float SampleHistoryValue(const FRMG_MRMCSampleHistory& History, double Seconds, double MaxExtrapolationSeconds = 0.0)
+{
+	const FRMG_MRMCSample* Previous = nullptr;
+	const FRMG_MRMCSample* Next = nullptr;
+	float Alpha = 0.0f;
+	if (!History.Sample(Seconds, Previous, Next, Alpha, MaxExtrapolationSeconds))
+	{
+		return 0.0f;
+	}
+	return Previous->Values[0] + (Next->Values[0] - Previous->Values[0]) * Alpha;
+}
+
+// Position of a move at 100 units/s that reverses to -300 units/s at 1.01 s, between two 50 Hz samples
+static double SampleHistoryKinkPosition(double Seconds)
+{
+	return Seconds < 1.01 ? 100.0 * Seconds : 101.0 - 300.0 * (Seconds - 1.01);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSampleHistoryFrameRatesTest, "RMG_MRMC.SampleHistory.FrameRates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSampleHistoryFrameRatesTest::RunTest(const FString& Parameters)
+{
+	const double Period = 0.02;
+	FRMG_MRMCSampleHistory History;
+	for (int32 Idx = 0; Idx <= 150; Idx++)
+	{
+		AddHistoryValue(History, Idx * Period, static_cast<float>(SampleHistoryKinkPosition(Idx * Period)));
+	}
+
+	// linear blending reproduces the move exactly except in the period holding the reversal, where it
+	// may cut the corner by at most a quarter of the velocity change times the period but never overshoot
+	const double Rates[] = { 24.0, 25.0, 30.0, 60.0 };
+	for (double Rate : Rates)
+	{
+		double WorstError = 0.0;
+		double WorstCornerError = 0.0;
+		bool bOvershoot = false;
+		for (int32 Frame = 0; Frame / Rate <= 3.0; Frame++)
+		{
+			const double Seconds = Frame / Rate;
+			const double Error = FMath::Abs(SampleHistoryValue(History, Seconds) - SampleHistoryKinkPosition(Seconds));
+			if (Seconds > 1.0 && Seconds < 1.02)
+			{
+				WorstCornerError = FMath::Max(WorstCornerError, Error);
+				const float Value = SampleHistoryValue(History, Seconds);
+				bOvershoot |= Value > SampleHistoryKinkPosition(1.01) || Value < SampleHistoryKinkPosition(1.02);
+			}
+			else
+			{
+				WorstError = FMath::Max(WorstError, Error);
+			}
+		}
+		TestTrue(FString::Printf(TEXT("%g fps: largest error %g away from the reversal"), Rate, WorstError), WorstError < 1e-3);
+		TestTrue(FString::Printf(TEXT("%g fps: largest error %g at the reversal"), Rate, WorstCornerError), WorstCornerError <= 400.0 * Period / 4.0 + 1e-3);
+		TestFalse(FString::Printf(TEXT("%g fps: overshoot at the reversal"), Rate), bOvershoot);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSampleHistoryJitterTest, "RMG_MRMC.SampleHistory.Jitter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSampleHistoryJitterTest::RunTest(const FString& Parameters)
+{
+	// 50 Hz at 100 units/s, delayed 2 to 6 ms on the way, on a receive clock running 200 ppm fast
+	const double Period = 0.02;
+	const double Velocity = 100.0;
+	FRandomStream Random(0x4a495454);
+	FRMG_MRMCSampleHistory ByReceive(1024);
+	FRMG_MRMCSampleHistory ByCounter(1024);
+	FRMG_MRMCFrameClock Clock;
+	const uint32 FirstCounter = 0xfffffe00;
+	for (int32 Idx = 0; Idx < 1000; Idx++)
+	{
+		const double SentSeconds = Idx * Period;
+		const double ReceiveSeconds = 100.0 + SentSeconds * (1.0 + 200e-6) + Random.FRandRange(0.002f, 0.006f);
+		const float Value = static_cast<float>(Velocity * SentSeconds);
+		AddHistoryValue(ByReceive, ReceiveSeconds, Value);
+		AddHistoryValue(ByCounter, Clock.EvaluateSeconds(FirstCounter + Idx, ReceiveSeconds), Value);
+	}
+	TestEqual(TEXT("counted history re-anchors across the counter wrap"), Clock.GetReanchorCount(), 0);
+
+	// speed between consecutive 60 fps engine frames, evaluated 40 ms behind as the source does; jitter in
+	// the sample times turns into speed changes although the robot moves steadily
+	const double FrameInterval = 1.0 / 60.0;
+	double ReceiveWorst = 0.0;
+	double CounterWorst = 0.0;
+	for (double Seconds = 102.0; Seconds < 119.0; Seconds += FrameInterval)
+	{
+		const double ReceiveSpeed = (SampleHistoryValue(ByReceive, Seconds + FrameInterval) - SampleHistoryValue(ByReceive, Seconds)) / FrameInterval;
+		const double CounterSpeed = (SampleHistoryValue(ByCounter, Seconds + FrameInterval) - SampleHistoryValue(ByCounter, Seconds)) / FrameInterval;
+		ReceiveWorst = FMath::Max(ReceiveWorst, FMath::Abs(ReceiveSpeed / Velocity - 1.0));
+		CounterWorst = FMath::Max(CounterWorst, FMath::Abs(CounterSpeed / Velocity - 1.0));
+	}
+	AddInfo(FString::Printf(TEXT("largest speed error between frames: %.2f%% keyed by receive time, %.2f%% keyed by counter"), ReceiveWorst * 100.0, CounterWorst * 100.0));
+	TestTrue(TEXT("receive-keyed speed error shows the jitter"), ReceiveWorst > 0.1);
+	TestTrue(TEXT("counter-keyed speed error below 1.5%"), CounterWorst < 0.015);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSampleHistoryOutOfOrderTest, "RMG_MRMC.SampleHistory.OutOfOrder", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSampleHistoryOutOfOrderTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCSampleHistory History;
+	AddHistoryValue(History, 0.00, 0.0f);
+	AddHistoryValue(History, 0.02, 2.0f);
+	AddHistoryValue(History, 0.06, 6.0f);
+	AddHistoryValue(History, 0.04, 4.0f);
+
+	const FRMG_MRMCSample* Previous = nullptr;
+	const FRMG_MRMCSample* Next = nullptr;
+	float Alpha = 0.0f;
+	TestTrue(TEXT("sampled"), History.Sample(0.05, Previous, Next, Alpha));
+	TestEqual(TEXT("late sample slotted in before the newest"), Previous->Seconds, 0.04);
+	TestEqual(TEXT("newest still last"), Next->Seconds, 0.06);
+	TestEqual(TEXT("alpha"), Alpha, 0.5f, 1e-4f);
+	TestEqual(TEXT("value between the late sample and the newest"), SampleHistoryValue(History, 0.03), 3.0f, 1e-4f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSampleHistoryFullTest, "RMG_MRMC.SampleHistory.Full", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSampleHistoryFullTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCSampleHistory History(8);
+	for (int32 Idx = 0; Idx < 20; Idx++)
+	{
+		AddHistoryValue(History, Idx * 0.02, static_cast<float>(Idx));
+	}
+	TestEqual(TEXT("kept samples"), History.Num(), 8);
+	TestEqual(TEXT("oldest kept before the range"), SampleHistoryValue(History, 0.0), 12.0f);
+	TestEqual(TEXT("blend across the ring's wrap"), SampleHistoryValue(History, 0.31), 15.5f, 1e-4f);
+
+	// a late sample still inside the range displaces the oldest, one older than everything kept is dropped
+	AddHistoryValue(History, 0.25, 12.5f);
+	TestEqual(TEXT("kept samples after a late one"), History.Num(), 8);
+	TestEqual(TEXT("oldest after a late one"), SampleHistoryValue(History, 0.0), 12.5f);
+	AddHistoryValue(History, 0.01, -1.0f);
+	TestEqual(TEXT("oldest after a stale one"), SampleHistoryValue(History, 0.0), 12.5f);
+	TestEqual(TEXT("newest after a stale one"), SampleHistoryValue(History, 1.0), 19.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSampleHistoryExtrapolationTest, "RMG_MRMC.SampleHistory.Extrapolation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSampleHistoryExtrapolationTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCSampleHistory History;
+	const FRMG_MRMCSample* Previous = nullptr;
+	const FRMG_MRMCSample* Next = nullptr;
+	float Alpha = 0.0f;
+	TestFalse(TEXT("empty history samples nothing"), History.Sample(0.0, Previous, Next, Alpha));
+
+	AddHistoryValue(History, 0.00, 0.0f);
+	TestEqual(TEXT("one sample is held, not extrapolated"), SampleHistoryValue(History, 0.01, 0.05), 0.0f);
+
+	AddHistoryValue(History, 0.02, 2.0f);
+	AddHistoryValue(History, 0.04, 4.0f);
+	TestTrue(TEXT("sampled past the newest"), History.Sample(0.05, Previous, Next, Alpha, 0.05));
+	TestEqual(TEXT("extrapolation alpha"), Alpha, 1.5f, 1e-4f);
+	TestEqual(TEXT("motion continued past the newest"), SampleHistoryValue(History, 0.09, 0.05), 9.0f, 1e-4f);
+	TestEqual(TEXT("held beyond the extrapolation limit"), SampleHistoryValue(History, 0.1, 0.05), 4.0f);
+	TestEqual(TEXT("held without extrapolation"), SampleHistoryValue(History, 0.05), 4.0f);
+	TestEqual(TEXT("held before the oldest"), SampleHistoryValue(History, -1.0, 0.05), 0.0f);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,256 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFaultInjector.h"
+#include "RMG_MRMCSequenceTracker.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Receive time of the first datagram in each sequence
+static const double SequenceTestStartSeconds = 100.0;
+
+// Feeds recorded datagrams to one tracker and remembers the verdicts, so a test reads as the sequence it checks
+struct FRMG_MRMCSequenceTestStream
+{
+	FRMG_MRMCSequenceTracker Tracker;
+	int32 LostChange = 0;
+
+	// A datagram carrying Counter, received at Seconds after the start
+	ERMG_MRMCSequenceVerdict Counter(uint32 FrameCounter, double Seconds)
+	{
+		return Check(RMG_MRMCHeadless::MakeOrbitSample(Seconds, FrameCounter, ERMG_MRMCPacketVariant::FrameCounter), Seconds);
+	}
+
+	// A basic datagram of the orbit at SampleSeconds, received at Seconds after the start
+	ERMG_MRMCSequenceVerdict Basic(double SampleSeconds, double Seconds)
+	{
+		return Check(RMG_MRMCHeadless::MakeOrbitSample(SampleSeconds, 0, ERMG_MRMCPacketVariant::Basic), Seconds);
+	}
+
+	ERMG_MRMCSequenceVerdict Check(const FRMG_MRMCDecodedPacket& Packet, double Seconds)
+	{
+		uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+		const int32 Size = RMG_MRMCPacketDecoder::Encode(Packet, Data);
+		return Tracker.Check(Data, Size, Packet, SequenceTestStartSeconds + Seconds, LostChange);
+	}
+};
+
+static const TCHAR* SequenceVerdictName(ERMG_MRMCSequenceVerdict Verdict)
+{
+	switch (Verdict)
+	{
+	case ERMG_MRMCSequenceVerdict::Accept: return TEXT("Accept");
+	case ERMG_MRMCSequenceVerdict::Duplicate: return TEXT("Duplicate");
+	default: return TEXT("Stale");
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSequenceTrackerCounterTest, "RMG_MRMC.SequenceTracker.Counter", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSequenceTrackerCounterTest::RunTest(const FString& Parameters)
+{
+	const double Period = 0.02;
+	FRMG_MRMCSequenceTestStream Stream;
+
+	// 10, 11, 13, 12, 12, 14: one frame late, then repeated
+	const uint32 Counters[] = { 10, 11, 13, 12, 12, 14 };
+	const ERMG_MRMCSequenceVerdict Expected[] = { ERMG_MRMCSequenceVerdict::Accept, ERMG_MRMCSequenceVerdict::Accept, ERMG_MRMCSequenceVerdict::Accept,
+		ERMG_MRMCSequenceVerdict::Stale, ERMG_MRMCSequenceVerdict::Duplicate, ERMG_MRMCSequenceVerdict::Accept };
+	const int32 ExpectedLostChange[] = { 0, 0, 1, -1, 0, 0 };
+	for (int32 Idx = 0; Idx < UE_ARRAY_COUNT(Counters); Idx++)
+	{
+		const ERMG_MRMCSequenceVerdict Verdict = Stream.Counter(Counters[Idx], Idx * Period);
+		TestEqual(FString::Printf(TEXT("counter %u verdict"), Counters[Idx]), SequenceVerdictName(Verdict), SequenceVerdictName(Expected[Idx]));
+		TestEqual(FString::Printf(TEXT("counter %u lost change"), Counters[Idx]), Stream.LostChange, ExpectedLostChange[Idx]);
+	}
+	TestEqual(TEXT("accepted"), Stream.Tracker.GetAccepted(), 4ull);
+	TestEqual(TEXT("stale"), Stream.Tracker.GetStale(), 1ull);
+	TestEqual(TEXT("duplicates"), Stream.Tracker.GetDuplicates(), 1ull);
+	TestEqual(TEXT("late frame no longer lost"), Stream.Tracker.GetLost(), 0ull);
+	TestTrue(TEXT("stream has a frame counter"), Stream.Tracker.HasFrameCounter());
+
+	// three frames missing in a row, then one of them arrives
+	Stream.Counter(18, 6 * Period);
+	TestEqual(TEXT("gap of three lost"), Stream.LostChange, 3);
+	TestEqual(TEXT("longest gap"), Stream.Tracker.GetLongestGap(), 3u);
+	Stream.Counter(16, 6 * Period);
+	TestEqual(TEXT("two of the gap still lost"), Stream.Tracker.GetLost(), 2ull);
+
+	// older than the 64 frame window: stale, and the loss it was counted as stays
+	TestEqual(TEXT("counter outside the window"), SequenceVerdictName(Stream.Counter(18 - 100, 7 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Stale));
+	TestEqual(TEXT("outside the window lost change"), Stream.LostChange, 0);
+	TestEqual(TEXT("lost after the window"), Stream.Tracker.GetLost(), 2ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSequenceTrackerWrapTest, "RMG_MRMC.SequenceTracker.CounterWrap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSequenceTrackerWrapTest::RunTest(const FString& Parameters)
+{
+	const double Period = 0.02;
+	FRMG_MRMCSequenceTestStream Stream;
+
+	// 0xfffffffe, 0xffffffff, 1 (0 lost), 0 (late), 0xffffffff (repeated), 2
+	const uint32 Counters[] = { 0xfffffffe, 0xffffffff, 1, 0, 0xffffffff, 2 };
+	const ERMG_MRMCSequenceVerdict Expected[] = { ERMG_MRMCSequenceVerdict::Accept, ERMG_MRMCSequenceVerdict::Accept, ERMG_MRMCSequenceVerdict::Accept,
+		ERMG_MRMCSequenceVerdict::Stale, ERMG_MRMCSequenceVerdict::Duplicate, ERMG_MRMCSequenceVerdict::Accept };
+	const int32 ExpectedLostChange[] = { 0, 0, 1, -1, 0, 0 };
+	for (int32 Idx = 0; Idx < UE_ARRAY_COUNT(Counters); Idx++)
+	{
+		const ERMG_MRMCSequenceVerdict Verdict = Stream.Counter(Counters[Idx], Idx * Period);
+		TestEqual(FString::Printf(TEXT("counter %u verdict"), Counters[Idx]), SequenceVerdictName(Verdict), SequenceVerdictName(Expected[Idx]));
+		TestEqual(FString::Printf(TEXT("counter %u lost change"), Counters[Idx]), Stream.LostChange, ExpectedLostChange[Idx]);
+	}
+	TestEqual(TEXT("accepted across the wrap"), Stream.Tracker.GetAccepted(), 4ull);
+	TestEqual(TEXT("lost across the wrap"), Stream.Tracker.GetLost(), 0ull);
+	TestEqual(TEXT("stale across the wrap"), Stream.Tracker.GetStale(), 1ull);
+	TestEqual(TEXT("duplicates across the wrap"), Stream.Tracker.GetDuplicates(), 1ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSequenceTrackerResyncTest, "RMG_MRMC.SequenceTracker.Resync", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSequenceTrackerResyncTest::RunTest(const FString& Parameters)
+{
+	const double Period = 0.02;
+	FRMG_MRMCSequenceTestStream Stream;
+
+	Stream.Counter(1000, 0.0);
+	// the largest jump still counted as loss
+	TestEqual(TEXT("jump of 250 accepted"), SequenceVerdictName(Stream.Counter(1000 + RMG_MRMC_SEQUENCE_RESYNC, Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	TestEqual(TEXT("jump of 250 lost change"), Stream.LostChange, RMG_MRMC_SEQUENCE_RESYNC - 1);
+
+	// one more is a robot restart: accepted without loss, in either direction
+	uint32 Counter = 1000 + RMG_MRMC_SEQUENCE_RESYNC;
+	Counter += RMG_MRMC_SEQUENCE_RESYNC + 1;
+	TestEqual(TEXT("jump of 251 accepted"), SequenceVerdictName(Stream.Counter(Counter, 2 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	TestEqual(TEXT("jump of 251 lost change"), Stream.LostChange, 0);
+	Counter = 3;
+	TestEqual(TEXT("restart from 3 accepted"), SequenceVerdictName(Stream.Counter(Counter, 3 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	TestEqual(TEXT("restart lost change"), Stream.LostChange, 0);
+
+	// the window starts over at the new counter: the old one is far outside it, the next one is in order
+	TestEqual(TEXT("counter from before the restart"), SequenceVerdictName(Stream.Counter(1000 + 2 * RMG_MRMC_SEQUENCE_RESYNC + 1, 4 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	Stream.Counter(3, 5 * Period);
+	TestEqual(TEXT("counter after the restart"), SequenceVerdictName(Stream.Counter(4, 5 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	TestEqual(TEXT("lost is only the counted jump"), Stream.Tracker.GetLost(), uint64(RMG_MRMC_SEQUENCE_RESYNC - 1));
+	TestEqual(TEXT("gaps"), Stream.Tracker.GetGaps(), 1ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSequenceTrackerSupersededTest, "RMG_MRMC.SequenceTracker.Superseded", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSequenceTrackerSupersededTest::RunTest(const FString& Parameters)
+{
+	const double Period = 0.02;
+	FRMG_MRMCSequenceTestStream Stream;
+
+	// a mailbox read 20, then 24 after overwriting 21, 22 and 23 unread
+	Stream.Counter(20, 0.0);
+	Stream.Tracker.AddSuperseded(3);
+	TestEqual(TEXT("newest after a stall accepted"), SequenceVerdictName(Stream.Counter(24, 4 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	TestEqual(TEXT("superseded frames are not lost"), Stream.LostChange, 0);
+	TestEqual(TEXT("no gap"), Stream.Tracker.GetGaps(), 0ull);
+
+	// a late copy of a frame the mailbox passed over was received once already
+	TestEqual(TEXT("copy of a superseded frame"), SequenceVerdictName(Stream.Counter(22, 4 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Duplicate));
+
+	// superseded frames cover only part of a real gap: 25 and 26 overwritten, 27 and 28 lost
+	Stream.Tracker.AddSuperseded(2);
+	Stream.Counter(29, 9 * Period);
+	TestEqual(TEXT("lost beyond the superseded frames"), Stream.LostChange, 2);
+	TestEqual(TEXT("lost"), Stream.Tracker.GetLost(), 2ull);
+	TestEqual(TEXT("one gap"), Stream.Tracker.GetGaps(), 1ull);
+
+	// pending superseded frames are used up by the next accepted frame
+	Stream.Counter(31, 11 * Period);
+	TestEqual(TEXT("gap after the superseded frames were used"), Stream.LostChange, 1);
+	TestEqual(TEXT("duplicates"), Stream.Tracker.GetDuplicates(), 1ull);
+	TestEqual(TEXT("stale"), Stream.Tracker.GetStale(), 0ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSequenceTrackerArrivalTest, "RMG_MRMC.SequenceTracker.Arrival", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSequenceTrackerArrivalTest::RunTest(const FString& Parameters)
+{
+	const double Period = 0.02;
+	FRMG_MRMCSequenceTestStream Stream;
+
+	// ten frames on time teach the rate
+	for (int32 Frame = 0; Frame < 10; Frame++)
+	{
+		Stream.Basic(Frame * Period, Frame * Period);
+	}
+	TestEqual(TEXT("nominal period"), float(Stream.Tracker.GetNominalPeriod()), float(Period), 1e-6f);
+	TestFalse(TEXT("basic stream has no frame counter"), Stream.Tracker.HasFrameCounter());
+
+	// a copy well inside the period is a duplicate, the same payload a period later is a robot at rest
+	TestEqual(TEXT("copy within a quarter period"), SequenceVerdictName(Stream.Basic(9 * Period, 9 * Period + 0.004)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Duplicate));
+	TestEqual(TEXT("repeat a period later"), SequenceVerdictName(Stream.Basic(9 * Period, 10 * Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+
+	// frames 11 and 12 missing
+	Stream.Basic(13 * Period, 13 * Period);
+	TestEqual(TEXT("two periods missing"), Stream.LostChange, 2);
+
+	// a mailbox passed over 14 and 15
+	Stream.Tracker.AddSuperseded(2);
+	Stream.Basic(16 * Period, 16 * Period);
+	TestEqual(TEXT("superseded periods are not lost"), Stream.LostChange, 0);
+
+	// a silence longer than the resync limit is a pause, not loss
+	const double Resumed = (17 + RMG_MRMC_SEQUENCE_RESYNC + 2) * Period;
+	TestEqual(TEXT("after a long pause"), SequenceVerdictName(Stream.Basic(Resumed, Resumed)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Accept));
+	TestEqual(TEXT("long pause lost change"), Stream.LostChange, 0);
+
+	TestEqual(TEXT("receive time going backwards"), SequenceVerdictName(Stream.Basic(Resumed + Period, Resumed - Period)), SequenceVerdictName(ERMG_MRMCSequenceVerdict::Stale));
+	TestEqual(TEXT("accepted"), Stream.Tracker.GetAccepted(), 14ull);
+	TestEqual(TEXT("duplicates"), Stream.Tracker.GetDuplicates(), 1ull);
+	TestEqual(TEXT("stale"), Stream.Tracker.GetStale(), 1ull);
+	TestEqual(TEXT("lost"), Stream.Tracker.GetLost(), 2ull);
+	TestEqual(TEXT("gaps"), Stream.Tracker.GetGaps(), 1ull);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSequenceTrackerFaultTest, "RMG_MRMC.SequenceTracker.InjectedFaults", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSequenceTrackerFaultTest::RunTest(const FString& Parameters)
+{
+	// a seeded fault injector, so the recorded sequence is the same on every run
+	FRMG_MRMCFaultOptions Options;
+	Options.Loss = 0.02f;
+	Options.Reorder = 0.02f;
+	Options.Duplicate = 0.02f;
+	Options.Seed = 13;
+	FRMG_MRMCFaultInjector Faults(Options, 1);
+
+	const int32 NumFrames = 20000;
+	FRMG_MRMCSequenceTestStream Stream;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		const FRMG_MRMCDecodedPacket Packet = RMG_MRMCHeadless::MakeOrbitSample(Frame * 0.02, 0xffffff00u + Frame, ERMG_MRMCPacketVariant::FrameCounter);
+		uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+		const int32 Size = RMG_MRMCPacketDecoder::Encode(Packet, Data);
+		Faults.Process(0, Data, Size, SequenceTestStartSeconds + Frame * 0.02, [&Stream](int32 InStream, const uint8* InData, int32 InSize, double ReceiveSeconds)
+		{
+			FRMG_MRMCDecodedPacket Received;
+			if (RMG_MRMCPacketDecoder::Decode(InData, InSize, Received))
+			{
+				Stream.Tracker.Check(InData, InSize, Received, ReceiveSeconds, Stream.LostChange);
+			}
+		});
+	}
+
+	const FRMG_MRMCSequenceTracker& Tracker = Stream.Tracker;
+	AddInfo(FString::Printf(TEXT("dropped %llu, duplicated %llu, reordered %llu; lost %llu, duplicates %llu, stale %llu"),
+		Faults.GetDropped(), Faults.GetDuplicated(), Faults.GetReordered(), Tracker.GetLost(), Tracker.GetDuplicates(), Tracker.GetStale()));
+	TestTrue(TEXT("faults were injected"), Faults.GetDropped() > 0 && Faults.GetDuplicated() > 0 && Faults.GetReordered() > 0);
+	TestEqual(TEXT("lost matches dropped"), Tracker.GetLost(), Faults.GetDropped());
+	TestEqual(TEXT("duplicates match duplicated"), Tracker.GetDuplicates(), Faults.GetDuplicated());
+	TestEqual(TEXT("stale matches reordered"), Tracker.GetStale(), Faults.GetReordered());
+	TestEqual(TEXT("every frame accounted for"), Tracker.GetAccepted() + Tracker.GetStale() + Tracker.GetLost(), uint64(NumFrames));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,206 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCSharedMemoryRing.h"
+#include "Misc/AutomationTest.h"
+#include <atomic>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Writes datagram Index into the ring: its index as the payload, the write stamp and the stream, so a
+// reader can tell a whole datagram from one mixed with another
+static void WriteSharedMemoryTestDatagram(RMG_MRMCSharedMemory::FRing& Ring, uint64 Index)
+{
+	uint8 Data[8];
+	FMemory::Memcpy(Data, &Index, sizeof(Index));
+	RMG_MRMCSharedMemory::Write(Ring, static_cast<uint16>(Index & 0xffff), Data, sizeof(Data), static_cast<int64>(Index));
+}
+
+// Index of a datagram written above, or ~0 when its payload, stamp and stream disagree
+static uint64 ReadSharedMemoryTestDatagram(uint16 Stream, const uint8* Data, uint32 Size, int64 WriteUnixNs)
+{
+	uint64 Index = ~uint64(0);
+	if (Size == sizeof(Index))
+	{
+		FMemory::Memcpy(&Index, Data, sizeof(Index));
+	}
+	return Size == sizeof(Index) && static_cast<int64>(Index) == WriteUnixNs && Stream == (Index & 0xffff) ? Index : ~uint64(0);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSharedMemoryRingOverrunTest, "RMG_MRMC.SharedMemoryRing.Overrun", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSharedMemoryRingOverrunTest::RunTest(const FString& Parameters)
+{
+	TUniquePtr<RMG_MRMCSharedMemory::FRing> Ring = MakeUnique<RMG_MRMCSharedMemory::FRing>();
+	TestTrue(TEXT("zeroed region initializes"), RMG_MRMCSharedMemory::Initialize(*Ring));
+	TestTrue(TEXT("initialized region is accepted again"), RMG_MRMCSharedMemory::Initialize(*Ring));
+
+	// written before the reader opened the ring: stale, never read
+	uint64 NextWrite = 0;
+	for (; NextWrite < 3; NextWrite++)
+	{
+		WriteSharedMemoryTestDatagram(*Ring, NextWrite);
+	}
+	RMG_MRMCSharedMemory::FReader Reader;
+	Reader.Open(*Ring);
+	TestFalse(TEXT("nothing pending after open"), Reader.HasPending(*Ring));
+
+	TArray<uint64> Read;
+	auto Sink = [&Read](uint16 Stream, const uint8* Data, uint32 Size, int64 WriteUnixNs)
+	{
+		Read.Add(ReadSharedMemoryTestDatagram(Stream, Data, Size, WriteUnixNs));
+	};
+
+	for (; NextWrite < 8; NextWrite++)
+	{
+		WriteSharedMemoryTestDatagram(*Ring, NextWrite);
+	}
+	TestTrue(TEXT("pending after writes"), Reader.HasPending(*Ring));
+	TestEqual(TEXT("datagrams read"), Reader.Drain(*Ring, Sink), 5u);
+	TestEqual(TEXT("first datagram read"), Read[0], uint64(3));
+	TestEqual(TEXT("last datagram read"), Read.Last(), uint64(7));
+	TestEqual(TEXT("overruns while keeping up"), Reader.Overruns, uint64(0));
+
+	// 100 more than the ring holds while the reader was away: the oldest 100 are lost, the rest read in order
+	Read.Reset();
+	const uint64 FirstBehind = NextWrite;
+	for (; NextWrite < FirstBehind + RMG_MRMCSharedMemory::NumSlots + 100; NextWrite++)
+	{
+		WriteSharedMemoryTestDatagram(*Ring, NextWrite);
+	}
+	TestEqual(TEXT("datagrams read after falling behind"), Reader.Drain(*Ring, Sink), RMG_MRMCSharedMemory::NumSlots);
+	TestEqual(TEXT("overruns after falling behind"), Reader.Overruns, uint64(100));
+	bool bInOrder = true;
+	for (int32 Idx = 0; Idx < Read.Num(); Idx++)
+	{
+		bInOrder &= Read[Idx] == FirstBehind + 100 + Idx;
+	}
+	TestTrue(TEXT("newest ring's worth read in order"), bInOrder);
+	TestEqual(TEXT("read index after falling behind"), Reader.ReadIndex, NextWrite);
+
+	// a claimed slot not yet published ends the drain, and is read once it is
+	const uint64 Claimed = Ring->WriteIndex.fetch_add(1);
+	Ring->Slots[Claimed & (RMG_MRMCSharedMemory::NumSlots - 1)].Sequence.store(RMG_MRMCSharedMemory::PublishedSequence(Claimed) - 1);
+	WriteSharedMemoryTestDatagram(*Ring, Claimed + 1);
+	Read.Reset();
+	TestEqual(TEXT("datagrams read behind an unpublished slot"), Reader.Drain(*Ring, Sink), 0u);
+	RMG_MRMCSharedMemory::FSlot& ClaimedSlot = Ring->Slots[Claimed & (RMG_MRMCSharedMemory::NumSlots - 1)];
+	FMemory::Memcpy(ClaimedSlot.Data, &Claimed, sizeof(Claimed));
+	ClaimedSlot.Size = sizeof(Claimed);
+	ClaimedSlot.Stream = static_cast<uint16>(Claimed & 0xffff);
+	ClaimedSlot.WriteUnixNs = static_cast<int64>(Claimed);
+	ClaimedSlot.Sequence.store(RMG_MRMCSharedMemory::PublishedSequence(Claimed));
+	TestEqual(TEXT("datagrams read once the slot is published"), Reader.Drain(*Ring, Sink), 2u);
+	TestTrue(TEXT("published slot read first"), Read.Num() == 2 && Read[0] == Claimed && Read[1] == Claimed + 1);
+
+	// the region recreated under the reader: it starts over from the new write index
+	Ring->WriteIndex.store(0);
+	FMemory::Memzero(Ring->Slots, sizeof(Ring->Slots));
+	TestTrue(TEXT("recreated region counts as pending"), Reader.HasPending(*Ring));
+	WriteSharedMemoryTestDatagram(*Ring, 0);
+	Read.Reset();
+	TestEqual(TEXT("datagrams read from a recreated region"), Reader.Drain(*Ring, Sink), 0u);
+	TestEqual(TEXT("read index in a recreated region"), Reader.ReadIndex, uint64(1));
+	WriteSharedMemoryTestDatagram(*Ring, 1);
+	TestEqual(TEXT("datagrams read after recreation"), Reader.Drain(*Ring, Sink), 1u);
+	TestEqual(TEXT("overruns in the end"), Reader.Overruns, uint64(100));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSharedMemoryRingLappedTest, "RMG_MRMC.SharedMemoryRing.Lapped", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSharedMemoryRingLappedTest::RunTest(const FString& Parameters)
+{
+	TUniquePtr<RMG_MRMCSharedMemory::FRing> Ring = MakeUnique<RMG_MRMCSharedMemory::FRing>();
+	RMG_MRMCSharedMemory::Initialize(*Ring);
+	RMG_MRMCSharedMemory::FReader Reader;
+	Reader.Open(*Ring);
+
+	for (uint64 Idx = 0; Idx < 10; Idx++)
+	{
+		WriteSharedMemoryTestDatagram(*Ring, Idx);
+	}
+
+	// the producers come round the whole ring while the first datagram is in the sink: the other nine are
+	// found overwritten by later laps and skipped, then the new lap is read
+	TArray<uint64> Read;
+	const uint32 NumRead = Reader.Drain(*Ring, [&Ring, &Read](uint16 Stream, const uint8* Data, uint32 Size, int64 WriteUnixNs)
+	{
+		Read.Add(ReadSharedMemoryTestDatagram(Stream, Data, Size, WriteUnixNs));
+		if (Read.Num() == 1)
+		{
+			for (uint64 Idx = 10; Idx < 10 + RMG_MRMCSharedMemory::NumSlots; Idx++)
+			{
+				WriteSharedMemoryTestDatagram(*Ring, Idx);
+			}
+		}
+	});
+
+	TestEqual(TEXT("datagrams read"), NumRead, 1 + RMG_MRMCSharedMemory::NumSlots);
+	TestEqual(TEXT("lapped slots counted"), Reader.Overruns, uint64(9));
+	bool bInOrder = Read.Num() > 0 && Read[0] == 0;
+	for (int32 Idx = 1; Idx < Read.Num(); Idx++)
+	{
+		bInOrder &= Read[Idx] == uint64(9 + Idx);
+	}
+	TestTrue(TEXT("first datagram, then the whole new lap in order"), bInOrder);
+	TestEqual(TEXT("read index"), Reader.ReadIndex, uint64(10 + RMG_MRMCSharedMemory::NumSlots));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCSharedMemoryRingConcurrentTest, "RMG_MRMC.SharedMemoryRing.Concurrent", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCSharedMemoryRingConcurrentTest::RunTest(const FString& Parameters)
+{
+	TUniquePtr<RMG_MRMCSharedMemory::FRing> Ring = MakeUnique<RMG_MRMCSharedMemory::FRing>();
+	RMG_MRMCSharedMemory::Initialize(*Ring);
+	RMG_MRMCSharedMemory::FReader Reader;
+	Reader.Open(*Ring);
+
+	// a producer against a reader that copies slots while they are rewritten, letting the reader keep up for
+	// the first half and running unpaced for the second: every datagram read must be whole and newer than
+	// the last, and every datagram written read or counted as overrun
+	const uint64 NumDatagrams = 500000;
+	std::atomic<bool> bWritten(false);
+	FRMG_MRMCBenchmarkThread Writer(TEXT("RMG_MRMCSharedMemoryRingTest"), [&Ring, &bWritten, NumDatagrams]()
+	{
+		for (uint64 Idx = 0; Idx < NumDatagrams; Idx++)
+		{
+			WriteSharedMemoryTestDatagram(*Ring, Idx);
+			if (Idx < NumDatagrams / 2 && Idx % 256 == 0)
+			{
+				FPlatformProcess::Yield();
+			}
+		}
+		bWritten = true;
+	});
+
+	uint64 NumRead = 0;
+	uint64 NumTorn = 0;
+	uint64 NumOutOfOrder = 0;
+	uint64 Last = 0;
+	auto Sink = [&NumRead, &NumTorn, &NumOutOfOrder, &Last](uint16 Stream, const uint8* Data, uint32 Size, int64 WriteUnixNs)
+	{
+		const uint64 Index = ReadSharedMemoryTestDatagram(Stream, Data, Size, WriteUnixNs);
+		NumTorn += Index == ~uint64(0);
+		NumOutOfOrder += NumRead > 0 && Index <= Last;
+		Last = Index;
+		NumRead++;
+	};
+	while (!bWritten)
+	{
+		Reader.Drain(*Ring, Sink);
+		FPlatformProcess::Yield();
+	}
+	Writer.WaitForCompletion();
+	Reader.Drain(*Ring, Sink);
+
+	AddInfo(FString::Printf(TEXT("%llu datagrams read, %llu overrun"), NumRead, static_cast<uint64>(Reader.Overruns)));
+	TestEqual(TEXT("torn datagrams read"), NumTorn, uint64(0));
+	TestEqual(TEXT("datagrams read out of order"), NumOutOfOrder, uint64(0));
+	TestEqual(TEXT("datagrams read or overrun"), NumRead + Reader.Overruns, NumDatagrams);
+	TestEqual(TEXT("last datagram read"), Last, NumDatagrams - 1);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,174 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCStreamProcessor.h"
+#include "RMG_MRMCSubjectMapping.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCStreamProcessorCaptureTest, "RMG_MRMC.StreamProcessor.Capture", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCStreamProcessorCaptureTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	if (!TestTrue(TEXT("built-in mapping compiles"), FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error)))
+	{
+		return false;
+	}
+	FApp::SetTimecodeFrameRate(FFrameRate(50, 1));
+
+	FRMG_MRMCCaptureFrameSink Sink;
+	FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+	Processor.PushStaticData(Sink);
+	TestEqual(TEXT("subjects set up"), Sink.StaticData.Num(), 2);
+	const FRMG_MRMCSubjectStaticData* CameraStatic = Sink.StaticData.Find(TEXT("robot_camera"));
+	if (!TestNotNull(TEXT("robot_camera static data"), CameraStatic))
+	{
+		return false;
+	}
+	TestEqual(TEXT("robot_camera bones"), CameraStatic->BoneNames.Num(), 2);
+	TestEqual(TEXT("CameraPose parent"), CameraStatic->BoneParents.Num() == 2 ? CameraStatic->BoneParents[1] : INDEX_NONE, 0);
+	TestEqual(TEXT("robot_camera properties"), CameraStatic->PropertyNames.Num(), 3);
+
+	const FRMG_MRMCDecodedPacket Sample = RMG_MRMCHeadless::MakeOrbitSample(1.25, 62, ERMG_MRMCPacketVariant::FrameCounter);
+	uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+	const int32 Size = RMG_MRMCPacketDecoder::Encode(Sample, Data);
+	TestTrue(TEXT("packet accepted"), Processor.ProcessPacket(Data, Size, 1000.0, Sink));
+	if (!TestEqual(TEXT("frames pushed for one packet"), Sink.Frames.Num(), 2))
+	{
+		return false;
+	}
+
+	// meters to centimeters with Y flipped into UE's left-handed frame
+	const FRMG_MRMCSubjectFrame& CameraFrame = Sink.Frames[0].SubjectName == TEXT("robot_camera") ? Sink.Frames[0] : Sink.Frames[1];
+	TestEqual(TEXT("CameraPose location"), CameraFrame.Transforms[1].GetLocation(), FVector(Sample.Robot.xv * 100.0f, -Sample.Robot.yv * 100.0f, Sample.Robot.zv * 100.0f), 0.01f);
+	TestEqual(TEXT("Roll property"), CameraFrame.PropertyValues[0], Sample.Robot.roll);
+	TestEqual(TEXT("Zoom property"), CameraFrame.PropertyValues[2], Sample.Robot.zoom);
+	const FVector LookAt(Sample.Robot.xt - Sample.Robot.xv, Sample.Robot.yv - Sample.Robot.yt, Sample.Robot.zt - Sample.Robot.zv);
+	TestEqual(TEXT("Focus property is the look-at distance"), CameraFrame.PropertyValues[1], LookAt.Size() * 100.0f, 0.1f);
+
+	Sink.Frames.Reset();
+	TestFalse(TEXT("repeated frame counter rejected"), Processor.ProcessPacket(Data, Size, 1000.02, Sink));
+	TestFalse(TEXT("truncated datagram rejected"), Processor.ProcessPacket(Data, Size - 1, 1000.02, Sink));
+	TestEqual(TEXT("frames pushed for rejected packets"), Sink.Frames.Num(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCStreamProcessorCameraRoleTest, "RMG_MRMC.StreamProcessor.CameraRole", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCStreamProcessorCameraRoleTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	if (!TestTrue(TEXT("built-in mapping compiles"), FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error)))
+	{
+		return false;
+	}
+	FApp::SetTimecodeFrameRate(FFrameRate(50, 1));
+
+	FRMG_MRMCProcessingOptions Options;
+	Options.bCameraRole = true;
+	FRMG_MRMCCaptureFrameSink Sink;
+	FRMG_MRMCStreamProcessor Processor(Mapping, Options);
+	Processor.PushStaticData(Sink);
+
+	const FRMG_MRMCSubjectStaticData* CameraStatic = Sink.StaticData.Find(TEXT("robot_camera"));
+	if (!TestNotNull(TEXT("robot_camera static data"), CameraStatic))
+	{
+		return false;
+	}
+	TestTrue(TEXT("robot_camera has the camera role"), CameraStatic->Role == ERMG_MRMCSubjectRole::Camera);
+	TestFalse(TEXT("raw zoom without a lens profile is no focal length"), CameraStatic->bHasFocalLength);
+	TestTrue(TEXT("focus distance mapped"), CameraStatic->bHasFocusDistance);
+	const FRMG_MRMCSubjectStaticData* TargetStatic = Sink.StaticData.Find(TEXT("camera_target"));
+	TestTrue(TEXT("camera_target keeps the animation role"), TargetStatic != nullptr && TargetStatic->Role == ERMG_MRMCSubjectRole::Animation);
+
+	const FRMG_MRMCDecodedPacket Sample = RMG_MRMCHeadless::MakeOrbitSample(3.5, 175, ERMG_MRMCPacketVariant::FrameCounter);
+	uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+	Processor.ProcessPacket(Data, RMG_MRMCPacketDecoder::Encode(Sample, Data), 1000.0, Sink);
+	const FRMG_MRMCSubjectFrame* CameraFrame = Sink.Frames.FindByPredicate([](const FRMG_MRMCSubjectFrame& Frame) { return Frame.SubjectName == TEXT("robot_camera"); });
+	if (!TestNotNull(TEXT("robot_camera frame"), CameraFrame))
+	{
+		return false;
+	}
+
+	// the camera transform is CameraPose composed onto top, which has no channels
+	const FVector CameraLocation(Sample.Robot.xv * 100.0f, -Sample.Robot.yv * 100.0f, Sample.Robot.zv * 100.0f);
+	TestEqual(TEXT("camera location"), CameraFrame->CameraTransform.GetLocation(), CameraLocation, 0.01f);
+	const FVector Target(Sample.Robot.xt * 100.0f, -Sample.Robot.yt * 100.0f, Sample.Robot.zt * 100.0f);
+	TestEqual(TEXT("camera focus distance"), CameraFrame->FocusDistance, FVector::Dist(CameraLocation, Target), 0.1f);
+	TestEqual(TEXT("camera looks at the target"), CameraFrame->CameraTransform.GetRotation().GetForwardVector(), (Target - CameraLocation).GetSafeNormal(), 0.01f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCStreamProcessorStreamsTest, "RMG_MRMC.StreamProcessor.Streams", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCStreamProcessorStreamsTest::RunTest(const FString& Parameters)
+{
+	FRMG_MRMCCompiledMapping Mapping;
+	FString Error;
+	if (!TestTrue(TEXT("built-in mapping compiles"), FRMG_MRMCCompiledMapping::Compile(FString(), Mapping, Error)))
+	{
+		return false;
+	}
+	FApp::SetTimecodeFrameRate(FFrameRate(50, 1));
+
+	// four robots at 50 Hz whose datagrams arrive together, as one receive wakeup drains them; frame timing
+	// shared between streams would let only the first through each frame
+	const int32 NumStreams = 4;
+	const int32 NumSamples = 200;
+	FRMG_MRMCCaptureFrameSink Interleaved[NumStreams];
+	FRMG_MRMCCaptureFrameSink Alone[NumStreams];
+	TArray<TUniquePtr<FRMG_MRMCStreamProcessor>> Processors;
+	for (int32 Stream = 0; Stream < NumStreams; Stream++)
+	{
+		Processors.Add(MakeUnique<FRMG_MRMCStreamProcessor>(Mapping, FRMG_MRMCProcessingOptions()));
+	}
+	for (int32 Sample = 0; Sample < NumSamples; Sample++)
+	{
+		for (int32 Stream = 0; Stream < NumStreams; Stream++)
+		{
+			uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+			const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Sample / 50.0, Sample, ERMG_MRMCPacketVariant::FrameCounter, Stream * 0.37), Data);
+			Processors[Stream]->ProcessPacket(Data, Size, 1000.0 + Sample / 50.0, Interleaved[Stream]);
+		}
+	}
+	for (int32 Stream = 0; Stream < NumStreams; Stream++)
+	{
+		FRMG_MRMCStreamProcessor Processor(Mapping, FRMG_MRMCProcessingOptions());
+		for (int32 Sample = 0; Sample < NumSamples; Sample++)
+		{
+			uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+			const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Sample / 50.0, Sample, ERMG_MRMCPacketVariant::FrameCounter, Stream * 0.37), Data);
+			Processor.ProcessPacket(Data, Size, 1000.0 + Sample / 50.0, Alone[Stream]);
+		}
+	}
+
+	for (int32 Stream = 0; Stream < NumStreams; Stream++)
+	{
+		const TArray<FRMG_MRMCSubjectFrame>& Frames = Interleaved[Stream].Frames;
+		const TArray<FRMG_MRMCSubjectFrame>& Expected = Alone[Stream].Frames;
+		if (!TestEqual(FString::Printf(TEXT("stream %d frames"), Stream), Frames.Num(), NumSamples * Mapping.NumSubjects())
+			|| !TestEqual(FString::Printf(TEXT("stream %d frames alone"), Stream), Expected.Num(), Frames.Num()))
+		{
+			continue;
+		}
+		int32 NumMismatches = 0;
+		for (int32 Idx = 0; Idx < Frames.Num(); Idx++)
+		{
+			const bool bSame = Frames[Idx].SubjectName == Expected[Idx].SubjectName
+				&& Frames[Idx].PropertyValues == Expected[Idx].PropertyValues
+				&& Frames[Idx].Transforms.Num() == Expected[Idx].Transforms.Num()
+				&& Frames[Idx].Transforms.Last().GetLocation().Equals(Expected[Idx].Transforms.Last().GetLocation(), 0.0f);
+			NumMismatches += bSame ? 0 : 1;
+		}
+		TestEqual(FString::Printf(TEXT("stream %d frames differing from the stream alone"), Stream), NumMismatches, 0);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,147 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCHeadless.h"
+#include "RMG_MRMCTakeRecorder.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Receive time of the first datagram of a test take
+static const double TakeTestStartSeconds = 10.0;
+
+// Appends one datagram of the orbit move at Frame on Stream, received at 50 Hz
+static bool AppendTakeTestFrame(FRMG_MRMCTakeRecorder& Recorder, int32 Stream, int32 Frame)
+{
+	uint8 Data[RMG_MRMCPacketDecoder::MaxPacketSize];
+	const double Seconds = Frame * 0.02;
+	const int32 Size = RMG_MRMCPacketDecoder::Encode(RMG_MRMCHeadless::MakeOrbitSample(Seconds, Frame, ERMG_MRMCPacketVariant::FrameCounter, Stream), Data);
+	return Recorder.Append(Stream, Data, Size, TakeTestStartSeconds + Seconds);
+}
+
+// Header of the take file as a reader sees it
+static FRMG_MRMCTakeHeader ReadTakeTestHeader(const FString& Filename)
+{
+	FRMG_MRMCTakeHeader Header;
+	FMemory::Memzero(Header);
+	TArray<uint8> Bytes;
+	if (FFileHelper::LoadFileToArray(Bytes, *Filename, FILEREAD_AllowWrite) && Bytes.Num() >= static_cast<int32>(sizeof(Header)))
+	{
+		FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(Header));
+	}
+	return Header;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCTakeRecorderGrowingTest, "RMG_MRMC.TakeRecorder.Growing", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCTakeRecorderGrowingTest::RunTest(const FString& Parameters)
+{
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("RMG_MRMCTakeRecorderTest.take");
+	const uint64 Capacity = 8192;
+	TUniquePtr<FRMG_MRMCTakeRecorder> Recorder = FRMG_MRMCTakeRecorder::Open(Filename, Capacity, 2);
+	if (!TestTrue(TEXT("take opened"), Recorder.IsValid()))
+	{
+		return false;
+	}
+
+	// stream 0 at 50 Hz with stream 1 interleaved every third frame, written while the take is read
+	const int32 NumFrames = 3000;
+	std::atomic<bool> bWritten(false);
+	FRMG_MRMCBenchmarkThread Writer(TEXT("RMG_MRMCTakeRecorderTest"), [&Recorder, &bWritten, NumFrames]()
+	{
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			AppendTakeTestFrame(*Recorder, 0, Frame);
+			if (Frame % 3 == 0)
+			{
+				AppendTakeTestFrame(*Recorder, 1, Frame);
+			}
+			if (Frame % 16 == 0)
+			{
+				FPlatformProcess::Yield();
+			}
+		}
+		bWritten = true;
+	});
+
+	// every read must see a whole prefix of stream 0: no record missing, torn or out of order below RecordCount
+	int32 NumReads = 0;
+	int32 NumPartialReads = 0;
+	int32 NumBadReads = 0;
+	int32 LastNum = 0;
+	while (!bWritten)
+	{
+		TArray<FRMG_MRMCTakeSample> Samples;
+		FString Error;
+		if (RMG_MRMCHeadless::LoadTakeSamples(Filename, 0, Samples, Error))
+		{
+			NumReads++;
+			NumPartialReads += Samples.Num() < NumFrames;
+			bool bPrefix = Samples.Num() >= LastNum && Samples.Num() <= NumFrames;
+			for (int32 Idx = 0; Idx < Samples.Num() && bPrefix; Idx++)
+			{
+				bPrefix = Samples[Idx].Seconds == TakeTestStartSeconds + Idx * 0.02;
+			}
+			NumBadReads += !bPrefix;
+			LastNum = Samples.Num();
+		}
+		FPlatformProcess::Yield();
+	}
+	Writer.WaitForCompletion();
+	AddInfo(FString::Printf(TEXT("%d reads while recording, %d of them before the last frame"), NumReads, NumPartialReads));
+	TestEqual(TEXT("reads that were not a whole prefix of the stream"), NumBadReads, 0);
+
+	const uint64 NumRecords = NumFrames + (NumFrames + 2) / 3;
+	TestEqual(TEXT("records appended"), Recorder->GetRecordCount(), NumRecords);
+	const FRMG_MRMCTakeHeader OpenHeader = ReadTakeTestHeader(Filename);
+	TestEqual(TEXT("record count a reader sees"), OpenHeader.RecordCount, NumRecords);
+	TestEqual(TEXT("not finalized while open"), OpenHeader.Flags & RMG_MRMC_TAKE_FLAG_FINALIZED, 0u);
+	TestEqual(TEXT("preallocated while open"), IFileManager::Get().FileSize(*Filename), int64(OpenHeader.RecordOffset + Capacity * sizeof(FRMG_MRMCTakeRecord)));
+
+	TArray<FRMG_MRMCTakeSample> Samples;
+	FString Error;
+	TestTrue(TEXT("stream 1 loads while open"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 1, Samples, Error));
+	TestEqual(TEXT("stream 1 samples"), Samples.Num(), (NumFrames + 2) / 3);
+
+	// closing finalizes the take and trims it to the records written
+	Recorder.Reset();
+	const FRMG_MRMCTakeHeader ClosedHeader = ReadTakeTestHeader(Filename);
+	TestEqual(TEXT("finalized once closed"), ClosedHeader.Flags & RMG_MRMC_TAKE_FLAG_FINALIZED, uint32(RMG_MRMC_TAKE_FLAG_FINALIZED));
+	TestEqual(TEXT("trimmed once closed"), IFileManager::Get().FileSize(*Filename), int64(ClosedHeader.RecordOffset + NumRecords * sizeof(FRMG_MRMCTakeRecord)));
+	TestTrue(TEXT("stream 0 loads once closed"), RMG_MRMCHeadless::LoadTakeSamples(Filename, 0, Samples, Error));
+	TestEqual(TEXT("stream 0 samples once closed"), Samples.Num(), NumFrames);
+
+	IFileManager::Get().Delete(*Filename);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRMG_MRMCTakeRecorderFullTest, "RMG_MRMC.TakeRecorder.Full", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRMG_MRMCTakeRecorderFullTest::RunTest(const FString& Parameters)
+{
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("RMG_MRMCTakeRecorderTest.take");
+	TUniquePtr<FRMG_MRMCTakeRecorder> Recorder = FRMG_MRMCTakeRecorder::Open(Filename, 10, 1);
+	if (!TestTrue(TEXT("take opened"), Recorder.IsValid()))
+	{
+		return false;
+	}
+
+	int32 NumAppended = 0;
+	for (int32 Frame = 0; Frame < 12; Frame++)
+	{
+		NumAppended += AppendTakeTestFrame(*Recorder, 0, Frame);
+	}
+	TestEqual(TEXT("appends accepted"), NumAppended, 10);
+	TestEqual(TEXT("records"), Recorder->GetRecordCount(), uint64(10));
+	TestEqual(TEXT("dropped"), Recorder->GetDroppedCount(), uint64(2));
+
+	Recorder.Reset();
+	TestEqual(TEXT("dropped count kept in the take"), ReadTakeTestHeader(Filename).DroppedCount, uint64(2));
+	IFileManager::Get().Delete(*Filename);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,30 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+using System.IO;
+using UnrealBuildTool;
+
+// Launch module of the RMG_MRMCHeadless program, see RMG_MRMCHeadless.Target.cs. Not listed in the
+// .uplugin, so the editor never loads it.
+public class RMG_MRMCHeadless : ModuleRules
+{
+	public RMG_MRMCHeadless(ReadOnlyTargetRules Target) : base(Target)
+	{
+		// RequiredProgramMainCPPInclude.h
+		PublicIncludePaths.Add(Path.Combine(EngineDirectory, "Source/Runtime/Launch/Public"));
+		PrivateIncludePaths.Add(Path.Combine(EngineDirectory, "Source/Runtime/Launch/Private"));
+
+		// the header-only packet ring, tested and benchmarked against the queue it replaced; the LiveLink
+		// module itself is not linked
+		PrivateIncludePaths.Add(Path.Combine(ModuleDirectory, "../RMG_MRMCLiveLink/Private"));
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"Networking",
+				"Projects",
+				"RMG_MRMCLiveLinkCore",
+				"Sockets",
+			});
+	}
+}
@@ -0,0 +1,26 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+// Console program running the core module's automation tests and benchmarks without the editor, LiveLink
+// or sockets. UBT only looks for targets in project and engine Source folders, so copy this file into the
+// host project's Source folder; the module itself is found in the plugin.
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class RMG_MRMCHeadlessTarget : TargetRules
+{
+	public RMG_MRMCHeadlessTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "RMG_MRMCHeadless";
+
+		bBuildDeveloperTools = false;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileICU = false;
+		bIsBuildingConsoleApplication = true;
+
+		// The checks are automation tests, keep them in Test configurations too
+		bForceCompileDevelopmentAutomationTests = true;
+	}
+}
@@ -0,0 +1,305 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCReceiveBackend.h"
+
+#if PLATFORM_LINUX
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Datagrams drained per recvmmsg call
+#define RMG_MRMC_RECVMMSG_BATCH 64
+
+// Bytes kept per datagram; anything longer is truncated by the kernel
+#define RMG_MRMC_RECVMMSG_BUFFER_SIZE 2048
+
+#define RECV_BUFFER_SIZE 1024 * 1024
+
+// epoll data of the wake eventfd; sockets use their stream index
+#define RMG_MRMC_WAKE_TOKEN MAX_uint32
+
+// Opens a non-blocking UDP socket bound to Endpoint (joining its group when multicast), or returns -1
+static int OpenSocket(const FIPv4Endpoint& Endpoint, int32 BusyPollMicroseconds)
+{
+	const int SocketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (SocketFd < 0)
+	{
+		return -1;
+	}
+
+	int Enable = 1;
+	int RecvBufferSize = RECV_BUFFER_SIZE;
+	setsockopt(SocketFd, SOL_SOCKET, SO_REUSEADDR, &Enable, sizeof(Enable));
+	setsockopt(SocketFd, SOL_SOCKET, SO_RCVBUF, &RecvBufferSize, sizeof(RecvBufferSize));
+
+	if (setsockopt(SocketFd, SOL_SOCKET, SO_TIMESTAMPNS, &Enable, sizeof(Enable)) != 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: SO_TIMESTAMPNS unavailable (errno %d), using user-space receive times"), errno);
+	}
+
+	if (BusyPollMicroseconds > 0 && setsockopt(SocketFd, SOL_SOCKET, SO_BUSY_POLL, &BusyPollMicroseconds, sizeof(BusyPollMicroseconds)) != 0)
+	{
+		// raising SO_BUSY_POLL needs CAP_NET_ADMIN; we still spin in user space
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: SO_BUSY_POLL refused (errno %d)"), errno);
+	}
+
+	const bool bMulticast = Endpoint.Address.IsMulticastAddress();
+
+	sockaddr_in BindAddr = {};
+	BindAddr.sin_family = AF_INET;
+	BindAddr.sin_port = htons(Endpoint.Port);
+	BindAddr.sin_addr.s_addr = bMulticast ? htonl(INADDR_ANY) : htonl(Endpoint.Address.Value);
+
+	if (bind(SocketFd, reinterpret_cast<sockaddr*>(&BindAddr), sizeof(BindAddr)) != 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: bind to %s failed (errno %d)"), *Endpoint.ToString(), errno);
+		close(SocketFd);
+		return -1;
+	}
+
+	if (bMulticast)
+	{
+		ip_mreq Group = {};
+		Group.imr_multiaddr.s_addr = htonl(Endpoint.Address.Value);
+		Group.imr_interface.s_addr = htonl(INADDR_ANY);
+		unsigned char Loopback = 1;
+		unsigned char Ttl = 2;
+		setsockopt(SocketFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &Group, sizeof(Group));
+		setsockopt(SocketFd, IPPROTO_IP, IP_MULTICAST_LOOP, &Loopback, sizeof(Loopback));
+		setsockopt(SocketFd, IPPROTO_IP, IP_MULTICAST_TTL, &Ttl, sizeof(Ttl));
+	}
+
+	return SocketFd;
+}
+
+// One socket per endpoint, all registered with a single epoll instance. Each wakeup drains every ready
+// socket with recvmmsg and reads the SO_TIMESTAMPNS kernel receive time of each datagram.
+// An eventfd in the same epoll set lets Wake() interrupt the wait without any polling.
+class FRMG_MRMCLinuxReceiveBackend : public FRMG_MRMCReceiveBackend
+{
+public:
+
+	FRMG_MRMCLinuxReceiveBackend(const TArray<FIPv4Endpoint>& Endpoints, int32 InBusyPollMicroseconds)
+	: EpollFd(-1)
+	, WakeFd(-1)
+	, BusyPollMicroseconds(InBusyPollMicroseconds)
+	, bWakeRequested(false)
+	{
+		EpollFd = epoll_create1(EPOLL_CLOEXEC);
+		WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (EpollFd < 0 || WakeFd < 0)
+		{
+			return;
+		}
+
+		epoll_event WakeEvent = {};
+		WakeEvent.events = EPOLLIN;
+		WakeEvent.data.u32 = RMG_MRMC_WAKE_TOKEN;
+		epoll_ctl(EpollFd, EPOLL_CTL_ADD, WakeFd, &WakeEvent);
+
+		for (int32 Stream = 0; Stream < Endpoints.Num(); Stream++)
+		{
+			const int SocketFd = OpenSocket(Endpoints[Stream], BusyPollMicroseconds);
+			SocketFds.Add(SocketFd);
+			if (SocketFd < 0)
+			{
+				continue;
+			}
+
+			epoll_event Event = {};
+			Event.events = EPOLLIN;
+			Event.data.u32 = static_cast<uint32>(Stream);
+			epoll_ctl(EpollFd, EPOLL_CTL_ADD, SocketFd, &Event);
+		}
+		ReadyEvents.SetNumZeroed(SocketFds.Num() + 1);
+
+		Buffers.SetNumUninitialized(RMG_MRMC_RECVMMSG_BATCH * RMG_MRMC_RECVMMSG_BUFFER_SIZE);
+		ControlBuffers.SetNumZeroed(RMG_MRMC_RECVMMSG_BATCH * ControlSize);
+
+		FMemory::Memzero(Messages);
+		for (int32 Idx = 0; Idx < RMG_MRMC_RECVMMSG_BATCH; Idx++)
+		{
+			Vectors[Idx].iov_base = Buffers.GetData() + Idx * RMG_MRMC_RECVMMSG_BUFFER_SIZE;
+			Vectors[Idx].iov_len = RMG_MRMC_RECVMMSG_BUFFER_SIZE;
+			Messages[Idx].msg_hdr.msg_iov = &Vectors[Idx];
+			Messages[Idx].msg_hdr.msg_iovlen = 1;
+			Messages[Idx].msg_hdr.msg_control = ControlBuffers.GetData() + Idx * ControlSize;
+		}
+	}
+
+	virtual ~FRMG_MRMCLinuxReceiveBackend()
+	{
+		for (int SocketFd : SocketFds)
+		{
+			if (SocketFd >= 0)
+			{
+				close(SocketFd);
+			}
+		}
+		if (EpollFd >= 0)
+		{
+			close(EpollFd);
+		}
+		if (WakeFd >= 0)
+		{
+			close(WakeFd);
+		}
+	}
+
+	virtual bool IsValid() const override
+	{
+		for (int SocketFd : SocketFds)
+		{
+			if (SocketFd < 0)
+			{
+				return false;
+			}
+		}
+		return EpollFd >= 0 && WakeFd >= 0 && SocketFds.Num() > 0;
+	}
+
+	virtual const TCHAR* GetName() const override { return TEXT("RecvMmsg"); }
+
+	virtual void Wake() override
+	{
+		bWakeRequested = true;
+		const uint64 One = 1;
+		ssize_t Written;
+		do
+		{
+			Written = write(WakeFd, &One, sizeof(One));
+		} while (Written < 0 && errno == EINTR);
+		// EAGAIN means the counter is already saturated, so the wait is signalled anyway
+		if (Written < 0 && errno != EAGAIN)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: wake eventfd write failed (errno %d)"), errno);
+		}
+	}
+
+	virtual int32 Receive(const FTimespan& WaitTime, FRMG_MRMCPacketSink Sink) override
+	{
+		if (BusyPollMicroseconds > 0)
+		{
+			// spin on non-blocking reads instead of sleeping in epoll_wait()
+			const double Deadline = FPlatformTime::Seconds() + WaitTime.GetTotalSeconds();
+			do
+			{
+				int32 Received = 0;
+				for (int32 Stream = 0; Stream < SocketFds.Num(); Stream++)
+				{
+					Received += Drain(Stream, Sink);
+				}
+				if (Received > 0 || bWakeRequested.exchange(false))
+				{
+					return Received;
+				}
+			} while (FPlatformTime::Seconds() < Deadline);
+			return 0;
+		}
+
+		const int Ready = epoll_wait(EpollFd, ReadyEvents.GetData(), ReadyEvents.Num(), static_cast<int>(WaitTime.GetTotalMilliseconds()));
+		int32 Received = 0;
+		for (int Idx = 0; Idx < Ready; Idx++)
+		{
+			if (ReadyEvents[Idx].data.u32 == RMG_MRMC_WAKE_TOKEN)
+			{
+				// EAGAIN means another wakeup already consumed the count
+				uint64 Count;
+				if (read(WakeFd, &Count, sizeof(Count)) < 0 && errno != EAGAIN && errno != EINTR)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: wake eventfd read failed (errno %d)"), errno);
+				}
+				bWakeRequested = false;
+				continue;
+			}
+			Received += Drain(static_cast<int32>(ReadyEvents[Idx].data.u32), Sink);
+		}
+		return Received;
+	}
+
+private:
+
+	int32 Drain(int32 Stream, FRMG_MRMCPacketSink Sink)
+	{
+		const int SocketFd = SocketFds[Stream];
+		int32 Total = 0;
+
+		for (;;)
+		{
+			for (int32 Idx = 0; Idx < RMG_MRMC_RECVMMSG_BATCH; Idx++)
+			{
+				// the kernel overwrites these on every call
+				Messages[Idx].msg_hdr.msg_controllen = ControlSize;
+				Messages[Idx].msg_hdr.msg_flags = 0;
+			}
+
+			const int Count = recvmmsg(SocketFd, Messages, RMG_MRMC_RECVMMSG_BATCH, MSG_DONTWAIT, nullptr);
+			if (Count <= 0)
+			{
+				break;
+			}
+
+			// kernel stamps are CLOCK_REALTIME; carry their age over to the FPlatformTime::Seconds() clock
+			timespec NowRealtime;
+			clock_gettime(CLOCK_REALTIME, &NowRealtime);
+			const double NowSeconds = FPlatformTime::Seconds();
+
+			for (int Idx = 0; Idx < Count; Idx++)
+			{
+				double ReceiveSeconds = NowSeconds;
+
+				msghdr& Header = Messages[Idx].msg_hdr;
+				for (cmsghdr* Control = CMSG_FIRSTHDR(&Header); Control != nullptr; Control = CMSG_NXTHDR(&Header, Control))
+				{
+					if (Control->cmsg_level == SOL_SOCKET && Control->cmsg_type == SCM_TIMESTAMPNS)
+					{
+						timespec KernelTime;
+						FMemory::Memcpy(&KernelTime, CMSG_DATA(Control), sizeof(KernelTime));
+						const int64 AgeNanoseconds = (int64(NowRealtime.tv_sec) - int64(KernelTime.tv_sec)) * 1000000000LL
+							+ (int64(NowRealtime.tv_nsec) - int64(KernelTime.tv_nsec));
+						ReceiveSeconds = NowSeconds - double(FMath::Max<int64>(AgeNanoseconds, 0)) * 1e-9;
+					}
+				}
+
+				Sink(Stream, static_cast<const uint8*>(Vectors[Idx].iov_base), static_cast<int32>(Messages[Idx].msg_len), ReceiveSeconds);
+			}
+
+			Total += Count;
+			if (Count < RMG_MRMC_RECVMMSG_BATCH)
+			{
+				break;
+			}
+		}
+		return Total;
+	}
+
+	static constexpr int32 ControlSize = CMSG_SPACE(sizeof(timespec));
+
+	int EpollFd;
+	int WakeFd;
+	TArray<int> SocketFds;
+	TArray<epoll_event> ReadyEvents;
+	int32 BusyPollMicroseconds;
+
+	// Ends the busy-poll spin, which never looks at the eventfd
+	std::atomic<bool> bWakeRequested;
+
+	TArray<uint8> Buffers;
+	TArray<uint8> ControlBuffers;
+
+	mmsghdr Messages[RMG_MRMC_RECVMMSG_BATCH];
+	iovec Vectors[RMG_MRMC_RECVMMSG_BATCH];
+};
+
+TUniquePtr<FRMG_MRMCReceiveBackend> CreateLinuxReceiveBackend(const TArray<FIPv4Endpoint>& Endpoints, const FRMG_MRMCLiveLinkSourceSettings& Settings)
+{
+	return MakeUnique<FRMG_MRMCLinuxReceiveBackend>(Endpoints, Settings.BusyPollMicroseconds);
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,93 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCLiveLinkFrameSink.h"
+
+#include "ILiveLinkClient.h"
+#include "LiveLinkTypes.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "Roles/LiveLinkCameraRole.h"
+#include "Roles/LiveLinkCameraTypes.h"
+
+void FRMG_MRMCLiveLinkFrameSink::PushStaticData(FRMG_MRMCSubjectStaticData&& InStaticData)
+{
+	if (InStaticData.Role == ERMG_MRMCSubjectRole::Camera)
+	{
+		PushCameraStaticData(MoveTemp(InStaticData));
+		return;
+	}
+
+	FLiveLinkStaticDataStruct StaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct());
+	FLiveLinkSkeletonStaticData& StaticData = *StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>();
+	Client->RemoveSubject_AnyThread({ SourceGuid, InStaticData.SubjectName });
+
+	StaticData.BoneNames = MoveTemp(InStaticData.BoneNames);
+	StaticData.BoneParents = MoveTemp(InStaticData.BoneParents);
+	StaticData.PropertyNames = MoveTemp(InStaticData.PropertyNames);
+
+	Client->PushSubjectStaticData_AnyThread({ SourceGuid, InStaticData.SubjectName },
+		ULiveLinkAnimationRole::StaticClass(),
+		MoveTemp(StaticDataStruct));
+}
+
+void FRMG_MRMCLiveLinkFrameSink::PushFrame(FRMG_MRMCSubjectFrame&& Frame)
+{
+	if (Frame.Role == ERMG_MRMCSubjectRole::Camera)
+	{
+		PushCameraFrame(MoveTemp(Frame));
+		return;
+	}
+
+	FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
+	FLiveLinkAnimationFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkAnimationFrameData>();
+
+	FrameData.WorldTime = Frame.WorldSeconds;
+	FrameData.MetaData.SceneTime = Frame.SceneTime;
+	// the arrays were sized once for this frame; hand them over instead of copying
+	FrameData.Transforms = MoveTemp(Frame.Transforms);
+	FrameData.PropertyValues = MoveTemp(Frame.PropertyValues);
+
+	Client->PushSubjectFrameData_AnyThread({ SourceGuid, Frame.SubjectName }, MoveTemp(FrameDataStruct));
+}
+
+void FRMG_MRMCLiveLinkFrameSink::PushCameraStaticData(FRMG_MRMCSubjectStaticData&& InStaticData)
+{
+	FLiveLinkStaticDataStruct StaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkCameraStaticData::StaticStruct());
+	FLiveLinkCameraStaticData& StaticData = *StaticDataStruct.Cast<FLiveLinkCameraStaticData>();
+	Client->RemoveSubject_AnyThread({ SourceGuid, InStaticData.SubjectName });
+
+	StaticData.bIsScaleSupported = false;
+	StaticData.bIsFieldOfViewSupported = InStaticData.bHasFocalLength;
+	StaticData.bIsFocalLengthSupported = InStaticData.bHasFocalLength;
+	StaticData.bIsAspectRatioSupported = true;
+	StaticData.bIsFocusDistanceSupported = InStaticData.bHasFocusDistance;
+	StaticData.bIsApertureSupported = false;
+	StaticData.bIsProjectionModeSupported = false;
+	StaticData.FilmBackWidth = InStaticData.Filmback.X;
+	StaticData.FilmBackHeight = InStaticData.Filmback.Y;
+
+	Client->PushSubjectStaticData_AnyThread({ SourceGuid, InStaticData.SubjectName },
+		ULiveLinkCameraRole::StaticClass(),
+		MoveTemp(StaticDataStruct));
+}
+
+void FRMG_MRMCLiveLinkFrameSink::PushCameraFrame(FRMG_MRMCSubjectFrame&& Frame)
+{
+	FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkCameraFrameData::StaticStruct());
+	FLiveLinkCameraFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkCameraFrameData>();
+
+	FrameData.WorldTime = Frame.WorldSeconds;
+	FrameData.MetaData.SceneTime = Frame.SceneTime;
+	FrameData.Transform = Frame.CameraTransform;
+	FrameData.FieldOfView = Frame.FieldOfView;
+	FrameData.AspectRatio = Frame.AspectRatio;
+	FrameData.FocalLength = Frame.FocalLength;
+	FrameData.FocusDistance = Frame.FocusDistance;
+
+	Client->PushSubjectFrameData_AnyThread({ SourceGuid, Frame.SubjectName }, MoveTemp(FrameDataStruct));
+}
+
+void FRMG_MRMCLiveLinkFrameSink::RemoveSubject(FName SubjectName)
+{
+	Client->RemoveSubject_AnyThread({ SourceGuid, SubjectName });
+}
@@ -0,0 +1,36 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCFrameSink.h"
+
+class ILiveLinkClient;
+
+// Forwards assembled subjects to LiveLink as animation-role subjects of one source, or camera-role
+// subjects with CameraRole
+class FRMG_MRMCLiveLinkFrameSink : public IRMG_MRMCFrameSink
+{
+public:
+
+	FRMG_MRMCLiveLinkFrameSink(ILiveLinkClient* InClient, FGuid InSourceGuid)
+	: Client(InClient)
+	, SourceGuid(InSourceGuid)
+	{
+	}
+
+	// Replaces any existing subject of the same name
+	virtual void PushStaticData(FRMG_MRMCSubjectStaticData&& StaticData) override;
+
+	virtual void PushFrame(FRMG_MRMCSubjectFrame&& Frame) override;
+
+	virtual void RemoveSubject(FName SubjectName) override;
+
+private:
+
+	void PushCameraStaticData(FRMG_MRMCSubjectStaticData&& InStaticData);
+	void PushCameraFrame(FRMG_MRMCSubjectFrame&& Frame);
+
+	ILiveLinkClient* Client;
+	FGuid SourceGuid;
+};
@@ -1,450 +1,675 @@
-// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
-
-#include "RMG_MRMCLiveLinkSource.h"
-#include <cmath>
-
-#include "ILiveLinkClient.h"
-#include "LiveLinkTypes.h"
-#include "Roles/LiveLinkAnimationRole.h"
-#include "Roles/LiveLinkAnimationTypes.h"
-
-#include "Async/Async.h"
-#include "Common/UdpSocketBuilder.h"
-#include "HAL/RunnableThread.h"
-#include "Json.h"
-#include "Sockets.h"
-#include "SocketSubsystem.h"
-#include <chrono>
-#include "RenderCore.h"
-
-#define LOCTEXT_NAMESPACE "RMG_MRMCLiveLinkSource"
-
-#define RECV_BUFFER_SIZE 1024 * 1024
-
-const FString version = "Version 0.1.12";
-
-using namespace std::chrono;
-
-
-FRMG_MRMCLiveLinkSource::FRMG_MRMCLiveLinkSource(FIPv4Endpoint InEndpoint)
-: Socket(nullptr)
-, Stopping(false)
-, Thread(nullptr)
-, isRunning(false)
-, WaitTime(FTimespan::FromMilliseconds(100))
-{
-    UE_LOG(LogTemp, Warning, TEXT("%s"), *version);
-	// defaults
-	DeviceEndpoint = InEndpoint;
-    FIPv4Address::Parse("0.0.0.0", DeviceEndpoint.Address);
-    DeviceEndpoint.Port = 55535;
-
-	SourceStatus = LOCTEXT("SourceStatus_DeviceNotFound", "Device Not Found");
-	SourceType = LOCTEXT("RMG_MRMCLiveLinkSourceType", "RMG MRMC LiveLink");
-	SourceMachineName = LOCTEXT("RMG_MRMCLiveLinkSourceMachineName", "localhost");
-
-	//setup socket
-	if (DeviceEndpoint.Address.IsMulticastAddress())
-	{
-		Socket = FUdpSocketBuilder(TEXT("JSONSOCKET"))
-			.AsNonBlocking()
-			.AsReusable()
-			.BoundToPort(DeviceEndpoint.Port)
-			.WithReceiveBufferSize(RECV_BUFFER_SIZE)
-
-			.BoundToAddress(FIPv4Address::Any)
-			.JoinedToGroup(DeviceEndpoint.Address)
-			.WithMulticastLoopback()
-			.WithMulticastTtl(2);
-					
-	}
-	else
-	{
-		Socket = FUdpSocketBuilder(TEXT("JSONSOCKET"))
-			.AsNonBlocking()
-			.AsReusable()
-			.BoundToAddress(DeviceEndpoint.Address)
-			.BoundToPort(DeviceEndpoint.Port)
-			.WithReceiveBufferSize(RECV_BUFFER_SIZE);
-	}
-
-	RecvBuffer.SetNumUninitialized(RECV_BUFFER_SIZE);
-
-	if ((Socket != nullptr) && (Socket->GetSocketType() == SOCKTYPE_Datagram))
-	{
-		SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
-
-		Start();
-
-		SourceStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
-        isRunning = true;
-	}
-}
-
-FRMG_MRMCLiveLinkSource::~FRMG_MRMCLiveLinkSource()
-{
-	Stop();
-	if (Thread != nullptr)
-	{
-		Thread->WaitForCompletion();
-		delete Thread;
-		Thread = nullptr;
-	}
-	if (Socket != nullptr)
-	{
-		Socket->Close();
-		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
-        isRunning = false;
-	}
-}
-
-void FRMG_MRMCLiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
-{
-	Client = InClient;
-	SourceGuid = InSourceGuid;
-}
-
-
-bool FRMG_MRMCLiveLinkSource::IsSourceStillValid() const
-{
-	// Source is valid if we have a valid thread and socket
-	bool bIsSourceValid = !Stopping && Thread != nullptr && Socket != nullptr;
-	return bIsSourceValid;
-}
-
-
-bool FRMG_MRMCLiveLinkSource::RequestSourceShutdown()
-{
-	Stop();
-
-	return true;
-}
-// FRunnable interface
-
-void FRMG_MRMCLiveLinkSource::Start()
-{
-	ThreadName = "RMG_MRMC UDP Receiver ";
-	ThreadName.AppendInt(FAsyncThreadIndex::GetNext());
-	
-	Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask());
-}
-
-void FRMG_MRMCLiveLinkSource::Stop()
-{
-	Stopping = true;
-}
-
-uint32 FRMG_MRMCLiveLinkSource::Run()
-{
-	TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
-	
-	while (!Stopping)
-	{
-		if (Socket->Wait(ESocketWaitConditions::WaitForRead, WaitTime))
-		{
-			uint32 Size;
-
-			while (Socket->HasPendingData(Size))
-			{
-				int32 Read = 0;
-
-				if (Socket->RecvFrom(RecvBuffer.GetData(), RecvBuffer.Num(), Read, *Sender))
-				{
-					if (Read > 0)
-					{
-						TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> ReceivedData = MakeShareable(new TArray<uint8>());
-						ReceivedData->SetNumUninitialized(Read);
-						memcpy(ReceivedData->GetData(), RecvBuffer.GetData(), Read);
-						AsyncTask(ENamedThreads::GameThread, [this, ReceivedData]() { HandleReceivedData(ReceivedData); });
-					}
-				}
-			}
-		}
-	}
-	return 0;
-}
-void  FRMG_MRMCLiveLinkSource::SetupSubjects(const FString JsonString, TArray<Subject> &SubjectList)
-{
-
-    FString InputJson =
-R"({ "sources": [{ 
-         "subject": "robot_camera", 
-             "properties": ["Roll", "Focus", "Zoom"],
-             "propertyIndex": [6, 7, 8],
-             "bones" : [{ 
-                 "name": "top", 
-                 "parent" : ""  ,
-                 "index": [-1, -1, -1, -1, -1, -1]
-              }, 
-              { 
-                 "name": "CameraPose", 
-                 "parent" : "top",
-                 "index": [0, 1, 2, 3, 4, 5]
-              }] 
-         },
-         { 
-         "subject": "camera_target",
-            "properties": ["CameraTarget_xt", "CameraTarget_yt", "CameraTarget_zt"], 
-             "propertyIndex": [9, 10, 11],
-            "bones" : [{ 
-                 "name": "top", 
-                 "parent" : "" ,
-                 "index": [-1, -1, -1, -1, -1, -1]
-            }, 
-            { 
-                 "name": "CameraTarget", 
-                 "parent" : "top" ,
-                 "index": [ 9, 10, 11, -1, -1, -1]
-            }]
-         }] 
-})";
-
-
-
-   // UE_LOG(LogTemp, Warning, TEXT("%s"), *InputJson);
-    UE_LOG(LogTemp, Warning, TEXT("%s"), *InputJson);
-
-    TSharedPtr<FJsonObject> JsonObject;
-    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(InputJson);
-    if (FJsonSerializer::Deserialize(Reader, JsonObject))
-    {
-        auto SubjectArray = JsonObject->GetArrayField(TEXT("sources"));
-        for (auto Subj : SubjectArray) {
-            Subject NewSubject;
-            auto SubjectObject = Subj->AsObject();
-            FName SubjectName = *SubjectObject->GetStringField("subject");
-            NewSubject.SubjectName = SubjectName;
-
-            FLiveLinkStaticDataStruct StaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct());
-            FLiveLinkSkeletonStaticData& StaticData = *StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>();
-            Client->RemoveSubject_AnyThread({ SourceGuid, SubjectName });
-
-            auto BoneArray = SubjectObject->GetArrayField(TEXT("bones"));
-
-            StaticData.BoneNames.Reset(BoneArray.Num());
-            StaticData.BoneParents.Reset(BoneArray.Num());
-
-            FString sname;
-            int BoneIdx = 0;
-            for (auto BoneItem : BoneArray) {
-                Bone NewBone;
-                auto BoneObject = BoneItem->AsObject();
-
-                FString BoneName;
-                if (BoneObject->TryGetStringField(TEXT("name"), BoneName))
-                {
-                    NewBone.Name = BoneName;
-                    NewBone.Id = BoneIdx;
-                }
-
-                FString BoneParent;
-                if (BoneObject->TryGetStringField("parent", BoneParent))
-                {
-                    NewBone.ParentName = BoneParent;
-                    if (!BoneParent.IsEmpty()) {
-                        NewBone.IsRoot = false;
-                    }
-                }
-                auto IndexArray = BoneObject->GetArrayField(TEXT("index"));
-                for (int i = 0; i < 6; i++) {
-                    if (i < IndexArray.Num()) {
-                        NewBone.Index[i] = IndexArray[i]->AsNumber();
-                        //UE_LOG(LogTemp, Warning, TEXT("Index:%d"), NewBone.Index[i]);
-                    }
-                }
-                BoneIdx++;
-                NewSubject.Bones.Add(NewBone);
-
-                StaticData.BoneNames.Add(*NewBone.Name);
-                auto parent = NewBone.IsRoot ? INDEX_NONE : 0;
-                StaticData.BoneParents.Add(parent);
-            }
-            auto PropertyArray = SubjectObject->GetArrayField(TEXT("properties"));
-            auto PropertyIndexArray = SubjectObject->GetArrayField(TEXT("propertyIndex"));
-            int pcnt = 0;
-            for (auto Prop : PropertyArray) {
-                BoneProperty NewBoneProperty;
-                NewBoneProperty.Name = Prop->AsString();
-                UE_LOG(LogTemp, Warning, TEXT("Property:%s"), *NewBoneProperty.Name);
-                if (pcnt < PropertyIndexArray.Num()) {
-                    NewBoneProperty.Index = PropertyIndexArray[pcnt++]->AsNumber();
-                    //UE_LOG(LogTemp, Warning, TEXT("Index:%d"), NewBoneProperty.Index);
-                }
-                NewSubject.Properties.Add(NewBoneProperty);
-                StaticData.PropertyNames.Add(*NewBoneProperty.Name);
-            }
-            SubjectList.Add(NewSubject);
-
-            Client->PushSubjectStaticData_AnyThread({ SourceGuid, SubjectName },
-                ULiveLinkAnimationRole::StaticClass(),
-                MoveTemp(StaticDataStruct));
-
-        }
-    }
-}
-
-static bool SkipFrame(FQualifiedFrameTime &SceneTime)
-{
-    double CurrentSeconds = FPlatformTime::Seconds();
-    FFrameRate FrameRate = FApp::GetTimecodeFrameRate();
-    FTimecode TimeCode = FTimecode(CurrentSeconds, FrameRate, true);
-    SceneTime = FQualifiedFrameTime(TimeCode,FrameRate);
-
-    static double LastSeconds = 0.0;
-    //static high_resolution_clock::time_point Time1 = high_resolution_clock::now();
-
-    //UE_LOG(LogTemp, Warning, TEXT("source time: %f"), CurrentSeconds);
-    //UE_LOG(LogTemp, Warning, TEXT("Timecode: %s"), *TimeCode.ToString());
-
-    double SecondRate = 1.0 / static_cast<double>(FrameRate.Numerator);
-
-    high_resolution_clock::time_point Time2 = high_resolution_clock::now();
-
-    //duration<double> time_span = duration_cast<duration<double>>(Time2 - Time1);
-    //UE_LOG(LogTemp, Warning, TEXT("delta: %f, time span:%f"), CurrentSeconds - LastSeconds,time_span.count());
-    if (CurrentSeconds < LastSeconds + SecondRate)
-    {
-        //UE_LOG(LogTemp, Warning, TEXT("Skipping             %f"), CurrentSeconds);
-        return true;
-    } else 
-    {
-    //UE_LOG(LogTemp, Warning, TEXT("Frame rate 1.0/%d"), FrameRate.Numerator);
-        LastSeconds = CurrentSeconds;
-        //Time1 = Time2;
-    }
-    return false;
-}
-
-void FRMG_MRMCLiveLinkSource::SendFrameToLiveLink(const TArray<Subject> SubjectList, const TArray<float> FrameValueList)
-{
-
-    FQualifiedFrameTime SceneTime;
-    if (SkipFrame(SceneTime))
-    {
-        return;
-    }
-    for (auto Subj : SubjectList) {
-        FName SubjectName = Subj.SubjectName;
-        //UE_LOG(LogTemp, Warning, TEXT("SubjectList: %s"), *SubjectName.ToString());
-        FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
-        FLiveLinkAnimationFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkAnimationFrameData>();
-
-        FrameData.Transforms.Reserve(Subj.Bones.Num());  
-        FrameData.WorldTime = FPlatformTime::Seconds();
-        FrameData.MetaData.SceneTime = SceneTime;
-
-        for (auto Bone : Subj.Bones) {
-            //UE_LOG(LogTemp, Warning, TEXT("Name:%s"), *Bone.Name);
-            //UE_LOG(LogTemp, Warning, TEXT("Parent:%s id:%d"), *Bone.ParentName,Bone.Id);
-            FTransform Trans;
-            FVector Location(0.0f, 0.0f, 0.0f);
-            FVector Rotation(0.0f, 0.0f, 0.0f);
-            int ValueSize = FrameValueList.Num();
-            int Xdx = Bone.Index[0];
-            int Ydx = Bone.Index[1];
-            int Zdx = Bone.Index[2];
-            if (Xdx > -1 && Ydx > -1 && Zdx > -1 &&
-                Xdx < ValueSize && Ydx < ValueSize && Zdx < ValueSize) {
-                Location.Set(FrameValueList[Xdx], FrameValueList[Ydx], FrameValueList[Zdx]);
-                //UE_LOG(LogTemp, Warning, TEXT("Loc:%f %f %f"), Location.X,Location.Y,Location.Z);
-                //UE_LOG(LogTemp, Warning, TEXT("Rot:%f %f %f"), Rotation.X,Rotation.Y,Rotation.Z);
-                if (Bone.Name == "CameraPose") {
-                    //UE_LOG(LogTemp, Warning, TEXT("Name:%s"), *Bone.Name);
-                    double CurrentSeconds = FPlatformTime::Seconds();
-                    static double LastCurrentSeconds = 0.0;
-                    //UE_LOG(LogTemp, Warning, TEXT("%0.4f,%0.2f,%0.2f,%0.2f"), CurrentSeconds - LastCurrentSeconds, Location.X, Location.Y, Location.Z);
-                    LastCurrentSeconds = CurrentSeconds;
-                }
-            }
-            int rXdx = Bone.Index[3];
-            int rYdx = Bone.Index[4];
-            int rZdx = Bone.Index[5];
-            if (rXdx > -1 && rYdx > -1 && rZdx > -1 &&
-                rXdx < ValueSize && rYdx < ValueSize && rZdx < ValueSize) {
-                Rotation.Set(FrameValueList[rXdx], FrameValueList[rYdx], FrameValueList[rZdx]);
-            }
-            Trans.SetLocation(Location);
-            if (Rotation.Size() > 0) {
-                Trans.SetRotation(FQuat::MakeFromEuler(Rotation));
-                //UE_LOG(LogTemp, Warning, TEXT("Name:%s"), *Bone.Name);
-                //UE_LOG(LogTemp, Warning, TEXT("Rot:%f %f %f"), Rotation.X,Rotation.Y,Rotation.Z);
-            }
-            FrameData.Transforms.Add(Trans);
-        }
-        for (auto Prop : Subj.Properties) {
-            if (Prop.Index > -1 && Prop.Index < FrameValueList.Num()) {
-                float Value = FrameValueList[Prop.Index];
-                //UE_LOG(LogTemp, Warning, TEXT("Property:%s index:%d"), *Prop.Name, Prop.Index);
-                //UE_LOG(LogTemp, Warning, TEXT("Value %f"), value);
-                FrameData.PropertyValues.Add(Value);
-            }
-        }
-        Client->PushSubjectFrameData_AnyThread({ SourceGuid, SubjectName }, MoveTemp(FrameDataStruct));
-    }
-}
-
-void FRMG_MRMCLiveLinkSource::HandleReceivedData(TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> ReceivedData)
-{
-    if (Stopping) {
-        return; // thread is shutting down
-    }
-	FString JsonString;
-	RobotData Robot_Data;
-	JsonString.Empty(ReceivedData->Num());
-	for (uint8& Byte : *ReceivedData.Get())
-	{
-		JsonString += TCHAR(Byte);
-	}
-
-	if (ReceivedData->Num() > 35) {
-		memcpy(&Robot_Data, ReceivedData->GetData(), 36);
-	}
-
-    if (NeedSubjectSeup) {
-        SetupSubjects(FString(""), Subjects);
-        NeedSubjectSeup = false;
-    }
-    FrameValues.Empty(); // init the FrameValues
-    // first lets manually setup Subj Values
-	FVector CameraPose;
-	FVector CameraTarget;
-	const float METER2CENT = 100.0f;
-
-    // adjust Robot_data for different coord system
-    Robot_Data.yv = -Robot_Data.yv; // flip Y axis
-    Robot_Data.yt = -Robot_Data.yt; // flip Y axis
-
-
-    CameraPose = FVector(Robot_Data.xv * METER2CENT,
-                         Robot_Data.yv * METER2CENT,
-                         Robot_Data.zv * METER2CENT); // CameraPose
-    CameraTarget = FVector(Robot_Data.xt * METER2CENT,
-                           Robot_Data.yt * METER2CENT,
-                           Robot_Data.zt * METER2CENT);
-    FVector LookAt = CameraTarget - CameraPose;
-    float PanX = LookAt.X;
-    float PanY = LookAt.Y;
-    float Pan = FMath::RadiansToDegrees(atan2(PanY, PanX)); // atan2 returns radians // flip z rotation for pan
-    float TiltX = FVector(LookAt.X, LookAt.Y, 0.0).Size();
-    float TiltY = LookAt.Z;
-    float Tilt = FMath::RadiansToDegrees(atan2(TiltY, TiltX)); // atan2 returns radians
-    float Roll = -Robot_Data.roll;  //reverse roll for UE after test
-
-    FrameValues.Add(CameraPose.X);     // 0
-    FrameValues.Add(CameraPose.Y);     // 1
-    FrameValues.Add(CameraPose.Z);     // 2
-    // roll is xrot, tilt is yrot, pan is zrot
-    FrameValues.Add(FMath::RadiansToDegrees(Roll));             // 3
-    FrameValues.Add(Tilt);             // 4
-    FrameValues.Add(Pan);              // 5
-    FrameValues.Add(Robot_Data.roll);  // 6
-    //FrameValues.Add(Robot_Data.focus * METER2CENT); // 7
-    FrameValues.Add(LookAt.Size()); // 7  // use LookAt because Robot focus distance is wrong
-    FrameValues.Add(Robot_Data.zoom);  // 8
-    FrameValues.Add(CameraTarget.X);  // 9
-    FrameValues.Add(CameraTarget.Y);  // 10 
-    FrameValues.Add(CameraTarget.Z);  // 11 
-
-    SendFrameToLiveLink(Subjects, FrameValues);
-}
-#undef LOCTEXT_NAMESPACE
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCLiveLinkSource.h"
+#include "RMG_MRMCFaultInjector.h"
+#include "RMG_MRMCLensProfile.h"
+#include "RMG_MRMCLiveLinkFrameSink.h"
+#include "RMG_MRMCPacketDecoder.h"
+#include "RMG_MRMCPacketRing.h"
+#include "RMG_MRMCReceiveBackend.h"
+#include "RMG_MRMCRelay.h"
+#include "RMG_MRMCStream.h"
+#include "RMG_MRMCTakeRecorder.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "RenderCore.h"
+
+#if PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define LOCTEXT_NAMESPACE "RMG_MRMCLiveLinkSource"
+
+// Stream N > 0 publishes the mapping's subjects with an _N suffix
+static FRMG_MRMCCompiledMapping MakeStreamMapping(const FRMG_MRMCCompiledMapping& Mapping, int32 StreamIndex)
+{
+	FRMG_MRMCCompiledMapping StreamMapping = Mapping;
+	if (StreamIndex > 0)
+	{
+		for (FName& SubjectName : StreamMapping.SubjectNames)
+		{
+			SubjectName = *FString::Printf(TEXT("%s_%d"), *SubjectName.ToString(), StreamIndex);
+		}
+	}
+	return StreamMapping;
+}
+
+const FString version = "Version 0.1.12";
+
+// The receive thread blocks on its sockets and a wake event, so this only bounds how long an idle
+// thread sleeps; shutdown does not wait for it
+#define RMG_MRMC_IDLE_WAIT_SECONDS 60
+
+
+static FRMG_MRMCLiveLinkSourceSettings SettingsFromEndpoint(const FIPv4Endpoint& InEndpoint)
+{
+	FRMG_MRMCLiveLinkSourceSettings Result;
+	Result.Endpoint = InEndpoint;
+	return Result;
+}
+
+FRMG_MRMCLiveLinkSource::FRMG_MRMCLiveLinkSource(FIPv4Endpoint InEndpoint)
+: FRMG_MRMCLiveLinkSource(SettingsFromEndpoint(InEndpoint))
+{
+}
+
+FRMG_MRMCLiveLinkSource::FRMG_MRMCLiveLinkSource(const FRMG_MRMCLiveLinkSourceSettings& InSettings)
+: Client(nullptr)
+, Settings(InSettings)
+, Stopping(false)
+, Thread(nullptr)
+, WaitTime(FTimespan::FromSeconds(RMG_MRMC_IDLE_WAIT_SECONDS))
+, StopCycles(0)
+, WakeLatencySeconds(0.0)
+, isRunning(false)
+{
+    const double CreateStartSeconds = FPlatformTime::Seconds();
+    UE_LOG(LogTemp, Warning, TEXT("%s"), *version);
+	DeviceEndpoint = Settings.Endpoint;
+
+	SourceStatus = LOCTEXT("SourceStatus_DeviceNotFound", "Device Not Found");
+	SourceType = LOCTEXT("RMG_MRMCLiveLinkSourceType", "RMG MRMC LiveLink");
+	SourceMachineName = LOCTEXT("RMG_MRMCLiveLinkSourceMachineName", "localhost");
+
+	const TArray<FIPv4Endpoint> Endpoints = Settings.GetEndpoints();
+	PacketRing = MakeUnique<FRMG_MRMCPacketRing>(256 * Endpoints.Num());
+
+	// validate the mapping once, up front; static data is pushed as soon as LiveLink hands us a client
+	FRMG_MRMCCompiledMapping Mapping;
+	FString MappingError;
+	bMappingValid = FRMG_MRMCCompiledMapping::Load(Settings.MappingFile, Mapping, MappingError);
+	if (!bMappingValid)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: subject mapping rejected, %s"), *MappingError);
+		SourceStatus = LOCTEXT("SourceStatus_InvalidMapping", "Invalid Mapping");
+		return;
+	}
+	if (Settings.bReloadMapping && !Settings.MappingFile.IsEmpty())
+	{
+		MappingPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Settings.MappingFile);
+		MappingTimeStamp = IFileManager::Get().GetTimeStamp(*MappingPath);
+	}
+
+	// a bad lens file is reported but not fatal, Zoom and Focus then pass through unprofiled
+	FRMG_MRMCLensProfile LensProfile;
+	if (!Settings.LensFile.IsEmpty())
+	{
+		FString LensError;
+		if (FRMG_MRMCLensProfile::Load(Settings.LensFile, LensProfile, LensError))
+		{
+			UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: lens %s, %d table entries, largest error %.2g of value"),
+				*LensProfile.GetName(), LensProfile.GetLutSize(), LensProfile.GetLutError());
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: lens file rejected, %s"), *LensError);
+		}
+	}
+
+	// keep instrumentation only if it fits its budget on this machine
+	const double RecordOverheadNs = FRMG_MRMCStats::MeasureRecordOverheadNs();
+	bCollectStats = RecordOverheadNs * RMG_MRMC_STATS_RECORDS_PER_PACKET <= RMG_MRMC_STATS_BUDGET_NS;
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: stats cost %.0f ns per packet, budget %.0f ns%s"),
+		RecordOverheadNs * RMG_MRMC_STATS_RECORDS_PER_PACKET, RMG_MRMC_STATS_BUDGET_NS, bCollectStats ? TEXT("") : TEXT(", collection disabled"));
+	if (bCollectStats && !Settings.StatsFile.IsEmpty())
+	{
+		StatsFilename = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("RMG_MRMCLiveLink") / TEXT("Stats"), Settings.StatsFile);
+	}
+
+	FRMG_MRMCProcessingOptions Options;
+	Options.bInterpolate = Settings.bInterpolate;
+	Options.PredictionLeadMs = Settings.PredictionLeadMs;
+	Options.PredictionProcessNoise = Settings.PredictionProcessNoise;
+	Options.PredictionMeasurementNoise = Settings.PredictionMeasurementNoise;
+	Options.GapFillMs = Settings.GapFillMs;
+	Options.SampleRate = Settings.SampleRate;
+	Options.bCameraRole = Settings.bCameraRole;
+
+	for (int32 StreamIndex = 0; StreamIndex < Endpoints.Num(); StreamIndex++)
+	{
+		Streams.Add(MakeUnique<FRMG_MRMCStream>(Endpoints[StreamIndex], MakeStreamMapping(Mapping, StreamIndex), Options));
+		Streams.Last()->Processor.SetStats(bCollectStats ? &Stats : nullptr);
+		Streams.Last()->Processor.SetLensProfile(LensProfile);
+	}
+
+	FRMG_MRMCFaultOptions FaultOptions;
+	FaultOptions.Loss = Settings.FaultLoss;
+	FaultOptions.Reorder = Settings.FaultReorder;
+	FaultOptions.Duplicate = Settings.FaultDuplicate;
+	FaultOptions.Seed = Settings.FaultSeed;
+	if (FaultOptions.IsEnabled())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: injecting faults, loss %g reorder %g duplicate %g seed %d"),
+			FaultOptions.Loss, FaultOptions.Reorder, FaultOptions.Duplicate, FaultOptions.Seed);
+		FaultInjector = MakeUnique<FRMG_MRMCFaultInjector>(FaultOptions, Endpoints.Num());
+	}
+
+	if (Settings.ProcessingMode == ERMG_MRMCProcessingMode::Mailbox && Settings.bInterpolate)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: interpolation resamples every datagram, queueing them instead of ProcessingMode=Mailbox"));
+	}
+
+	if (Settings.GapFillMs > 0.0f && ProcessesOnReceiveThread())
+	{
+		// gaps are filled between receives, so the thread has to wake up at least once per robot frame
+		WaitTime = FTimespan::FromMilliseconds(5);
+	}
+
+	if (!Settings.RecordFile.IsEmpty())
+	{
+		const FString TakeFile = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("RMG_MRMCLiveLink") / TEXT("Takes"), Settings.RecordFile);
+		const uint64 Capacity = uint64(FMath::Max(Settings.RecordMinutes, 1)) * 60 * 50 * Endpoints.Num();
+		Recorder = FRMG_MRMCTakeRecorder::Open(TakeFile, Capacity, Endpoints.Num());
+	}
+
+	if (Settings.RelayEndpoints.Num() > 0)
+	{
+		Relay = FRMG_MRMCRelay::Create(Endpoints, Settings.RelayEndpoints, Settings.bRelayAddTimestamp, Settings.RelayTtl);
+		if (Relay.IsValid())
+		{
+			UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: relaying to %d target(s) with the %s relay%s"), Relay->GetNumTargets(), Relay->GetName(),
+				Settings.bRelayAddTimestamp ? TEXT(", with receive timestamps") : TEXT(""));
+		}
+	}
+
+	// one backend and one thread for every stream
+	ReceiveBackend = FRMG_MRMCReceiveBackend::Create(Endpoints, Settings);
+
+	if (ReceiveBackend->IsValid())
+	{
+		const bool bSharedMemory = FCString::Strcmp(ReceiveBackend->GetName(), TEXT("SharedMemory")) == 0;
+		UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: receiving %d stream(s) on %s with the %s backend"), Endpoints.Num(),
+			bSharedMemory ? *Settings.SharedMemoryName : *DeviceEndpoint.ToString(), ReceiveBackend->GetName());
+
+		Start();
+
+		SourceStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
+        isRunning = true;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: source created in %.2f ms"), (FPlatformTime::Seconds() - CreateStartSeconds) * 1000.0);
+}
+
+FRMG_MRMCLiveLinkSource::~FRMG_MRMCLiveLinkSource()
+{
+	const double DestroyStartSeconds = FPlatformTime::Seconds();
+	Stop();
+	const bool bHadThread = Thread != nullptr;
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	ReceiveBackend.Reset();
+	Recorder.Reset();
+	if (Relay.IsValid())
+	{
+		UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: relayed %llu datagrams to %d target(s), %llu sends failed"),
+			Relay->GetForwarded(), Relay->GetNumTargets(), Relay->GetFailed());
+		Relay.Reset();
+	}
+    isRunning = false;
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: source destroyed in %.2f ms%s"), (FPlatformTime::Seconds() - DestroyStartSeconds) * 1000.0,
+		bHadThread ? *FString::Printf(TEXT(", receive thread woke %.3f ms after stop"), WakeLatencySeconds * 1000.0) : TEXT(""));
+	if (!StatsFilename.IsEmpty())
+	{
+		WriteStats(StatsFilename);
+	}
+	if (UsesMailbox())
+	{
+		uint64 Superseded = 0;
+		for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+		{
+			Superseded += Stream->Mailbox.GetSupersededCount();
+		}
+		UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: %llu packets superseded in the mailbox before the game thread read them"), Superseded);
+	}
+	if (PacketRing->GetOverflowCount() > 0 || PacketRing->GetTruncatedCount() > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: %llu packets dropped on ring overflow, %llu truncated"),
+			PacketRing->GetOverflowCount(), PacketRing->GetTruncatedCount());
+	}
+	if (FaultInjector.IsValid())
+	{
+		UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: fault injection dropped %llu, reordered %llu, duplicated %llu"),
+			FaultInjector->GetDropped(), FaultInjector->GetReordered(), FaultInjector->GetDuplicated());
+	}
+	for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+	{
+		const FRMG_MRMCSequenceTracker& Sequence = Stream->Processor.GetSequence();
+		if (Sequence.GetLost() > 0 || Sequence.GetStale() > 0 || Sequence.GetDuplicates() > 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: %s %llu frames lost in %llu gaps (longest %u), %llu stale, %llu duplicate, %s"),
+				*Stream->Endpoint.ToString(), Sequence.GetLost(), Sequence.GetGaps(), Sequence.GetLongestGap(),
+				Sequence.GetStale(), Sequence.GetDuplicates(),
+				Sequence.HasFrameCounter() ? TEXT("by frame counter") : TEXT("by arrival time"));
+		}
+		const FRMG_MRMCFrameClock& FrameClock = Stream->Processor.GetFrameClock();
+		if (FrameClock.GetReanchorCount() > 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: %s scene time re-anchored %d times at %s samples, robot restarted or timecode re-jammed"),
+				*Stream->Endpoint.ToString(), FrameClock.GetReanchorCount(), *FrameClock.GetSampleRate().ToPrettyText().ToString());
+		}
+	}
+	for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+	{
+		const FRMG_MRMCPredictor* Predictor = Stream->Processor.GetPredictor();
+		if (Predictor == nullptr || Predictor->GetNumSamples() == 0)
+		{
+			continue;
+		}
+		UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: %s %.0f ms prediction error rms, camera %.3f %.3f %.3f cm, pan %.3f tilt %.3f roll %.3f deg, focus %.3f cm, zoom %.4f"),
+			*Stream->Endpoint.ToString(), Settings.PredictionLeadMs,
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::CameraPoseX),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::CameraPoseY),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::CameraPoseZ),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::Pan),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::Tilt),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::RollDegrees),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::Focus),
+			Predictor->GetLeadErrorRms(RMG_MRMCChannel::Zoom));
+	}
+}
+
+void FRMG_MRMCLiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
+{
+	SourceGuid = InSourceGuid;
+	FrameSink = MakeUnique<FRMG_MRMCLiveLinkFrameSink>(InClient, SourceGuid);
+	// static data goes out before Client is published, so the receive thread cannot push a frame ahead of it
+	SetupSubjects();
+	Client.store(InClient, std::memory_order_release);
+}
+
+
+void FRMG_MRMCLiveLinkSource::Update()
+{
+	if (!MappingPath.IsEmpty() && isRunning && !Stopping)
+	{
+		CheckMappingFile();
+	}
+
+	if (UsesMailbox())
+	{
+		DrainMailboxes();
+		FillGaps(FPlatformTime::Seconds());
+	}
+	else if (!ProcessesOnReceiveThread())
+	{
+		DrainReceivedPackets();
+		FillGaps(FPlatformTime::Seconds());
+	}
+
+	if (Settings.bInterpolate && HasClient() && !Stopping)
+	{
+		PushInterpolatedFrame(FApp::GetCurrentTime() - Settings.InterpolationDelayMs * 0.001);
+	}
+
+	if (bCollectStats && isRunning)
+	{
+		UpdateStats();
+	}
+}
+
+void FRMG_MRMCLiveLinkSource::UpdateStats()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastStatusSeconds < 1.0)
+	{
+		return;
+	}
+
+	const uint64 Packets = Stats.PacketsReceived.load(std::memory_order_relaxed);
+	const double PacketsPerSecond = LastStatusSeconds > 0.0 ? (Packets - LastStatusPackets) / (Now - LastStatusSeconds) : 0.0;
+	LastStatusSeconds = Now;
+	LastStatusPackets = Packets;
+	SourceStatus = FText::FromString(Stats.ToStatusString(PacketsPerSecond));
+
+	if (!StatsFilename.IsEmpty() && Now - LastStatsWriteSeconds >= 10.0)
+	{
+		LastStatsWriteSeconds = Now;
+		WriteStats(StatsFilename);
+	}
+}
+
+bool FRMG_MRMCLiveLinkSource::WriteStats(const FString& Filename) const
+{
+	if (!Stats.WriteCsv(Filename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: cannot write stats to %s"), *Filename);
+		return false;
+	}
+	return true;
+}
+
+bool FRMG_MRMCLiveLinkSource::ProcessesOnReceiveThread() const
+{
+	// resampling happens once per engine tick, so buffered samples must be consumed on the game thread
+	return Settings.ProcessingMode == ERMG_MRMCProcessingMode::ReceiveThread && !Settings.bInterpolate;
+}
+
+bool FRMG_MRMCLiveLinkSource::UsesMailbox() const
+{
+	// interpolation needs every sample in its history, so it keeps the queue
+	return Settings.ProcessingMode == ERMG_MRMCProcessingMode::Mailbox && !Settings.bInterpolate;
+}
+
+bool FRMG_MRMCLiveLinkSource::IsSourceStillValid() const
+{
+	// Source is valid if we have a valid thread and socket
+	bool bIsSourceValid = !Stopping && Thread != nullptr && ReceiveBackend.IsValid() && ReceiveBackend->IsValid();
+	return bIsSourceValid;
+}
+
+
+bool FRMG_MRMCLiveLinkSource::RequestSourceShutdown()
+{
+	Stop();
+
+	return true;
+}
+// FRunnable interface
+
+void FRMG_MRMCLiveLinkSource::Start()
+{
+	ThreadName = "RMG_MRMC UDP Receiver ";
+	ThreadName.AppendInt(FAsyncThreadIndex::GetNext());
+	
+	const uint64 AffinityMask = Settings.AffinityMask != 0 ? Settings.AffinityMask : FPlatformAffinity::GetPoolThreadMask();
+	Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, Settings.ThreadPriority, AffinityMask);
+
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: %s priority %s, cores %s"), *ThreadName,
+		FRMG_MRMCLiveLinkSourceSettings::GetThreadPriorityName(Settings.ThreadPriority),
+		Settings.AffinityMask != 0 ? *FRMG_MRMCLiveLinkSourceSettings::AffinityMaskToCoreList(Settings.AffinityMask) : TEXT("pool"));
+}
+
+bool FRMG_MRMCLiveLinkSource::Init()
+{
+#if PLATFORM_LINUX
+	if (Settings.RealtimePriority > 0)
+	{
+		// applied from the thread itself; FRunnableThread only knows nice levels
+		sched_param Param = {};
+		Param.sched_priority = FMath::Clamp(Settings.RealtimePriority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+		const int Error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &Param);
+		if (Error != 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: SCHED_FIFO %d refused (error %d), needs CAP_SYS_NICE or an rtprio limit"), Param.sched_priority, Error);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: receive thread running SCHED_FIFO %d"), Param.sched_priority);
+		}
+	}
+#else
+	if (Settings.RealtimePriority > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: RealtimePriority is Linux only, use ThreadPriority=TimeCritical"));
+	}
+#endif
+	return true;
+}
+
+void FRMG_MRMCLiveLinkSource::Stop()
+{
+	uint64 NotStopped = 0;
+	StopCycles.compare_exchange_strong(NotStopped, FPlatformTime::Cycles64());
+	Stopping = true;
+	if (ReceiveBackend.IsValid())
+	{
+		ReceiveBackend->Wake();
+	}
+}
+
+uint32 FRMG_MRMCLiveLinkSource::Run()
+{
+	auto Deliver = [this](int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds)
+	{
+		const double QueuedSeconds = FPlatformTime::Seconds();
+		if (bCollectStats)
+		{
+			Stats.PacketsReceived.fetch_add(1, std::memory_order_relaxed);
+			Stats.Stages[RMG_MRMCStage::Receive].RecordSeconds(QueuedSeconds - ReceiveSeconds);
+		}
+
+		if (Recorder.IsValid())
+		{
+			Recorder->Append(Stream, Data, Size, ReceiveSeconds);
+		}
+		if (UsesMailbox())
+		{
+			// latest wins, whatever the game thread has not read yet is overwritten
+			Streams[Stream]->Mailbox.Publish(Stream, Data, Size, ReceiveSeconds, QueuedSeconds);
+		}
+		else if (!PacketRing->Push(Stream, Data, Size, ReceiveSeconds, QueuedSeconds) && bCollectStats)
+		{
+			Stats.PacketsDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (ProcessesOnReceiveThread())
+		{
+			// decode and push without waiting for the game thread
+			DrainReceivedPackets();
+		}
+	};
+
+	auto OnPacket = [this, &Deliver](int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds)
+	{
+		// datagrams from another source's relay carry its receive time in front, the simulator's its send time
+		int64 RelayReceiveUnixNs = 0;
+		if (RMG_MRMCPacketDecoder::StripRelayHeader(Data, Size, RelayReceiveUnixNs))
+		{
+			if (bCollectStats)
+			{
+				const int64 TransitNs = FRMG_MRMCRelay::ToUnixNs(ReceiveSeconds) - RelayReceiveUnixNs;
+				Stats.Stages[RMG_MRMCStage::Transit].Record(TransitNs > 0 ? static_cast<uint64>(TransitNs) : 0);
+			}
+			if (Settings.bUseRelayTimestamp)
+			{
+				ReceiveSeconds = FRMG_MRMCRelay::FromUnixNs(RelayReceiveUnixNs);
+			}
+		}
+
+		// forward first, so render nodes wait for nothing but the network
+		if (Relay.IsValid())
+		{
+			FRMG_MRMCStageTimer RelayTimer(bCollectStats ? &Stats.Stages[RMG_MRMCStage::Relay] : nullptr);
+			const int32 TargetsFailed = Relay->Forward(Data, Size, ReceiveSeconds);
+			if (bCollectStats)
+			{
+				Stats.PacketsRelayed.fetch_add(1, std::memory_order_relaxed);
+				Stats.RelayFailures.fetch_add(TargetsFailed, std::memory_order_relaxed);
+			}
+		}
+
+		if (FaultInjector.IsValid())
+		{
+			FaultInjector->Process(Stream, Data, Size, ReceiveSeconds, Deliver);
+		}
+		else
+		{
+			Deliver(Stream, Data, Size, ReceiveSeconds);
+		}
+	};
+
+	while (!Stopping)
+	{
+		ReceiveBackend->Receive(WaitTime, OnPacket);
+
+		if (ProcessesOnReceiveThread())
+		{
+			ApplyPendingMapping();
+			FillGaps(FPlatformTime::Seconds());
+		}
+	}
+
+	WakeLatencySeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StopCycles.load());
+	return 0;
+}
+
+void FRMG_MRMCLiveLinkSource::DrainReceivedPackets()
+{
+	while (const FRMG_MRMCPacket* Packet = PacketRing->Peek())
+	{
+		if (bCollectStats)
+		{
+			Stats.Stages[RMG_MRMCStage::Handoff].RecordSeconds(FPlatformTime::Seconds() - Packet->QueuedSeconds);
+		}
+		HandleReceivedData(Packet->Stream, Packet->Data, Packet->GetPayloadSize(), Packet->ReceiveSeconds);
+		PacketRing->Pop();
+	}
+}
+
+void FRMG_MRMCLiveLinkSource::DrainMailboxes()
+{
+	FRMG_MRMCPacket Packet;
+	for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+	{
+		uint32 Superseded = 0;
+		if (!Stream->Mailbox.Read(Packet, Superseded))
+		{
+			continue;
+		}
+		if (bCollectStats)
+		{
+			Stats.Stages[RMG_MRMCStage::Handoff].RecordSeconds(FPlatformTime::Seconds() - Packet.QueuedSeconds);
+			Stats.PacketsSuperseded.fetch_add(Superseded, std::memory_order_relaxed);
+		}
+		Stream->Processor.AddSuperseded(Superseded);
+		HandleReceivedData(Packet.Stream, Packet.Data, Packet.GetPayloadSize(), Packet.ReceiveSeconds);
+	}
+}
+void FRMG_MRMCLiveLinkSource::CheckMappingFile()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastMappingCheckSeconds < 1.0)
+	{
+		return;
+	}
+	LastMappingCheckSeconds = Now;
+
+	// nothing to push static data to yet; the timestamp stays put, so an edit made before ReceiveClient() is
+	// picked up on the first check after it
+	if (!HasClient())
+	{
+		return;
+	}
+
+	// MinValue while an editor replaces the file; look again on the next check
+	const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*MappingPath);
+	if (TimeStamp == MappingTimeStamp || TimeStamp == FDateTime::MinValue())
+	{
+		return;
+	}
+	MappingTimeStamp = TimeStamp;
+
+	TUniquePtr<FRMG_MRMCCompiledMapping> Mapping = MakeUnique<FRMG_MRMCCompiledMapping>();
+	FString MappingError;
+	if (!FRMG_MRMCCompiledMapping::Load(Settings.MappingFile, *Mapping, MappingError))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: reloaded subject mapping rejected, keeping the previous one, %s"), *MappingError);
+		return;
+	}
+
+	if (ProcessesOnReceiveThread())
+	{
+		// the processors belong to the receive thread, which switches between two batches of packets
+		{
+			FScopeLock Lock(&PendingMappingLock);
+			PendingMapping = MoveTemp(Mapping);
+		}
+		bMappingPending.store(true, std::memory_order_release);
+		ReceiveBackend->Wake();
+	}
+	else
+	{
+		ApplyMapping(*Mapping);
+	}
+}
+
+void FRMG_MRMCLiveLinkSource::ApplyPendingMapping()
+{
+	if (!bMappingPending.load(std::memory_order_acquire))
+	{
+		return;
+	}
+	TUniquePtr<FRMG_MRMCCompiledMapping> Mapping;
+	{
+		FScopeLock Lock(&PendingMappingLock);
+		Mapping = MoveTemp(PendingMapping);
+		bMappingPending.store(false, std::memory_order_relaxed);
+	}
+	if (Mapping.IsValid())
+	{
+		ApplyMapping(*Mapping);
+	}
+}
+
+void FRMG_MRMCLiveLinkSource::ApplyMapping(const FRMG_MRMCCompiledMapping& Mapping)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	int32 NumPushed = 0;
+	for (int32 StreamIndex = 0; StreamIndex < Streams.Num(); StreamIndex++)
+	{
+		NumPushed += Streams[StreamIndex]->Processor.SetMapping(MakeStreamMapping(Mapping, StreamIndex), *FrameSink);
+	}
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: reloaded %s in %.2f ms, static data pushed again for %d of %d subjects"),
+		*Settings.MappingFile, (FPlatformTime::Seconds() - StartSeconds) * 1000.0, NumPushed, Mapping.NumSubjects() * Streams.Num());
+}
+
+void FRMG_MRMCLiveLinkSource::SetupSubjects()
+{
+    for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+    {
+        Stream->Processor.PushStaticData(*FrameSink);
+
+        const FRMG_MRMCCompiledMapping& Mapping = Stream->Processor.GetMapping();
+        UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: %s mapped %d subjects, %d bones, %d properties"),
+            *Stream->Endpoint.ToString(), Mapping.NumSubjects(), Mapping.BoneNames.Num(), Mapping.PropertyNames.Num());
+    }
+}
+
+void FRMG_MRMCLiveLinkSource::PushInterpolatedFrame(double EvaluationSeconds)
+{
+    FQualifiedFrameTime SceneTime;
+    TOptional<FQualifiedFrameTime> EngineFrameTime = FApp::GetCurrentFrameTime();
+    if (EngineFrameTime.IsSet())
+    {
+        SceneTime = EngineFrameTime.GetValue();
+    }
+    else
+    {
+        FFrameRate FrameRate = FApp::GetTimecodeFrameRate();
+        SceneTime = FQualifiedFrameTime(FTimecode(EvaluationSeconds, FrameRate, true), FrameRate);
+    }
+
+    for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+    {
+        Stream->Processor.PushInterpolatedFrame(EvaluationSeconds, SceneTime, *FrameSink);
+    }
+}
+
+void FRMG_MRMCLiveLinkSource::FillGaps(double NowSeconds)
+{
+    if (Settings.GapFillMs <= 0.0f || Settings.bInterpolate || Stopping || !HasClient()) {
+        return;
+    }
+    for (const TUniquePtr<FRMG_MRMCStream>& Stream : Streams)
+    {
+        Stream->Processor.FillGap(NowSeconds, *FrameSink);
+    }
+}
+
+void FRMG_MRMCLiveLinkSource::HandleReceivedData(int32 StreamIndex, const uint8* Data, int32 Size, double ReceiveSeconds)
+{
+    if (Stopping || !HasClient()) {
+        return; // thread is shutting down or LiveLink has not handed us a client yet
+    }
+    Streams[StreamIndex]->Processor.ProcessPacket(Data, Size, ReceiveSeconds, *FrameSink);
+}
+#undef LOCTEXT_NAMESPACE
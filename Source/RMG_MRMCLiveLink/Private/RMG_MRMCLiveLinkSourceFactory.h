@@ -1,28 +1,29 @@
-// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "LiveLinkSourceFactory.h"
-#include "Interfaces/IPv4/IPv4Endpoint.h"
-#include "RMG_MRMCLiveLinkSourceFactory.generated.h"
-
-class SRMG_MRMCLiveLinkSourceEditor;
-
-UCLASS()
-class URMG_MRMCLiveLinkSourceFactory : public ULiveLinkSourceFactory
-{
-public:
-
-	GENERATED_BODY()
-
-	virtual FText GetSourceDisplayName() const override;
-	virtual FText GetSourceTooltip() const override;
-
-	virtual EMenuType GetMenuType() const override { return EMenuType::SubPanel; }
-    //virtual EMenuType GetMenuType() const { return EMenuType::SubPanel; }
-	virtual TSharedPtr<SWidget> BuildCreationPanel(FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const override;
-	TSharedPtr<ILiveLinkSource> CreateSource(const FString& ConnectionString) const override;
-private:
-	void OnOkClicked(FIPv4Endpoint Endpoint, FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const;
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkSourceFactory.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "RMG_MRMCLiveLinkSourceSettings.h"
+#include "RMG_MRMCLiveLinkSourceFactory.generated.h"
+
+class SRMG_MRMCLiveLinkSourceEditor;
+
+UCLASS()
+class URMG_MRMCLiveLinkSourceFactory : public ULiveLinkSourceFactory
+{
+public:
+
+	GENERATED_BODY()
+
+	virtual FText GetSourceDisplayName() const override;
+	virtual FText GetSourceTooltip() const override;
+
+	virtual EMenuType GetMenuType() const override { return EMenuType::SubPanel; }
+    //virtual EMenuType GetMenuType() const { return EMenuType::SubPanel; }
+	virtual TSharedPtr<SWidget> BuildCreationPanel(FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const override;
+	TSharedPtr<ILiveLinkSource> CreateSource(const FString& ConnectionString) const override;
+private:
+	void OnOkClicked(FRMG_MRMCLiveLinkSourceSettings Settings, FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const;
 };
\ No newline at end of file
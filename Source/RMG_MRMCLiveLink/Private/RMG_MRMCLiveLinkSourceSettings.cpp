@@ -0,0 +1,369 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCLiveLinkSourceSettings.h"
+#include "Misc/Parse.h"
+
+static const TCHAR* DefaultSharedMemoryName = TEXT("RMG_MRMC");
+
+FRMG_MRMCLiveLinkSourceSettings::FRMG_MRMCLiveLinkSourceSettings()
+{
+	FIPv4Address::Parse("0.0.0.0", Endpoint.Address);
+	Endpoint.Port = 55535;
+	SharedMemoryName = DefaultSharedMemoryName;
+}
+
+static const EThreadPriority ThreadPriorities[] = { TPri_Lowest, TPri_BelowNormal, TPri_SlightlyBelowNormal, TPri_Normal, TPri_AboveNormal, TPri_Highest, TPri_TimeCritical };
+static const TCHAR* ThreadPriorityNames[] = { TEXT("Lowest"), TEXT("BelowNormal"), TEXT("SlightlyBelowNormal"), TEXT("Normal"), TEXT("AboveNormal"), TEXT("Highest"), TEXT("TimeCritical") };
+
+const TCHAR* FRMG_MRMCLiveLinkSourceSettings::GetThreadPriorityName(EThreadPriority Priority)
+{
+	for (int32 Idx = 0; Idx < UE_ARRAY_COUNT(ThreadPriorities); Idx++)
+	{
+		if (ThreadPriorities[Idx] == Priority)
+		{
+			return ThreadPriorityNames[Idx];
+		}
+	}
+	return TEXT("AboveNormal");
+}
+
+bool FRMG_MRMCLiveLinkSourceSettings::ParseThreadPriority(const FString& Name, EThreadPriority& OutPriority)
+{
+	for (int32 Idx = 0; Idx < UE_ARRAY_COUNT(ThreadPriorities); Idx++)
+	{
+		if (Name.Equals(ThreadPriorityNames[Idx], ESearchCase::IgnoreCase))
+		{
+			OutPriority = ThreadPriorities[Idx];
+			return true;
+		}
+	}
+	return false;
+}
+
+FString FRMG_MRMCLiveLinkSourceSettings::AffinityMaskToCoreList(uint64 Mask)
+{
+	TArray<FString> Cores;
+	for (int32 Core = 0; Core < 64; Core++)
+	{
+		if (Mask & (uint64(1) << Core))
+		{
+			Cores.Add(FString::FromInt(Core));
+		}
+	}
+	return FString::Join(Cores, TEXT(","));
+}
+
+bool FRMG_MRMCLiveLinkSourceSettings::ParseCoreList(const FString& CoreList, uint64& OutMask)
+{
+	TArray<FString> Cores;
+	CoreList.ParseIntoArray(Cores, TEXT(","));
+
+	uint64 Mask = 0;
+	for (const FString& Core : Cores)
+	{
+		const FString Trimmed = Core.TrimStartAndEnd();
+		if (!Trimmed.IsNumeric() || FCString::Atoi(*Trimmed) < 0 || FCString::Atoi(*Trimmed) > 63)
+		{
+			return false;
+		}
+		Mask |= uint64(1) << FCString::Atoi(*Trimmed);
+	}
+	OutMask = Mask;
+	return true;
+}
+
+FString FRMG_MRMCLiveLinkSourceSettings::FrameRateToString(const FFrameRate& Rate)
+{
+	return Rate.Denominator == 1 ? FString::FromInt(Rate.Numerator) : FString::Printf(TEXT("%d/%d"), Rate.Numerator, Rate.Denominator);
+}
+
+bool FRMG_MRMCLiveLinkSourceSettings::ParseFrameRate(const FString& Text, FFrameRate& OutRate)
+{
+	FString Numerator = Text.TrimStartAndEnd();
+	FString Denominator = TEXT("1");
+	Text.TrimStartAndEnd().Split(TEXT("/"), &Numerator, &Denominator);
+	Numerator.TrimStartAndEndInline();
+	Denominator.TrimStartAndEndInline();
+
+	if (!Numerator.IsNumeric() || !Denominator.IsNumeric() || FCString::Atoi(*Numerator) <= 0 || FCString::Atoi(*Denominator) <= 0)
+	{
+		return false;
+	}
+	OutRate = FFrameRate(FCString::Atoi(*Numerator), FCString::Atoi(*Denominator));
+	return true;
+}
+
+TArray<FIPv4Endpoint> FRMG_MRMCLiveLinkSourceSettings::GetEndpoints() const
+{
+	TArray<FIPv4Endpoint> Result;
+	Result.Add(Endpoint);
+	Result.Append(AdditionalEndpoints);
+	return Result;
+}
+
+// "<addr>:<port>,..." lists used by Streams and Relay
+static bool ParseEndpointList(const FString& List, TArray<FIPv4Endpoint>& OutEndpoints)
+{
+	TArray<FString> Items;
+	List.ParseIntoArray(Items, TEXT(","));
+	for (const FString& Item : Items)
+	{
+		FIPv4Endpoint Parsed;
+		if (!FIPv4Endpoint::Parse(Item.TrimStartAndEnd(), Parsed))
+		{
+			return false;
+		}
+		OutEndpoints.Add(Parsed);
+	}
+	return true;
+}
+
+static FString EndpointListToString(const TArray<FIPv4Endpoint>& Endpoints)
+{
+	TArray<FString> Items;
+	for (const FIPv4Endpoint& Item : Endpoints)
+	{
+		Items.Add(Item.ToString());
+	}
+	return FString::Join(Items, TEXT(","));
+}
+
+bool FRMG_MRMCLiveLinkSourceSettings::Parse(const FString& ConnectionString, FRMG_MRMCLiveLinkSourceSettings& OutSettings)
+{
+	const FString Trimmed = ConnectionString.TrimStartAndEnd();
+	FString EndpointString;
+	FString Options;
+	if (!Trimmed.Split(TEXT(" "), &EndpointString, &Options))
+	{
+		EndpointString = Trimmed;
+	}
+
+	if (!FIPv4Endpoint::Parse(EndpointString, OutSettings.Endpoint))
+	{
+		return false;
+	}
+
+	FString Streams;
+	if (FParse::Value(*Options, TEXT("Streams="), Streams) && !ParseEndpointList(Streams, OutSettings.AdditionalEndpoints))
+	{
+		return false;
+	}
+
+	FString Relay;
+	if (FParse::Value(*Options, TEXT("Relay="), Relay) && !ParseEndpointList(Relay, OutSettings.RelayEndpoints))
+	{
+		return false;
+	}
+	FParse::Bool(*Options, TEXT("RelayAddTimestamp="), OutSettings.bRelayAddTimestamp);
+	FParse::Value(*Options, TEXT("RelayTtl="), OutSettings.RelayTtl);
+	FParse::Bool(*Options, TEXT("UseRelayTimestamp="), OutSettings.bUseRelayTimestamp);
+
+	FParse::Value(*Options, TEXT("MappingFile="), OutSettings.MappingFile);
+	FParse::Bool(*Options, TEXT("ReloadMapping="), OutSettings.bReloadMapping);
+	FParse::Bool(*Options, TEXT("CameraRole="), OutSettings.bCameraRole);
+	FParse::Value(*Options, TEXT("LensFile="), OutSettings.LensFile);
+
+	FString Mode;
+	if (FParse::Value(*Options, TEXT("ProcessingMode="), Mode))
+	{
+		if (Mode.Equals(TEXT("ReceiveThread"), ESearchCase::IgnoreCase))
+		{
+			OutSettings.ProcessingMode = ERMG_MRMCProcessingMode::ReceiveThread;
+		}
+		else if (Mode.Equals(TEXT("Mailbox"), ESearchCase::IgnoreCase))
+		{
+			OutSettings.ProcessingMode = ERMG_MRMCProcessingMode::Mailbox;
+		}
+		else
+		{
+			OutSettings.ProcessingMode = ERMG_MRMCProcessingMode::GameThread;
+		}
+	}
+
+	FString BackendName;
+	if (FParse::Value(*Options, TEXT("Backend="), BackendName))
+	{
+		if (BackendName.Equals(TEXT("Socket"), ESearchCase::IgnoreCase))
+		{
+			OutSettings.Backend = ERMG_MRMCReceiveBackend::Socket;
+		}
+		else if (BackendName.Equals(TEXT("RecvMmsg"), ESearchCase::IgnoreCase))
+		{
+			OutSettings.Backend = ERMG_MRMCReceiveBackend::RecvMmsg;
+		}
+		else if (BackendName.Equals(TEXT("SharedMemory"), ESearchCase::IgnoreCase))
+		{
+			OutSettings.Backend = ERMG_MRMCReceiveBackend::SharedMemory;
+		}
+		else
+		{
+			OutSettings.Backend = ERMG_MRMCReceiveBackend::Auto;
+		}
+	}
+
+	FParse::Value(*Options, TEXT("SharedMemoryName="), OutSettings.SharedMemoryName);
+	FParse::Value(*Options, TEXT("BusyPollUs="), OutSettings.BusyPollMicroseconds);
+
+	FString Priority;
+	if (FParse::Value(*Options, TEXT("ThreadPriority="), Priority) && !ParseThreadPriority(Priority, OutSettings.ThreadPriority))
+	{
+		return false;
+	}
+
+	FString Cores;
+	if (FParse::Value(*Options, TEXT("Cores="), Cores) && !ParseCoreList(Cores, OutSettings.AffinityMask))
+	{
+		return false;
+	}
+
+	FString SampleRate;
+	if (FParse::Value(*Options, TEXT("SampleRate="), SampleRate) && !ParseFrameRate(SampleRate, OutSettings.SampleRate))
+	{
+		return false;
+	}
+
+	FParse::Value(*Options, TEXT("RealtimePriority="), OutSettings.RealtimePriority);
+	FParse::Bool(*Options, TEXT("Interpolate="), OutSettings.bInterpolate);
+	FParse::Value(*Options, TEXT("InterpolationDelayMs="), OutSettings.InterpolationDelayMs);
+	FParse::Value(*Options, TEXT("RecordFile="), OutSettings.RecordFile);
+	FParse::Value(*Options, TEXT("RecordMinutes="), OutSettings.RecordMinutes);
+	FParse::Value(*Options, TEXT("PredictionLeadMs="), OutSettings.PredictionLeadMs);
+	FParse::Value(*Options, TEXT("PredictionProcessNoise="), OutSettings.PredictionProcessNoise);
+	FParse::Value(*Options, TEXT("PredictionMeasurementNoise="), OutSettings.PredictionMeasurementNoise);
+	FParse::Value(*Options, TEXT("StatsFile="), OutSettings.StatsFile);
+	FParse::Value(*Options, TEXT("GapFillMs="), OutSettings.GapFillMs);
+	FParse::Value(*Options, TEXT("FaultLoss="), OutSettings.FaultLoss);
+	FParse::Value(*Options, TEXT("FaultReorder="), OutSettings.FaultReorder);
+	FParse::Value(*Options, TEXT("FaultDuplicate="), OutSettings.FaultDuplicate);
+	FParse::Value(*Options, TEXT("FaultSeed="), OutSettings.FaultSeed);
+
+	return true;
+}
+
+FString FRMG_MRMCLiveLinkSourceSettings::ToConnectionString() const
+{
+	FString Result = Endpoint.ToString();
+
+	if (AdditionalEndpoints.Num() > 0)
+	{
+		Result += FString::Printf(TEXT(" Streams=\"%s\""), *EndpointListToString(AdditionalEndpoints));
+	}
+
+	if (RelayEndpoints.Num() > 0)
+	{
+		Result += FString::Printf(TEXT(" Relay=\"%s\" RelayTtl=%d"), *EndpointListToString(RelayEndpoints), RelayTtl);
+		if (bRelayAddTimestamp)
+		{
+			Result += TEXT(" RelayAddTimestamp=true");
+		}
+	}
+
+	if (bUseRelayTimestamp)
+	{
+		Result += TEXT(" UseRelayTimestamp=true");
+	}
+
+	if (!MappingFile.IsEmpty())
+	{
+		Result += FString::Printf(TEXT(" MappingFile=\"%s\""), *MappingFile);
+		if (!bReloadMapping)
+		{
+			Result += TEXT(" ReloadMapping=false");
+		}
+	}
+
+	if (!LensFile.IsEmpty())
+	{
+		Result += FString::Printf(TEXT(" LensFile=\"%s\""), *LensFile);
+	}
+
+	if (bCameraRole)
+	{
+		Result += TEXT(" CameraRole=true");
+	}
+
+	if (ProcessingMode == ERMG_MRMCProcessingMode::ReceiveThread)
+	{
+		Result += TEXT(" ProcessingMode=ReceiveThread");
+	}
+	else if (ProcessingMode == ERMG_MRMCProcessingMode::Mailbox)
+	{
+		Result += TEXT(" ProcessingMode=Mailbox");
+	}
+
+	if (Backend == ERMG_MRMCReceiveBackend::Socket)
+	{
+		Result += TEXT(" Backend=Socket");
+	}
+	else if (Backend == ERMG_MRMCReceiveBackend::RecvMmsg)
+	{
+		Result += TEXT(" Backend=RecvMmsg");
+	}
+	else if (Backend == ERMG_MRMCReceiveBackend::SharedMemory)
+	{
+		Result += TEXT(" Backend=SharedMemory");
+	}
+
+	if (SharedMemoryName != DefaultSharedMemoryName)
+	{
+		Result += FString::Printf(TEXT(" SharedMemoryName=\"%s\""), *SharedMemoryName);
+	}
+
+	if (BusyPollMicroseconds > 0)
+	{
+		Result += FString::Printf(TEXT(" BusyPollUs=%d"), BusyPollMicroseconds);
+	}
+
+	if (ThreadPriority != TPri_AboveNormal)
+	{
+		Result += FString::Printf(TEXT(" ThreadPriority=%s"), GetThreadPriorityName(ThreadPriority));
+	}
+
+	if (AffinityMask != 0)
+	{
+		Result += FString::Printf(TEXT(" Cores=\"%s\""), *AffinityMaskToCoreList(AffinityMask));
+	}
+
+	if (RealtimePriority > 0)
+	{
+		Result += FString::Printf(TEXT(" RealtimePriority=%d"), RealtimePriority);
+	}
+
+	if (bInterpolate)
+	{
+		Result += FString::Printf(TEXT(" Interpolate=true InterpolationDelayMs=%g"), InterpolationDelayMs);
+	}
+
+	if (!RecordFile.IsEmpty())
+	{
+		Result += FString::Printf(TEXT(" RecordFile=\"%s\" RecordMinutes=%d"), *RecordFile, RecordMinutes);
+	}
+
+	if (PredictionLeadMs > 0.0f)
+	{
+		Result += FString::Printf(TEXT(" PredictionLeadMs=%g PredictionProcessNoise=%g PredictionMeasurementNoise=%g"),
+			PredictionLeadMs, PredictionProcessNoise, PredictionMeasurementNoise);
+	}
+
+	if (!StatsFile.IsEmpty())
+	{
+		Result += FString::Printf(TEXT(" StatsFile=\"%s\""), *StatsFile);
+	}
+
+	if (GapFillMs > 0.0f)
+	{
+		Result += FString::Printf(TEXT(" GapFillMs=%g"), GapFillMs);
+	}
+
+	if (SampleRate != FFrameRate(50, 1))
+	{
+		Result += FString::Printf(TEXT(" SampleRate=\"%s\""), *FrameRateToString(SampleRate));
+	}
+
+	if (FaultLoss > 0.0f || FaultReorder > 0.0f || FaultDuplicate > 0.0f)
+	{
+		Result += FString::Printf(TEXT(" FaultLoss=%g FaultReorder=%g FaultDuplicate=%g FaultSeed=%d"), FaultLoss, FaultReorder, FaultDuplicate, FaultSeed);
+	}
+
+	return Result;
+}
@@ -0,0 +1,89 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCPacketRing.h"
+#include <atomic>
+
+// Single-slot latest-wins handoff of one stream's datagrams, see ProcessingMode=Mailbox.
+// Publish() overwrites whatever the consumer has not read yet, so however long the consumer stalls it
+// only ever processes the newest datagram, never a backlog. The slot is a seqlock: Sequence is odd
+// while the producer writes and the consumer retries a copy that overlapped a write.
+// Publish() may only be called from one thread and Read() from one other thread.
+class FRMG_MRMCPacketMailbox
+{
+public:
+
+	FRMG_MRMCPacketMailbox()
+	: Sequence(0)
+	, LastReadSequence(0)
+	, Superseded(0)
+	{
+	}
+
+	// Producer side. Never waits and never fails.
+	void Publish(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds, double QueuedSeconds)
+	{
+		const uint32 Current = Sequence.load(std::memory_order_relaxed);
+		Sequence.store(Current + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Slot.ReceiveSeconds = ReceiveSeconds;
+		Slot.QueuedSeconds = QueuedSeconds;
+		Slot.Stream = Stream;
+		Slot.Size = Size;
+		FMemory::Memcpy(Slot.Data, Data, Slot.GetPayloadSize());
+
+		Sequence.store(Current + 2, std::memory_order_release);
+	}
+
+	// Consumer side. Copies the newest datagram into OutPacket; returns false when nothing was published
+	// since the last read. OutSuperseded is the number of datagrams overwritten before they were read.
+	bool Read(FRMG_MRMCPacket& OutPacket, uint32& OutSuperseded)
+	{
+		for (;;)
+		{
+			const uint32 Before = Sequence.load(std::memory_order_acquire);
+			if (Before == LastReadSequence)
+			{
+				return false;
+			}
+			if (Before & 1)
+			{
+				FPlatformProcess::Yield();
+				continue;
+			}
+
+			OutPacket.ReceiveSeconds = Slot.ReceiveSeconds;
+			OutPacket.QueuedSeconds = Slot.QueuedSeconds;
+			OutPacket.Stream = Slot.Stream;
+			OutPacket.Size = Slot.Size;
+			FMemory::Memcpy(OutPacket.Data, Slot.Data, FMath::Min(Slot.Size, RMG_MRMC_PACKET_SLOT_SIZE));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (Sequence.load(std::memory_order_relaxed) != Before)
+			{
+				continue;
+			}
+
+			OutSuperseded = (Before - LastReadSequence) / 2 - 1;
+			Superseded += OutSuperseded;
+			LastReadSequence = Before;
+			return true;
+		}
+	}
+
+	// Datagrams overwritten before the consumer read them, since creation
+	uint64 GetSupersededCount() const { return Superseded; }
+
+private:
+
+	// Only written by the producer
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Sequence;
+	FRMG_MRMCPacket Slot;
+
+	// Only touched by the consumer
+	alignas(PLATFORM_CACHE_LINE_SIZE) uint32 LastReadSequence;
+	uint64 Superseded;
+};
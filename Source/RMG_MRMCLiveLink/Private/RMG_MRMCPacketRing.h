@@ -0,0 +1,109 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Payload bytes kept per slot. The Flair RobotData datagram is 36 bytes; the slack leaves room for protocol variants.
+#define RMG_MRMC_PACKET_SLOT_SIZE 64
+
+struct FRMG_MRMCPacket
+{
+	// FPlatformTime::Seconds() when the datagram was received
+	double ReceiveSeconds = 0.0;
+
+	// FPlatformTime::Seconds() when the receive thread queued it, for handoff timing
+	double QueuedSeconds = 0.0;
+
+	// Index of the robot stream the datagram arrived on
+	int32 Stream = 0;
+
+	// Size of the datagram on the wire; only the first RMG_MRMC_PACKET_SLOT_SIZE bytes are kept
+	int32 Size = 0;
+
+	uint8 Data[RMG_MRMC_PACKET_SLOT_SIZE];
+
+	int32 GetPayloadSize() const { return FMath::Min(Size, RMG_MRMC_PACKET_SLOT_SIZE); }
+};
+
+// Fixed-capacity single-producer/single-consumer queue of packet slots.
+// All storage is allocated up front, so pushing and popping never touch the heap.
+// Push() may only be called from one thread and Peek()/Pop() from one other thread.
+class FRMG_MRMCPacketRing
+{
+public:
+
+	// Capacity is rounded up to a power of two
+	explicit FRMG_MRMCPacketRing(uint32 InCapacity = 256)
+	: Head(0)
+	, Tail(0)
+	, Overflows(0)
+	, Truncations(0)
+	{
+		Slots.SetNum(FMath::RoundUpToPowerOfTwo(FMath::Max<uint32>(InCapacity, 2)));
+		Mask = Slots.Num() - 1;
+	}
+
+	// Producer side. Copies the datagram into the next free slot; returns false and counts an overflow when full.
+	bool Push(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds, double QueuedSeconds)
+	{
+		const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+		if (CurrentHead - Tail.load(std::memory_order_acquire) > Mask)
+		{
+			Overflows.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		FRMG_MRMCPacket& Slot = Slots[CurrentHead & Mask];
+		Slot.ReceiveSeconds = ReceiveSeconds;
+		Slot.QueuedSeconds = QueuedSeconds;
+		Slot.Stream = Stream;
+		Slot.Size = Size;
+		if (Size > RMG_MRMC_PACKET_SLOT_SIZE)
+		{
+			Truncations.fetch_add(1, std::memory_order_relaxed);
+		}
+		FMemory::Memcpy(Slot.Data, Data, Slot.GetPayloadSize());
+
+		Head.store(CurrentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns the oldest queued packet, or nullptr when empty. The slot stays valid until Pop().
+	const FRMG_MRMCPacket* Peek() const
+	{
+		const uint32 CurrentTail = Tail.load(std::memory_order_relaxed);
+		if (CurrentTail == Head.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+		return &Slots[CurrentTail & Mask];
+	}
+
+	void Pop()
+	{
+		Tail.store(Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	uint32 Num() const { return Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire); }
+	uint32 GetCapacity() const { return Mask + 1; }
+
+	// Datagrams dropped because the consumer fell a full ring behind
+	uint64 GetOverflowCount() const { return Overflows.load(std::memory_order_relaxed); }
+
+	// Datagrams larger than a slot, kept truncated
+	uint64 GetTruncatedCount() const { return Truncations.load(std::memory_order_relaxed); }
+
+private:
+
+	TArray<FRMG_MRMCPacket> Slots;
+	uint32 Mask;
+
+	// Head is only written by the producer and Tail only by the consumer; keep them on separate cache lines
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail;
+
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Overflows;
+	std::atomic<uint64> Truncations;
+};
@@ -0,0 +1,216 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCReceiveBackend.h"
+
+#include "Common/UdpSocketBuilder.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+#define RECV_BUFFER_SIZE 1024 * 1024
+
+// Longest a sliced wait blocks on one socket while others may have data
+#define RMG_MRMC_WAIT_SLICE_MS 1
+
+static FString DescribeEndpoints(const TArray<FIPv4Endpoint>& Endpoints)
+{
+	FString Result;
+	for (const FIPv4Endpoint& Endpoint : Endpoints)
+	{
+		Result += Result.IsEmpty() ? Endpoint.ToString() : TEXT(", ") + Endpoint.ToString();
+	}
+	return Result;
+}
+
+TUniquePtr<FRMG_MRMCReceiveBackend> FRMG_MRMCReceiveBackend::Create(const TArray<FIPv4Endpoint>& Endpoints, const FRMG_MRMCLiveLinkSourceSettings& Settings)
+{
+	if (Settings.Backend == ERMG_MRMCReceiveBackend::SharedMemory)
+	{
+		TUniquePtr<FRMG_MRMCReceiveBackend> SharedMemoryBackend = CreateSharedMemoryReceiveBackend(Endpoints.Num(), Settings);
+		if (SharedMemoryBackend->IsValid())
+		{
+			return SharedMemoryBackend;
+		}
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: shared memory ring %s unavailable, receiving on %s"), *Settings.SharedMemoryName, *DescribeEndpoints(Endpoints));
+	}
+
+#if PLATFORM_LINUX
+	if (Settings.Backend != ERMG_MRMCReceiveBackend::Socket)
+	{
+		TUniquePtr<FRMG_MRMCReceiveBackend> LinuxBackend = CreateLinuxReceiveBackend(Endpoints, Settings);
+		if (LinuxBackend.IsValid() && LinuxBackend->IsValid())
+		{
+			return LinuxBackend;
+		}
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: recvmmsg backend unavailable for %s, using FSocket"), *DescribeEndpoints(Endpoints));
+	}
+#else
+	if (Settings.Backend == ERMG_MRMCReceiveBackend::RecvMmsg)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: recvmmsg backend is Linux only, using FSocket"));
+	}
+#endif
+
+	return MakeUnique<FRMG_MRMCSocketReceiveBackend>(Endpoints);
+}
+
+static FSocket* CreateSocket(const FIPv4Endpoint& Endpoint)
+{
+	//setup socket
+	if (Endpoint.Address.IsMulticastAddress())
+	{
+		return FUdpSocketBuilder(TEXT("JSONSOCKET"))
+			.AsNonBlocking()
+			.AsReusable()
+			.BoundToPort(Endpoint.Port)
+			.WithReceiveBufferSize(RECV_BUFFER_SIZE)
+
+			.BoundToAddress(FIPv4Address::Any)
+			.JoinedToGroup(Endpoint.Address)
+			.WithMulticastLoopback()
+			.WithMulticastTtl(2);
+
+	}
+	else
+	{
+		return FUdpSocketBuilder(TEXT("JSONSOCKET"))
+			.AsNonBlocking()
+			.AsReusable()
+			.BoundToAddress(Endpoint.Address)
+			.BoundToPort(Endpoint.Port)
+			.WithReceiveBufferSize(RECV_BUFFER_SIZE);
+	}
+}
+
+FRMG_MRMCSocketReceiveBackend::FRMG_MRMCSocketReceiveBackend(const TArray<FIPv4Endpoint>& Endpoints)
+: WakeSocket(nullptr)
+, WakePort(-1)
+, bWakeRequested(false)
+, NextWaitSocket(0)
+{
+	for (const FIPv4Endpoint& Endpoint : Endpoints)
+	{
+		Sockets.Add(CreateSocket(Endpoint));
+	}
+
+	RecvBuffer.SetNumUninitialized(RECV_BUFFER_SIZE);
+	Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	if (Endpoints.Num() > 0)
+	{
+		// wildcard and multicast endpoints are reachable on loopback, a unicast one only on its own address
+		const FIPv4Endpoint& First = Endpoints[0];
+		const bool bLoopback = First.Address == FIPv4Address::Any || First.Address.IsMulticastAddress();
+		WakeTarget = FIPv4Endpoint(bLoopback ? FIPv4Address(127, 0, 0, 1) : First.Address, First.Port).ToInternetAddr();
+
+		WakeSocket = FUdpSocketBuilder(TEXT("RMG_MRMCWake"))
+			.AsNonBlocking()
+			.BoundToAddress(FIPv4Address::Any)
+			.BoundToPort(0);
+		if (WakeSocket != nullptr)
+		{
+			WakePort = WakeSocket->GetPortNo();
+		}
+	}
+}
+
+FRMG_MRMCSocketReceiveBackend::~FRMG_MRMCSocketReceiveBackend()
+{
+	for (FSocket* Socket : Sockets)
+	{
+		if (Socket != nullptr)
+		{
+			Socket->Close();
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		}
+	}
+	if (WakeSocket != nullptr)
+	{
+		WakeSocket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(WakeSocket);
+	}
+}
+
+void FRMG_MRMCSocketReceiveBackend::Wake()
+{
+	bWakeRequested = true;
+	if (WakeSocket != nullptr)
+	{
+		const uint8 Byte = 0;
+		int32 Sent = 0;
+		WakeSocket->SendTo(&Byte, 1, Sent, *WakeTarget);
+	}
+}
+
+bool FRMG_MRMCSocketReceiveBackend::IsValid() const
+{
+	for (FSocket* Socket : Sockets)
+	{
+		if (Socket == nullptr || Socket->GetSocketType() != SOCKTYPE_Datagram)
+		{
+			return false;
+		}
+	}
+	return Sockets.Num() > 0;
+}
+
+int32 FRMG_MRMCSocketReceiveBackend::Receive(const FTimespan& WaitTime, FRMG_MRMCPacketSink Sink)
+{
+	if (bWakeRequested.exchange(false))
+	{
+		return Drain(Sink);
+	}
+
+	if (Sockets.Num() == 1)
+	{
+		return Sockets[0]->Wait(ESocketWaitConditions::WaitForRead, WaitTime) ? Drain(Sink) : 0;
+	}
+
+	int32 Received = Drain(Sink);
+	if (Received > 0)
+	{
+		return Received;
+	}
+
+	const FTimespan Slice = FMath::Min(WaitTime, FTimespan::FromMilliseconds(RMG_MRMC_WAIT_SLICE_MS));
+	const double Deadline = FPlatformTime::Seconds() + WaitTime.GetTotalSeconds();
+	do
+	{
+		FSocket* Socket = Sockets[NextWaitSocket];
+		NextWaitSocket = (NextWaitSocket + 1) % Sockets.Num();
+
+		Socket->Wait(ESocketWaitConditions::WaitForRead, Slice);
+		Received = Drain(Sink);
+	} while (Received == 0 && !bWakeRequested.exchange(false) && FPlatformTime::Seconds() < Deadline);
+
+	return Received;
+}
+
+int32 FRMG_MRMCSocketReceiveBackend::Drain(FRMG_MRMCPacketSink Sink)
+{
+	int32 Received = 0;
+
+	for (int32 Stream = 0; Stream < Sockets.Num(); Stream++)
+	{
+		FSocket* Socket = Sockets[Stream];
+		uint32 Size;
+
+		while (Socket->HasPendingData(Size))
+		{
+			int32 Read = 0;
+
+			if (Socket->RecvFrom(RecvBuffer.GetData(), RecvBuffer.Num(), Read, *Sender))
+			{
+				if (Read == 1 && Sender->GetPort() == WakePort)
+				{
+					continue;
+				}
+				if (Read > 0)
+				{
+					Sink(Stream, RecvBuffer.GetData(), Read, FPlatformTime::Seconds());
+					Received++;
+				}
+			}
+		}
+	}
+	return Received;
+}
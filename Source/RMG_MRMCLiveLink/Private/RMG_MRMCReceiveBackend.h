@@ -0,0 +1,85 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include "RMG_MRMCLiveLinkSourceSettings.h"
+#include <atomic>
+
+class FSocket;
+
+// Called on the receive thread for every datagram. Stream is the index of the endpoint it arrived on.
+// Data is only valid for the duration of the call.
+typedef TFunctionRef<void(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds)> FRMG_MRMCPacketSink;
+
+// Socket layer used by FRMG_MRMCLiveLinkSource's receive thread. One backend listens on every
+// endpoint of the source, so a single thread services all robot streams.
+class FRMG_MRMCReceiveBackend
+{
+public:
+
+	virtual ~FRMG_MRMCReceiveBackend() {}
+
+	virtual bool IsValid() const = 0;
+
+	// Blocks for up to WaitTime until data arrives on any endpoint, then hands every queued datagram to Sink.
+	// ReceiveSeconds is on the FPlatformTime::Seconds() clock. Returns the number of datagrams delivered.
+	virtual int32 Receive(const FTimespan& WaitTime, FRMG_MRMCPacketSink Sink) = 0;
+
+	// Makes a Receive() blocked on another thread return as soon as possible. Safe to call from any thread.
+	virtual void Wake() = 0;
+
+	virtual const TCHAR* GetName() const = 0;
+
+	// Picks the backend requested in Settings, falling back to the portable FSocket backend
+	static TUniquePtr<FRMG_MRMCReceiveBackend> Create(const TArray<FIPv4Endpoint>& Endpoints, const FRMG_MRMCLiveLinkSourceSettings& Settings);
+};
+
+// Portable backend on top of FSocket: one Wait/RecvFrom per datagram, timestamped after the read returns.
+// FSocket cannot wait on several sockets at once, so with more than one endpoint the wait is split into
+// short slices rotating over the sockets, and every socket is drained after each slice.
+// Wake() sends a one byte datagram from a private socket to the first endpoint, which the drain discards.
+class FRMG_MRMCSocketReceiveBackend : public FRMG_MRMCReceiveBackend
+{
+public:
+
+	FRMG_MRMCSocketReceiveBackend(const TArray<FIPv4Endpoint>& Endpoints);
+	virtual ~FRMG_MRMCSocketReceiveBackend();
+
+	virtual bool IsValid() const override;
+	virtual int32 Receive(const FTimespan& WaitTime, FRMG_MRMCPacketSink Sink) override;
+	virtual void Wake() override;
+	virtual const TCHAR* GetName() const override { return TEXT("Socket"); }
+
+private:
+
+	int32 Drain(FRMG_MRMCPacketSink Sink);
+
+	TArray<FSocket*> Sockets;
+
+	// Sends wake datagrams to WakeTarget; datagrams from WakePort are not handed to the sink
+	FSocket* WakeSocket;
+	TSharedPtr<FInternetAddr> WakeTarget;
+	int32 WakePort;
+
+	// Ends a sliced wait, which may be blocked on a socket the wake datagram does not reach
+	std::atomic<bool> bWakeRequested;
+
+	// Socket the next sliced wait blocks on
+	int32 NextWaitSocket;
+
+	TSharedPtr<FInternetAddr> Sender;
+
+	// Buffer to receive socket data into
+	TArray<uint8> RecvBuffer;
+};
+
+#if PLATFORM_LINUX
+// epoll + recvmmsg backend with SO_TIMESTAMPNS kernel receive times, see Linux/RMG_MRMCLinuxReceiveBackend.cpp
+TUniquePtr<FRMG_MRMCReceiveBackend> CreateLinuxReceiveBackend(const TArray<FIPv4Endpoint>& Endpoints, const FRMG_MRMCLiveLinkSourceSettings& Settings);
+#endif
+
+// Reads the shared-memory ring named Settings.SharedMemoryName that same-machine producers write into,
+// see RMG_MRMCSharedMemoryRing.h and RMG_MRMCSharedMemoryReceiveBackend.cpp. Linux and Windows only.
+TUniquePtr<FRMG_MRMCReceiveBackend> CreateSharedMemoryReceiveBackend(int32 NumStreams, const FRMG_MRMCLiveLinkSourceSettings& Settings);
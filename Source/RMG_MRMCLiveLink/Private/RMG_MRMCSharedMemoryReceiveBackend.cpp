@@ -0,0 +1,317 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCReceiveBackend.h"
+#include "RMG_MRMCPacketDecoder.h"
+#include "RMG_MRMCSharedMemoryRing.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#elif PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+static_assert(RMG_MRMCSharedMemory::MaxDatagram >= RMG_MRMCPacketDecoder::MaxPacketSize, "a ring slot must hold every datagram variant");
+
+// Producer stamps older than this are taken as a producer without a working clock and replaced by the read time
+#define RMG_MRMC_SHARED_MEMORY_MAX_AGE_NS 1000000000LL
+
+static int64 GetUnixNowNs()
+{
+#if PLATFORM_LINUX
+	timespec Now;
+	clock_gettime(CLOCK_REALTIME, &Now);
+	return int64(Now.tv_sec) * 1000000000LL + int64(Now.tv_nsec);
+#elif PLATFORM_WINDOWS
+	// looked up at run time, the engine targets Windows versions without it; the fallback ticks every few ms
+	typedef void (WINAPI *FGetSystemTime)(LPFILETIME);
+	static const FGetSystemTime GetPreciseTime = reinterpret_cast<FGetSystemTime>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetSystemTimePreciseAsFileTime"));
+
+	// 100 ns ticks since 1601
+	FILETIME Now;
+	if (GetPreciseTime != nullptr)
+	{
+		GetPreciseTime(&Now);
+	}
+	else
+	{
+		GetSystemTimeAsFileTime(&Now);
+	}
+	const int64 Ticks = (int64(Now.dwHighDateTime) << 32) | int64(Now.dwLowDateTime);
+	return (Ticks - 116444736000000000LL) * 100;
+#else
+	return (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTicks() * 100;
+#endif
+}
+
+// Reads the ring described in RMG_MRMCSharedMemoryRing.h. The region is created when no producer has
+// created it yet and is left in place on close, so producers keep their mapping across source restarts.
+// Receive() sleeps on the ring's futex (Linux) or wake event (Windows) and never touches a socket, so a
+// datagram is handed over with one cache line copy and, when the reader is asleep, one wake-up.
+class FRMG_MRMCSharedMemoryReceiveBackend : public FRMG_MRMCReceiveBackend
+{
+public:
+
+	FRMG_MRMCSharedMemoryReceiveBackend(const FString& InName, int32 InNumStreams, int32 InBusyPollMicroseconds)
+	: Name(InName)
+	, NumStreams(InNumStreams)
+	, BusyPollMicroseconds(InBusyPollMicroseconds)
+	, Ring(nullptr)
+	, bWakeRequested(false)
+	{
+		Ring = Map();
+		if (Ring == nullptr)
+		{
+			return;
+		}
+		if (!RMG_MRMCSharedMemory::Initialize(*Ring))
+		{
+			UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: shared memory ring %s holds layout version %u, expected %u"), *Name, Ring->Version, RMG_MRMCSharedMemory::VersionValue);
+			Unmap();
+			return;
+		}
+
+		// whatever was written before the source opened the ring is stale
+		Reader.Open(*Ring);
+	}
+
+	virtual ~FRMG_MRMCSharedMemoryReceiveBackend()
+	{
+		if (Ring != nullptr)
+		{
+			UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: shared memory ring %s, %llu datagrams overwritten before they were read"), *Name, Reader.Overruns);
+		}
+		Unmap();
+	}
+
+	virtual bool IsValid() const override { return Ring != nullptr; }
+
+	virtual const TCHAR* GetName() const override { return TEXT("SharedMemory"); }
+
+	virtual void Wake() override
+	{
+		bWakeRequested = true;
+		if (Ring != nullptr)
+		{
+			Ring->WakeCount.fetch_add(1);
+			WakeReader();
+		}
+	}
+
+	virtual int32 Receive(const FTimespan& WaitTime, FRMG_MRMCPacketSink Sink) override
+	{
+		int32 Received = Drain(Sink);
+		if (Received > 0 || bWakeRequested.exchange(false))
+		{
+			return Received;
+		}
+
+		const double Deadline = FPlatformTime::Seconds() + WaitTime.GetTotalSeconds();
+		if (BusyPollMicroseconds > 0)
+		{
+			// spin on the ring instead of sleeping, producers then never make a wake-up call
+			do
+			{
+				Received = Drain(Sink);
+			} while (Received == 0 && !bWakeRequested.exchange(false) && FPlatformTime::Seconds() < Deadline);
+			return Received;
+		}
+
+		for (;;)
+		{
+			// announce the sleep before the last look at the ring, see RMG_MRMCSharedMemory::Write
+			Ring->ReaderWaiting.store(1);
+			const uint32 ExpectedWakeCount = Ring->WakeCount.load();
+			if (Reader.HasPending(*Ring) || bWakeRequested.exchange(false))
+			{
+				break;
+			}
+			const double RemainingSeconds = Deadline - FPlatformTime::Seconds();
+			if (RemainingSeconds <= 0.0)
+			{
+				break;
+			}
+			WaitForWake(ExpectedWakeCount, RemainingSeconds);
+			if (Reader.HasPending(*Ring))
+			{
+				break;
+			}
+		}
+		Ring->ReaderWaiting.store(0, std::memory_order_relaxed);
+
+		return Drain(Sink);
+	}
+
+private:
+
+	int32 Drain(FRMG_MRMCPacketSink Sink)
+	{
+		int64 NowUnixNs = 0;
+		double NowSeconds = 0.0;
+		int32 Received = 0;
+		Reader.Drain(*Ring, [this, Sink, &NowUnixNs, &NowSeconds, &Received](uint16_t Stream, const uint8_t* Data, uint32_t Size, int64_t WriteUnixNs)
+		{
+			// datagrams for streams this source has no endpoint for are dropped, as a socket would never see them
+			if (Stream >= NumStreams)
+			{
+				return;
+			}
+
+			if (Received == 0)
+			{
+				NowUnixNs = GetUnixNowNs();
+				NowSeconds = FPlatformTime::Seconds();
+			}
+			// producer stamps are Unix time; carry their age over to the FPlatformTime::Seconds() clock
+			const int64 AgeNs = NowUnixNs - WriteUnixNs;
+			const double ReceiveSeconds = AgeNs >= 0 && AgeNs < RMG_MRMC_SHARED_MEMORY_MAX_AGE_NS ? NowSeconds - double(AgeNs) * 1e-9 : NowSeconds;
+
+			Sink(Stream, Data, Size, ReceiveSeconds);
+			Received++;
+		});
+		return Received;
+	}
+
+#if PLATFORM_LINUX
+
+	RMG_MRMCSharedMemory::FRing* Map()
+	{
+		// no shm_unlink on close, see the class comment
+		const int Fd = shm_open(TCHAR_TO_UTF8(*(TEXT("/") + Name)), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+		if (Fd < 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: cannot open shared memory ring %s (errno %d)"), *Name, errno);
+			return nullptr;
+		}
+
+		struct stat Info;
+		if (fstat(Fd, &Info) != 0 || (Info.st_size < static_cast<off_t>(sizeof(RMG_MRMCSharedMemory::FRing)) && ftruncate(Fd, sizeof(RMG_MRMCSharedMemory::FRing)) != 0))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: cannot size shared memory ring %s (errno %d)"), *Name, errno);
+			close(Fd);
+			return nullptr;
+		}
+
+		void* Address = mmap(nullptr, sizeof(RMG_MRMCSharedMemory::FRing), PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+		close(Fd);
+		if (Address == MAP_FAILED)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: cannot map shared memory ring %s (errno %d)"), *Name, errno);
+			return nullptr;
+		}
+		return static_cast<RMG_MRMCSharedMemory::FRing*>(Address);
+	}
+
+	void Unmap()
+	{
+		if (Ring != nullptr)
+		{
+			munmap(Ring, sizeof(RMG_MRMCSharedMemory::FRing));
+			Ring = nullptr;
+		}
+	}
+
+	void WaitForWake(uint32 ExpectedWakeCount, double TimeoutSeconds)
+	{
+		RMG_MRMCSharedMemory::WaitForWake(*Ring, ExpectedWakeCount, TimeoutSeconds);
+	}
+
+	void WakeReader()
+	{
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Ring->WakeCount), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+	}
+
+#elif PLATFORM_WINDOWS
+
+	RMG_MRMCSharedMemory::FRing* Map()
+	{
+		// Windows keeps the mapping while any process has it open, there is nothing to leave in place
+		MappingHandle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(RMG_MRMCSharedMemory::FRing), *(TEXT("Local\\") + Name));
+		if (MappingHandle == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: cannot open shared memory ring %s (error %u)"), *Name, GetLastError());
+			return nullptr;
+		}
+		WakeEvent = CreateEventW(nullptr, FALSE, FALSE, *(TEXT("Local\\") + Name + TEXT("Wake")));
+
+		void* Address = MapViewOfFile(MappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(RMG_MRMCSharedMemory::FRing));
+		if (Address == nullptr || WakeEvent == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: cannot map shared memory ring %s (error %u)"), *Name, GetLastError());
+			if (Address != nullptr)
+			{
+				UnmapViewOfFile(Address);
+			}
+			return nullptr;
+		}
+		return static_cast<RMG_MRMCSharedMemory::FRing*>(Address);
+	}
+
+	void Unmap()
+	{
+		if (Ring != nullptr)
+		{
+			UnmapViewOfFile(Ring);
+			Ring = nullptr;
+		}
+		if (WakeEvent != nullptr)
+		{
+			CloseHandle(WakeEvent);
+			WakeEvent = nullptr;
+		}
+		if (MappingHandle != nullptr)
+		{
+			CloseHandle(MappingHandle);
+			MappingHandle = nullptr;
+		}
+	}
+
+	void WaitForWake(uint32 ExpectedWakeCount, double TimeoutSeconds)
+	{
+		// the event is auto-reset and stays set for a wake that raced ahead of us, ExpectedWakeCount is not needed
+		WaitForSingleObject(WakeEvent, static_cast<DWORD>(FMath::CeilToInt(TimeoutSeconds * 1000.0)));
+	}
+
+	void WakeReader()
+	{
+		SetEvent(WakeEvent);
+	}
+
+	void* MappingHandle = nullptr;
+	void* WakeEvent = nullptr;
+
+#else
+
+	RMG_MRMCSharedMemory::FRing* Map()
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: the shared memory backend needs Linux or Windows"));
+		return nullptr;
+	}
+
+	void Unmap() {}
+	void WaitForWake(uint32 ExpectedWakeCount, double TimeoutSeconds) {}
+	void WakeReader() {}
+
+#endif
+
+	FString Name;
+	int32 NumStreams;
+	int32 BusyPollMicroseconds;
+
+	RMG_MRMCSharedMemory::FRing* Ring;
+
+	RMG_MRMCSharedMemory::FReader Reader;
+
+	std::atomic<bool> bWakeRequested;
+};
+
+TUniquePtr<FRMG_MRMCReceiveBackend> CreateSharedMemoryReceiveBackend(int32 NumStreams, const FRMG_MRMCLiveLinkSourceSettings& Settings)
+{
+	return MakeUnique<FRMG_MRMCSharedMemoryReceiveBackend>(Settings.SharedMemoryName, NumStreams, Settings.BusyPollMicroseconds);
+}
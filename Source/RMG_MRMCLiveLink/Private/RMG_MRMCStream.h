@@ -0,0 +1,27 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "RMG_MRMCPacketMailbox.h"
+#include "RMG_MRMCStreamProcessor.h"
+
+// One robot stream of a source. A source ingests several streams on one receive thread;
+// each gets its own subjects and nothing is shared between them.
+struct FRMG_MRMCStream
+{
+	FRMG_MRMCStream(const FIPv4Endpoint& InEndpoint, const FRMG_MRMCCompiledMapping& InMapping, const FRMG_MRMCProcessingOptions& InOptions)
+	: Endpoint(InEndpoint)
+	, Processor(InMapping, InOptions)
+	{
+	}
+
+	FIPv4Endpoint Endpoint;
+
+	// Decode, conversion and frame assembly with this stream's subject names
+	FRMG_MRMCStreamProcessor Processor;
+
+	// Newest datagram of this stream, instead of the packet ring with ProcessingMode=Mailbox
+	FRMG_MRMCPacketMailbox Mailbox;
+};
@@ -1,118 +1,367 @@
-// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
-
-#include "SRMG_MRMCLiveLinkSourceFactory.h"
-#include "Interfaces/IPv4/IPv4Endpoint.h"
-#include "Widgets/SBoxPanel.h"
-#include "Widgets/Input/SButton.h"
-#include "Widgets/Input/SCheckBox.h"
-#include "Widgets/Input/SEditableTextBox.h"
-#include "Widgets/Layout/SBox.h"
-#include "Widgets/Text/STextBlock.h"
-
-#define LOCTEXT_NAMESPACE "RMG_MRMCLiveLinkSourceEditor"
-
-void SRMG_MRMCLiveLinkSourceFactory::Construct(const FArguments& Args)
-{
-	OkClicked = Args._OnOkClicked;
-
-	FIPv4Endpoint Endpoint;
-//	Endpoint.Address = FIPv4Address::Any;
-	FIPv4Address::Parse("0.0.0.0", Endpoint.Address);
-	Endpoint.Port = 55535;
-
-	ChildSlot
-	[
-		SNew(SBox)
-		.WidthOverride(250)
-		[
-			SNew(SVerticalBox)
-			+ SVerticalBox::Slot()
-			.AutoHeight()
-			[
-
-			SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-			.VAlign(VAlign_Center)
-			.FillWidth(0.40)
-			[
-				SNew(STextBlock).Text(LOCTEXT("Udp Connects", "Udp Connect"))
-			]
-
-		   + SHorizontalBox::Slot()
-			.VAlign(VAlign_Center)
-			[
-
-				SNew(SCheckBox)
-				.IsChecked(this, &SRMG_MRMCLiveLinkSourceFactory::GetConnectedBody)
-			    .OnCheckStateChanged(this, &SRMG_MRMCLiveLinkSourceFactory::ConnectedBodyChanged, &_checkValUdp)
-
-			]
-			]
-
-			+ SVerticalBox::Slot()
-			.AutoHeight()
-			[
-				SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Left)
-				.FillWidth(0.5f)
-				[
-					SNew(STextBlock)
-					.Text(LOCTEXT("JSONPortNumber", "Port Number"))
-				]
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Fill)
-				.FillWidth(0.5f)
-				[
-					SAssignNew(EditabledText, SEditableTextBox)
-					.Text(FText::FromString(Endpoint.ToString()))
-					.OnTextCommitted(this, &SRMG_MRMCLiveLinkSourceFactory::OnEndpointChanged)
-				]
-			]
-			+ SVerticalBox::Slot()
-			.HAlign(HAlign_Right)
-			.AutoHeight()
-			[
-				SNew(SButton)
-				.OnClicked(this, &SRMG_MRMCLiveLinkSourceFactory::OnOkClicked)
-				[
-					SNew(STextBlock)
-					.Text(LOCTEXT("Ok", "Ok"))
-				]
-			]
-		]
-	];
-}
-
-void SRMG_MRMCLiveLinkSourceFactory::OnEndpointChanged(const FText& NewValue, ETextCommit::Type)
-{
-	TSharedPtr<SEditableTextBox> EditabledTextPin = EditabledText.Pin();
-	if (EditabledTextPin.IsValid())
-	{
-		FIPv4Endpoint Endpoint;
-		if (!FIPv4Endpoint::Parse(NewValue.ToString(), Endpoint))
-		{
-			//Endpoint.Address = FIPv4Address::Any;
-			FIPv4Address::Parse("239.255.1.2", Endpoint.Address);
-			//Endpoint.Port = 54321;
-			Endpoint.Port = 24680;
-			EditabledTextPin->SetText(FText::FromString(Endpoint.ToString()));
-		}
-	}
-}
-
-FReply SRMG_MRMCLiveLinkSourceFactory::OnOkClicked()
-{
-	TSharedPtr<SEditableTextBox> EditabledTextPin = EditabledText.Pin();
-	if (EditabledTextPin.IsValid())
-	{
-		FIPv4Endpoint Endpoint;
-		if (FIPv4Endpoint::Parse(EditabledTextPin->GetText().ToString(), Endpoint))
-		{
-			OkClicked.ExecuteIfBound(Endpoint);
-		}
-	}
-	return FReply::Handled();
-}
-
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "SRMG_MRMCLiveLinkSourceFactory.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Input/STextComboBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "RMG_MRMCLiveLinkSourceEditor"
+
+// SO_BUSY_POLL budget requested when Busy Spin is ticked
+#define RMG_MRMC_PANEL_BUSY_POLL_US 50
+
+void SRMG_MRMCLiveLinkSourceFactory::Construct(const FArguments& Args)
+{
+	OkClicked = Args._OnOkClicked;
+
+	FIPv4Endpoint Endpoint;
+//	Endpoint.Address = FIPv4Address::Any;
+	FIPv4Address::Parse("0.0.0.0", Endpoint.Address);
+	Endpoint.Port = 55535;
+
+	const FRMG_MRMCLiveLinkSourceSettings Defaults;
+	for (EThreadPriority Priority : { TPri_Normal, TPri_AboveNormal, TPri_Highest, TPri_TimeCritical })
+	{
+		ThreadPriorityOptions.Add(MakeShared<FString>(FRMG_MRMCLiveLinkSourceSettings::GetThreadPriorityName(Priority)));
+		if (Priority == Defaults.ThreadPriority)
+		{
+			SelectedThreadPriority = ThreadPriorityOptions.Last();
+		}
+	}
+
+	ChildSlot
+	[
+		SNew(SBox)
+		.WidthOverride(250)
+		[
+			SNew(SVerticalBox)
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+
+			SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+			.VAlign(VAlign_Center)
+			.FillWidth(0.40)
+			[
+				SNew(STextBlock).Text(LOCTEXT("Udp Connects", "Udp Connect"))
+			]
+
+		   + SHorizontalBox::Slot()
+			.VAlign(VAlign_Center)
+			[
+
+				SNew(SCheckBox)
+				.IsChecked(this, &SRMG_MRMCLiveLinkSourceFactory::GetConnectedBody)
+			    .OnCheckStateChanged(this, &SRMG_MRMCLiveLinkSourceFactory::ConnectedBodyChanged, &_checkValUdp)
+
+			]
+			]
+
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("JSONPortNumber", "Port Number"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(EditabledText, SEditableTextBox)
+					.Text(FText::FromString(Endpoint.ToString()))
+					.OnTextCommitted(this, &SRMG_MRMCLiveLinkSourceFactory::OnEndpointChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("AdditionalStreams", "Additional Streams"))
+					.ToolTipText(LOCTEXT("AdditionalStreamsTooltip", "Comma separated address:port list of further robots received on the same thread. Their subjects get an _1, _2... suffix"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(StreamsText, SEditableTextBox)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("RelayTo", "Relay To"))
+					.ToolTipText(LOCTEXT("RelayToTooltip", "Comma separated address:port list of unicast or multicast endpoints every received datagram is forwarded to, e.g. the render nodes of an nDisplay cluster"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(RelayText, SEditableTextBox)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("MappingFile", "Mapping File"))
+					.ToolTipText(LOCTEXT("MappingFileTooltip", "Subject mapping JSON, relative to the project directory. Leave empty for the built-in robot_camera/camera_target mapping"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(MappingFileText, SEditableTextBox)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("LensFile", "Lens File"))
+					.ToolTipText(LOCTEXT("LensFileTooltip", "Lens calibration JSON, relative to the project directory. Maps the raw zoom and focus encoders to focal length and focus distance. Leave empty to pass them through"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(LensFileText, SEditableTextBox)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.VAlign(VAlign_Center)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ReceiveThread", "Process On Receive Thread"))
+					.ToolTipText(LOCTEXT("ReceiveThreadTooltip", "Decode and push frames from the UDP receive thread instead of waiting for the game thread"))
+				]
+				+ SHorizontalBox::Slot()
+				.VAlign(VAlign_Center)
+				.FillWidth(0.5f)
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SRMG_MRMCLiveLinkSourceFactory::GetReceiveThread)
+					.OnCheckStateChanged(this, &SRMG_MRMCLiveLinkSourceFactory::ReceiveThreadChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.VAlign(VAlign_Center)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ThreadPriority", "Thread Priority"))
+					.ToolTipText(LOCTEXT("ThreadPriorityTooltip", "Priority of the UDP receive thread"))
+				]
+				+ SHorizontalBox::Slot()
+				.VAlign(VAlign_Center)
+				.FillWidth(0.5f)
+				[
+					SNew(STextComboBox)
+					.OptionsSource(&ThreadPriorityOptions)
+					.InitiallySelectedItem(SelectedThreadPriority)
+					.OnSelectionChanged(this, &SRMG_MRMCLiveLinkSourceFactory::ThreadPriorityChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("Cores", "Receive Cores"))
+					.ToolTipText(LOCTEXT("CoresTooltip", "Comma separated cores the receive thread is pinned to, e.g. 2,3. Leave empty to share the engine's pool thread cores"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(CoresText, SEditableTextBox)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("RealtimePriority", "SCHED_FIFO Priority"))
+					.ToolTipText(LOCTEXT("RealtimePriorityTooltip", "Linux only. Run the receive thread under SCHED_FIFO at this priority, 1 - 99. Leave empty for normal scheduling"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(RealtimePriorityText, SEditableTextBox)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.VAlign(VAlign_Center)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("BusySpin", "Busy Spin"))
+					.ToolTipText(LOCTEXT("BusySpinTooltip", "Linux only. Spin on the sockets instead of sleeping; costs a whole core, pin it with Receive Cores"))
+				]
+				+ SHorizontalBox::Slot()
+				.VAlign(VAlign_Center)
+				.FillWidth(0.5f)
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SRMG_MRMCLiveLinkSourceFactory::GetBusySpin)
+					.OnCheckStateChanged(this, &SRMG_MRMCLiveLinkSourceFactory::BusySpinChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.HAlign(HAlign_Right)
+			.AutoHeight()
+			[
+				SNew(SButton)
+				.OnClicked(this, &SRMG_MRMCLiveLinkSourceFactory::OnOkClicked)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("Ok", "Ok"))
+				]
+			]
+		]
+	];
+}
+
+void SRMG_MRMCLiveLinkSourceFactory::OnEndpointChanged(const FText& NewValue, ETextCommit::Type)
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = EditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		FIPv4Endpoint Endpoint;
+		if (!FIPv4Endpoint::Parse(NewValue.ToString(), Endpoint))
+		{
+			//Endpoint.Address = FIPv4Address::Any;
+			FIPv4Address::Parse("239.255.1.2", Endpoint.Address);
+			//Endpoint.Port = 54321;
+			Endpoint.Port = 24680;
+			EditabledTextPin->SetText(FText::FromString(Endpoint.ToString()));
+		}
+	}
+}
+
+FReply SRMG_MRMCLiveLinkSourceFactory::OnOkClicked()
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = EditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		FRMG_MRMCLiveLinkSourceSettings Settings;
+		if (FIPv4Endpoint::Parse(EditabledTextPin->GetText().ToString(), Settings.Endpoint))
+		{
+			Settings.ProcessingMode = _checkValReceiveThread ? ERMG_MRMCProcessingMode::ReceiveThread : ERMG_MRMCProcessingMode::GameThread;
+			TSharedPtr<SEditableTextBox> StreamsTextPin = StreamsText.Pin();
+			if (StreamsTextPin.IsValid())
+			{
+				TArray<FString> StreamEndpoints;
+				StreamsTextPin->GetText().ToString().ParseIntoArray(StreamEndpoints, TEXT(","));
+				for (const FString& StreamEndpoint : StreamEndpoints)
+				{
+					FIPv4Endpoint Parsed;
+					if (FIPv4Endpoint::Parse(StreamEndpoint.TrimStartAndEnd(), Parsed))
+					{
+						Settings.AdditionalEndpoints.Add(Parsed);
+					}
+				}
+			}
+			TSharedPtr<SEditableTextBox> RelayTextPin = RelayText.Pin();
+			if (RelayTextPin.IsValid())
+			{
+				TArray<FString> RelayEndpoints;
+				RelayTextPin->GetText().ToString().ParseIntoArray(RelayEndpoints, TEXT(","));
+				for (const FString& RelayEndpoint : RelayEndpoints)
+				{
+					FIPv4Endpoint Parsed;
+					if (FIPv4Endpoint::Parse(RelayEndpoint.TrimStartAndEnd(), Parsed))
+					{
+						Settings.RelayEndpoints.Add(Parsed);
+					}
+				}
+			}
+			TSharedPtr<SEditableTextBox> MappingFileTextPin = MappingFileText.Pin();
+			if (MappingFileTextPin.IsValid())
+			{
+				Settings.MappingFile = MappingFileTextPin->GetText().ToString().TrimStartAndEnd();
+			}
+			TSharedPtr<SEditableTextBox> LensFileTextPin = LensFileText.Pin();
+			if (LensFileTextPin.IsValid())
+			{
+				Settings.LensFile = LensFileTextPin->GetText().ToString().TrimStartAndEnd();
+			}
+			if (SelectedThreadPriority.IsValid())
+			{
+				FRMG_MRMCLiveLinkSourceSettings::ParseThreadPriority(*SelectedThreadPriority, Settings.ThreadPriority);
+			}
+			TSharedPtr<SEditableTextBox> CoresTextPin = CoresText.Pin();
+			if (CoresTextPin.IsValid())
+			{
+				FRMG_MRMCLiveLinkSourceSettings::ParseCoreList(CoresTextPin->GetText().ToString(), Settings.AffinityMask);
+			}
+			TSharedPtr<SEditableTextBox> RealtimePriorityTextPin = RealtimePriorityText.Pin();
+			if (RealtimePriorityTextPin.IsValid())
+			{
+				Settings.RealtimePriority = FCString::Atoi(*RealtimePriorityTextPin->GetText().ToString());
+			}
+			if (_checkValBusySpin)
+			{
+				Settings.BusyPollMicroseconds = RMG_MRMC_PANEL_BUSY_POLL_US;
+			}
+			OkClicked.ExecuteIfBound(Settings);
+		}
+	}
+	return FReply::Handled();
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -1,35 +1,55 @@
-// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "Widgets/SCompoundWidget.h"
-#include "Input/Reply.h"
-#include "Types/SlateEnums.h"
-#include "Widgets/DeclarativeSyntaxSupport.h"
-
-class SEditableTextBox;
-
-class SRMG_MRMCLiveLinkSourceFactory : public SCompoundWidget
-{
-public:
-	DECLARE_DELEGATE_OneParam(FOnOkClicked, FIPv4Endpoint);
-
-	SLATE_BEGIN_ARGS(SRMG_MRMCLiveLinkSourceFactory){}
-		SLATE_EVENT(FOnOkClicked, OnOkClicked)
-	SLATE_END_ARGS()
-
-	void Construct(const FArguments& Args);
-
-private:
-
-	void OnEndpointChanged(const FText& NewValue, ETextCommit::Type);
-
-	FReply OnOkClicked();
-
-	bool _checkValUdp = true;
-	ECheckBoxState GetConnectedBody()const { return (_checkValUdp==true) ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; };
-	void ConnectedBodyChanged(ECheckBoxState state, bool* value) { _checkValUdp = (state == ECheckBoxState::Checked); }
-
-	TWeakPtr<SEditableTextBox> EditabledText;
-	FOnOkClicked OkClicked;
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Widgets/SCompoundWidget.h"
+#include "Input/Reply.h"
+#include "Types/SlateEnums.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "RMG_MRMCLiveLinkSourceSettings.h"
+
+class SEditableTextBox;
+
+class SRMG_MRMCLiveLinkSourceFactory : public SCompoundWidget
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnOkClicked, FRMG_MRMCLiveLinkSourceSettings);
+
+	SLATE_BEGIN_ARGS(SRMG_MRMCLiveLinkSourceFactory){}
+		SLATE_EVENT(FOnOkClicked, OnOkClicked)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& Args);
+
+private:
+
+	void OnEndpointChanged(const FText& NewValue, ETextCommit::Type);
+
+	FReply OnOkClicked();
+
+	bool _checkValUdp = true;
+	ECheckBoxState GetConnectedBody()const { return (_checkValUdp==true) ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; };
+	void ConnectedBodyChanged(ECheckBoxState state, bool* value) { _checkValUdp = (state == ECheckBoxState::Checked); }
+
+	bool _checkValReceiveThread = false;
+	ECheckBoxState GetReceiveThread() const { return _checkValReceiveThread ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; }
+	void ReceiveThreadChanged(ECheckBoxState state) { _checkValReceiveThread = (state == ECheckBoxState::Checked); }
+
+	bool _checkValBusySpin = false;
+	ECheckBoxState GetBusySpin() const { return _checkValBusySpin ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; }
+	void BusySpinChanged(ECheckBoxState state) { _checkValBusySpin = (state == ECheckBoxState::Checked); }
+
+	// ThreadPriority names, see FRMG_MRMCLiveLinkSourceSettings::GetThreadPriorityName
+	TArray<TSharedPtr<FString>> ThreadPriorityOptions;
+	TSharedPtr<FString> SelectedThreadPriority;
+	void ThreadPriorityChanged(TSharedPtr<FString> NewValue, ESelectInfo::Type) { SelectedThreadPriority = NewValue; }
+
+	TWeakPtr<SEditableTextBox> EditabledText;
+	TWeakPtr<SEditableTextBox> CoresText;
+	TWeakPtr<SEditableTextBox> RealtimePriorityText;
+	TWeakPtr<SEditableTextBox> MappingFileText;
+	TWeakPtr<SEditableTextBox> LensFileText;
+	TWeakPtr<SEditableTextBox> StreamsText;
+	TWeakPtr<SEditableTextBox> RelayText;
+	FOnOkClicked OkClicked;
 };
\ No newline at end of file
@@ -1,128 +1,169 @@
-// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "ILiveLinkSource.h"
-#include "HAL/Runnable.h"
-#include "HAL/ThreadSafeBool.h"
-#include "IMessageContext.h"
-#include "Interfaces/IPv4/IPv4Endpoint.h"
-
-class FRunnableThread;
-class FSocket;
-class ILiveLinkClient;
-class ISocketSubsystem;
-
-
-struct Bone {
-    FString Name;
-    FString ParentName;
-    FTransform BoneTransform;
-    int Index[6] = { -1,-1,-1,-1,-1,-1 };
-    bool IsRoot = true;
-    int Id=0;
-};
-
-struct BoneProperty {
-    FString Name;
-    int Index = -1;
-};
-
-struct Subject {
-    FName SubjectName;
-    TArray<Bone> Bones;
-    TArray<BoneProperty> Properties;
-    TArray<float> Values;
-};
-struct RobotData {
-	float xv = 0.0f;
-	float yv = 0.0f;
-	float zv = 0.0f;
-	float xt = 0.0f;
-	float yt = 0.0f;
-	float zt = 0.0f;
-	float roll = 0.0f;
-	float focus = 0.0f;
-	float zoom = 0.0f;
-};
-
-class RMG_MRMCLIVELINK_API FRMG_MRMCLiveLinkSource : public ILiveLinkSource, public FRunnable
-{
-public:
-
-	FRMG_MRMCLiveLinkSource(FIPv4Endpoint Endpoint);
-
-	virtual ~FRMG_MRMCLiveLinkSource();
-
-	// Begin ILiveLinkSource Interface
-	
-	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
-
-	virtual bool IsSourceStillValid() const override;
-
-	virtual bool RequestSourceShutdown() override;
-
-	virtual FText GetSourceType() const override { return SourceType; };
-	virtual FText GetSourceMachineName() const override { return SourceMachineName; }
-	virtual FText GetSourceStatus() const override { return SourceStatus; }
-
-	// End ILiveLinkSource Interface
-
-	// Begin FRunnable Interface
-
-	virtual bool Init() override { return true; }
-	virtual uint32 Run() override;
-	void Start();
-	virtual void Stop() override;
-	virtual void Exit() override { }
-
-	// End FRunnable Interface
-
-	void HandleReceivedData(TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> ReceivedData);
-    void SetupSubjects(const FString JsonString, TArray<Subject> &Subjects);
-    void SendFrameToLiveLink(const TArray<Subject> Subjects, const TArray<float> FrameValues);
-
-private:
-
-	ILiveLinkClient* Client;
-
-	// Our identifier in LiveLink
-	FGuid SourceGuid;
-
-	FMessageAddress ConnectionAddress;
-
-	FText SourceType;
-	FText SourceMachineName;
-	FText SourceStatus;
-
-	FIPv4Endpoint DeviceEndpoint;
-
-	// Socket to receive data on
-	FSocket* Socket;
-
-	// Subsystem associated to Socket
-	ISocketSubsystem* SocketSubsystem;
-
-	// Threadsafe Bool for terminating the main thread loop
-	FThreadSafeBool Stopping;
-
-	// Thread to run socket operations on
-	FRunnableThread* Thread;
-
-	// Name of the sockets thread
-	FString ThreadName;
-
-	// Time to wait between attempted receives
-	FTimespan WaitTime;
-
-	// List of subjects we've already encountered
-	TSet<FName> EncounteredSubjects;
-
-	// Buffer to receive socket data into
-	TArray<uint8> RecvBuffer;
-
-    bool NeedSubjectSeup = true;
-    bool isRunning = false;
-    TArray<Subject> Subjects;
-    TArray<float> FrameValues;
-};
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ILiveLinkSource.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "IMessageContext.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/QualifiedFrameTime.h"
+#include "RMG_MRMCLiveLinkSourceSettings.h"
+#include "RMG_MRMCRobotData.h"
+#include "RMG_MRMCStats.h"
+#include <atomic>
+
+struct FRMG_MRMCCompiledMapping;
+struct FRMG_MRMCStream;
+class FRMG_MRMCFaultInjector;
+class FRMG_MRMCLiveLinkFrameSink;
+class FRMG_MRMCPacketRing;
+class FRMG_MRMCReceiveBackend;
+class FRMG_MRMCRelay;
+class FRMG_MRMCTakeRecorder;
+class FRunnableThread;
+class ILiveLinkClient;
+
+
+
+class RMG_MRMCLIVELINK_API FRMG_MRMCLiveLinkSource : public ILiveLinkSource, public FRunnable
+{
+public:
+
+	FRMG_MRMCLiveLinkSource(FIPv4Endpoint Endpoint);
+	FRMG_MRMCLiveLinkSource(const FRMG_MRMCLiveLinkSourceSettings& InSettings);
+
+	virtual ~FRMG_MRMCLiveLinkSource();
+
+	// Begin ILiveLinkSource Interface
+	
+	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
+
+	virtual void Update() override;
+
+	virtual bool IsSourceStillValid() const override;
+
+	virtual bool RequestSourceShutdown() override;
+
+	virtual FText GetSourceType() const override { return SourceType; };
+	virtual FText GetSourceMachineName() const override { return SourceMachineName; }
+	virtual FText GetSourceStatus() const override { return SourceStatus; }
+
+	// End ILiveLinkSource Interface
+
+	// Begin FRunnable Interface
+
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	void Start();
+	virtual void Stop() override;
+	virtual void Exit() override { }
+
+	// End FRunnable Interface
+
+	void HandleReceivedData(int32 StreamIndex, const uint8* Data, int32 Size, double ReceiveSeconds);
+	void DrainReceivedPackets();
+	// Processes the newest datagram of each stream, with ProcessingMode=Mailbox
+	void DrainMailboxes();
+    // Pushes static data for every subject of every stream
+    void SetupSubjects();
+    // False when the mapping file could not be read or compiled; the source then never receives
+    bool HasValidMapping() const { return bMappingValid; }
+    void PushInterpolatedFrame(double EvaluationSeconds);
+    // Pushes extrapolated frames for streams that went quiet, see GapFillMs
+    void FillGaps(double NowSeconds);
+    // Counters and per-stage latency histograms, live while the source runs
+    const FRMG_MRMCStats& GetStats() const { return Stats; }
+    bool WriteStats(const FString& Filename) const;
+
+private:
+
+	bool ProcessesOnReceiveThread() const;
+	bool UsesMailbox() const;
+
+	// Reloads Settings.MappingFile when it changed on disk, checked about once a second from Update() once there
+	// is a client
+	void CheckMappingFile();
+	// Switches every stream to a reloaded mapping, on the thread that processes packets; needs the client's sink
+	void ApplyMapping(const FRMG_MRMCCompiledMapping& Mapping);
+	void ApplyPendingMapping();
+
+	// Refreshes SourceStatus from the stats and writes the stats file, about once a second
+	void UpdateStats();
+
+	// Set by ReceiveClient() with release order after FrameSink and the static data, so whichever thread processes
+	// packets sees both once it loads a non-null client with acquire order, see HasClient()
+	std::atomic<ILiveLinkClient*> Client;
+
+	bool HasClient() const { return Client.load(std::memory_order_acquire) != nullptr; }
+
+	// Our identifier in LiveLink
+	FGuid SourceGuid;
+
+	FMessageAddress ConnectionAddress;
+
+	FText SourceType;
+	FText SourceMachineName;
+	FText SourceStatus;
+
+	FIPv4Endpoint DeviceEndpoint;
+
+	FRMG_MRMCLiveLinkSourceSettings Settings;
+
+	// Socket layer the receive thread waits on
+	TUniquePtr<FRMG_MRMCReceiveBackend> ReceiveBackend;
+
+	// Threadsafe Bool for terminating the main thread loop
+	FThreadSafeBool Stopping;
+
+	// Thread to run socket operations on
+	FRunnableThread* Thread;
+
+	// Name of the sockets thread
+	FString ThreadName;
+
+	// Longest the receive thread blocks with nothing arriving; Stop() wakes it straight away
+	FTimespan WaitTime;
+
+	// FPlatformTime::Cycles64() when Stop() was first called, and how long the receive thread took to notice
+	std::atomic<uint64> StopCycles;
+	double WakeLatencySeconds;
+
+	// List of subjects we've already encountered
+	TSet<FName> EncounteredSubjects;
+
+	// Preallocated handoff from the receive thread to whichever thread processes packets
+	TUniquePtr<FRMG_MRMCPacketRing> PacketRing;
+
+    bool isRunning = false;
+    bool bMappingValid = false;
+    // One per endpoint, indexed like Settings.GetEndpoints(); each carries the subject mapping
+    // loaded from Settings.MappingFile when the source is created
+    TArray<TUniquePtr<FRMG_MRMCStream>> Streams;
+    // Absolute path of Settings.MappingFile and its time stamp when last loaded, empty when not reloading
+    FString MappingPath;
+    FDateTime MappingTimeStamp;
+    double LastMappingCheckSeconds = 0.0;
+    // Reloaded mapping handed to the receive thread when it processes packets
+    FCriticalSection PendingMappingLock;
+    TUniquePtr<FRMG_MRMCCompiledMapping> PendingMapping;
+    std::atomic<bool> bMappingPending { false };
+    // Simulated network faults applied on the receive thread; null unless a Fault option is set
+    TUniquePtr<FRMG_MRMCFaultInjector> FaultInjector;
+    // Forwards received datagrams to other machines from the receive thread; null unless Relay is set
+    TUniquePtr<FRMG_MRMCRelay> Relay;
+    // Raw datagram capture, written from the receive thread; null unless RecordFile is set
+    TUniquePtr<FRMG_MRMCTakeRecorder> Recorder;
+    // Forwards assembled frames to Client, created in ReceiveClient
+    TUniquePtr<FRMG_MRMCLiveLinkFrameSink> FrameSink;
+    // Shared by the receive thread and every stream's processor
+    FRMG_MRMCStats Stats;
+    // False when measured collection overhead exceeds RMG_MRMC_STATS_BUDGET_NS
+    bool bCollectStats = false;
+    // Absolute path of Settings.StatsFile, empty when not writing stats
+    FString StatsFilename;
+    double LastStatusSeconds = 0.0;
+    double LastStatsWriteSeconds = 0.0;
+    uint64 LastStatusPackets = 0;
+};
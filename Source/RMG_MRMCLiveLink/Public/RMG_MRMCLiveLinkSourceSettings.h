@@ -0,0 +1,160 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformAffinity.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/FrameRate.h"
+
+// Which thread decodes received datagrams and pushes them to LiveLink
+enum class ERMG_MRMCProcessingMode : uint8
+{
+	// Hand every datagram to the game thread before decoding (original behaviour)
+	GameThread,
+	// Decode, convert and push straight from the UDP receive thread
+	ReceiveThread,
+	// Hand only each stream's newest datagram to the game thread, so a hitch never leaves a backlog of
+	// old samples to work through; see FRMG_MRMCPacketMailbox
+	Mailbox,
+};
+
+// Socket layer of the receive thread
+enum class ERMG_MRMCReceiveBackend : uint8
+{
+	// recvmmsg on Linux, FSocket elsewhere
+	Auto,
+	// Portable FSocket Wait/RecvFrom loop
+	Socket,
+	// Linux recvmmsg batching with SO_TIMESTAMPNS kernel receive times
+	RecvMmsg,
+	// Named shared-memory ring written by producers on the same machine, see RMG_MRMCSharedMemoryRing.h
+	SharedMemory,
+};
+
+// Per-source options, round-tripped through the LiveLink connection string.
+// The connection string is "<address>:<port>" optionally followed by Key=Value pairs,
+// e.g. "0.0.0.0:55535 ProcessingMode=ReceiveThread".
+struct RMG_MRMCLIVELINK_API FRMG_MRMCLiveLinkSourceSettings
+{
+	FIPv4Endpoint Endpoint;
+
+	// Further robot streams serviced by the same receive thread. Stream N (counting Endpoint as 0) publishes
+	// the mapping's subjects with an _N suffix, e.g. robot_camera_1.
+	TArray<FIPv4Endpoint> AdditionalEndpoints;
+
+	// Every received datagram is forwarded unchanged to these unicast or multicast endpoints from the receive
+	// thread, e.g. to the render nodes of an nDisplay cluster when the robot can only send to one machine
+	TArray<FIPv4Endpoint> RelayEndpoints;
+
+	// Put a header with the relay's receive time in front of forwarded datagrams, see RMG_MRMCPacketLayout::FRelayHeader
+	bool bRelayAddTimestamp = false;
+
+	// Multicast hop limit of forwarded datagrams
+	int32 RelayTtl = 1;
+
+	// When receiving from a relay, time samples by the relay header instead of the local receive time, so every
+	// node of a cluster agrees on them. Needs clocks synchronized across the cluster, e.g. by PTP.
+	bool bUseRelayTimestamp = false;
+
+	// Subject mapping JSON, relative to the project directory. Empty uses the built-in robot_camera/camera_target mapping.
+	FString MappingFile;
+
+	// Watch MappingFile while the source runs and switch to it when it is saved. Only subjects whose bones
+	// or properties changed are set up again; the others keep streaming.
+	bool bReloadMapping = true;
+
+	// Push subjects the mapping gives a "camera" object (robot_camera in the built-in mapping) with the LiveLink
+	// Camera role: one transform plus field of view, focal length and focus distance, instead of a skeleton
+	// with Roll, Focus and Zoom properties
+	bool bCameraRole = false;
+
+	// Lens calibration JSON, relative to the project directory, see FRMG_MRMCLensProfile. Empty passes the raw
+	// zoom encoder and the camera-to-target distance through as Zoom and Focus.
+	FString LensFile;
+
+	ERMG_MRMCProcessingMode ProcessingMode = ERMG_MRMCProcessingMode::GameThread;
+
+	ERMG_MRMCReceiveBackend Backend = ERMG_MRMCReceiveBackend::Auto;
+
+	// Ring the SharedMemory backend reads; producers write stream N's datagrams with stream index N
+	FString SharedMemoryName;
+
+	// Linux only: spin on the socket instead of sleeping, and ask the driver for SO_BUSY_POLL of this many microseconds. 0 disables.
+	// The SharedMemory backend spins on its ring for any value above 0, on every platform.
+	int32 BusyPollMicroseconds = 0;
+
+	// Priority of the receive thread
+	EThreadPriority ThreadPriority = TPri_AboveNormal;
+
+	// Cores the receive thread may run on, bit N for core N. 0 uses the engine's pool thread mask, which
+	// shares cores with the task graph workers; pin to a core they leave alone for steady receive times.
+	uint64 AffinityMask = 0;
+
+	// Linux only: run the receive thread under SCHED_FIFO at this priority (1 - 99) so render and task
+	// graph threads cannot preempt it. Needs CAP_SYS_NICE or an rtprio limit. 0 keeps normal scheduling.
+	int32 RealtimePriority = 0;
+
+	// Buffer samples and push one frame per engine tick, resampled at the engine frame time, instead of pushing
+	// each packet as it arrives. Packets are then always consumed on the game thread.
+	bool bInterpolate = false;
+
+	// How far behind the engine frame time samples are evaluated, so there is usually a newer sample to blend towards
+	float InterpolationDelayMs = 40.0f;
+
+	// Extrapolate every channel this far ahead with a constant-acceleration Kalman filter to hide the
+	// rig-to-screen latency. 0 disables prediction.
+	float PredictionLeadMs = 0.0f;
+
+	// Filter tuning in channel units (centimeters, degrees): white-jerk spectral density and measurement variance.
+	// Raise the process noise to follow sharp moves, raise the measurement noise to smooth jitter.
+	float PredictionProcessNoise = 1.0e5f;
+	float PredictionMeasurementNoise = 0.01f;
+
+	// Without interpolation, keep pushing frames that continue the last motion for gaps up to this long;
+	// with it, extrapolate the history this far past its newest sample. 0 holds the last pose.
+	float GapFillMs = 0.0f;
+
+	// Rate of the robot's frame counter. Frames from robots that send one get their scene time counted from it
+	// at the project timecode rate instead of read from the clock when they arrive.
+	FFrameRate SampleRate = FFrameRate(50, 1);
+
+	// Fault injection for testing sequence tracking and gap filling: drop, reorder (swap with the next
+	// datagram) and duplicate received datagrams with these probabilities, 0 - 1. Seeded, so a replayed
+	// stream sees the same faults every run.
+	float FaultLoss = 0.0f;
+	float FaultReorder = 0.0f;
+	float FaultDuplicate = 0.0f;
+	int32 FaultSeed = 0;
+
+	// Raw datagrams are appended to this take file when set; relative paths land in Saved/RMG_MRMCLiveLink/Takes
+	FString RecordFile;
+
+	// Take file capacity in minutes of 50 Hz data per stream; the file is preallocated to this size
+	int32 RecordMinutes = 240;
+
+	// Per-stage latency histograms and counters are written to this CSV file every few seconds and when the
+	// source closes; relative paths land in Saved/RMG_MRMCLiveLink/Stats
+	FString StatsFile;
+
+	FRMG_MRMCLiveLinkSourceSettings();
+
+	// Endpoint followed by AdditionalEndpoints, indexed by stream
+	TArray<FIPv4Endpoint> GetEndpoints() const;
+
+	static bool Parse(const FString& ConnectionString, FRMG_MRMCLiveLinkSourceSettings& OutSettings);
+
+	// Names used for ThreadPriority in the connection string, e.g. "AboveNormal"
+	static const TCHAR* GetThreadPriorityName(EThreadPriority Priority);
+	static bool ParseThreadPriority(const FString& Name, EThreadPriority& OutPriority);
+
+	// "2,3" style core lists for AffinityMask
+	static FString AffinityMaskToCoreList(uint64 Mask);
+	static bool ParseCoreList(const FString& CoreList, uint64& OutMask);
+
+	// "50" or "30000/1001" style rates for SampleRate
+	static FString FrameRateToString(const FFrameRate& Rate);
+	static bool ParseFrameRate(const FString& Text, FFrameRate& OutRate);
+
+	FString ToConnectionString() const;
+};
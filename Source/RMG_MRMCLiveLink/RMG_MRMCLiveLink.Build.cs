@@ -1,33 +1,33 @@
-// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
-
-using UnrealBuildTool;
-
-public class RMG_MRMCLiveLink : ModuleRules
-{
-	public RMG_MRMCLiveLink(ReadOnlyTargetRules Target) : base(Target)
-	{
-		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
-
-		PublicDependencyModuleNames.AddRange(
-			new string[]
-			{
-				"Core",
-				"LiveLinkInterface",
-				"Messaging",
-			});
-
-		PrivateDependencyModuleNames.AddRange(
-			new string[]
-			{
-				"CoreUObject",
-				"Engine",
-				"InputCore",
-				"Json",
-				"JsonUtilities",
-				"Networking",
-				"Slate",
-				"SlateCore",
-				"Sockets",
-			});
-	}
-}
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class RMG_MRMCLiveLink : ModuleRules
+{
+	public RMG_MRMCLiveLink(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"LiveLinkInterface",
+				"Messaging",
+				"RMG_MRMCLiveLinkCore",
+			});
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"CoreUObject",
+				"Engine",
+				"InputCore",
+				"JsonUtilities",
+				"Networking",
+				"Slate",
+				"SlateCore",
+				"Sockets",
+			});
+	}
+}
@@ -0,0 +1,122 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCRelay.h"
+
+#if PLATFORM_LINUX
+
+#include "RMG_MRMCPacketDecoder.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define RMG_MRMC_RELAY_SEND_BUFFER_SIZE 256 * 1024
+
+// One non-blocking socket and one prepared mmsghdr per target. Every message gathers the same two iovecs,
+// the header and the datagram where it lies in the receive buffer, so Forward() fills in one pointer and
+// reaches all targets with a single sendmmsg call.
+// MSG_ZEROCOPY is not used: for 44 byte datagrams its completion notifications cost more than the copy.
+class FRMG_MRMCLinuxRelay : public FRMG_MRMCRelay
+{
+public:
+
+	FRMG_MRMCLinuxRelay(const TArray<FIPv4Endpoint>& Targets, bool bInTimestamp, int32 Ttl)
+	: SocketFd(-1)
+	, bTimestamp(bInTimestamp)
+	{
+		SocketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (SocketFd < 0)
+		{
+			return;
+		}
+
+		int SendBufferSize = RMG_MRMC_RELAY_SEND_BUFFER_SIZE;
+		unsigned char Loopback = 1;
+		unsigned char MulticastTtl = static_cast<unsigned char>(Ttl);
+		setsockopt(SocketFd, SOL_SOCKET, SO_SNDBUF, &SendBufferSize, sizeof(SendBufferSize));
+		setsockopt(SocketFd, IPPROTO_IP, IP_MULTICAST_LOOP, &Loopback, sizeof(Loopback));
+		setsockopt(SocketFd, IPPROTO_IP, IP_MULTICAST_TTL, &MulticastTtl, sizeof(MulticastTtl));
+
+		// sized once, the messages point into these arrays
+		Addresses.SetNumZeroed(Targets.Num());
+		Messages.SetNumZeroed(Targets.Num());
+		for (int32 Idx = 0; Idx < Targets.Num(); Idx++)
+		{
+			Addresses[Idx].sin_family = AF_INET;
+			Addresses[Idx].sin_port = htons(Targets[Idx].Port);
+			Addresses[Idx].sin_addr.s_addr = htonl(Targets[Idx].Address.Value);
+
+			msghdr& Header = Messages[Idx].msg_hdr;
+			Header.msg_name = &Addresses[Idx];
+			Header.msg_namelen = sizeof(sockaddr_in);
+			Header.msg_iov = bTimestamp ? Vectors : Vectors + 1;
+			Header.msg_iovlen = bTimestamp ? 2 : 1;
+		}
+		NumTargets = Targets.Num();
+
+		Vectors[0].iov_base = RelayHeader;
+		Vectors[0].iov_len = sizeof(RelayHeader);
+	}
+
+	virtual ~FRMG_MRMCLinuxRelay()
+	{
+		if (SocketFd >= 0)
+		{
+			close(SocketFd);
+		}
+	}
+
+	virtual bool IsValid() const override { return SocketFd >= 0; }
+
+	virtual const TCHAR* GetName() const override { return TEXT("SendMmsg"); }
+
+	virtual int32 Forward(const uint8* Data, int32 Size, double ReceiveSeconds) override
+	{
+		if (bTimestamp)
+		{
+			RMG_MRMCPacketDecoder::WriteRelayHeader(ToUnixNs(ReceiveSeconds), RelayHeader);
+		}
+		Vectors[1].iov_base = const_cast<uint8*>(Data);
+		Vectors[1].iov_len = Size;
+
+		int32 TargetsFailed = 0;
+		int32 Next = 0;
+		while (Next < Messages.Num())
+		{
+			// stops at the first target that fails; skip it and carry on with the rest
+			const int Sent = sendmmsg(SocketFd, Messages.GetData() + Next, Messages.Num() - Next, MSG_DONTWAIT);
+			if (Sent <= 0)
+			{
+				TargetsFailed++;
+				Next++;
+				continue;
+			}
+			Next += Sent;
+		}
+
+		Forwarded++;
+		Failed += TargetsFailed;
+		return TargetsFailed;
+	}
+
+private:
+
+	int SocketFd;
+	bool bTimestamp;
+
+	TArray<sockaddr_in> Addresses;
+	TArray<mmsghdr> Messages;
+
+	// Relay header and the datagram being forwarded; the header is left out without timestamps
+	iovec Vectors[2];
+	uint8 RelayHeader[RMG_MRMCPacketLayout::FRelayHeader::Size];
+};
+
+TUniquePtr<FRMG_MRMCRelay> CreateLinuxRelay(const TArray<FIPv4Endpoint>& Targets, bool bTimestamp, int32 Ttl)
+{
+	return MakeUnique<FRMG_MRMCLinuxRelay>(Targets, bTimestamp, Ttl);
+}
+
+#endif // PLATFORM_LINUX
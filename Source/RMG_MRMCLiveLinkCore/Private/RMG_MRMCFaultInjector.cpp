@@ -0,0 +1,46 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCFaultInjector.h"
+
+FRMG_MRMCFaultInjector::FRMG_MRMCFaultInjector(const FRMG_MRMCFaultOptions& InOptions, int32 NumStreams)
+: Options(InOptions)
+, Random(InOptions.Seed)
+{
+	Held.SetNum(FMath::Max(NumStreams, 1));
+}
+
+void FRMG_MRMCFaultInjector::Process(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds, FSink Sink)
+{
+	FHeldPacket& Slot = Held[Stream];
+
+	if (Random.FRand() < Options.Loss)
+	{
+		Dropped++;
+		return;
+	}
+
+	// hold this one back behind the next, unless a datagram is already waiting or it does not fit
+	if (!Slot.bHeld && Size <= static_cast<int32>(sizeof(Slot.Data)) && Random.FRand() < Options.Reorder)
+	{
+		Slot.bHeld = true;
+		Slot.Size = Size;
+		FMemory::Memcpy(Slot.Data, Data, Size);
+		Reordered++;
+		return;
+	}
+
+	Sink(Stream, Data, Size, ReceiveSeconds);
+
+	if (Random.FRand() < Options.Duplicate)
+	{
+		Sink(Stream, Data, Size, ReceiveSeconds);
+		Duplicated++;
+	}
+
+	if (Slot.bHeld)
+	{
+		// a late datagram is stamped when it finally arrives, like one delayed on the network
+		Slot.bHeld = false;
+		Sink(Stream, Slot.Data, Slot.Size, ReceiveSeconds);
+	}
+}
@@ -0,0 +1,106 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCFrameClock.h"
+#include "RMG_MRMCSequenceTracker.h"
+
+FRMG_MRMCFrameClock::FRMG_MRMCFrameClock(const FFrameRate& InSampleRate)
+: SampleRate(InSampleRate.IsValid() ? InSampleRate : FFrameRate(50, 1))
+, bAnchored(false)
+, AnchorIndex(0)
+, bSecondsAnchored(false)
+, SecondsOffset(0.0)
+, SecondsAnchorIndex(0)
+, bCounting(false)
+, Index(0)
+, LastCounter(0)
+, ReanchorCount(0)
+{
+}
+
+bool FRMG_MRMCFrameClock::Advance(uint32 Counter)
+{
+	bool bJump = false;
+	if (bCounting)
+	{
+		// serial number arithmetic, so the 32-bit counter may wrap
+		const int32 Step = static_cast<int32>(Counter - LastCounter);
+		Index += Step;
+		bJump = Step > RMG_MRMC_SEQUENCE_RESYNC || Step < -RMG_MRMC_SEQUENCE_RESYNC;
+	}
+	bCounting = true;
+	LastCounter = Counter;
+	return bJump;
+}
+
+FFrameTime FRMG_MRMCFrameClock::CountToFrames(int64 Count, const FFrameRate& InSampleRate, const FFrameRate& TimecodeRate)
+{
+	// Count * (TimecodeRate / SampleRate) as an exact fraction; a day of 50 Hz samples at 60000/1001 stays far below 2^63
+	const int64 Numerator = Count * int64(TimecodeRate.Numerator) * int64(InSampleRate.Denominator);
+	const int64 Denominator = int64(TimecodeRate.Denominator) * int64(InSampleRate.Numerator);
+
+	int64 Whole = Numerator / Denominator;
+	int64 Remainder = Numerator % Denominator;
+	if (Remainder < 0)
+	{
+		Whole--;
+		Remainder += Denominator;
+	}
+
+	const float SubFrame = FMath::Min(static_cast<float>(double(Remainder) / double(Denominator)), FFrameTime::MaxSubframe);
+	return FFrameTime(FFrameNumber(static_cast<int32>(Whole)), SubFrame);
+}
+
+FQualifiedFrameTime FRMG_MRMCFrameClock::Evaluate(uint32 Counter, const FFrameTime& Reference, const FFrameRate& TimecodeRate, bool bReferenceIsTimecode)
+{
+	bool bReanchor = !bAnchored || TimecodeRate != AnchorRate;
+	bReanchor |= Advance(Counter);
+
+	FFrameTime Time;
+	if (!bReanchor)
+	{
+		Time = AnchorTime + CountToFrames(Index - AnchorIndex, SampleRate, TimecodeRate);
+
+		// the anchor sits somewhere inside its frame, so counted and sent timecode may differ by under a frame
+		if (bReferenceIsTimecode)
+		{
+			const double Difference = (Time - Reference).AsDecimal();
+			bReanchor = Difference <= -1.0 || Difference >= 1.0;
+		}
+	}
+
+	if (bReanchor)
+	{
+		ReanchorCount += bAnchored ? 1 : 0;
+		bAnchored = true;
+		AnchorRate = TimecodeRate;
+		AnchorTime = Reference;
+		AnchorIndex = Index;
+		Time = Reference;
+	}
+
+	return FQualifiedFrameTime(Time, TimecodeRate);
+}
+
+double FRMG_MRMCFrameClock::EvaluateSeconds(uint32 Counter, double ReceiveSeconds)
+{
+	const bool bJump = Advance(Counter);
+	const double Counted = double(Index - SecondsAnchorIndex) * SampleRate.Denominator / SampleRate.Numerator;
+	const double Offset = ReceiveSeconds - Counted;
+
+	// a counter that runs at another rate than SampleRate falls behind the receive clock for good
+	if (!bSecondsAnchored || bJump || Offset - SecondsOffset > 1.0)
+	{
+		ReanchorCount += bSecondsAnchored ? 1 : 0;
+		bSecondsAnchored = true;
+		SecondsOffset = ReceiveSeconds;
+		SecondsAnchorIndex = Index;
+		return ReceiveSeconds;
+	}
+
+	// a datagram is only ever delayed, so the quickest ones tell best when samples were sent. Moving an eighth
+	// of the way towards a quicker one keeps a single lucky datagram from stepping the keys, and creeping
+	// towards slower ones by 0.1% of the counted time follows drift between the two clocks.
+	const double MaxCreep = 0.001 * SampleRate.AsInterval();
+	SecondsOffset = Offset < SecondsOffset ? SecondsOffset + (Offset - SecondsOffset) * 0.125 : FMath::Min(Offset, SecondsOffset + MaxCreep);
+	return SecondsOffset + Counted;
+}
@@ -0,0 +1,250 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCLensProfile.h"
+#include "Json.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Lookup tables may deviate from their curve by this fraction of the value, 0.006 cm at a 60 cm focus distance.
+// Near zero, as distortion coefficients are, the error is taken relative to a hundredth of the curve's range.
+static const float LutRelativeTolerance = 1e-4f;
+static const float NearZeroFraction = 0.01f;
+
+static const int32 MinLutEntries = 256;
+static const int32 MaxLutEntries = 65536;
+
+bool FRMG_MRMCLensCurve::Set(const TArray<FVector2D>& InPoints, FString& OutError)
+{
+	for (int32 Idx = 1; Idx < InPoints.Num(); Idx++)
+	{
+		if (!(InPoints[Idx].X > InPoints[Idx - 1].X))
+		{
+			OutError = FString::Printf(TEXT("encoder values must increase, %g follows %g"), InPoints[Idx].X, InPoints[Idx - 1].X);
+			return false;
+		}
+	}
+
+	Points = InPoints;
+	Tangents.SetNumZeroed(Points.Num());
+
+	const int32 NumSegments = Points.Num() - 1;
+	if (NumSegments < 1)
+	{
+		return true;
+	}
+
+	// Fritsch-Butland tangents: a weighted harmonic mean of the neighbouring slopes, zero at local extrema
+	TArray<float> Slopes;
+	Slopes.SetNumUninitialized(NumSegments);
+	for (int32 Seg = 0; Seg < NumSegments; Seg++)
+	{
+		Slopes[Seg] = (Points[Seg + 1].Y - Points[Seg].Y) / (Points[Seg + 1].X - Points[Seg].X);
+	}
+
+	Tangents[0] = Slopes[0];
+	Tangents[NumSegments] = Slopes[NumSegments - 1];
+	for (int32 Idx = 1; Idx < NumSegments; Idx++)
+	{
+		const float Before = Slopes[Idx - 1];
+		const float After = Slopes[Idx];
+		if (Before * After <= 0.0f)
+		{
+			continue;
+		}
+		const float WidthBefore = Points[Idx].X - Points[Idx - 1].X;
+		const float WidthAfter = Points[Idx + 1].X - Points[Idx].X;
+		Tangents[Idx] = 3.0f * (WidthBefore + WidthAfter) / ((2.0f * WidthAfter + WidthBefore) / Before + (WidthAfter + 2.0f * WidthBefore) / After);
+	}
+	return true;
+}
+
+float FRMG_MRMCLensCurve::Evaluate(float Input) const
+{
+	if (Points.Num() == 0)
+	{
+		return 0.0f;
+	}
+	if (!(Input > Points[0].X))
+	{
+		return Points[0].Y;
+	}
+	if (Input >= Points.Last().X)
+	{
+		return Points.Last().Y;
+	}
+
+	// last point at or below Input
+	int32 Low = 0;
+	int32 High = Points.Num() - 1;
+	while (High - Low > 1)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Points[Mid].X <= Input)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	const float Width = Points[High].X - Points[Low].X;
+	const float T = (Input - Points[Low].X) / Width;
+	const float T2 = T * T;
+	const float T3 = T2 * T;
+	return (2.0f * T3 - 3.0f * T2 + 1.0f) * Points[Low].Y
+		+ (T3 - 2.0f * T2 + T) * Width * Tangents[Low]
+		+ (-2.0f * T3 + 3.0f * T2) * Points[High].Y
+		+ (T3 - T2) * Width * Tangents[High];
+}
+
+float FRMG_MRMCLensLut::Build(const FRMG_MRMCLensCurve& Curve, float RelativeTolerance)
+{
+	Table.Reset();
+	if (Curve.IsEmpty())
+	{
+		return 0.0f;
+	}
+
+	const float Range = Curve.GetMaxInput() - Curve.GetMinInput();
+	InputMin = Curve.GetMinInput();
+
+	float Error = 0.0f;
+	for (int32 NumEntries = MinLutEntries; NumEntries <= MaxLutEntries; NumEntries *= 2)
+	{
+		// a single point is a constant, one segment of two equal entries covers it
+		const int32 Segments = Range > 0.0f ? NumEntries : 1;
+		InputScale = Range > 0.0f ? Segments / Range : 0.0f;
+		MaxPosition = static_cast<float>(Segments);
+
+		Table.SetNumUninitialized(Segments + 2);
+		for (int32 Idx = 0; Idx <= Segments; Idx++)
+		{
+			Table[Idx] = Curve.Evaluate(InputMin + Range * Idx / Segments);
+		}
+		Table[Segments + 1] = Table[Segments];
+
+		const float ValueRange = FMath::Max(Table) - FMath::Min(Table);
+		Error = MeasureError(Curve, FMath::Max(ValueRange * NearZeroFraction, SMALL_NUMBER));
+		if (Error <= RelativeTolerance || Range <= 0.0f)
+		{
+			break;
+		}
+	}
+	return Error;
+}
+
+float FRMG_MRMCLensLut::MeasureError(const FRMG_MRMCLensCurve& Curve, float Floor) const
+{
+	const int32 Segments = Num();
+	const float Range = Curve.GetMaxInput() - Curve.GetMinInput();
+
+	float Error = 0.0f;
+	for (int32 Idx = 0; Idx < Segments; Idx++)
+	{
+		const float Input = InputMin + Range * (Idx + 0.5f) / Segments;
+		const float Expected = Curve.Evaluate(Input);
+		Error = FMath::Max(Error, FMath::Abs(Evaluate(Input) - Expected) / FMath::Max(FMath::Abs(Expected), Floor));
+	}
+	return Error;
+}
+
+static bool CompileCurve(const TSharedPtr<FJsonObject>& Group, const TCHAR* GroupName, const TCHAR* CurveName, FRMG_MRMCLensLut& OutLut, float& OutLutError, FString& OutError)
+{
+	if (!Group.IsValid() || !Group->HasField(CurveName))
+	{
+		return true;
+	}
+	const TArray<TSharedPtr<FJsonValue>>* PointArray = nullptr;
+	if (!Group->TryGetArrayField(CurveName, PointArray))
+	{
+		OutError = FString::Printf(TEXT("%s.%s: must be a list of [encoder, value] points"), GroupName, CurveName);
+		return false;
+	}
+
+	TArray<FVector2D> Points;
+	for (const TSharedPtr<FJsonValue>& PointValue : *PointArray)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Pair = nullptr;
+		double Encoder = 0.0;
+		double Value = 0.0;
+		if (!PointValue->TryGetArray(Pair) || Pair->Num() != 2 || !(*Pair)[0]->TryGetNumber(Encoder) || !(*Pair)[1]->TryGetNumber(Value))
+		{
+			OutError = FString::Printf(TEXT("%s.%s: points must be [encoder, value] pairs of numbers"), GroupName, CurveName);
+			return false;
+		}
+		Points.Add(FVector2D(static_cast<float>(Encoder), static_cast<float>(Value)));
+	}
+	if (Points.Num() == 0)
+	{
+		return true;
+	}
+
+	// only the table is kept, the curve is needed just to fill it
+	FRMG_MRMCLensCurve Curve;
+	FString CurveError;
+	if (!Curve.Set(Points, CurveError))
+	{
+		OutError = FString::Printf(TEXT("%s.%s: %s"), GroupName, CurveName, *CurveError);
+		return false;
+	}
+
+	OutLutError = OutLut.Build(Curve, LutRelativeTolerance);
+	return true;
+}
+
+bool FRMG_MRMCLensProfile::Compile(const FString& JsonString, FRMG_MRMCLensProfile& OutProfile, FString& OutError)
+{
+	OutProfile = FRMG_MRMCLensProfile();
+
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	{
+		OutError = FString::Printf(TEXT("invalid JSON: %s"), *Reader->GetErrorMessage());
+		return false;
+	}
+
+	JsonObject->TryGetStringField(TEXT("name"), OutProfile.Name);
+
+	const TSharedPtr<FJsonObject>* Zoom = nullptr;
+	const TSharedPtr<FJsonObject>* Focus = nullptr;
+	if ((!JsonObject->TryGetObjectField(TEXT("zoom"), Zoom) && JsonObject->HasField(TEXT("zoom")))
+		|| (!JsonObject->TryGetObjectField(TEXT("focus"), Focus) && JsonObject->HasField(TEXT("focus"))))
+	{
+		OutError = TEXT("zoom and focus must be objects of curves");
+		return false;
+	}
+	const TSharedPtr<FJsonObject> ZoomGroup = Zoom != nullptr ? *Zoom : nullptr;
+	const TSharedPtr<FJsonObject> FocusGroup = Focus != nullptr ? *Focus : nullptr;
+
+	if (!CompileCurve(ZoomGroup, TEXT("zoom"), TEXT("focalLength"), OutProfile.FocalLength, OutProfile.FocalLengthError, OutError)
+		|| !CompileCurve(ZoomGroup, TEXT("zoom"), TEXT("k1"), OutProfile.K1, OutProfile.K1Error, OutError)
+		|| !CompileCurve(ZoomGroup, TEXT("zoom"), TEXT("k2"), OutProfile.K2, OutProfile.K2Error, OutError)
+		|| !CompileCurve(FocusGroup, TEXT("focus"), TEXT("distance"), OutProfile.FocusDistance, OutProfile.FocusDistanceError, OutError))
+	{
+		// no half-applied lens: the curves compiled before the bad one are dropped too
+		OutProfile = FRMG_MRMCLensProfile();
+		return false;
+	}
+
+	if (OutProfile.IsEmpty())
+	{
+		OutError = TEXT("no zoom.focalLength, zoom.k1, zoom.k2 or focus.distance curve");
+		return false;
+	}
+	return true;
+}
+
+bool FRMG_MRMCLensProfile::Load(const FString& LensFile, FRMG_MRMCLensProfile& OutProfile, FString& OutError)
+{
+	const FString FullPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), LensFile);
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *FullPath))
+	{
+		OutError = FString::Printf(TEXT("cannot read lens file %s"), *FullPath);
+		return false;
+	}
+	return Compile(JsonString, OutProfile, OutError);
+}
@@ -0,0 +1,79 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCPacketDecoder.h"
+
+using namespace RMG_MRMCPacketLayout;
+
+bool RMG_MRMCPacketDecoder::Decode(const uint8* Data, int32 Size, FRMG_MRMCDecodedPacket& OutPacket)
+{
+	switch (Size)
+	{
+	case FBasic::Size:
+		ReadSample<FBasic>(Data, OutPacket.Robot);
+		OutPacket.Variant = FBasic::Variant;
+		OutPacket.FrameCounter = 0;
+		OutPacket.Timecode = 0;
+		return true;
+
+	case FWithFrameCounter::Size:
+		ReadSample<FWithFrameCounter>(Data, OutPacket.Robot);
+		OutPacket.Variant = FWithFrameCounter::Variant;
+		OutPacket.FrameCounter = FWithFrameCounter::FrameCounter::Read(Data);
+		OutPacket.Timecode = 0;
+		return true;
+
+	case FWithTimecode::Size:
+		ReadSample<FWithTimecode>(Data, OutPacket.Robot);
+		OutPacket.Variant = FWithTimecode::Variant;
+		OutPacket.FrameCounter = FWithTimecode::FrameCounter::Read(Data);
+		OutPacket.Timecode = FWithTimecode::Timecode::Read(Data);
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+int32 RMG_MRMCPacketDecoder::Encode(const FRMG_MRMCDecodedPacket& Packet, uint8* Data)
+{
+	switch (Packet.Variant)
+	{
+	case ERMG_MRMCPacketVariant::FrameCounter:
+		WriteSample<FWithFrameCounter>(Packet.Robot, Data);
+		FWithFrameCounter::FrameCounter::Write(Packet.FrameCounter, Data);
+		return FWithFrameCounter::Size;
+
+	case ERMG_MRMCPacketVariant::Timecode:
+		WriteSample<FWithTimecode>(Packet.Robot, Data);
+		FWithTimecode::FrameCounter::Write(Packet.FrameCounter, Data);
+		FWithTimecode::Timecode::Write(Packet.Timecode, Data);
+		return FWithTimecode::Size;
+
+	default:
+		WriteSample<FBasic>(Packet.Robot, Data);
+		return FBasic::Size;
+	}
+}
+
+void RMG_MRMCPacketDecoder::WriteRelayHeader(int64 ReceiveUnixNs, uint8* Header)
+{
+	FRelayHeader::Magic::Write(FRelayHeader::MagicValue, Header);
+	FRelayHeader::Version::Write(FRelayHeader::VersionValue, Header);
+	FRelayHeader::ReceiveNsLow::Write(static_cast<uint32>(uint64(ReceiveUnixNs)), Header);
+	FRelayHeader::ReceiveNsHigh::Write(static_cast<uint32>(uint64(ReceiveUnixNs) >> 32), Header);
+}
+
+bool RMG_MRMCPacketDecoder::StripRelayHeader(const uint8*& Data, int32& Size, int64& OutReceiveUnixNs)
+{
+	// plain datagrams are shorter than a header plus the smallest sample, so they are never mistaken for relayed ones
+	if (Size < FRelayHeader::Size + FBasic::Size || FRelayHeader::Magic::Read(Data) != FRelayHeader::MagicValue
+		|| FRelayHeader::Version::Read(Data) != FRelayHeader::VersionValue)
+	{
+		return false;
+	}
+
+	OutReceiveUnixNs = static_cast<int64>(uint64(FRelayHeader::ReceiveNsLow::Read(Data)) | uint64(FRelayHeader::ReceiveNsHigh::Read(Data)) << 32);
+	Data += FRelayHeader::Size;
+	Size -= FRelayHeader::Size;
+	return true;
+}
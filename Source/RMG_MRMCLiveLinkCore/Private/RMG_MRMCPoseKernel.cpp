@@ -0,0 +1,171 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCPoseKernel.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	const VectorRegister SignBitMask = MakeVectorRegister((uint32)0x80000000, (uint32)0x80000000, (uint32)0x80000000, (uint32)0x80000000);
+	const VectorRegister AbsMask = MakeVectorRegister((uint32)0x7fffffff, (uint32)0x7fffffff, (uint32)0x7fffffff, (uint32)0x7fffffff);
+
+	const VectorRegister VZero = MakeVectorRegister(0.0f, 0.0f, 0.0f, 0.0f);
+	// small enough to vanish in centimeter data, large enough that the reciprocal refinement cannot overflow
+	const VectorRegister VTiny = MakeVectorRegister(1e-18f, 1e-18f, 1e-18f, 1e-18f);
+	const VectorRegister VPi = MakeVectorRegister(PI, PI, PI, PI);
+	const VectorRegister VHalfPi = MakeVectorRegister(HALF_PI, HALF_PI, HALF_PI, HALF_PI);
+	const VectorRegister VRadToDeg = MakeVectorRegister(180.0f / PI, 180.0f / PI, 180.0f / PI, 180.0f / PI);
+	const VectorRegister VNegRadToDeg = MakeVectorRegister(-180.0f / PI, -180.0f / PI, -180.0f / PI, -180.0f / PI);
+
+	const float METER2CENT = 100.0f;
+	const VectorRegister VMeterToCent = MakeVectorRegister(METER2CENT, METER2CENT, METER2CENT, METER2CENT);
+	const VectorRegister VFlipMeterToCent = MakeVectorRegister(-METER2CENT, -METER2CENT, -METER2CENT, -METER2CENT);
+
+	// Abramowitz & Stegun 4.4.49, atan(a) on [0, 1] with |error| <= 2e-8
+	const VectorRegister C1 = MakeVectorRegister(0.9999993329f, 0.9999993329f, 0.9999993329f, 0.9999993329f);
+	const VectorRegister C3 = MakeVectorRegister(-0.3332985605f, -0.3332985605f, -0.3332985605f, -0.3332985605f);
+	const VectorRegister C5 = MakeVectorRegister(0.1994653599f, 0.1994653599f, 0.1994653599f, 0.1994653599f);
+	const VectorRegister C7 = MakeVectorRegister(-0.1390853351f, -0.1390853351f, -0.1390853351f, -0.1390853351f);
+	const VectorRegister C9 = MakeVectorRegister(0.0964200441f, 0.0964200441f, 0.0964200441f, 0.0964200441f);
+	const VectorRegister C11 = MakeVectorRegister(-0.0559098861f, -0.0559098861f, -0.0559098861f, -0.0559098861f);
+	const VectorRegister C13 = MakeVectorRegister(0.0218612288f, 0.0218612288f, 0.0218612288f, 0.0218612288f);
+	const VectorRegister C15 = MakeVectorRegister(-0.0040540580f, -0.0040540580f, -0.0040540580f, -0.0040540580f);
+
+	enum EInput
+	{
+		InXv, InYv, InZv, InXt, InYt, InZt, InRoll, InFocus, InZoom, InNum
+	};
+
+	// Branch-free atan2: reduce to atan(min/max) on [0, 1], then fix up the octant and sign with masks
+	FORCEINLINE VectorRegister VectorATan2Approx(const VectorRegister& Y, const VectorRegister& X)
+	{
+		const VectorRegister AbsX = VectorBitwiseAnd(X, AbsMask);
+		const VectorRegister AbsY = VectorBitwiseAnd(Y, AbsMask);
+		const VectorRegister Min = VectorMin(AbsX, AbsY);
+		const VectorRegister Max = VectorMax(VectorMax(AbsX, AbsY), VTiny);
+		const VectorRegister A = VectorMultiply(Min, VectorReciprocalAccurate(Max));
+		const VectorRegister S = VectorMultiply(A, A);
+
+		VectorRegister P = VectorMultiplyAdd(C15, S, C13);
+		P = VectorMultiplyAdd(P, S, C11);
+		P = VectorMultiplyAdd(P, S, C9);
+		P = VectorMultiplyAdd(P, S, C7);
+		P = VectorMultiplyAdd(P, S, C5);
+		P = VectorMultiplyAdd(P, S, C3);
+		P = VectorMultiplyAdd(P, S, C1);
+		VectorRegister R = VectorMultiply(P, A);
+
+		R = VectorSelect(VectorCompareGT(AbsY, AbsX), VectorSubtract(VHalfPi, R), R);
+		R = VectorSelect(VectorCompareLT(X, VZero), VectorSubtract(VPi, R), R);
+		return VectorBitwiseOr(R, VectorBitwiseAnd(Y, SignBitMask));
+	}
+
+	// sqrt through the reciprocal square root; the clamp keeps sqrt(0) at 0 instead of 0 * inf
+	FORCEINLINE VectorRegister VectorSqrtApprox(const VectorRegister& V)
+	{
+		return VectorMultiply(V, VectorReciprocalSqrtAccurate(VectorMax(V, VTiny)));
+	}
+
+	FORCEINLINE void ConvertBlock(const VectorRegister (&In)[InNum], VectorRegister (&Out)[RMG_MRMCChannel::Num])
+	{
+		// adjust Robot_data for different coord system, flip Y axis
+		const VectorRegister PoseX = VectorMultiply(In[InXv], VMeterToCent);
+		const VectorRegister PoseY = VectorMultiply(In[InYv], VFlipMeterToCent);
+		const VectorRegister PoseZ = VectorMultiply(In[InZv], VMeterToCent);
+		const VectorRegister TargetX = VectorMultiply(In[InXt], VMeterToCent);
+		const VectorRegister TargetY = VectorMultiply(In[InYt], VFlipMeterToCent);
+		const VectorRegister TargetZ = VectorMultiply(In[InZt], VMeterToCent);
+
+		const VectorRegister LookAtX = VectorSubtract(TargetX, PoseX);
+		const VectorRegister LookAtY = VectorSubtract(TargetY, PoseY);
+		const VectorRegister LookAtZ = VectorSubtract(TargetZ, PoseZ);
+
+		const VectorRegister PlanarSizeSquared = VectorMultiplyAdd(LookAtY, LookAtY, VectorMultiply(LookAtX, LookAtX));
+		const VectorRegister SizeSquared = VectorMultiplyAdd(LookAtZ, LookAtZ, PlanarSizeSquared);
+
+		Out[RMG_MRMCChannel::CameraPoseX] = PoseX;
+		Out[RMG_MRMCChannel::CameraPoseY] = PoseY;
+		Out[RMG_MRMCChannel::CameraPoseZ] = PoseZ;
+		// roll is xrot, tilt is yrot, pan is zrot; roll is reversed for UE
+		Out[RMG_MRMCChannel::RollDegrees] = VectorMultiply(In[InRoll], VNegRadToDeg);
+		Out[RMG_MRMCChannel::Tilt] = VectorMultiply(VectorATan2Approx(LookAtZ, VectorSqrtApprox(PlanarSizeSquared)), VRadToDeg);
+		Out[RMG_MRMCChannel::Pan] = VectorMultiply(VectorATan2Approx(LookAtY, LookAtX), VRadToDeg);
+		Out[RMG_MRMCChannel::Roll] = In[InRoll];
+		// use LookAt because Robot focus distance is wrong
+		Out[RMG_MRMCChannel::Focus] = VectorSqrtApprox(SizeSquared);
+		Out[RMG_MRMCChannel::Zoom] = In[InZoom];
+		Out[RMG_MRMCChannel::CameraTargetX] = TargetX;
+		Out[RMG_MRMCChannel::CameraTargetY] = TargetY;
+		Out[RMG_MRMCChannel::CameraTargetZ] = TargetZ;
+		// only a lens profile knows the distortion
+		Out[RMG_MRMCChannel::DistortionK1] = VZero;
+		Out[RMG_MRMCChannel::DistortionK2] = VZero;
+	}
+}
+
+void RMG_MRMCPoseKernel::ConvertSamples(const FRMG_MRMCRobotSamples& Samples, FRMG_MRMCChannelPlanes& OutPlanes)
+{
+	const float* InPlanes[InNum] = { Samples.Xv, Samples.Yv, Samples.Zv, Samples.Xt, Samples.Yt, Samples.Zt, Samples.Roll, Samples.Focus, Samples.Zoom };
+
+	VectorRegister In[InNum];
+	VectorRegister Out[RMG_MRMCChannel::Num];
+
+	int32 Idx = 0;
+	for (; Idx + 4 <= Samples.Num; Idx += 4)
+	{
+		for (int32 Field = 0; Field < InNum; Field++)
+		{
+			In[Field] = VectorLoad(InPlanes[Field] + Idx);
+		}
+		ConvertBlock(In, Out);
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			VectorStore(Out[Channel], OutPlanes.Channels[Channel] + Idx);
+		}
+	}
+
+	// remaining 1-3 samples go through the same block, zero padded
+	const int32 Remaining = Samples.Num - Idx;
+	if (Remaining > 0)
+	{
+		float Lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int32 Field = 0; Field < InNum; Field++)
+		{
+			FMemory::Memcpy(Lanes, InPlanes[Field] + Idx, Remaining * sizeof(float));
+			In[Field] = VectorLoad(Lanes);
+		}
+		ConvertBlock(In, Out);
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			VectorStore(Out[Channel], Lanes);
+			FMemory::Memcpy(OutPlanes.Channels[Channel] + Idx, Lanes, Remaining * sizeof(float));
+		}
+	}
+}
+
+void RMG_MRMCPoseKernel::ConvertSample(const RobotData& Sample, float* OutValues)
+{
+	const float* Fields = &Sample.xv;
+	static_assert(sizeof(RobotData) == InNum * sizeof(float), "RobotData must stay nine packed floats");
+
+	VectorRegister In[InNum];
+	VectorRegister Out[RMG_MRMCChannel::Num];
+	for (int32 Field = 0; Field < InNum; Field++)
+	{
+		In[Field] = VectorLoadFloat1(Fields + Field);
+	}
+	ConvertBlock(In, Out);
+
+	float Lanes[4];
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		VectorStore(Out[Channel], Lanes);
+		OutValues[Channel] = Lanes[0];
+	}
+}
+
+float RMG_MRMCPoseKernel::ATan2(float Y, float X)
+{
+	float Lanes[4];
+	VectorStore(VectorATan2Approx(VectorSetFloat1(Y), VectorSetFloat1(X)), Lanes);
+	return Lanes[0];
+}
@@ -0,0 +1,257 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCPredictor.h"
+
+namespace
+{
+	// Wrap period of each channel, zero for linear channels. Pan and roll jump at +-180 degrees,
+	// the raw roll at +-pi; tilt never leaves [-90, 90].
+	const double ChannelPeriod[RMG_MRMCChannel::Num] =
+	{
+		0.0, 0.0, 0.0,        // CameraPose
+		360.0, 0.0, 360.0,    // RollDegrees, Tilt, Pan
+		2.0 * PI, 0.0, 0.0,   // Roll, Focus, Zoom
+		0.0, 0.0, 0.0,        // CameraTarget
+		0.0, 0.0              // DistortionK1, DistortionK2
+	};
+
+	// A gap this long means the robot stopped streaming, the old velocity is meaningless
+	const double MaxDeltaSeconds = 0.5;
+
+	// Initial uncertainty of the unobserved velocity and acceleration
+	const double InitialVariance = 1e6;
+
+	// Weight of the newest error in the smoothed lead error, roughly a hundred sample window
+	const float LeadErrorSmoothing = 0.01f;
+
+	const int32 MaxPendingPredictions = 64;
+
+	FORCEINLINE double WrapChannel(int32 Channel, double Value)
+	{
+		const double Period = ChannelPeriod[Channel];
+		if (Period > 0.0)
+		{
+			Value -= Period * FMath::RoundToDouble(Value / Period);
+		}
+		return Value;
+	}
+}
+
+FRMG_MRMCPredictor::FRMG_MRMCPredictor(float InLeadSeconds, float InProcessNoise, float InMeasurementNoise)
+: LeadSeconds(InLeadSeconds)
+, ProcessNoise(InProcessNoise)
+, MeasurementNoise(FMath::Max(InMeasurementNoise, 1e-6f))
+{
+	Pending.SetNumZeroed(MaxPendingPredictions);
+	Reset();
+}
+
+void FRMG_MRMCPredictor::Reset()
+{
+	FMemory::Memzero(Channels, sizeof(Channels));
+	FMemory::Memzero(LastValues, sizeof(LastValues));
+	FMemory::Memzero(LeadErrorMeanSquared, sizeof(LeadErrorMeanSquared));
+	LastSeconds = 0.0;
+	NumSamples = 0;
+	PendingFirst = 0;
+	PendingCount = 0;
+}
+
+void FRMG_MRMCPredictor::Process(double Seconds, float* Values)
+{
+	const double DeltaSeconds = Seconds - LastSeconds;
+	const bool bRestart = NumSamples == 0 || DeltaSeconds > MaxDeltaSeconds || DeltaSeconds < -MaxDeltaSeconds;
+
+	if (bRestart)
+	{
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			FChannelState& State = Channels[Channel];
+			FMemory::Memzero(State);
+			State.X[0] = Values[Channel];
+			State.P[0][0] = MeasurementNoise;
+			State.P[1][1] = InitialVariance;
+			State.P[2][2] = InitialVariance;
+		}
+		PendingCount = 0;
+		NumSamples = 0;
+	}
+	else
+	{
+		ScoreDuePredictions(Seconds, Values);
+		// a reordered datagram is still a measurement, it just does not advance time
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			UpdateChannel(Channel, FMath::Max(DeltaSeconds, 0.0), Values[Channel]);
+		}
+	}
+
+	if (DeltaSeconds >= 0.0 || bRestart)
+	{
+		LastSeconds = Seconds;
+		FMemory::Memcpy(LastValues, Values, sizeof(LastValues));
+	}
+	NumSamples++;
+
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		Values[Channel] = static_cast<float>(PredictChannel(Channel, LeadSeconds));
+	}
+
+	if (LeadSeconds > 0.0f)
+	{
+		if (PendingCount == Pending.Num())
+		{
+			PendingFirst = (PendingFirst + 1) % Pending.Num();
+			PendingCount--;
+		}
+		FPendingPrediction& Prediction = Pending[(PendingFirst + PendingCount) % Pending.Num()];
+		Prediction.TargetSeconds = Seconds + LeadSeconds;
+		FMemory::Memcpy(Prediction.Values, Values, sizeof(Prediction.Values));
+		PendingCount++;
+	}
+}
+
+bool FRMG_MRMCPredictor::IsCovarianceValid() const
+{
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		const double (&P)[3][3] = Channels[Channel].P;
+		const double Scale = FMath::Max3(FMath::Abs(P[0][0]), FMath::Abs(P[1][1]), FMath::Abs(P[2][2]));
+		const double Tolerance = FMath::Max(Scale * 1e-9, 1e-300);
+
+		// Cholesky with a rounding allowance: a pivot below -Tolerance means a negative eigenvalue
+		double L[3][3] = {};
+		for (int32 Row = 0; Row < 3; Row++)
+		{
+			for (int32 Col = 0; Col < Row; Col++)
+			{
+				if (FMath::Abs(P[Row][Col] - P[Col][Row]) > Tolerance)
+				{
+					return false;
+				}
+			}
+			for (int32 Col = 0; Col <= Row; Col++)
+			{
+				double Sum = P[Row][Col];
+				for (int32 K = 0; K < Col; K++)
+				{
+					Sum -= L[Row][K] * L[Col][K];
+				}
+				if (Col < Row)
+				{
+					L[Row][Col] = L[Col][Col] > 0.0 ? Sum / L[Col][Col] : 0.0;
+				}
+				else if (Sum < -Tolerance)
+				{
+					return false;
+				}
+				else
+				{
+					L[Row][Row] = FMath::Sqrt(FMath::Max(Sum, 0.0));
+				}
+			}
+		}
+	}
+	return true;
+}
+
+float FRMG_MRMCPredictor::WrapDifference(int32 Channel, float Difference)
+{
+	return static_cast<float>(WrapChannel(Channel, Difference));
+}
+
+void FRMG_MRMCPredictor::UpdateChannel(int32 Channel, double Dt, double Measurement)
+{
+	FChannelState& State = Channels[Channel];
+	double (&X)[3] = State.X;
+	double (&P)[3][3] = State.P;
+
+	// predict: x = F x, P = F P F' + Q with F the constant-acceleration transition
+	const double Dt2 = Dt * Dt / 2.0;
+	X[0] += X[1] * Dt + X[2] * Dt2;
+	X[1] += X[2] * Dt;
+
+	double FP[3][3];
+	for (int32 Col = 0; Col < 3; Col++)
+	{
+		FP[0][Col] = P[0][Col] + Dt * P[1][Col] + Dt2 * P[2][Col];
+		FP[1][Col] = P[1][Col] + Dt * P[2][Col];
+		FP[2][Col] = P[2][Col];
+	}
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		P[Row][0] = FP[Row][0] + Dt * FP[Row][1] + Dt2 * FP[Row][2];
+		P[Row][1] = FP[Row][1] + Dt * FP[Row][2];
+		P[Row][2] = FP[Row][2];
+	}
+
+	// white jerk process noise, q * [dt^5/20 dt^4/8 dt^3/6; dt^4/8 dt^3/3 dt^2/2; dt^3/6 dt^2/2 dt]
+	const double Dt3 = Dt2 * Dt;
+	const double Q = ProcessNoise;
+	P[0][0] += Q * Dt3 * Dt2 / 5.0;
+	P[0][1] += Q * Dt2 * Dt2 / 2.0;
+	P[1][0] += Q * Dt2 * Dt2 / 2.0;
+	P[0][2] += Q * Dt3 / 3.0;
+	P[2][0] += Q * Dt3 / 3.0;
+	P[1][1] += Q * Dt3 * 2.0 / 3.0;
+	P[1][2] += Q * Dt2;
+	P[2][1] += Q * Dt2;
+	P[2][2] += Q * Dt;
+
+	// update with the position measurement, innovation taken the short way round for angles
+	const double Innovation = WrapChannel(Channel, Measurement - X[0]);
+	const double S = P[0][0] + MeasurementNoise;
+	const double K[3] = { P[0][0] / S, P[1][0] / S, P[2][0] / S };
+
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		X[Row] += K[Row] * Innovation;
+	}
+	const double P0[3] = { P[0][0], P[0][1], P[0][2] };
+	for (int32 Row = 0; Row < 3; Row++)
+	{
+		for (int32 Col = 0; Col < 3; Col++)
+		{
+			P[Row][Col] -= K[Row] * P0[Col];
+		}
+	}
+
+	X[0] = WrapChannel(Channel, X[0]);
+}
+
+double FRMG_MRMCPredictor::PredictChannel(int32 Channel, double Lead) const
+{
+	const double (&X)[3] = Channels[Channel].X;
+	return WrapChannel(Channel, X[0] + X[1] * Lead + X[2] * Lead * Lead / 2.0);
+}
+
+void FRMG_MRMCPredictor::ScoreDuePredictions(double Seconds, const float* Values)
+{
+	const double Span = Seconds - LastSeconds;
+	if (Span <= 0.0)
+	{
+		return;
+	}
+
+	// compare each prediction against the robot's reported value at the target time, interpolated between samples
+	while (PendingCount > 0)
+	{
+		const FPendingPrediction& Prediction = Pending[PendingFirst];
+		if (Prediction.TargetSeconds > Seconds)
+		{
+			break;
+		}
+
+		const double Alpha = FMath::Max((Prediction.TargetSeconds - LastSeconds) / Span, 0.0);
+		for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+		{
+			const double Truth = LastValues[Channel] + Alpha * WrapChannel(Channel, Values[Channel] - LastValues[Channel]);
+			const float Error = static_cast<float>(WrapChannel(Channel, Prediction.Values[Channel] - Truth));
+			LeadErrorMeanSquared[Channel] = FMath::Lerp(LeadErrorMeanSquared[Channel], Error * Error, LeadErrorSmoothing);
+		}
+
+		PendingFirst = (PendingFirst + 1) % Pending.Num();
+		PendingCount--;
+	}
+}
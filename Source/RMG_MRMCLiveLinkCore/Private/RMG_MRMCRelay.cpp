@@ -0,0 +1,139 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCRelay.h"
+#include "RMG_MRMCPacketDecoder.h"
+
+#include "Common/UdpSocketBuilder.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+// Largest datagram forwarded; longer ones are not robot samples and are dropped
+#define RMG_MRMC_RELAY_MAX_DATAGRAM 2048
+
+#define RMG_MRMC_RELAY_SEND_BUFFER_SIZE 256 * 1024
+
+// Offset from FPlatformTime::Seconds() to Unix time, taken once per process
+static int64 GetUnixOffsetNs()
+{
+	static const int64 OffsetNs = (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTicks() * 100 - static_cast<int64>(FPlatformTime::Seconds() * 1e9);
+	return OffsetNs;
+}
+
+int64 FRMG_MRMCRelay::ToUnixNs(double Seconds)
+{
+	return static_cast<int64>(Seconds * 1e9) + GetUnixOffsetNs();
+}
+
+double FRMG_MRMCRelay::FromUnixNs(int64 UnixNs)
+{
+	return static_cast<double>(UnixNs - GetUnixOffsetNs()) * 1e-9;
+}
+
+TUniquePtr<FRMG_MRMCRelay> FRMG_MRMCRelay::Create(const TArray<FIPv4Endpoint>& ReceiveEndpoints, const TArray<FIPv4Endpoint>& RelayEndpoints, bool bAddTimestamp, int32 RelayTtl)
+{
+	TArray<FIPv4Endpoint> Targets;
+	for (const FIPv4Endpoint& Target : RelayEndpoints)
+	{
+		bool bLoops = false;
+		for (const FIPv4Endpoint& Endpoint : ReceiveEndpoints)
+		{
+			const bool bLoopbackToAny = Endpoint.Address == FIPv4Address::Any && (Target.Address.Value >> 24) == 127;
+			bLoops |= Target.Port == Endpoint.Port && (Target.Address == Endpoint.Address || bLoopbackToAny);
+		}
+		if (bLoops)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: not relaying to %s, the source receives there itself"), *Target.ToString());
+			continue;
+		}
+		Targets.Add(Target);
+	}
+	if (Targets.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const int32 Ttl = FMath::Clamp(RelayTtl, 1, 255);
+
+#if PLATFORM_LINUX
+	TUniquePtr<FRMG_MRMCRelay> LinuxRelay = CreateLinuxRelay(Targets, bAddTimestamp, Ttl);
+	if (LinuxRelay.IsValid() && LinuxRelay->IsValid())
+	{
+		return LinuxRelay;
+	}
+	UE_LOG(LogTemp, Warning, TEXT("RMG_MRMC: sendmmsg relay unavailable, using FSocket"));
+#endif
+
+	TUniquePtr<FRMG_MRMCRelay> SocketRelay = MakeUnique<FRMG_MRMCSocketRelay>(Targets, bAddTimestamp, Ttl);
+	if (!SocketRelay->IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: cannot open the relay socket"));
+		return nullptr;
+	}
+	return SocketRelay;
+}
+
+FRMG_MRMCSocketRelay::FRMG_MRMCSocketRelay(const TArray<FIPv4Endpoint>& Targets, bool bInTimestamp, int32 Ttl)
+: Socket(nullptr)
+, bTimestamp(bInTimestamp)
+{
+	Socket = FUdpSocketBuilder(TEXT("RMG_MRMCRelay"))
+		.AsNonBlocking()
+		.BoundToAddress(FIPv4Address::Any)
+		.BoundToPort(0)
+		.WithSendBufferSize(RMG_MRMC_RELAY_SEND_BUFFER_SIZE)
+		.WithMulticastLoopback()
+		.WithMulticastTtl(static_cast<uint8>(Ttl));
+
+	for (const FIPv4Endpoint& Target : Targets)
+	{
+		TargetAddresses.Add(Target.ToInternetAddr());
+	}
+	NumTargets = TargetAddresses.Num();
+
+	if (bTimestamp)
+	{
+		SendBuffer.SetNumUninitialized(RMG_MRMCPacketLayout::FRelayHeader::Size + RMG_MRMC_RELAY_MAX_DATAGRAM);
+	}
+}
+
+FRMG_MRMCSocketRelay::~FRMG_MRMCSocketRelay()
+{
+	if (Socket != nullptr)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+	}
+}
+
+int32 FRMG_MRMCSocketRelay::Forward(const uint8* Data, int32 Size, double ReceiveSeconds)
+{
+	if (Size > RMG_MRMC_RELAY_MAX_DATAGRAM)
+	{
+		Failed += NumTargets;
+		return NumTargets;
+	}
+
+	const uint8* Payload = Data;
+	int32 PayloadSize = Size;
+	if (bTimestamp)
+	{
+		RMG_MRMCPacketDecoder::WriteRelayHeader(ToUnixNs(ReceiveSeconds), SendBuffer.GetData());
+		FMemory::Memcpy(SendBuffer.GetData() + RMG_MRMCPacketLayout::FRelayHeader::Size, Data, Size);
+		Payload = SendBuffer.GetData();
+		PayloadSize += RMG_MRMCPacketLayout::FRelayHeader::Size;
+	}
+
+	int32 TargetsFailed = 0;
+	for (const TSharedRef<FInternetAddr>& Target : TargetAddresses)
+	{
+		int32 BytesSent = 0;
+		if (!Socket->SendTo(Payload, PayloadSize, BytesSent, *Target) || BytesSent != PayloadSize)
+		{
+			TargetsFailed++;
+		}
+	}
+
+	Forwarded++;
+	Failed += TargetsFailed;
+	return TargetsFailed;
+}
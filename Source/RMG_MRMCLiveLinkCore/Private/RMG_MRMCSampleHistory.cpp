@@ -0,0 +1,90 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCSampleHistory.h"
+
+FRMG_MRMCSampleHistory::FRMG_MRMCSampleHistory(int32 InCapacity)
+: Oldest(0)
+, Count(0)
+{
+	Samples.SetNumZeroed(FMath::Max(InCapacity, 2));
+}
+
+void FRMG_MRMCSampleHistory::Add(double Seconds, const float* Values)
+{
+	if (Count == Samples.Num())
+	{
+		// a late sample older than everything kept would only push out a newer one
+		if (Seconds < Get(0).Seconds)
+		{
+			return;
+		}
+		Oldest = (Oldest + 1) % Samples.Num();
+		Count--;
+	}
+
+	// datagrams almost always arrive in order, so this rarely shifts anything
+	int32 Insert = Count;
+	while (Insert > 0 && Get(Insert - 1).Seconds > Seconds)
+	{
+		Get(Insert) = Get(Insert - 1);
+		Insert--;
+	}
+
+	FRMG_MRMCSample& Slot = Get(Insert);
+	Slot.Seconds = Seconds;
+	FMemory::Memcpy(Slot.Values, Values, sizeof(Slot.Values));
+	Count++;
+}
+
+bool FRMG_MRMCSampleHistory::Sample(double Seconds, const FRMG_MRMCSample*& OutPrevious, const FRMG_MRMCSample*& OutNext, float& OutAlpha, double MaxExtrapolationSeconds) const
+{
+	if (Count == 0)
+	{
+		return false;
+	}
+
+	OutAlpha = 0.0f;
+
+	if (Seconds <= Get(0).Seconds)
+	{
+		OutPrevious = OutNext = &Get(0);
+		return true;
+	}
+	if (Seconds >= Get(Count - 1).Seconds)
+	{
+		OutPrevious = OutNext = &Get(Count - 1);
+		if (Count > 1 && Seconds <= OutNext->Seconds + MaxExtrapolationSeconds)
+		{
+			const FRMG_MRMCSample& Before = Get(Count - 2);
+			const double Span = OutNext->Seconds - Before.Seconds;
+			if (Span > 0.0)
+			{
+				OutPrevious = &Before;
+				OutAlpha = static_cast<float>((Seconds - Before.Seconds) / Span);
+			}
+		}
+		return true;
+	}
+
+	// binary search for the last sample at or before Seconds
+	int32 Low = 0;
+	int32 High = Count - 1;
+	while (High - Low > 1)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Get(Mid).Seconds <= Seconds)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	OutPrevious = &Get(Low);
+	OutNext = &Get(High);
+	const double Span = OutNext->Seconds - OutPrevious->Seconds;
+	OutAlpha = Span > 0.0 ? static_cast<float>((Seconds - OutPrevious->Seconds) / Span) : 0.0f;
+	return true;
+}
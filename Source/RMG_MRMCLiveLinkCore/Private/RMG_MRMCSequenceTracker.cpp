@@ -0,0 +1,163 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCSequenceTracker.h"
+
+// Flair robots stream at 50 Hz; the estimate follows whatever rate actually arrives
+static const double DefaultPeriod = 1.0 / 50.0;
+
+FRMG_MRMCSequenceTracker::FRMG_MRMCSequenceTracker()
+{
+	Reset();
+}
+
+void FRMG_MRMCSequenceTracker::Reset()
+{
+	bStarted = false;
+	bHasCounter = false;
+	LastCounter = 0;
+	ReceivedWindow = 0;
+	LastSeconds = 0.0;
+	LastPayloadSize = 0;
+	NominalPeriod = DefaultPeriod;
+	PendingSuperseded = 0;
+	Accepted = 0;
+	Duplicates = 0;
+	Stale = 0;
+	Lost = 0;
+	Gaps = 0;
+	LongestGap = 0;
+}
+
+ERMG_MRMCSequenceVerdict FRMG_MRMCSequenceTracker::Check(const uint8* Data, int32 Size, const FRMG_MRMCDecodedPacket& Packet, double ReceiveSeconds, int32& OutLostChange)
+{
+	OutLostChange = 0;
+
+	const uint32 Counter = Packet.FrameCounter;
+	bHasCounter = Packet.HasFrameCounter();
+
+	const ERMG_MRMCSequenceVerdict Verdict = bHasCounter && bStarted
+		? CheckCounter(Counter, OutLostChange)
+		: CheckArrival(Data, Size, ReceiveSeconds, OutLostChange);
+
+	if (Verdict == ERMG_MRMCSequenceVerdict::Accept)
+	{
+		if (bStarted)
+		{
+			// learn the rate from back to back frames only, gaps and bursts would skew it
+			const double Interval = ReceiveSeconds - LastSeconds;
+			if (OutLostChange == 0 && PendingSuperseded == 0 && Interval > 0.0 && Interval < 1.5 * NominalPeriod)
+			{
+				const double Weight = Accepted < 8 ? 0.5 : 0.05;
+				NominalPeriod += (Interval - NominalPeriod) * Weight;
+			}
+		}
+		else if (bHasCounter)
+		{
+			ReceivedWindow = 1;
+		}
+
+		bStarted = true;
+		PendingSuperseded = 0;
+		LastCounter = Counter;
+		LastSeconds = ReceiveSeconds;
+		LastPayloadSize = FMath::Min(Size, static_cast<int32>(sizeof(LastPayload)));
+		FMemory::Memcpy(LastPayload, Data, LastPayloadSize);
+		Accepted++;
+	}
+	else if (Verdict == ERMG_MRMCSequenceVerdict::Duplicate)
+	{
+		Duplicates++;
+	}
+	else
+	{
+		Stale++;
+	}
+	return Verdict;
+}
+
+ERMG_MRMCSequenceVerdict FRMG_MRMCSequenceTracker::CheckCounter(uint32 Counter, int32& OutLostChange)
+{
+	// serial number arithmetic, so the counter may wrap
+	const int32 Delta = static_cast<int32>(Counter - LastCounter);
+
+	if (Delta > RMG_MRMC_SEQUENCE_RESYNC || Delta < -RMG_MRMC_SEQUENCE_RESYNC)
+	{
+		ReceivedWindow = 1;
+		return ERMG_MRMCSequenceVerdict::Accept;
+	}
+
+	if (Delta > 0)
+	{
+		ReceivedWindow = Delta < 64 ? (ReceivedWindow << Delta) | 1 : 1;
+		// the counters a mailbox passed over were received, so a late copy of one is a duplicate
+		const uint32 Passed = FMath::Min<uint32>(PendingSuperseded, FMath::Min(Delta - 1, 63));
+		if (Passed > 0)
+		{
+			ReceivedWindow |= ((uint64(1) << Passed) - 1) << 1;
+		}
+		CountGap(Delta - 1, OutLostChange);
+		return ERMG_MRMCSequenceVerdict::Accept;
+	}
+
+	const int32 Age = -Delta;
+	if (Age < 64)
+	{
+		const uint64 Bit = uint64(1) << Age;
+		if (ReceivedWindow & Bit)
+		{
+			return ERMG_MRMCSequenceVerdict::Duplicate;
+		}
+		// it was counted as lost when the newer frame arrived
+		ReceivedWindow |= Bit;
+		if (Lost > 0)
+		{
+			Lost--;
+			OutLostChange = -1;
+		}
+	}
+	return ERMG_MRMCSequenceVerdict::Stale;
+}
+
+ERMG_MRMCSequenceVerdict FRMG_MRMCSequenceTracker::CheckArrival(const uint8* Data, int32 Size, double ReceiveSeconds, int32& OutLostChange)
+{
+	if (!bStarted)
+	{
+		return ERMG_MRMCSequenceVerdict::Accept;
+	}
+
+	const double Interval = ReceiveSeconds - LastSeconds;
+	if (Interval < 0.0)
+	{
+		// only possible when replaying out of order timestamps
+		return ERMG_MRMCSequenceVerdict::Stale;
+	}
+
+	// a robot at rest repeats its payload every period, so only a repeat far inside one period is a copy
+	if (Interval < 0.25 * NominalPeriod && Size == LastPayloadSize && FMemory::Memcmp(Data, LastPayload, Size) == 0)
+	{
+		return ERMG_MRMCSequenceVerdict::Duplicate;
+	}
+
+	if (Interval > 1.5 * NominalPeriod)
+	{
+		const double Missing = FMath::RoundToDouble(Interval / NominalPeriod) - 1.0;
+		if (Missing <= RMG_MRMC_SEQUENCE_RESYNC)
+		{
+			CountGap(static_cast<uint32>(Missing), OutLostChange);
+		}
+	}
+	return ERMG_MRMCSequenceVerdict::Accept;
+}
+
+void FRMG_MRMCSequenceTracker::CountGap(uint32 Missing, int32& OutLostChange)
+{
+	Missing -= FMath::Min(Missing, PendingSuperseded);
+	if (Missing == 0)
+	{
+		return;
+	}
+	Lost += Missing;
+	Gaps++;
+	LongestGap = FMath::Max(LongestGap, Missing);
+	OutLostChange = static_cast<int32>(Missing);
+}
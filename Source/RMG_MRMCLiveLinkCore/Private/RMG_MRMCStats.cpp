@@ -0,0 +1,196 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCStats.h"
+#include "Misc/FileHelper.h"
+
+FRMG_MRMCLatencyHistogram::FRMG_MRMCLatencyHistogram()
+{
+	Reset();
+}
+
+int32 FRMG_MRMCLatencyHistogram::GetBucket(uint64 Value)
+{
+	if (Value < SubBucketCount)
+	{
+		return static_cast<int32>(Value);
+	}
+
+	// the top SubBucketBits bits below the leading one pick the linear sub-bucket of this power of two
+	const int32 Magnitude = FMath::Min(static_cast<int32>(FMath::FloorLog2_64(Value)), MaxMagnitude);
+	if (Magnitude == MaxMagnitude && (Value >> MaxMagnitude) > 1)
+	{
+		return BucketCount - 1;
+	}
+	const int32 Shift = Magnitude - SubBucketBits;
+	const int32 SubBucket = static_cast<int32>(Value >> Shift) & (SubBucketCount - 1);
+	return (Magnitude - SubBucketBits + 1) * SubBucketCount + SubBucket;
+}
+
+uint64 FRMG_MRMCLatencyHistogram::GetBucketUpperBound(int32 Bucket)
+{
+	if (Bucket < SubBucketCount)
+	{
+		return static_cast<uint64>(Bucket);
+	}
+
+	const int32 Magnitude = Bucket / SubBucketCount + SubBucketBits - 1;
+	const int32 SubBucket = Bucket % SubBucketCount;
+	const int32 Shift = Magnitude - SubBucketBits;
+	return ((static_cast<uint64>(SubBucketCount + SubBucket) + 1) << Shift) - 1;
+}
+
+void FRMG_MRMCLatencyHistogram::Record(uint64 Nanoseconds)
+{
+	Buckets[GetBucket(Nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	Count.fetch_add(1, std::memory_order_relaxed);
+	Sum.fetch_add(Nanoseconds, std::memory_order_relaxed);
+
+	uint64 Previous = Max.load(std::memory_order_relaxed);
+	while (Nanoseconds > Previous && !Max.compare_exchange_weak(Previous, Nanoseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+double FRMG_MRMCLatencyHistogram::GetMean() const
+{
+	const uint64 Recorded = GetCount();
+	return Recorded > 0 ? static_cast<double>(Sum.load(std::memory_order_relaxed)) / static_cast<double>(Recorded) : 0.0;
+}
+
+uint64 FRMG_MRMCLatencyHistogram::GetPercentile(double Percentile) const
+{
+	const uint64 Recorded = GetCount();
+	if (Recorded == 0)
+	{
+		return 0;
+	}
+
+	// buckets may still be moving while we read; clamp to what the max says was ever seen
+	const uint64 Rank = FMath::Max<uint64>(1, static_cast<uint64>(FMath::CeilToDouble(FMath::Clamp(Percentile, 0.0, 100.0) * 0.01 * static_cast<double>(Recorded))));
+	uint64 Seen = 0;
+	for (int32 Bucket = 0; Bucket < BucketCount; Bucket++)
+	{
+		Seen += Buckets[Bucket].load(std::memory_order_relaxed);
+		if (Seen >= Rank)
+		{
+			return FMath::Min(GetBucketUpperBound(Bucket), GetMax());
+		}
+	}
+	return GetMax();
+}
+
+void FRMG_MRMCLatencyHistogram::Reset()
+{
+	for (std::atomic<uint64>& Bucket : Buckets)
+	{
+		Bucket.store(0, std::memory_order_relaxed);
+	}
+	Count.store(0, std::memory_order_relaxed);
+	Sum.store(0, std::memory_order_relaxed);
+	Max.store(0, std::memory_order_relaxed);
+}
+
+const TCHAR* RMG_MRMCStage::GetName(Type Stage)
+{
+	switch (Stage)
+	{
+	case Receive: return TEXT("Receive");
+	case Handoff: return TEXT("Handoff");
+	case Decode: return TEXT("Decode");
+	case Push: return TEXT("Push");
+	case Jitter: return TEXT("Jitter");
+	case Relay: return TEXT("Relay");
+	case Transit: return TEXT("Transit");
+	default: return TEXT("Unknown");
+	}
+}
+
+FRMG_MRMCStats::FRMG_MRMCStats()
+{
+	Reset();
+}
+
+void FRMG_MRMCStats::Reset()
+{
+	PacketsReceived.store(0, std::memory_order_relaxed);
+	PacketsDropped.store(0, std::memory_order_relaxed);
+	PacketsSuperseded.store(0, std::memory_order_relaxed);
+	PacketsMalformed.store(0, std::memory_order_relaxed);
+	PacketsDuplicate.store(0, std::memory_order_relaxed);
+	PacketsStale.store(0, std::memory_order_relaxed);
+	FramesLost.store(0, std::memory_order_relaxed);
+	Gaps.store(0, std::memory_order_relaxed);
+	FramesFilled.store(0, std::memory_order_relaxed);
+	FramesSkipped.store(0, std::memory_order_relaxed);
+	FramesPushed.store(0, std::memory_order_relaxed);
+	PacketsRelayed.store(0, std::memory_order_relaxed);
+	RelayFailures.store(0, std::memory_order_relaxed);
+	for (FRMG_MRMCLatencyHistogram& Stage : Stages)
+	{
+		Stage.Reset();
+	}
+}
+
+FString FRMG_MRMCStats::ToStatusString(double PacketsPerSecond) const
+{
+	return FString::Printf(TEXT("%.1f Hz, jitter p99 %.2f ms, decode p99 %.1f us, push p99 %.1f us, %llu lost, %llu stale or duplicate, %llu malformed, %llu dropped, %llu superseded, %llu skipped"),
+		PacketsPerSecond,
+		Stages[RMG_MRMCStage::Jitter].GetPercentile(99.0) * 1e-6,
+		Stages[RMG_MRMCStage::Decode].GetPercentile(99.0) * 1e-3,
+		Stages[RMG_MRMCStage::Push].GetPercentile(99.0) * 1e-3,
+		FramesLost.load(std::memory_order_relaxed),
+		PacketsStale.load(std::memory_order_relaxed) + PacketsDuplicate.load(std::memory_order_relaxed),
+		PacketsMalformed.load(std::memory_order_relaxed),
+		PacketsDropped.load(std::memory_order_relaxed),
+		PacketsSuperseded.load(std::memory_order_relaxed),
+		FramesSkipped.load(std::memory_order_relaxed));
+}
+
+bool FRMG_MRMCStats::WriteCsv(const FString& Filename) const
+{
+	FString Csv = TEXT("Counter,Value\n");
+	Csv += FString::Printf(TEXT("PacketsReceived,%llu\n"), PacketsReceived.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("PacketsDropped,%llu\n"), PacketsDropped.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("PacketsSuperseded,%llu\n"), PacketsSuperseded.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("PacketsMalformed,%llu\n"), PacketsMalformed.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("PacketsDuplicate,%llu\n"), PacketsDuplicate.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("PacketsStale,%llu\n"), PacketsStale.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("FramesLost,%llu\n"), FramesLost.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("Gaps,%llu\n"), Gaps.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("FramesFilled,%llu\n"), FramesFilled.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("FramesSkipped,%llu\n"), FramesSkipped.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("FramesPushed,%llu\n"), FramesPushed.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("PacketsRelayed,%llu\n"), PacketsRelayed.load(std::memory_order_relaxed));
+	Csv += FString::Printf(TEXT("RelayFailures,%llu\n"), RelayFailures.load(std::memory_order_relaxed));
+
+	Csv += TEXT("\nStage,Count,MeanUs,P50Us,P90Us,P99Us,P999Us,MaxUs\n");
+	for (int32 Stage = 0; Stage < RMG_MRMCStage::Num; Stage++)
+	{
+		const FRMG_MRMCLatencyHistogram& Histogram = Stages[Stage];
+		Csv += FString::Printf(TEXT("%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+			RMG_MRMCStage::GetName(static_cast<RMG_MRMCStage::Type>(Stage)),
+			Histogram.GetCount(),
+			Histogram.GetMean() * 1e-3,
+			Histogram.GetPercentile(50.0) * 1e-3,
+			Histogram.GetPercentile(90.0) * 1e-3,
+			Histogram.GetPercentile(99.0) * 1e-3,
+			Histogram.GetPercentile(99.9) * 1e-3,
+			Histogram.GetMax() * 1e-3);
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Filename);
+}
+
+double FRMG_MRMCStats::MeasureRecordOverheadNs()
+{
+	static const int32 Iterations = 20000;
+
+	TUniquePtr<FRMG_MRMCLatencyHistogram> Scratch = MakeUnique<FRMG_MRMCLatencyHistogram>();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		FRMG_MRMCStageTimer Timer(Scratch.Get());
+	}
+	const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	return Seconds * 1e9 / Iterations;
+}
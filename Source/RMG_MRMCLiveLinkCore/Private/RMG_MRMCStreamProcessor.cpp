@@ -0,0 +1,428 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCStreamProcessor.h"
+#include "RMG_MRMCPacketDecoder.h"
+#include "RMG_MRMCPoseKernel.h"
+#include "Misc/App.h"
+
+FRMG_MRMCStreamProcessor::FRMG_MRMCStreamProcessor(const FRMG_MRMCCompiledMapping& InMapping, const FRMG_MRMCProcessingOptions& InOptions)
+: Mapping(InMapping)
+, Options(InOptions)
+, PreviousSeconds(0.0)
+, LatestSeconds(0.0)
+, LastFillSeconds(0.0)
+, FrameClock(InOptions.SampleRate)
+, LastPushSeconds(0.0)
+, bHasPushedFrame(false)
+, bCountedSceneTime(false)
+, Stats(nullptr)
+, LastReceiveSeconds(0.0)
+, LastInterval(-1.0)
+{
+	FrameValues.SetNumZeroed(RMG_MRMC_FRAME_VALUE_COUNT);
+	if (Options.GapFillMs > 0.0f && !Options.bInterpolate)
+	{
+		PreviousValues.SetNumZeroed(RMG_MRMC_FRAME_VALUE_COUNT);
+		GapValues.SetNumZeroed(RMG_MRMC_FRAME_VALUE_COUNT);
+	}
+	if (Options.PredictionLeadMs > 0.0f)
+	{
+		Predictor = MakeUnique<FRMG_MRMCPredictor>(Options.PredictionLeadMs * 0.001f, Options.PredictionProcessNoise, Options.PredictionMeasurementNoise);
+	}
+}
+
+void FRMG_MRMCStreamProcessor::PushSubjectStaticData(int32 SubjectIdx, IRMG_MRMCFrameSink& Sink) const
+{
+	const int32 Camera = GetCamera(SubjectIdx);
+	if (Camera != INDEX_NONE)
+	{
+		const int32 FocalLengthChannel = Mapping.CameraFocalLengthChannel[Camera];
+
+		FRMG_MRMCSubjectStaticData StaticData;
+		StaticData.SubjectName = Mapping.SubjectNames[SubjectIdx];
+		StaticData.Role = ERMG_MRMCSubjectRole::Camera;
+		// the raw zoom encoder is no focal length, field of view needs a lens file
+		StaticData.bHasFocalLength = FocalLengthChannel != RMG_MRMCChannel::Zero && (FocalLengthChannel != RMG_MRMCChannel::Zoom || LensProfile.HasFocalLength());
+		StaticData.bHasFocusDistance = Mapping.CameraFocusDistanceChannel[Camera] != RMG_MRMCChannel::Zero;
+		StaticData.Filmback = Mapping.CameraFilmback[Camera];
+		Sink.PushStaticData(MoveTemp(StaticData));
+		return;
+	}
+
+	const int32 FirstBone = Mapping.SubjectFirstBone[SubjectIdx];
+	const int32 NumBones = Mapping.SubjectNumBones[SubjectIdx];
+	const int32 FirstProperty = Mapping.SubjectFirstProperty[SubjectIdx];
+	const int32 NumProperties = Mapping.SubjectNumProperties[SubjectIdx];
+
+	FRMG_MRMCSubjectStaticData StaticData;
+	StaticData.SubjectName = Mapping.SubjectNames[SubjectIdx];
+	StaticData.BoneNames.Append(Mapping.BoneNames.GetData() + FirstBone, NumBones);
+	StaticData.BoneParents.Append(Mapping.BoneParents.GetData() + FirstBone, NumBones);
+	StaticData.PropertyNames.Append(Mapping.PropertyNames.GetData() + FirstProperty, NumProperties);
+	Sink.PushStaticData(MoveTemp(StaticData));
+}
+
+void FRMG_MRMCStreamProcessor::PushStaticData(IRMG_MRMCFrameSink& Sink) const
+{
+	for (int32 SubjectIdx = 0; SubjectIdx < Mapping.NumSubjects(); SubjectIdx++)
+	{
+		PushSubjectStaticData(SubjectIdx, Sink);
+	}
+}
+
+int32 FRMG_MRMCStreamProcessor::SetMapping(const FRMG_MRMCCompiledMapping& NewMapping, IRMG_MRMCFrameSink& Sink)
+{
+	for (int32 SubjectIdx = 0; SubjectIdx < Mapping.NumSubjects(); SubjectIdx++)
+	{
+		if (NewMapping.FindSubject(Mapping.SubjectNames[SubjectIdx]) == INDEX_NONE)
+		{
+			Sink.RemoveSubject(Mapping.SubjectNames[SubjectIdx]);
+		}
+	}
+
+	const FRMG_MRMCCompiledMapping OldMapping = MoveTemp(Mapping);
+	Mapping = NewMapping;
+
+	int32 NumPushed = 0;
+	for (int32 SubjectIdx = 0; SubjectIdx < Mapping.NumSubjects(); SubjectIdx++)
+	{
+		const int32 OldIdx = OldMapping.FindSubject(Mapping.SubjectNames[SubjectIdx]);
+		if (OldIdx != INDEX_NONE && Mapping.HasSameLayout(SubjectIdx, OldMapping, OldIdx))
+		{
+			continue;
+		}
+
+		PushSubjectStaticData(SubjectIdx, Sink);
+		NumPushed++;
+	}
+	return NumPushed;
+}
+
+void FRMG_MRMCStreamProcessor::AddSuperseded(uint32 Count)
+{
+	if (Count == 0)
+	{
+		return;
+	}
+	Sequence.AddSuperseded(Count);
+	// the interval to the next datagram spans the skipped ones, it says nothing about jitter
+	LastReceiveSeconds = 0.0;
+	LastInterval = -1.0;
+}
+
+bool FRMG_MRMCStreamProcessor::ProcessPacket(const uint8* Data, int32 Size, double ReceiveSeconds, IRMG_MRMCFrameSink& Sink)
+{
+	if (Stats != nullptr)
+	{
+		RecordArrival(ReceiveSeconds);
+	}
+
+	float* Values = FrameValues.GetData();
+	FRMG_MRMCDecodedPacket Packet;
+	{
+		FRMG_MRMCStageTimer DecodeTimer(Stats != nullptr ? &Stats->Stages[RMG_MRMCStage::Decode] : nullptr);
+
+		if (!RMG_MRMCPacketDecoder::Decode(Data, Size, Packet))
+		{
+			if (Stats != nullptr)
+			{
+				Stats->PacketsMalformed.fetch_add(1, std::memory_order_relaxed);
+			}
+			return false;
+		}
+
+		// drop late and repeated datagrams before they cost a conversion or move the camera backwards
+		int32 LostChange = 0;
+		const ERMG_MRMCSequenceVerdict Verdict = Sequence.Check(Data, Size, Packet, ReceiveSeconds, LostChange);
+		if (Stats != nullptr)
+		{
+			CountSequence(Verdict, LostChange);
+		}
+		if (Verdict != ERMG_MRMCSequenceVerdict::Accept)
+		{
+			return false;
+		}
+
+		if (PreviousValues.Num() > 0)
+		{
+			FMemory::Memcpy(PreviousValues.GetData(), Values, PreviousValues.Num() * sizeof(float));
+			PreviousSeconds = LatestSeconds;
+			LatestSeconds = LastFillSeconds = ReceiveSeconds;
+		}
+
+		RMG_MRMCPoseKernel::ConvertSample(Packet.Robot, Values);
+		if (!LensProfile.IsEmpty())
+		{
+			LensProfile.Apply(Packet.Robot, Values);
+		}
+
+		if (Predictor.IsValid())
+		{
+			// filter on the receive timestamp and replace the sample with its lead-time extrapolation
+			Predictor->Process(ReceiveSeconds, Values);
+		}
+	}
+
+	if (Options.bInterpolate)
+	{
+		// every sample is kept; PushInterpolatedFrame() resamples them at the engine frame time. With a frame
+		// counter they are keyed by counted time, so receive jitter does not turn into uneven motion.
+		History.Add(Packet.HasFrameCounter() ? FrameClock.EvaluateSeconds(Packet.FrameCounter, ReceiveSeconds) : ReceiveSeconds, Values);
+		return true;
+	}
+
+	FQualifiedFrameTime SceneTime;
+	if (!SkipFrame(Packet, ReceiveSeconds, SceneTime))
+	{
+		PushSubjectFrames(Values, Values, 0.0f, ReceiveSeconds, SceneTime, Sink);
+	}
+	else if (Stats != nullptr)
+	{
+		Stats->FramesSkipped.fetch_add(1, std::memory_order_relaxed);
+	}
+	return true;
+}
+
+void FRMG_MRMCStreamProcessor::CountSequence(ERMG_MRMCSequenceVerdict Verdict, int32 LostChange)
+{
+	if (Verdict == ERMG_MRMCSequenceVerdict::Duplicate)
+	{
+		Stats->PacketsDuplicate.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if (Verdict == ERMG_MRMCSequenceVerdict::Stale)
+	{
+		Stats->PacketsStale.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (LostChange > 0)
+	{
+		Stats->FramesLost.fetch_add(LostChange, std::memory_order_relaxed);
+		Stats->Gaps.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if (LostChange < 0)
+	{
+		// a frame counted as lost turned up late after all
+		Stats->FramesLost.fetch_sub(-LostChange, std::memory_order_relaxed);
+	}
+}
+
+void FRMG_MRMCStreamProcessor::RecordArrival(double ReceiveSeconds)
+{
+	// jitter is the change between consecutive inter-arrival intervals, so a steady stream at any rate reads zero
+	if (LastReceiveSeconds > 0.0)
+	{
+		const double Interval = ReceiveSeconds - LastReceiveSeconds;
+		if (LastInterval >= 0.0)
+		{
+			Stats->Stages[RMG_MRMCStage::Jitter].RecordSeconds(FMath::Abs(Interval - LastInterval));
+		}
+		LastInterval = Interval;
+	}
+	LastReceiveSeconds = ReceiveSeconds;
+}
+
+void FRMG_MRMCStreamProcessor::PushInterpolatedFrame(double EvaluationSeconds, const FQualifiedFrameTime& SceneTime, IRMG_MRMCFrameSink& Sink)
+{
+	const FRMG_MRMCSample* Previous = nullptr;
+	const FRMG_MRMCSample* Next = nullptr;
+	float Alpha = 0.0f;
+	if (History.Sample(EvaluationSeconds, Previous, Next, Alpha, Options.GapFillMs * 0.001))
+	{
+		if (Alpha > 1.0f && Stats != nullptr)
+		{
+			Stats->FramesFilled.fetch_add(1, std::memory_order_relaxed);
+		}
+		PushSubjectFrames(Previous->Values, Next->Values, Alpha, EvaluationSeconds, SceneTime, Sink);
+	}
+}
+
+void FRMG_MRMCStreamProcessor::FillGap(double NowSeconds, IRMG_MRMCFrameSink& Sink)
+{
+	if (GapValues.Num() == 0 || PreviousSeconds <= 0.0)
+	{
+		return;
+	}
+
+	const double Period = Sequence.GetNominalPeriod();
+	const double Silence = NowSeconds - LatestSeconds;
+	const double Span = LatestSeconds - PreviousSeconds;
+	if (Silence < 1.5 * Period || Silence > Options.GapFillMs * 0.001 || NowSeconds - LastFillSeconds < Period || Span <= 0.0)
+	{
+		return;
+	}
+	LastFillSeconds = NowSeconds;
+
+	// continue the last sample's motion; angles take the short way round so pan keeps wrapping through +-180
+	const float Scale = static_cast<float>(Silence / Span);
+	const float* Latest = FrameValues.GetData();
+	const float* Previous = PreviousValues.GetData();
+	float* Values = GapValues.GetData();
+	for (int32 Channel = 0; Channel < RMG_MRMCChannel::Num; Channel++)
+	{
+		float Delta = Latest[Channel] - Previous[Channel];
+		if (Channel == RMG_MRMCChannel::Pan || Channel == RMG_MRMCChannel::RollDegrees)
+		{
+			Delta = FMath::FindDeltaAngleDegrees(Previous[Channel], Latest[Channel]);
+		}
+		else if (Channel == RMG_MRMCChannel::Roll)
+		{
+			Delta = FMath::FindDeltaAngleRadians(Previous[Channel], Latest[Channel]);
+		}
+		Values[Channel] = Latest[Channel] + Delta * Scale;
+	}
+	Values[RMG_MRMCChannel::Zero] = 0.0f;
+
+	const FFrameRate FrameRate = FApp::GetTimecodeFrameRate();
+	FQualifiedFrameTime SceneTime(FTimecode(NowSeconds, FrameRate, true), FrameRate);
+	if (bCountedSceneTime && LastSceneTime.Rate == FrameRate)
+	{
+		// continue the counted time of the last sample rather than jump back to the receive clock
+		SceneTime = FQualifiedFrameTime(LastSceneTime.Time + FrameRate.AsFrameTime(NowSeconds - LatestSeconds), FrameRate);
+	}
+	if (Stats != nullptr)
+	{
+		Stats->FramesFilled.fetch_add(1, std::memory_order_relaxed);
+	}
+	PushSubjectFrames(Values, Values, 0.0f, NowSeconds, SceneTime, Sink);
+}
+
+FQualifiedFrameTime FRMG_MRMCStreamProcessor::MakeSceneTime(const FRMG_MRMCDecodedPacket& Packet, double ReceiveSeconds)
+{
+	const FFrameRate FrameRate = FApp::GetTimecodeFrameRate();
+
+	FFrameTime Reference;
+	if (Packet.HasTimecode())
+	{
+		const FTimecode Timecode(
+			static_cast<int32>(Packet.Timecode >> 24),
+			static_cast<int32>((Packet.Timecode >> 16) & 0xff),
+			static_cast<int32>((Packet.Timecode >> 8) & 0xff),
+			static_cast<int32>(Packet.Timecode & 0xff),
+			FTimecode::IsDropFormatTimecodeSupported(FrameRate));
+		Reference = Timecode.ToFrameNumber(FrameRate);
+	}
+	else
+	{
+		Reference = FTimecode(ReceiveSeconds, FrameRate, true).ToFrameNumber(FrameRate);
+	}
+
+	if (!Packet.HasFrameCounter())
+	{
+		return FQualifiedFrameTime(Reference, FrameRate);
+	}
+	return FrameClock.Evaluate(Packet.FrameCounter, Reference, FrameRate, Packet.HasTimecode());
+}
+
+bool FRMG_MRMCStreamProcessor::SkipFrame(const FRMG_MRMCDecodedPacket& Packet, double ReceiveSeconds, FQualifiedFrameTime& SceneTime)
+{
+	SceneTime = MakeSceneTime(Packet, ReceiveSeconds);
+	bCountedSceneTime = Packet.HasFrameCounter();
+	LastSceneTime = SceneTime;
+
+	if (bCountedSceneTime)
+	{
+		// counted scene time has no jitter, so push the first sample of every timecode frame
+		const FFrameNumber Frame = SceneTime.Time.GetFrame();
+		if (bHasPushedFrame && Frame == LastPushFrame)
+		{
+			return true;
+		}
+		bHasPushedFrame = true;
+		LastPushFrame = Frame;
+		return false;
+	}
+
+	// AsInterval() keeps the denominator, so 29.97 and 23.976 are not treated as 30 and 24
+	if (ReceiveSeconds < LastPushSeconds + SceneTime.Rate.AsInterval())
+	{
+		return true;
+	}
+	LastPushSeconds = ReceiveSeconds;
+	return false;
+}
+
+// Local transform of one bone from its channels, blended towards NextValues by Alpha when bBlend
+static FORCEINLINE FTransform MakeBoneTransform(const FRMG_MRMCCompiledMapping& Mapping, int32 Bone, const float* Values, const float* NextValues, float Alpha, bool bBlend)
+{
+	const int32* Loc = Mapping.LocationChannels.GetData() + Bone * 3;
+	FVector Location(Values[Loc[0]], Values[Loc[1]], Values[Loc[2]]);
+	if (bBlend)
+	{
+		Location = FMath::Lerp(Location, FVector(NextValues[Loc[0]], NextValues[Loc[1]], NextValues[Loc[2]]), Alpha);
+	}
+
+	FTransform Trans(Location);
+	if (Mapping.BoneHasRotation[Bone])
+	{
+		const int32* Rot = Mapping.RotationChannels.GetData() + Bone * 3;
+		FQuat Rotation = FQuat::MakeFromEuler(FVector(Values[Rot[0]], Values[Rot[1]], Values[Rot[2]]));
+		if (bBlend)
+		{
+			// slerp takes the short way round, so pan wrapping through +-180 blends correctly
+			Rotation = FQuat::Slerp(Rotation, FQuat::MakeFromEuler(FVector(NextValues[Rot[0]], NextValues[Rot[1]], NextValues[Rot[2]])), Alpha);
+		}
+		Trans.SetRotation(Rotation);
+	}
+	return Trans;
+}
+
+void FRMG_MRMCStreamProcessor::PushSubjectFrames(const float* Values, const float* NextValues, float Alpha, double WorldSeconds, const FQualifiedFrameTime& SceneTime, IRMG_MRMCFrameSink& Sink) const
+{
+	FRMG_MRMCStageTimer PushTimer(Stats != nullptr ? &Stats->Stages[RMG_MRMCStage::Push] : nullptr);
+	if (Stats != nullptr)
+	{
+		Stats->FramesPushed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const bool bBlend = Alpha > 0.0f && Values != NextValues;
+
+	for (int32 SubjectIdx = 0; SubjectIdx < Mapping.NumSubjects(); SubjectIdx++)
+	{
+		FRMG_MRMCSubjectFrame Frame;
+		Frame.SubjectName = Mapping.SubjectNames[SubjectIdx];
+		Frame.WorldSeconds = WorldSeconds;
+		Frame.SceneTime = SceneTime;
+
+		const int32 FirstBone = Mapping.SubjectFirstBone[SubjectIdx];
+		const int32 Camera = GetCamera(SubjectIdx);
+		if (Camera != INDEX_NONE)
+		{
+			// compose up the parent chain, so the frame carries the camera's own transform; compilation and
+			// IsConsistent() for cached mappings check every chain reaches the root
+			const int32 CameraBone = Mapping.CameraBone[Camera];
+			Frame.CameraTransform = MakeBoneTransform(Mapping, FirstBone + CameraBone, Values, NextValues, Alpha, bBlend);
+			for (int32 Parent = Mapping.BoneParents[FirstBone + CameraBone]; Parent != INDEX_NONE; Parent = Mapping.BoneParents[FirstBone + Parent])
+			{
+				Frame.CameraTransform *= MakeBoneTransform(Mapping, FirstBone + Parent, Values, NextValues, Alpha, bBlend);
+			}
+
+			const int32 FocalLength = Mapping.CameraFocalLengthChannel[Camera];
+			const int32 FocusDistance = Mapping.CameraFocusDistanceChannel[Camera];
+			const FVector2D& Filmback = Mapping.CameraFilmback[Camera];
+			Frame.Role = ERMG_MRMCSubjectRole::Camera;
+			Frame.FocalLength = bBlend ? FMath::Lerp(Values[FocalLength], NextValues[FocalLength], Alpha) : Values[FocalLength];
+			Frame.FocusDistance = bBlend ? FMath::Lerp(Values[FocusDistance], NextValues[FocusDistance], Alpha) : Values[FocusDistance];
+			Frame.FieldOfView = Frame.FocalLength > 0.0f ? FMath::RadiansToDegrees(2.0f * FMath::Atan(Filmback.X / (2.0f * Frame.FocalLength))) : 0.0f;
+			Frame.AspectRatio = Filmback.X / Filmback.Y;
+			Sink.PushFrame(MoveTemp(Frame));
+			continue;
+		}
+
+		const int32 NumBones = Mapping.SubjectNumBones[SubjectIdx];
+		Frame.Transforms.SetNumUninitialized(NumBones);
+		for (int32 BoneIdx = 0; BoneIdx < NumBones; BoneIdx++)
+		{
+			Frame.Transforms[BoneIdx] = MakeBoneTransform(Mapping, FirstBone + BoneIdx, Values, NextValues, Alpha, bBlend);
+		}
+
+		const int32* Props = Mapping.PropertyChannels.GetData() + Mapping.SubjectFirstProperty[SubjectIdx];
+		const int32 NumProperties = Mapping.SubjectNumProperties[SubjectIdx];
+		Frame.PropertyValues.SetNumUninitialized(NumProperties);
+		for (int32 PropIdx = 0; PropIdx < NumProperties; PropIdx++)
+		{
+			const float Value = Values[Props[PropIdx]];
+			Frame.PropertyValues[PropIdx] = bBlend ? FMath::Lerp(Value, NextValues[Props[PropIdx]], Alpha) : Value;
+		}
+		Sink.PushFrame(MoveTemp(Frame));
+	}
+}
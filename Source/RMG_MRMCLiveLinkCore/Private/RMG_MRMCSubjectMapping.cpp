@@ -0,0 +1,537 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCSubjectMapping.h"
+#include "Json.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+// Bump whenever the compiled layout or its serialization changes, stale cache files are then recompiled
+static const uint32 MappingCacheMagic = 0x524d4d43; // 'RMMC'
+static const int32 MappingCacheVersion = 3;
+
+static const TCHAR* DefaultMappingJson =
+TEXT(R"({ "sources": [{
+         "subject": "robot_camera",
+             "camera": {},
+             "properties": ["Roll", "Focus", "Zoom"],
+             "propertyIndex": [6, 7, 8],
+             "bones" : [{
+                 "name": "top",
+                 "parent" : ""  ,
+                 "index": [-1, -1, -1, -1, -1, -1]
+              },
+              {
+                 "name": "CameraPose",
+                 "parent" : "top",
+                 "index": [0, 1, 2, 3, 4, 5]
+              }]
+         },
+         {
+         "subject": "camera_target",
+            "properties": ["CameraTarget_xt", "CameraTarget_yt", "CameraTarget_zt"],
+             "propertyIndex": [9, 10, 11],
+            "bones" : [{
+                 "name": "top",
+                 "parent" : "" ,
+                 "index": [-1, -1, -1, -1, -1, -1]
+            },
+            {
+                 "name": "CameraTarget",
+                 "parent" : "top" ,
+                 "index": [ 9, 10, 11, -1, -1, -1]
+            }]
+         }]
+})");
+
+static int32 ValidateChannel(int32 Index)
+{
+	return (Index >= 0 && Index < RMG_MRMCChannel::Num) ? Index : RMG_MRMCChannel::Zero;
+}
+
+// Resolves three consecutive channels; if any of them is unmapped the whole triple reads zero
+static bool CompileTriple(const TArray<TSharedPtr<FJsonValue>>& IndexArray, int32 First, TArray<int32>& OutChannels)
+{
+	int32 Channels[3];
+	bool bValid = true;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		const int32 Index = (First + Axis < IndexArray.Num()) ? static_cast<int32>(IndexArray[First + Axis]->AsNumber()) : INDEX_NONE;
+		Channels[Axis] = ValidateChannel(Index);
+		bValid &= (Channels[Axis] != RMG_MRMCChannel::Zero);
+	}
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		OutChannels.Add(bValid ? Channels[Axis] : RMG_MRMCChannel::Zero);
+	}
+	return bValid;
+}
+
+// Super 35 gate, the usual sensor of the cameras Flair rigs carry
+static const FVector2D DefaultFilmback(24.89f, 18.66f);
+
+// Compiles the "camera" object of the subject just added:
+//   { "bone": "CameraPose", "focalLengthIndex": 8, "focusDistanceIndex": 7, "filmback": [24.89, 18.66] }
+// Every field is optional. The bone defaults to the last one with a rotation, the channels to Zoom and Focus.
+static bool CompileCamera(const FJsonObject& CameraObject, FRMG_MRMCCompiledMapping& OutMapping, const FString& SubjectName, FString& OutError)
+{
+	const int32 SubjectIdx = OutMapping.NumSubjects() - 1;
+	const int32 FirstBone = OutMapping.SubjectFirstBone[SubjectIdx];
+	const int32 NumBones = OutMapping.SubjectNumBones[SubjectIdx];
+
+	int32 Bone = INDEX_NONE;
+	FString BoneName;
+	if (CameraObject.TryGetStringField(TEXT("bone"), BoneName))
+	{
+		for (int32 BoneIdx = 0; BoneIdx < NumBones; BoneIdx++)
+		{
+			if (OutMapping.BoneNames[FirstBone + BoneIdx] == FName(*BoneName))
+			{
+				Bone = BoneIdx;
+			}
+		}
+		if (Bone == INDEX_NONE)
+		{
+			OutError = FString::Printf(TEXT("subject %s: camera bone %s is not one of its bones"), *SubjectName, *BoneName);
+			return false;
+		}
+	}
+	else
+	{
+		for (int32 BoneIdx = 0; BoneIdx < NumBones; BoneIdx++)
+		{
+			if (OutMapping.BoneHasRotation[FirstBone + BoneIdx])
+			{
+				Bone = BoneIdx;
+			}
+		}
+		if (Bone == INDEX_NONE)
+		{
+			OutError = FString::Printf(TEXT("subject %s: a camera needs a bone with a rotation"), *SubjectName);
+			return false;
+		}
+	}
+
+	int32 FocalLengthIndex = RMG_MRMCChannel::Zoom;
+	int32 FocusDistanceIndex = RMG_MRMCChannel::Focus;
+	CameraObject.TryGetNumberField(TEXT("focalLengthIndex"), FocalLengthIndex);
+	CameraObject.TryGetNumberField(TEXT("focusDistanceIndex"), FocusDistanceIndex);
+
+	FVector2D Filmback = DefaultFilmback;
+	const TArray<TSharedPtr<FJsonValue>>* FilmbackArray = nullptr;
+	if (CameraObject.TryGetArrayField(TEXT("filmback"), FilmbackArray))
+	{
+		if (FilmbackArray->Num() != 2 || (*FilmbackArray)[0]->AsNumber() <= 0.0 || (*FilmbackArray)[1]->AsNumber() <= 0.0)
+		{
+			OutError = FString::Printf(TEXT("subject %s: camera filmback must be [width, height] in mm"), *SubjectName);
+			return false;
+		}
+		Filmback = FVector2D((*FilmbackArray)[0]->AsNumber(), (*FilmbackArray)[1]->AsNumber());
+	}
+
+	OutMapping.SubjectCamera.Add(OutMapping.CameraBone.Num());
+	OutMapping.CameraBone.Add(Bone);
+	OutMapping.CameraFocalLengthChannel.Add(ValidateChannel(FocalLengthIndex));
+	OutMapping.CameraFocusDistanceChannel.Add(ValidateChannel(FocusDistanceIndex));
+	OutMapping.CameraFilmback.Add(Filmback);
+	return true;
+}
+
+void FRMG_MRMCCompiledMapping::Reset()
+{
+	SubjectNames.Reset();
+	SubjectFirstBone.Reset();
+	SubjectNumBones.Reset();
+	SubjectFirstProperty.Reset();
+	SubjectNumProperties.Reset();
+	LocationChannels.Reset();
+	RotationChannels.Reset();
+	BoneHasRotation.Reset();
+	PropertyChannels.Reset();
+	BoneNames.Reset();
+	BoneParents.Reset();
+	PropertyNames.Reset();
+	SubjectCamera.Reset();
+	CameraBone.Reset();
+	CameraFocalLengthChannel.Reset();
+	CameraFocusDistanceChannel.Reset();
+	CameraFilmback.Reset();
+}
+
+bool FRMG_MRMCCompiledMapping::Compile(const FString& JsonString, FRMG_MRMCCompiledMapping& OutMapping, FString& OutError)
+{
+	OutMapping.Reset();
+
+	const FString InputJson = JsonString.IsEmpty() ? FString(DefaultMappingJson) : JsonString;
+
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(InputJson);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	{
+		OutError = FString::Printf(TEXT("invalid JSON: %s"), *Reader->GetErrorMessage());
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* SubjectArray = nullptr;
+	if (!JsonObject->TryGetArrayField(TEXT("sources"), SubjectArray))
+	{
+		OutError = TEXT("missing \"sources\" array");
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonValue>& Subj : *SubjectArray)
+	{
+		const TSharedPtr<FJsonObject>* SubjectObject = nullptr;
+		FString SubjectName;
+		if (!Subj->TryGetObject(SubjectObject) || !(*SubjectObject)->TryGetStringField(TEXT("subject"), SubjectName) || SubjectName.IsEmpty())
+		{
+			OutError = TEXT("every source needs a \"subject\" name");
+			return false;
+		}
+
+		OutMapping.SubjectNames.Add(*SubjectName);
+		OutMapping.SubjectFirstBone.Add(OutMapping.BoneNames.Num());
+		OutMapping.SubjectFirstProperty.Add(OutMapping.PropertyNames.Num());
+
+		const TArray<TSharedPtr<FJsonValue>>* BoneArray = nullptr;
+		(*SubjectObject)->TryGetArrayField(TEXT("bones"), BoneArray);
+
+		const int32 FirstBone = OutMapping.BoneNames.Num();
+		TArray<FString> ParentNames;
+		if (BoneArray != nullptr)
+		{
+			for (const TSharedPtr<FJsonValue>& BoneItem : *BoneArray)
+			{
+				const TSharedPtr<FJsonObject>* BoneObject = nullptr;
+				if (!BoneItem->TryGetObject(BoneObject))
+				{
+					OutError = FString::Printf(TEXT("subject %s: bones must be objects"), *SubjectName);
+					return false;
+				}
+
+				FString BoneName;
+				FString BoneParent;
+				(*BoneObject)->TryGetStringField(TEXT("name"), BoneName);
+				(*BoneObject)->TryGetStringField(TEXT("parent"), BoneParent);
+				OutMapping.BoneNames.Add(*BoneName);
+				ParentNames.Add(BoneParent);
+
+				const TArray<TSharedPtr<FJsonValue>>* IndexArray = nullptr;
+				static const TArray<TSharedPtr<FJsonValue>> NoIndices;
+				if (!(*BoneObject)->TryGetArrayField(TEXT("index"), IndexArray))
+				{
+					IndexArray = &NoIndices;
+				}
+				CompileTriple(*IndexArray, 0, OutMapping.LocationChannels);
+				OutMapping.BoneHasRotation.Add(CompileTriple(*IndexArray, 3, OutMapping.RotationChannels));
+			}
+		}
+
+		// parents are resolved by name within the subject; an unknown name falls back to the first bone, which
+		// itself then stays a root
+		for (int32 BoneIdx = 0; BoneIdx < ParentNames.Num(); BoneIdx++)
+		{
+			int32 Parent = INDEX_NONE;
+			if (!ParentNames[BoneIdx].IsEmpty())
+			{
+				Parent = BoneIdx > 0 ? 0 : INDEX_NONE;
+				for (int32 Candidate = 0; Candidate < ParentNames.Num(); Candidate++)
+				{
+					if (Candidate != BoneIdx && OutMapping.BoneNames[FirstBone + Candidate] == FName(*ParentNames[BoneIdx]))
+					{
+						Parent = Candidate;
+						break;
+					}
+				}
+			}
+			OutMapping.BoneParents.Add(Parent);
+		}
+		OutMapping.SubjectNumBones.Add(ParentNames.Num());
+
+		// a camera transform is composed up the parent chain every frame, so every chain must reach the root
+		for (int32 BoneIdx = 0; BoneIdx < ParentNames.Num(); BoneIdx++)
+		{
+			int32 Steps = 0;
+			for (int32 Parent = OutMapping.BoneParents[FirstBone + BoneIdx]; Parent != INDEX_NONE; Parent = OutMapping.BoneParents[FirstBone + Parent])
+			{
+				if (++Steps > ParentNames.Num())
+				{
+					OutError = FString::Printf(TEXT("subject %s: the parents of bone %s form a loop"), *SubjectName, *OutMapping.BoneNames[FirstBone + BoneIdx].ToString());
+					return false;
+				}
+			}
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* PropertyArray = nullptr;
+		const TArray<TSharedPtr<FJsonValue>>* PropertyIndexArray = nullptr;
+		(*SubjectObject)->TryGetArrayField(TEXT("properties"), PropertyArray);
+		(*SubjectObject)->TryGetArrayField(TEXT("propertyIndex"), PropertyIndexArray);
+
+		const int32 NumProperties = PropertyArray ? PropertyArray->Num() : 0;
+		for (int32 PropIdx = 0; PropIdx < NumProperties; PropIdx++)
+		{
+			OutMapping.PropertyNames.Add(*(*PropertyArray)[PropIdx]->AsString());
+
+			// a property without a valid index still gets a value so it stays aligned with its name
+			const int32 Index = (PropertyIndexArray && PropIdx < PropertyIndexArray->Num())
+				? static_cast<int32>((*PropertyIndexArray)[PropIdx]->AsNumber()) : INDEX_NONE;
+			OutMapping.PropertyChannels.Add(ValidateChannel(Index));
+		}
+		OutMapping.SubjectNumProperties.Add(NumProperties);
+
+		const TSharedPtr<FJsonObject>* CameraObject = nullptr;
+		if (!(*SubjectObject)->TryGetObjectField(TEXT("camera"), CameraObject))
+		{
+			OutMapping.SubjectCamera.Add(INDEX_NONE);
+			continue;
+		}
+		if (!CompileCamera(**CameraObject, OutMapping, SubjectName, OutError))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Whether the camera static data reports a focal length and a focus distance follows from these two channels
+// being unmapped and, for the focal length, being the raw zoom encoder, which needs a lens profile
+static bool HasSameLensValues(const FRMG_MRMCCompiledMapping& Mapping, int32 Camera, const FRMG_MRMCCompiledMapping& Other, int32 OtherCamera)
+{
+	const int32 FocalLength = Mapping.CameraFocalLengthChannel[Camera];
+	const int32 OtherFocalLength = Other.CameraFocalLengthChannel[OtherCamera];
+	const int32 FocusDistance = Mapping.CameraFocusDistanceChannel[Camera];
+	const int32 OtherFocusDistance = Other.CameraFocusDistanceChannel[OtherCamera];
+	return (FocalLength == RMG_MRMCChannel::Zero) == (OtherFocalLength == RMG_MRMCChannel::Zero)
+		&& (FocalLength == RMG_MRMCChannel::Zoom) == (OtherFocalLength == RMG_MRMCChannel::Zoom)
+		&& (FocusDistance == RMG_MRMCChannel::Zero) == (OtherFocusDistance == RMG_MRMCChannel::Zero);
+}
+
+bool FRMG_MRMCCompiledMapping::HasSameLayout(int32 SubjectIdx, const FRMG_MRMCCompiledMapping& Other, int32 OtherIdx) const
+{
+	const int32 NumBones = SubjectNumBones[SubjectIdx];
+	const int32 NumProperties = SubjectNumProperties[SubjectIdx];
+	if (NumBones != Other.SubjectNumBones[OtherIdx] || NumProperties != Other.SubjectNumProperties[OtherIdx])
+	{
+		return false;
+	}
+
+	const int32 FirstBone = SubjectFirstBone[SubjectIdx];
+	const int32 OtherFirstBone = Other.SubjectFirstBone[OtherIdx];
+	for (int32 BoneIdx = 0; BoneIdx < NumBones; BoneIdx++)
+	{
+		if (BoneNames[FirstBone + BoneIdx] != Other.BoneNames[OtherFirstBone + BoneIdx]
+			|| BoneParents[FirstBone + BoneIdx] != Other.BoneParents[OtherFirstBone + BoneIdx])
+		{
+			return false;
+		}
+	}
+
+	const int32 Camera = SubjectCamera[SubjectIdx];
+	const int32 OtherCamera = Other.SubjectCamera[OtherIdx];
+	if ((Camera == INDEX_NONE) != (OtherCamera == INDEX_NONE)
+		|| (Camera != INDEX_NONE && (CameraFilmback[Camera] != Other.CameraFilmback[OtherCamera] || !HasSameLensValues(*this, Camera, Other, OtherCamera))))
+	{
+		return false;
+	}
+
+	const int32 FirstProperty = SubjectFirstProperty[SubjectIdx];
+	const int32 OtherFirstProperty = Other.SubjectFirstProperty[OtherIdx];
+	for (int32 PropIdx = 0; PropIdx < NumProperties; PropIdx++)
+	{
+		if (PropertyNames[FirstProperty + PropIdx] != Other.PropertyNames[OtherFirstProperty + PropIdx])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FRMG_MRMCCompiledMapping::IsConsistent() const
+{
+	const int32 NumBones = BoneNames.Num();
+	const int32 NumProperties = PropertyNames.Num();
+	if (SubjectFirstBone.Num() != NumSubjects() || SubjectNumBones.Num() != NumSubjects()
+		|| SubjectFirstProperty.Num() != NumSubjects() || SubjectNumProperties.Num() != NumSubjects()
+		|| LocationChannels.Num() != NumBones * 3 || RotationChannels.Num() != NumBones * 3
+		|| BoneHasRotation.Num() != NumBones || BoneParents.Num() != NumBones
+		|| PropertyChannels.Num() != NumProperties
+		|| SubjectCamera.Num() != NumSubjects() || CameraFocalLengthChannel.Num() != CameraBone.Num()
+		|| CameraFocusDistanceChannel.Num() != CameraBone.Num() || CameraFilmback.Num() != CameraBone.Num())
+	{
+		return false;
+	}
+
+	for (int32 SubjectIdx = 0; SubjectIdx < NumSubjects(); SubjectIdx++)
+	{
+		if (SubjectFirstBone[SubjectIdx] < 0 || SubjectNumBones[SubjectIdx] < 0 || SubjectFirstBone[SubjectIdx] + SubjectNumBones[SubjectIdx] > NumBones
+			|| SubjectFirstProperty[SubjectIdx] < 0 || SubjectNumProperties[SubjectIdx] < 0 || SubjectFirstProperty[SubjectIdx] + SubjectNumProperties[SubjectIdx] > NumProperties)
+		{
+			return false;
+		}
+
+		const int32 Camera = SubjectCamera[SubjectIdx];
+		if (Camera != INDEX_NONE && (Camera < 0 || Camera >= CameraBone.Num() || CameraBone[Camera] < 0 || CameraBone[Camera] >= SubjectNumBones[SubjectIdx]))
+		{
+			return false;
+		}
+
+		// parents are subject-local and every chain must reach the root, the camera transform walks it per frame
+		const int32 FirstBone = SubjectFirstBone[SubjectIdx];
+		const int32 SubjectBones = SubjectNumBones[SubjectIdx];
+		for (int32 BoneIdx = 0; BoneIdx < SubjectBones; BoneIdx++)
+		{
+			int32 Steps = 0;
+			for (int32 Parent = BoneParents[FirstBone + BoneIdx]; Parent != INDEX_NONE; Parent = BoneParents[FirstBone + Parent])
+			{
+				if (Parent < 0 || Parent >= SubjectBones || ++Steps > SubjectBones)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	auto ChannelsInRange = [](const TArray<int32>& Channels)
+	{
+		for (int32 Channel : Channels)
+		{
+			if (Channel < 0 || Channel > RMG_MRMCChannel::Zero)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+	return ChannelsInRange(LocationChannels) && ChannelsInRange(RotationChannels) && ChannelsInRange(PropertyChannels)
+		&& ChannelsInRange(CameraFocalLengthChannel) && ChannelsInRange(CameraFocusDistanceChannel);
+}
+
+// Names are stored as strings so the cache does not depend on the name table of the session that wrote it
+static void SerializeNames(FArchive& Ar, TArray<FName>& Names)
+{
+	TArray<FString> Strings;
+	if (Ar.IsSaving())
+	{
+		for (const FName& Name : Names)
+		{
+			Strings.Add(Name.ToString());
+		}
+	}
+	Ar << Strings;
+	if (Ar.IsLoading())
+	{
+		Names.Reset(Strings.Num());
+		for (const FString& String : Strings)
+		{
+			Names.Add(*String);
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FRMG_MRMCCompiledMapping& Mapping)
+{
+	SerializeNames(Ar, Mapping.SubjectNames);
+	Ar << Mapping.SubjectFirstBone;
+	Ar << Mapping.SubjectNumBones;
+	Ar << Mapping.SubjectFirstProperty;
+	Ar << Mapping.SubjectNumProperties;
+	Ar << Mapping.LocationChannels;
+	Ar << Mapping.RotationChannels;
+	Ar << Mapping.BoneHasRotation;
+	Ar << Mapping.PropertyChannels;
+	SerializeNames(Ar, Mapping.BoneNames);
+	Ar << Mapping.BoneParents;
+	SerializeNames(Ar, Mapping.PropertyNames);
+	Ar << Mapping.SubjectCamera;
+	Ar << Mapping.CameraBone;
+	Ar << Mapping.CameraFocalLengthChannel;
+	Ar << Mapping.CameraFocusDistanceChannel;
+	Ar << Mapping.CameraFilmback;
+	return Ar;
+}
+
+static bool LoadCachedMapping(const FString& CachePath, FRMG_MRMCCompiledMapping& OutMapping)
+{
+	TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*CachePath, FILEREAD_Silent));
+	if (!FileReader)
+	{
+		return false;
+	}
+
+	FArchive& Ar = *FileReader;
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Ar << Magic;
+	Ar << Version;
+	if (Magic != MappingCacheMagic || Version != MappingCacheVersion)
+	{
+		return false;
+	}
+
+	Ar << OutMapping;
+	if (Ar.IsError() || !OutMapping.IsConsistent())
+	{
+		OutMapping.Reset();
+		return false;
+	}
+	return true;
+}
+
+static void SaveCachedMapping(const FString& CachePath, FRMG_MRMCCompiledMapping& Mapping)
+{
+	TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*CachePath, FILEWRITE_Silent));
+	if (!FileWriter)
+	{
+		return;
+	}
+
+	FArchive& Ar = *FileWriter;
+	uint32 Magic = MappingCacheMagic;
+	int32 Version = MappingCacheVersion;
+	Ar << Magic;
+	Ar << Version;
+	Ar << Mapping;
+
+	const bool bFailed = Ar.IsError();
+	FileWriter.Reset();
+	if (bFailed)
+	{
+		IFileManager::Get().Delete(*CachePath, false, false, true);
+	}
+}
+
+bool FRMG_MRMCCompiledMapping::Load(const FString& MappingFile, FRMG_MRMCCompiledMapping& OutMapping, FString& OutError)
+{
+	FString JsonString;
+	if (!MappingFile.IsEmpty())
+	{
+		const FString FullPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), MappingFile);
+		if (!FFileHelper::LoadFileToString(JsonString, *FullPath))
+		{
+			OutError = FString::Printf(TEXT("cannot read mapping file %s"), *FullPath);
+			return false;
+		}
+	}
+
+	const FTCHARToUTF8 KeySource(JsonString.IsEmpty() ? DefaultMappingJson : *JsonString);
+	FMD5 Md5;
+	Md5.Update(reinterpret_cast<const uint8*>(KeySource.Get()), KeySource.Length());
+	FMD5Hash Key;
+	Key.Set(Md5);
+	const FString CachePath = FPaths::ProjectSavedDir() / TEXT("RMG_MRMCLiveLink") / (LexToString(Key) + TEXT(".mapping"));
+
+	if (LoadCachedMapping(CachePath, OutMapping))
+	{
+		return true;
+	}
+
+	if (!Compile(JsonString, OutMapping, OutError))
+	{
+		return false;
+	}
+
+	SaveCachedMapping(CachePath, OutMapping);
+	return true;
+}
@@ -0,0 +1,199 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#include "RMG_MRMCTakeRecorder.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformAtomics.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+TUniquePtr<FRMG_MRMCTakeRecorder> FRMG_MRMCTakeRecorder::Open(const FString& InFilename, uint64 Capacity, int32 NumStreams)
+{
+	TUniquePtr<FRMG_MRMCTakeRecorder> Recorder(new FRMG_MRMCTakeRecorder());
+	Recorder->Filename = InFilename;
+	Recorder->StreamSequence.SetNumZeroed(FMath::Max(NumStreams, 1));
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(InFilename), true);
+
+	Capacity = FMath::Max<uint64>(Capacity, 1);
+	const uint64 IndexCapacity = (Capacity + RMG_MRMC_TAKE_INDEX_STRIDE - 1) / RMG_MRMC_TAKE_INDEX_STRIDE;
+	const uint64 IndexOffset = sizeof(FRMG_MRMCTakeHeader);
+	const uint64 RecordOffset = Align(IndexOffset + IndexCapacity * sizeof(double), sizeof(FRMG_MRMCTakeRecord));
+	const uint64 FileSize = RecordOffset + Capacity * sizeof(FRMG_MRMCTakeRecord);
+
+	if (!Recorder->Map(FileSize))
+	{
+		return TUniquePtr<FRMG_MRMCTakeRecorder>();
+	}
+
+	// fault every page in now, on the owning thread, so the receive thread only ever writes resident memory
+	const uint64 PageSize = FPlatformMemory::GetConstants().PageSize;
+	for (uint64 Offset = 0; Offset < FileSize; Offset += PageSize)
+	{
+		Recorder->Base[Offset] = 0;
+	}
+
+	FRMG_MRMCTakeHeader& Header = *reinterpret_cast<FRMG_MRMCTakeHeader*>(Recorder->Base);
+	FMemory::Memzero(Header);
+	Header.Magic = RMG_MRMC_TAKE_MAGIC;
+	Header.Version = RMG_MRMC_TAKE_VERSION;
+	Header.HeaderSize = sizeof(FRMG_MRMCTakeHeader);
+	Header.RecordSize = sizeof(FRMG_MRMCTakeRecord);
+	Header.PayloadSize = RMG_MRMC_TAKE_PAYLOAD_SIZE;
+	Header.IndexStride = RMG_MRMC_TAKE_INDEX_STRIDE;
+	Header.NumStreams = Recorder->StreamSequence.Num();
+	Header.RecordCapacity = Capacity;
+	Header.IndexOffset = IndexOffset;
+	Header.RecordOffset = RecordOffset;
+	Header.StartUnixMicroseconds = (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTicks() / ETimespan::TicksPerMicrosecond;
+	Header.StartPlatformSeconds = FPlatformTime::Seconds();
+
+	Recorder->Header = &Header;
+	Recorder->Index = reinterpret_cast<double*>(Recorder->Base + IndexOffset);
+	Recorder->Records = reinterpret_cast<FRMG_MRMCTakeRecord*>(Recorder->Base + RecordOffset);
+
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: recording take to %s, %llu records, %llu MB"), *InFilename, Capacity, FileSize >> 20);
+	return Recorder;
+}
+
+FRMG_MRMCTakeRecorder::~FRMG_MRMCTakeRecorder()
+{
+	if (Base == nullptr)
+	{
+		return;
+	}
+
+	Header->Flags |= RMG_MRMC_TAKE_FLAG_FINALIZED;
+	const uint64 UsedSize = Header->RecordOffset + Header->RecordCount * sizeof(FRMG_MRMCTakeRecord);
+
+	UE_LOG(LogTemp, Log, TEXT("RMG_MRMC: take %s closed, %llu records, %llu dropped"), *Filename, Header->RecordCount, Header->DroppedCount);
+	Unmap(UsedSize);
+}
+
+bool FRMG_MRMCTakeRecorder::Append(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds)
+{
+	const uint64 Count = Header->RecordCount;
+	if (Count == Header->RecordCapacity)
+	{
+		Header->DroppedCount++;
+		return false;
+	}
+
+	FRMG_MRMCTakeRecord& Record = Records[Count];
+	Record.ReceiveSeconds = ReceiveSeconds;
+	Record.Sequence = StreamSequence[Stream]++;
+	Record.Stream = static_cast<uint16>(Stream);
+	Record.Size = static_cast<uint16>(FMath::Min(Size, 0xffff));
+	const int32 Kept = FMath::Min(Size, RMG_MRMC_TAKE_PAYLOAD_SIZE);
+	FMemory::Memcpy(Record.Data, Data, Kept);
+	FMemory::Memzero(Record.Data + Kept, RMG_MRMC_TAKE_PAYLOAD_SIZE - Kept);
+
+	if (Count % RMG_MRMC_TAKE_INDEX_STRIDE == 0)
+	{
+		Index[Count / RMG_MRMC_TAKE_INDEX_STRIDE] = ReceiveSeconds;
+	}
+
+	// publish after the record and index entry, so a concurrent reader never sees a half written record
+	FPlatformAtomics::AtomicStore(reinterpret_cast<volatile int64*>(&Header->RecordCount), static_cast<int64>(Count + 1));
+	return true;
+}
+
+#if PLATFORM_WINDOWS
+
+bool FRMG_MRMCTakeRecorder::Map(uint64 FileSize)
+{
+	// FILE_SHARE_READ lets tools open the take while it is being written
+	HANDLE File = CreateFileW(*Filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: cannot create take %s (error %u)"), *Filename, GetLastError());
+		return false;
+	}
+
+	HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READWRITE, static_cast<DWORD>(FileSize >> 32), static_cast<DWORD>(FileSize), nullptr);
+	void* View = Mapping != nullptr ? MapViewOfFile(Mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(FileSize)) : nullptr;
+	if (View == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: cannot map take %s (error %u)"), *Filename, GetLastError());
+		if (Mapping != nullptr)
+		{
+			CloseHandle(Mapping);
+		}
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle = File;
+	MappingHandle = Mapping;
+	Base = static_cast<uint8*>(View);
+	MappedSize = FileSize;
+	return true;
+}
+
+void FRMG_MRMCTakeRecorder::Unmap(uint64 UsedSize)
+{
+	FlushViewOfFile(Base, 0);
+	UnmapViewOfFile(Base);
+	CloseHandle(MappingHandle);
+
+	LARGE_INTEGER End;
+	End.QuadPart = static_cast<LONGLONG>(UsedSize);
+	SetFilePointerEx(FileHandle, End, nullptr, FILE_BEGIN);
+	SetEndOfFile(FileHandle);
+	CloseHandle(FileHandle);
+
+	Base = nullptr;
+}
+
+#else
+
+bool FRMG_MRMCTakeRecorder::Map(uint64 FileSize)
+{
+	const FTCHARToUTF8 Path(*Filename);
+	const int Fd = open(Path.Get(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (Fd < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: cannot create take %s (errno %d)"), *Filename, errno);
+		return false;
+	}
+
+	// reserve the blocks up front, a sparse file would allocate them on first write
+	bool bSized = ftruncate(Fd, static_cast<off_t>(FileSize)) == 0;
+#if PLATFORM_LINUX
+	bSized = bSized && posix_fallocate(Fd, 0, static_cast<off_t>(FileSize)) == 0;
+#endif
+	void* View = bSized ? mmap(nullptr, FileSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0) : MAP_FAILED;
+	if (View == MAP_FAILED)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RMG_MRMC: cannot map take %s (errno %d)"), *Filename, errno);
+		close(Fd);
+		return false;
+	}
+
+	FileDescriptor = Fd;
+	Base = static_cast<uint8*>(View);
+	MappedSize = FileSize;
+	return true;
+}
+
+void FRMG_MRMCTakeRecorder::Unmap(uint64 UsedSize)
+{
+	msync(Base, MappedSize, MS_SYNC);
+	munmap(Base, MappedSize);
+	ftruncate(FileDescriptor, static_cast<off_t>(UsedSize));
+	close(FileDescriptor);
+
+	Base = nullptr;
+}
+
+#endif
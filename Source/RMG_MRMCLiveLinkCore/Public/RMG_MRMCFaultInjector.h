@@ -0,0 +1,57 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Templates/Function.h"
+
+// Network impairment applied to received datagrams before they reach the pipeline
+struct FRMG_MRMCFaultOptions
+{
+	// Probabilities per datagram, 0 - 1
+	float Loss = 0.0f;
+	float Reorder = 0.0f;
+	float Duplicate = 0.0f;
+
+	// Same seed, same faults for the same input, so a replayed take reproduces a run exactly
+	int32 Seed = 0;
+
+	bool IsEnabled() const { return Loss > 0.0f || Reorder > 0.0f || Duplicate > 0.0f; }
+};
+
+// Drops, duplicates and reorders datagrams per stream, to exercise sequence tracking and gap filling
+// against a live or replayed stream. A reordered datagram is held back and delivered right after the
+// next one of its stream, stamped with that one's receive time. Called from one thread only; the held datagrams are preallocated.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCFaultInjector
+{
+public:
+
+	typedef TFunctionRef<void(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds)> FSink;
+
+	FRMG_MRMCFaultInjector(const FRMG_MRMCFaultOptions& InOptions, int32 NumStreams);
+
+	// Passes the datagram on to Sink zero, one or two times, possibly after a held back one
+	void Process(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds, FSink Sink);
+
+	uint64 GetDropped() const { return Dropped; }
+	uint64 GetDuplicated() const { return Duplicated; }
+	uint64 GetReordered() const { return Reordered; }
+
+private:
+
+	struct FHeldPacket
+	{
+		bool bHeld = false;
+		int32 Size = 0;
+		uint8 Data[64];
+	};
+
+	FRMG_MRMCFaultOptions Options;
+	FRandomStream Random;
+	TArray<FHeldPacket> Held;
+
+	uint64 Dropped = 0;
+	uint64 Duplicated = 0;
+	uint64 Reordered = 0;
+};
@@ -0,0 +1,71 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FrameRate.h"
+#include "Misc/FrameTime.h"
+#include "Misc/QualifiedFrameTime.h"
+#include "Misc/Timecode.h"
+
+// Scene time of robot samples, counted from the robot's frame counter instead of from receive times.
+//
+// The first sample anchors the counter to a reference: the timecode the robot sent with it, or the receive
+// time converted at the timecode rate. Every later sample is the anchor plus its counter distance, converted
+// from the sample rate to the timecode rate with exact integer arithmetic, so hours of 50 Hz samples at
+// 23.976, 29.97 or 59.94 fps accumulate no drift and network jitter never moves a frame.
+//
+// The anchor is re-taken when the timecode rate changes, the counter jumps (robot restart) or, with sent
+// timecode, the counted frame disagrees with it (the robot was re-jammed).
+//
+// EvaluateSeconds() counts the same way on the receive clock, for keying interpolated samples. One clock
+// serves either Evaluate() or EvaluateSeconds(), since both advance the counter.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCFrameClock
+{
+public:
+
+	explicit FRMG_MRMCFrameClock(const FFrameRate& InSampleRate = FFrameRate(50, 1));
+
+	// Scene time of a sample at TimecodeRate. Reference is the sample's own timecode when the robot
+	// sends one, otherwise the receive time at TimecodeRate; it is only used to anchor.
+	FQualifiedFrameTime Evaluate(uint32 Counter, const FFrameTime& Reference, const FFrameRate& TimecodeRate, bool bReferenceIsTimecode);
+
+	// Receive time of a sample with the network jitter taken out: its counted time since the anchor plus the
+	// receive delay of the quickest datagrams, so consecutive samples are one sample period apart. Re-anchors
+	// on a counter jump or when the counted time falls a second behind the receive time.
+	double EvaluateSeconds(uint32 Counter, double ReceiveSeconds);
+
+	// Counter distance from the anchor converted to TimecodeRate frames; exposed for checks
+	static FFrameTime CountToFrames(int64 Count, const FFrameRate& SampleRate, const FFrameRate& TimecodeRate);
+
+	void Reset() { bAnchored = false; bSecondsAnchored = false; bCounting = false; }
+
+	const FFrameRate& GetSampleRate() const { return SampleRate; }
+
+	// Number of times the anchor was re-taken after the first
+	int32 GetReanchorCount() const { return ReanchorCount; }
+
+private:
+
+	// Unwraps Counter into Index; returns true when it jumped too far from the last one to be the same run
+	bool Advance(uint32 Counter);
+
+	FFrameRate SampleRate;
+
+	bool bAnchored;
+	FFrameRate AnchorRate;
+	FFrameTime AnchorTime;
+	int64 AnchorIndex;
+
+	// Receive time of the anchor sample less the smallest receive delay since, for EvaluateSeconds()
+	bool bSecondsAnchored;
+	double SecondsOffset;
+	int64 SecondsAnchorIndex;
+
+	// Counter unwrapped to 64 bits, and its last raw value
+	bool bCounting;
+	int64 Index;
+	uint32 LastCounter;
+
+	int32 ReanchorCount;
+};
@@ -0,0 +1,99 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/QualifiedFrameTime.h"
+
+// LiveLink role a subject is pushed as
+enum class ERMG_MRMCSubjectRole : uint8
+{
+	// Skeleton of the mapped bones with the mapped properties
+	Animation,
+	// One camera transform with lens values, see CameraRole
+	Camera,
+};
+
+// Skeleton of one subject, pushed once before its frames
+struct FRMG_MRMCSubjectStaticData
+{
+	FName SubjectName;
+	ERMG_MRMCSubjectRole Role = ERMG_MRMCSubjectRole::Animation;
+
+	// Animation role
+	TArray<FName> BoneNames;
+	TArray<int32> BoneParents;
+	TArray<FName> PropertyNames;
+
+	// Camera role: which lens values the frames carry, and the filmback in mm
+	bool bHasFocalLength = false;
+	bool bHasFocusDistance = false;
+	FVector2D Filmback = FVector2D::ZeroVector;
+};
+
+// One evaluated frame of a subject
+struct FRMG_MRMCSubjectFrame
+{
+	FName SubjectName;
+	ERMG_MRMCSubjectRole Role = ERMG_MRMCSubjectRole::Animation;
+	double WorldSeconds = 0.0;
+	FQualifiedFrameTime SceneTime;
+
+	// Animation role
+	TArray<FTransform> Transforms;
+	TArray<float> PropertyValues;
+
+	// Camera role: the camera transform relative to the subject root, horizontal field of view in degrees,
+	// focal length in mm and focus distance in cm
+	FTransform CameraTransform;
+	float FieldOfView = 0.0f;
+	float AspectRatio = 0.0f;
+	float FocalLength = 0.0f;
+	float FocusDistance = 0.0f;
+};
+
+// Destination of assembled subjects. The plugin forwards them to ILiveLinkClient; headless
+// tools and benchmarks capture them instead. Called from whichever thread processes packets.
+class IRMG_MRMCFrameSink
+{
+public:
+
+	virtual ~IRMG_MRMCFrameSink() {}
+
+	virtual void PushStaticData(FRMG_MRMCSubjectStaticData&& StaticData) = 0;
+
+	virtual void PushFrame(FRMG_MRMCSubjectFrame&& Frame) = 0;
+
+	// Called when a reloaded mapping no longer has the subject
+	virtual void RemoveSubject(FName SubjectName) = 0;
+};
+
+// Keeps everything pushed to it, standing in for LiveLink outside the editor
+class FRMG_MRMCCaptureFrameSink : public IRMG_MRMCFrameSink
+{
+public:
+
+	virtual void PushStaticData(FRMG_MRMCSubjectStaticData&& InStaticData) override
+	{
+		StaticData.Add(InStaticData.SubjectName, MoveTemp(InStaticData));
+	}
+
+	virtual void PushFrame(FRMG_MRMCSubjectFrame&& Frame) override
+	{
+		Frames.Add(MoveTemp(Frame));
+	}
+
+	virtual void RemoveSubject(FName SubjectName) override
+	{
+		StaticData.Remove(SubjectName);
+	}
+
+	void Reset()
+	{
+		StaticData.Reset();
+		Frames.Reset();
+	}
+
+	TMap<FName, FRMG_MRMCSubjectStaticData> StaticData;
+	TArray<FRMG_MRMCSubjectFrame> Frames;
+};
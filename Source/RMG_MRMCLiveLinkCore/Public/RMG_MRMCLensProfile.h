@@ -0,0 +1,137 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCRobotData.h"
+
+// One calibration curve: measured (encoder, value) points joined by a monotone cubic, so the curve passes
+// through every measurement and never overshoots between them
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCLensCurve
+{
+public:
+
+	// Points must have strictly increasing inputs
+	bool Set(const TArray<FVector2D>& InPoints, FString& OutError);
+
+	bool IsEmpty() const { return Points.Num() == 0; }
+
+	float GetMinInput() const { return Points.Num() > 0 ? Points[0].X : 0.0f; }
+	float GetMaxInput() const { return Points.Num() > 0 ? Points.Last().X : 0.0f; }
+
+	// Direct evaluation, a binary search and a cubic; inputs outside the measured range clamp to the ends
+	float Evaluate(float Input) const;
+
+private:
+
+	TArray<FVector2D> Points;
+
+	// Curve slope at each point
+	TArray<float> Tangents;
+};
+
+// A curve sampled on a uniform grid. Evaluating it is a scale, a clamp and a lerp with no search or branch,
+// which is what runs per frame.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCLensLut
+{
+public:
+
+	// Samples Curve with the fewest entries, doubling from 256 up to 65536, that keep the linear
+	// interpolation within RelativeTolerance of the curve everywhere. Returns the largest relative error found.
+	float Build(const FRMG_MRMCLensCurve& Curve, float RelativeTolerance);
+
+	bool IsEmpty() const { return Table.Num() == 0; }
+
+	// Number of segments; the table holds one more entry plus the repeated last one
+	int32 Num() const { return FMath::Max(Table.Num() - 2, 0); }
+
+	FORCEINLINE float Evaluate(float Input) const
+	{
+		// Max before Min so a NaN input lands on the first entry, as the curve clamps it, instead of indexing
+		// outside the table
+		const float Position = FMath::Min(FMath::Max((Input - InputMin) * InputScale, 0.0f), MaxPosition);
+		const int32 Index = static_cast<int32>(Position);
+		const float Alpha = Position - static_cast<float>(Index);
+		// the table ends with a repeated entry, so Index + 1 is valid even at MaxPosition
+		const float* Entry = Table.GetData() + Index;
+		return Entry[0] + (Entry[1] - Entry[0]) * Alpha;
+	}
+
+private:
+
+	// Largest difference between the table and Curve halfway between entries, relative to the curve value
+	// but never to less than Floor
+	float MeasureError(const FRMG_MRMCLensCurve& Curve, float Floor) const;
+
+	TArray<float> Table;
+	float InputMin = 0.0f;
+	float InputScale = 0.0f;
+	float MaxPosition = 0.0f;
+};
+
+// Per-lens calibration, mapping the robot's raw zoom and focus encoders to focal length, focus distance and
+// radial distortion. Loaded from JSON:
+//
+//   { "name": "Fujinon HA19x7.4",
+//     "zoom": { "focalLength": [[0, 7.4], [65535, 137]], "k1": [[0, -0.08], [65535, 0.01]], "k2": [[0, 0.01], [65535, 0]] },
+//     "focus": { "distance": [[0, 60], [65535, 100000]] } }
+//
+// Each curve is a list of [encoder, value] points; focal length is in millimeters, focus distance in
+// centimeters. Any curve may be left out, the channel then keeps its unprofiled value.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCLensProfile
+{
+public:
+
+	static bool Compile(const FString& JsonString, FRMG_MRMCLensProfile& OutProfile, FString& OutError);
+
+	// Relative paths resolve against the project directory
+	static bool Load(const FString& LensFile, FRMG_MRMCLensProfile& OutProfile, FString& OutError);
+
+	bool IsEmpty() const { return FocalLength.IsEmpty() && FocusDistance.IsEmpty() && K1.IsEmpty() && K2.IsEmpty(); }
+
+	// Whether Zoom carries focal length in mm rather than the raw encoder
+	bool HasFocalLength() const { return !FocalLength.IsEmpty(); }
+
+	// Overwrites the Zoom, Focus and distortion channels of a converted frame from the sample's raw encoders
+	FORCEINLINE void Apply(const RobotData& Sample, float* Values) const
+	{
+		if (!FocalLength.IsEmpty())
+		{
+			Values[RMG_MRMCChannel::Zoom] = FocalLength.Evaluate(Sample.zoom);
+		}
+		if (!FocusDistance.IsEmpty())
+		{
+			Values[RMG_MRMCChannel::Focus] = FocusDistance.Evaluate(Sample.focus);
+		}
+		if (!K1.IsEmpty())
+		{
+			Values[RMG_MRMCChannel::DistortionK1] = K1.Evaluate(Sample.zoom);
+		}
+		if (!K2.IsEmpty())
+		{
+			Values[RMG_MRMCChannel::DistortionK2] = K2.Evaluate(Sample.zoom);
+		}
+	}
+
+	const FString& GetName() const { return Name; }
+
+	// Largest relative lookup error of the tables, as found when building them
+	float GetLutError() const { return FMath::Max(FMath::Max(FocalLengthError, FocusDistanceError), FMath::Max(K1Error, K2Error)); }
+
+	// Total table entries
+	int32 GetLutSize() const { return FocalLength.Num() + FocusDistance.Num() + K1.Num() + K2.Num(); }
+
+private:
+
+	FString Name;
+
+	FRMG_MRMCLensLut FocalLength;
+	FRMG_MRMCLensLut FocusDistance;
+	FRMG_MRMCLensLut K1;
+	FRMG_MRMCLensLut K2;
+
+	float FocalLengthError = 0.0f;
+	float FocusDistanceError = 0.0f;
+	float K1Error = 0.0f;
+	float K2Error = 0.0f;
+};
@@ -0,0 +1,194 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCRobotData.h"
+
+// Flair datagram variants, told apart by their exact size
+enum class ERMG_MRMCPacketVariant : uint8
+{
+	// Nine floats: camera xyz, target xyz, roll, focus, zoom
+	Basic,
+	// Basic followed by a uint32 frame counter
+	FrameCounter,
+	// FrameCounter followed by a packed uint32 timecode, see FRMG_MRMCDecodedPacket::Timecode
+	Timecode,
+};
+
+// Everything read from one datagram
+struct FRMG_MRMCDecodedPacket
+{
+	RobotData Robot;
+
+	ERMG_MRMCPacketVariant Variant = ERMG_MRMCPacketVariant::Basic;
+
+	// Robot frame index, valid unless Variant is Basic
+	uint32 FrameCounter = 0;
+
+	// Timecode of the sample as hours << 24 | minutes << 16 | seconds << 8 | frames, valid for the Timecode variant
+	uint32 Timecode = 0;
+
+	bool HasFrameCounter() const { return Variant != ERMG_MRMCPacketVariant::Basic; }
+	bool HasTimecode() const { return Variant == ERMG_MRMCPacketVariant::Timecode; }
+};
+
+// Packet layouts described at compile time. Each field names its type, byte offset and byte order and is
+// read in place from the receive buffer, so decoding never copies the datagram or allocates.
+namespace RMG_MRMCPacketLayout
+{
+	enum class EEndian : uint8
+	{
+		Little,
+		Big,
+	};
+
+	template<EEndian Endian>
+	FORCEINLINE uint32 Load32(const uint8* Bytes)
+	{
+		return Endian == EEndian::Little
+			? uint32(Bytes[0]) | uint32(Bytes[1]) << 8 | uint32(Bytes[2]) << 16 | uint32(Bytes[3]) << 24
+			: uint32(Bytes[3]) | uint32(Bytes[2]) << 8 | uint32(Bytes[1]) << 16 | uint32(Bytes[0]) << 24;
+	}
+
+	template<EEndian Endian>
+	FORCEINLINE void Store32(uint32 Value, uint8* Bytes)
+	{
+		for (int32 Idx = 0; Idx < 4; Idx++)
+		{
+			const int32 Shift = Endian == EEndian::Little ? Idx * 8 : (3 - Idx) * 8;
+			Bytes[Idx] = static_cast<uint8>(Value >> Shift);
+		}
+	}
+
+	// One 32-bit field of a layout
+	template<typename T, int32 InOffset, EEndian Endian = EEndian::Little>
+	struct TField
+	{
+		static_assert(sizeof(T) == 4, "packet fields are 32 bits wide");
+
+		static constexpr int32 Offset = InOffset;
+		static constexpr int32 End = InOffset + 4;
+
+		static FORCEINLINE T Read(const uint8* Data)
+		{
+			const uint32 Bits = Load32<Endian>(Data + Offset);
+			T Value;
+			FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+			return Value;
+		}
+
+		static FORCEINLINE void Write(T Value, uint8* Data)
+		{
+			uint32 Bits;
+			FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+			Store32<Endian>(Bits, Data + Offset);
+		}
+	};
+
+	// The original 36-byte RobotData datagram
+	struct FBasic
+	{
+		static constexpr ERMG_MRMCPacketVariant Variant = ERMG_MRMCPacketVariant::Basic;
+		static constexpr int32 Size = 36;
+
+		typedef TField<float, 0> CameraX;
+		typedef TField<float, 4> CameraY;
+		typedef TField<float, 8> CameraZ;
+		typedef TField<float, 12> TargetX;
+		typedef TField<float, 16> TargetY;
+		typedef TField<float, 20> TargetZ;
+		typedef TField<float, 24> Roll;
+		typedef TField<float, 28> Focus;
+		typedef TField<float, 32> Zoom;
+	};
+
+	struct FWithFrameCounter : FBasic
+	{
+		static constexpr ERMG_MRMCPacketVariant Variant = ERMG_MRMCPacketVariant::FrameCounter;
+		static constexpr int32 Size = 40;
+
+		typedef TField<uint32, 36> FrameCounter;
+	};
+
+	struct FWithTimecode : FWithFrameCounter
+	{
+		static constexpr ERMG_MRMCPacketVariant Variant = ERMG_MRMCPacketVariant::Timecode;
+		static constexpr int32 Size = 44;
+
+		typedef TField<uint32, 40> Timecode;
+	};
+
+	static_assert(FBasic::Zoom::End == FBasic::Size, "basic layout must cover the datagram");
+	static_assert(FWithFrameCounter::FrameCounter::Offset == FBasic::Size && FWithFrameCounter::FrameCounter::End == FWithFrameCounter::Size, "frame counter follows the basic layout");
+	static_assert(FWithTimecode::Timecode::Offset == FWithFrameCounter::Size && FWithTimecode::Timecode::End == FWithTimecode::Size, "timecode follows the frame counter");
+
+	// Header a relaying source may put in front of a forwarded datagram: a magic word, a version and the
+	// time the relay received the datagram as nanoseconds since the Unix epoch, split into two words
+	struct FRelayHeader
+	{
+		static constexpr int32 Size = 16;
+		static constexpr uint32 MagicValue = 0x52474d52; // 'RMGR'
+		static constexpr uint32 VersionValue = 1;
+
+		typedef TField<uint32, 0> Magic;
+		typedef TField<uint32, 4> Version;
+		typedef TField<uint32, 8> ReceiveNsLow;
+		typedef TField<uint32, 12> ReceiveNsHigh;
+	};
+
+	static_assert(FRelayHeader::ReceiveNsHigh::End == FRelayHeader::Size, "relay header fields must cover the header");
+
+	// Reads every field of Layout; Data must hold at least Layout::Size bytes
+	template<typename Layout>
+	FORCEINLINE void ReadSample(const uint8* Data, RobotData& Out)
+	{
+		Out.xv = Layout::CameraX::Read(Data);
+		Out.yv = Layout::CameraY::Read(Data);
+		Out.zv = Layout::CameraZ::Read(Data);
+		Out.xt = Layout::TargetX::Read(Data);
+		Out.yt = Layout::TargetY::Read(Data);
+		Out.zt = Layout::TargetZ::Read(Data);
+		Out.roll = Layout::Roll::Read(Data);
+		Out.focus = Layout::Focus::Read(Data);
+		Out.zoom = Layout::Zoom::Read(Data);
+	}
+
+	template<typename Layout>
+	FORCEINLINE void WriteSample(const RobotData& Sample, uint8* Data)
+	{
+		Layout::CameraX::Write(Sample.xv, Data);
+		Layout::CameraY::Write(Sample.yv, Data);
+		Layout::CameraZ::Write(Sample.zv, Data);
+		Layout::TargetX::Write(Sample.xt, Data);
+		Layout::TargetY::Write(Sample.yt, Data);
+		Layout::TargetZ::Write(Sample.zt, Data);
+		Layout::Roll::Write(Sample.roll, Data);
+		Layout::Focus::Write(Sample.focus, Data);
+		Layout::Zoom::Write(Sample.zoom, Data);
+	}
+}
+
+// Turns a Flair datagram into RobotData
+namespace RMG_MRMCPacketDecoder
+{
+	// Size of the basic RobotData datagram, nine little endian floats
+	const int32 RobotDataSize = RMG_MRMCPacketLayout::FBasic::Size;
+
+	// Largest datagram any variant uses
+	const int32 MaxPacketSize = RMG_MRMCPacketLayout::FWithTimecode::Size;
+
+	// Decodes a datagram whose size matches one of the variants exactly. Returns false, leaving OutPacket
+	// untouched, for any other size, so a changed layout is rejected instead of read as garbage.
+	RMG_MRMCLIVELINKCORE_API bool Decode(const uint8* Data, int32 Size, FRMG_MRMCDecodedPacket& OutPacket);
+
+	// Writes Packet in its variant's layout and returns the datagram size; Data needs MaxPacketSize bytes
+	RMG_MRMCLIVELINKCORE_API int32 Encode(const FRMG_MRMCDecodedPacket& Packet, uint8* Data);
+
+	// Writes a relay header for a datagram received at ReceiveUnixNs; Header needs FRelayHeader::Size bytes
+	RMG_MRMCLIVELINKCORE_API void WriteRelayHeader(int64 ReceiveUnixNs, uint8* Header);
+
+	// When Data starts with a relay header, advances Data and Size past it, sets OutReceiveUnixNs and returns
+	// true. Plain datagrams are left alone.
+	RMG_MRMCLIVELINKCORE_API bool StripRelayHeader(const uint8*& Data, int32& Size, int64& OutReceiveUnixNs);
+}
@@ -0,0 +1,44 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCRobotData.h"
+
+// Flair samples in structure-of-arrays layout, one plane per RobotData field
+struct FRMG_MRMCRobotSamples
+{
+	const float* Xv = nullptr;
+	const float* Yv = nullptr;
+	const float* Zv = nullptr;
+	const float* Xt = nullptr;
+	const float* Yt = nullptr;
+	const float* Zt = nullptr;
+	const float* Roll = nullptr;
+	const float* Focus = nullptr;
+	const float* Zoom = nullptr;
+
+	int32 Num = 0;
+};
+
+// Destination planes, Channels[RMG_MRMCChannel::Pan][i] is the pan of sample i. Each plane must hold Num floats.
+struct FRMG_MRMCChannelPlanes
+{
+	float* Channels[RMG_MRMCChannel::Num];
+};
+
+// Converts robot samples to LiveLink channels: meters to centimeters, Y flipped into UE's
+// coordinate system, pan/tilt from the camera-to-target vector and roll in degrees.
+// Runs four samples per iteration on the platform vector unit (SSE or NEON through VectorRegister).
+namespace RMG_MRMCPoseKernel
+{
+	// Bulk conversion for replay, offline rendering and multi-robot streams
+	RMG_MRMCLIVELINKCORE_API void ConvertSamples(const FRMG_MRMCRobotSamples& Samples, FRMG_MRMCChannelPlanes& OutPlanes);
+
+	// Single live sample into a frame value buffer of RMG_MRMC_FRAME_VALUE_COUNT floats.
+	// Uses the same vector code as ConvertSamples, so both paths produce identical values.
+	RMG_MRMCLIVELINKCORE_API void ConvertSample(const RobotData& Sample, float* OutValues);
+
+	// Polynomial atan2 used by the kernel, in radians. Absolute error stays below 5e-7 rad over the whole plane.
+	RMG_MRMCLIVELINKCORE_API float ATan2(float Y, float X);
+}
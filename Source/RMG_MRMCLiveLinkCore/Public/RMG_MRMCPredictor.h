@@ -0,0 +1,70 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCRobotData.h"
+
+// Constant-acceleration Kalman filter run independently on every channel of the robot stream.
+// Extrapolating the filtered state by a lead time hides the fixed network/LiveLink/render delay
+// between the physical rig and the virtual camera.
+// Not thread safe; owned by whichever thread consumes packets.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCPredictor
+{
+public:
+
+	// ProcessNoise is the white-jerk spectral density and MeasurementNoise the sample variance, both in channel units
+	FRMG_MRMCPredictor(float InLeadSeconds, float InProcessNoise, float InMeasurementNoise);
+
+	// Filters one sample received at Seconds, then overwrites Values with the prediction for Seconds + lead time
+	void Process(double Seconds, float* Values);
+
+	void Reset();
+
+	// RMS difference between the value predicted for a time and the value the robot then reported for it,
+	// smoothed over roughly the last hundred samples. Use it to tune the lead time.
+	float GetLeadErrorRms(int32 Channel) const { return FMath::Sqrt(LeadErrorMeanSquared[Channel]); }
+
+	int32 GetNumSamples() const { return NumSamples; }
+
+	// Whether every channel's error covariance is still symmetric positive semi-definite, for checks
+	bool IsCovarianceValid() const;
+
+	// Difference between two values of Channel, taken the short way round for the angles that wrap
+	static float WrapDifference(int32 Channel, float Difference);
+
+private:
+
+	struct FChannelState
+	{
+		// position, velocity, acceleration
+		double X[3];
+		double P[3][3];
+	};
+
+	struct FPendingPrediction
+	{
+		double TargetSeconds;
+		float Values[RMG_MRMCChannel::Num];
+	};
+
+	void UpdateChannel(int32 Channel, double DeltaSeconds, double Measurement);
+	double PredictChannel(int32 Channel, double LeadSeconds) const;
+	void ScoreDuePredictions(double Seconds, const float* Values);
+
+	float LeadSeconds;
+	double ProcessNoise;
+	double MeasurementNoise;
+
+	FChannelState Channels[RMG_MRMCChannel::Num];
+	double LastSeconds;
+	float LastValues[RMG_MRMCChannel::Num];
+	int32 NumSamples;
+
+	// Predictions waiting for the robot to reach their target time
+	TArray<FPendingPrediction> Pending;
+	int32 PendingFirst;
+	int32 PendingCount;
+
+	float LeadErrorMeanSquared[RMG_MRMCChannel::Num];
+};
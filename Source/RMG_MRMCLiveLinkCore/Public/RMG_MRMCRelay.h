@@ -0,0 +1,74 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+class FInternetAddr;
+class FSocket;
+
+// Forwards received datagrams to the source's RelayEndpoints, so one machine receiving the robot can feed
+// every render node. Forward() runs on the receive thread, never
+// allocates, and sends the payload from the receive buffer wherever the platform can gather it with the header.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCRelay
+{
+public:
+
+	virtual ~FRMG_MRMCRelay() {}
+
+	virtual bool IsValid() const = 0;
+
+	// Sends Data, behind a relay header when timestamps are on, to every target. Returns the number of
+	// targets the send failed for; a full send buffer fails instead of blocking the receive thread.
+	virtual int32 Forward(const uint8* Data, int32 Size, double ReceiveSeconds) = 0;
+
+	virtual const TCHAR* GetName() const = 0;
+
+	int32 GetNumTargets() const { return NumTargets; }
+	uint64 GetForwarded() const { return Forwarded; }
+	uint64 GetFailed() const { return Failed; }
+
+	// FPlatformTime::Seconds() times to and from nanoseconds since the Unix epoch, for the relay header
+	static int64 ToUnixNs(double Seconds);
+	static double FromUnixNs(int64 UnixNs);
+
+	// Relays to RelayEndpoints, behind a relay header when bAddTimestamp is set, multicast limited to RelayTtl
+	// hops. Targets that are also receive endpoints are left out, they would relay to themselves forever.
+	// Returns null when no target remains.
+	static TUniquePtr<FRMG_MRMCRelay> Create(const TArray<FIPv4Endpoint>& ReceiveEndpoints, const TArray<FIPv4Endpoint>& RelayEndpoints, bool bAddTimestamp, int32 RelayTtl);
+
+protected:
+
+	int32 NumTargets = 0;
+	uint64 Forwarded = 0;
+	uint64 Failed = 0;
+};
+
+// Portable relay on one FSocket, one SendTo per target. FSocket cannot gather, so with timestamps the
+// datagram is copied behind the header in a preallocated buffer.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCSocketRelay : public FRMG_MRMCRelay
+{
+public:
+
+	FRMG_MRMCSocketRelay(const TArray<FIPv4Endpoint>& Targets, bool bInTimestamp, int32 Ttl);
+	virtual ~FRMG_MRMCSocketRelay();
+
+	virtual bool IsValid() const override { return Socket != nullptr; }
+	virtual int32 Forward(const uint8* Data, int32 Size, double ReceiveSeconds) override;
+	virtual const TCHAR* GetName() const override { return TEXT("Socket"); }
+
+private:
+
+	FSocket* Socket;
+	TArray<TSharedRef<FInternetAddr>> TargetAddresses;
+	bool bTimestamp;
+
+	// Header followed by the datagram, only used with timestamps
+	TArray<uint8> SendBuffer;
+};
+
+#if PLATFORM_LINUX
+// sendmmsg relay reaching every target in one system call, see Linux/RMG_MRMCLinuxRelay.cpp
+TUniquePtr<FRMG_MRMCRelay> CreateLinuxRelay(const TArray<FIPv4Endpoint>& Targets, bool bTimestamp, int32 Ttl);
+#endif
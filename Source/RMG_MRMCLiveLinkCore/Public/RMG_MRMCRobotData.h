@@ -0,0 +1,48 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One Flair sample as sent on the wire: camera and target position in meters, roll in radians
+struct RobotData {
+	float xv = 0.0f;
+	float yv = 0.0f;
+	float zv = 0.0f;
+	float xt = 0.0f;
+	float yt = 0.0f;
+	float zt = 0.0f;
+	float roll = 0.0f;
+	float focus = 0.0f;
+	float zoom = 0.0f;
+};
+
+// Channels computed from every Flair sample; the "index" fields of a mapping refer to these
+namespace RMG_MRMCChannel
+{
+	enum Type : int32
+	{
+		CameraPoseX,		// 0  cm
+		CameraPoseY,		// 1
+		CameraPoseZ,		// 2
+		RollDegrees,		// 3  x rotation
+		Tilt,				// 4  y rotation
+		Pan,				// 5  z rotation
+		Roll,				// 6  raw robot roll
+		Focus,				// 7
+		Zoom,				// 8
+		CameraTargetX,		// 9  cm
+		CameraTargetY,		// 10
+		CameraTargetZ,		// 11
+		DistortionK1,		// 12 radial distortion, from a lens profile
+		DistortionK2,		// 13
+
+		Num,
+
+		// Always 0. Unmapped or out of range indices are compiled to point here.
+		Zero = Num,
+	};
+}
+
+// Size of a frame value buffer, including the trailing zero channel
+#define RMG_MRMC_FRAME_VALUE_COUNT (RMG_MRMCChannel::Num + 1)
@@ -0,0 +1,47 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCRobotData.h"
+
+// One converted robot sample and the time it was received, on the FPlatformTime::Seconds() clock;
+// see FRMG_MRMCFrameClock::EvaluateSeconds() for taking the network jitter out of it
+struct FRMG_MRMCSample
+{
+	double Seconds = 0.0;
+	float Values[RMG_MRMC_FRAME_VALUE_COUNT];
+};
+
+// Fixed-capacity, time-ordered history of converted samples, used to resample the 50 Hz robot
+// stream at the engine's frame time instead of dropping packets that arrive between frames.
+// Not thread safe; owned by whichever thread consumes packets.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCSampleHistory
+{
+public:
+
+	explicit FRMG_MRMCSampleHistory(int32 InCapacity = 256);
+
+	// Adds a sample, keeping the history ordered by time. When full the oldest sample is overwritten,
+	// or the new one dropped if it is older still.
+	void Add(double Seconds, const float* Values);
+
+	// Finds the samples surrounding Seconds. Alpha is the blend weight of OutNext; outside the
+	// recorded range both outputs are the nearest end sample. Up to MaxExtrapolationSeconds past the
+	// newest sample the two newest are returned with Alpha above 1 instead, continuing their motion.
+	// Returns false while the history is empty.
+	bool Sample(double Seconds, const FRMG_MRMCSample*& OutPrevious, const FRMG_MRMCSample*& OutNext, float& OutAlpha, double MaxExtrapolationSeconds = 0.0) const;
+
+	int32 Num() const { return Count; }
+
+	void Reset() { Count = 0; Oldest = 0; }
+
+private:
+
+	const FRMG_MRMCSample& Get(int32 Index) const { return Samples[(Oldest + Index) % Samples.Num()]; }
+	FRMG_MRMCSample& Get(int32 Index) { return Samples[(Oldest + Index) % Samples.Num()]; }
+
+	TArray<FRMG_MRMCSample> Samples;
+	int32 Oldest;
+	int32 Count;
+};
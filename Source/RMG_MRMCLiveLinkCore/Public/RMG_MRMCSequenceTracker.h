@@ -0,0 +1,95 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCPacketDecoder.h"
+
+// Counter jump, in frames, treated as a robot restart rather than loss or reordering
+#define RMG_MRMC_SEQUENCE_RESYNC 250
+
+// What to do with a received datagram
+enum class ERMG_MRMCSequenceVerdict : uint8
+{
+	// Newer than anything seen so far
+	Accept,
+	// A copy of a datagram already accepted
+	Duplicate,
+	// Older than the newest accepted datagram: reordered or delayed on the way
+	Stale,
+};
+
+// Orders the datagrams of one robot stream so a late or repeated packet never moves the camera backwards,
+// and counts what the network lost.
+//
+// Datagrams carrying a Flair frame counter are ordered by it, with a 64 frame window remembering which
+// recent counters arrived: a counter seen before is a duplicate, an unseen older one is stale and no
+// longer counts as lost. A jump of more than RMG_MRMC_SEQUENCE_RESYNC frames either way is taken as the
+// robot restarting and resynchronizes without counting a gap.
+//
+// Basic datagrams have no counter, so only arrival order is available: a byte-identical payload arriving
+// within a quarter of the nominal period is a duplicate, and an interval of more than 1.5 periods is a
+// gap of the missing number of periods. Reordering cannot be detected without a counter.
+//
+// With ProcessingMode=Mailbox the consumer only sees the newest datagram; the ones it passed over are
+// reported with AddSuperseded() and count neither as lost nor as a gap.
+//
+// Not thread safe; owned by whichever thread consumes packets.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCSequenceTracker
+{
+public:
+
+	FRMG_MRMCSequenceTracker();
+
+	// Classifies a decoded datagram. OutLostChange is the change to the lost frame count this datagram implies:
+	// the gap in front of an accepted datagram, or -1 for a stale datagram that had been counted as lost.
+	ERMG_MRMCSequenceVerdict Check(const uint8* Data, int32 Size, const FRMG_MRMCDecodedPacket& Packet, double ReceiveSeconds, int32& OutLostChange);
+
+	void Reset();
+
+	// Datagrams that arrived but were overwritten in a mailbox before being read, in front of the next one
+	// checked. They are not counted as lost, and the rate is not learned across them.
+	void AddSuperseded(uint32 Count) { PendingSuperseded += Count; }
+
+	bool HasFrameCounter() const { return bHasCounter; }
+
+	// Running estimate of the time between two robot frames
+	double GetNominalPeriod() const { return NominalPeriod; }
+
+	uint64 GetAccepted() const { return Accepted; }
+	uint64 GetDuplicates() const { return Duplicates; }
+	uint64 GetStale() const { return Stale; }
+	uint64 GetLost() const { return Lost; }
+	uint64 GetGaps() const { return Gaps; }
+	uint32 GetLongestGap() const { return LongestGap; }
+
+private:
+
+	ERMG_MRMCSequenceVerdict CheckCounter(uint32 Counter, int32& OutLostChange);
+	ERMG_MRMCSequenceVerdict CheckArrival(const uint8* Data, int32 Size, double ReceiveSeconds, int32& OutLostChange);
+	void CountGap(uint32 Missing, int32& OutLostChange);
+
+	bool bStarted;
+	bool bHasCounter;
+
+	// Newest accepted counter, and bit N set when counter LastCounter - N was received
+	uint32 LastCounter;
+	uint64 ReceivedWindow;
+
+	// Arrival time and payload of the newest accepted datagram
+	double LastSeconds;
+	uint8 LastPayload[RMG_MRMCPacketDecoder::MaxPacketSize];
+	int32 LastPayloadSize;
+
+	double NominalPeriod;
+
+	// Passed over by the consumer since the last accepted datagram, see AddSuperseded()
+	uint32 PendingSuperseded;
+
+	uint64 Accepted;
+	uint64 Duplicates;
+	uint64 Stale;
+	uint64 Lost;
+	uint64 Gaps;
+	uint32 LongestGap;
+};
@@ -0,0 +1,211 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+// Layout of the named shared-memory ring that producers on the engine machine (Flair, a simulator, the
+// motion-control bridge) write datagrams into instead of sending them over UDP, see Backend=SharedMemory.
+// Only standard headers are used so producers can include this file without the engine.
+//
+// The ring lives in a region of sizeof(FRing) bytes named after SharedMemoryName: /dev/shm/<name> on
+// Linux (shm_open("/<name>")), a named file mapping "Local\<name>" on Windows. Whoever opens it first
+// finds Magic unset and initializes it; a zeroed region is a valid empty ring apart from the header words.
+//
+// Producers claim a slot by incrementing WriteIndex, so several may share the ring. Each slot is a
+// seqlock: its Sequence is odd while being written and 2 * Index + 2 once published, which lets the
+// reader notice a slot that was overwritten while it was copying. The ring never blocks a producer; a
+// reader that falls more than NumSlots behind loses the oldest datagrams. FReader is the reader side.
+//
+// The reader sleeps on WakeCount. After publishing, a producer that sees ReaderWaiting set increments
+// WakeCount and wakes it: FUTEX_WAKE on Linux (see WakeReader), SetEvent on the auto-reset event
+// "Local\<name>Wake" on Windows.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace RMG_MRMCSharedMemory
+{
+	static constexpr uint32_t MagicValue = 0x53474d52; // 'RMGS'
+	static constexpr uint32_t VersionValue = 1;
+
+	// Power of two, 64 KiB of slots
+	static constexpr uint32_t NumSlots = 1024;
+
+	// Largest datagram a slot holds, the timecode variant
+	static constexpr uint32_t MaxDatagram = 44;
+
+	// One datagram in one cache line
+	struct alignas(64) FSlot
+	{
+		std::atomic<uint64_t> Sequence;
+
+		// When the producer wrote the datagram, in nanoseconds since the Unix epoch (CLOCK_REALTIME)
+		int64_t WriteUnixNs;
+
+		// Stream index, as the endpoint index of a UDP source
+		uint16_t Stream;
+		uint16_t Size;
+		uint8_t Data[MaxDatagram];
+	};
+
+	static_assert(sizeof(FSlot) == 64, "a slot is one cache line");
+	static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "ring atomics must be lock free to work across processes");
+
+	struct FRing
+	{
+		std::atomic<uint32_t> Magic;
+		uint32_t Version;
+		uint32_t SlotCount;
+		uint32_t SlotSize;
+
+		// Next index a producer claims; slot Index % NumSlots
+		alignas(64) std::atomic<uint64_t> WriteIndex;
+
+		// Futex word the reader sleeps on, and whether it is about to
+		alignas(64) std::atomic<uint32_t> WakeCount;
+		std::atomic<uint32_t> ReaderWaiting;
+
+		alignas(64) FSlot Slots[NumSlots];
+	};
+
+	inline uint64_t PublishedSequence(uint64_t Index) { return 2 * Index + 2; }
+
+	// Sets up the header of a region that does not carry one yet. Returns false when it holds another
+	// layout version.
+	inline bool Initialize(FRing& Ring)
+	{
+		if (Ring.Magic.load(std::memory_order_acquire) == MagicValue)
+		{
+			return Ring.Version == VersionValue && Ring.SlotCount == NumSlots && Ring.SlotSize == sizeof(FSlot);
+		}
+		Ring.Version = VersionValue;
+		Ring.SlotCount = NumSlots;
+		Ring.SlotSize = sizeof(FSlot);
+		Ring.Magic.store(MagicValue, std::memory_order_release);
+		return true;
+	}
+
+	// Producer side: copies one datagram into the next slot and publishes it. Returns true when the reader
+	// is asleep and has to be woken.
+	inline bool Write(FRing& Ring, uint16_t Stream, const uint8_t* Data, uint32_t Size, int64_t WriteUnixNs)
+	{
+		const uint64_t Index = Ring.WriteIndex.fetch_add(1, std::memory_order_relaxed);
+		FSlot& Slot = Ring.Slots[Index & (NumSlots - 1)];
+
+		Slot.Sequence.store(PublishedSequence(Index) - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Slot.WriteUnixNs = WriteUnixNs;
+		Slot.Stream = Stream;
+		Slot.Size = static_cast<uint16_t>(Size < MaxDatagram ? Size : MaxDatagram);
+		std::memcpy(Slot.Data, Data, Slot.Size);
+
+		// sequentially consistent with the reader's ReaderWaiting store, so either it sees this slot or we see it waiting
+		Slot.Sequence.store(PublishedSequence(Index), std::memory_order_seq_cst);
+		return Ring.ReaderWaiting.load(std::memory_order_seq_cst) != 0;
+	}
+
+	// Reader side: where the reader is in the ring and what it lost
+	struct FReader
+	{
+		// Next index to read
+		uint64_t ReadIndex = 0;
+
+		// Datagrams overwritten by the producers before or while they were read
+		uint64_t Overruns = 0;
+
+		// A datagram copied out of its slot, so the sink never sees a slot the producers are rewriting
+		uint8_t Buffer[MaxDatagram];
+
+		// Skips whatever was written before the reader opened the ring
+		void Open(const FRing& Ring)
+		{
+			ReadIndex = Ring.WriteIndex.load(std::memory_order_acquire);
+		}
+
+		bool HasPending(const FRing& Ring) const
+		{
+			const FSlot& Slot = Ring.Slots[ReadIndex & (NumSlots - 1)];
+			return Slot.Sequence.load() >= PublishedSequence(ReadIndex) || Ring.WriteIndex.load() < ReadIndex;
+		}
+
+		// Calls Sink(Stream, Data, Size, WriteUnixNs) for every datagram published since the last call, in
+		// order, and returns how many it passed. Stops at the first slot that is claimed but not yet published.
+		template <typename SinkType>
+		uint32_t Drain(const FRing& Ring, SinkType&& Sink)
+		{
+			const uint64_t WriteIndex = Ring.WriteIndex.load(std::memory_order_acquire);
+			if (WriteIndex < ReadIndex)
+			{
+				// the region was recreated under us
+				ReadIndex = WriteIndex;
+			}
+			else if (WriteIndex - ReadIndex > NumSlots)
+			{
+				Overruns += WriteIndex - ReadIndex - NumSlots;
+				ReadIndex = WriteIndex - NumSlots;
+			}
+
+			uint32_t Received = 0;
+			for (;;)
+			{
+				const FSlot& Slot = Ring.Slots[ReadIndex & (NumSlots - 1)];
+				const uint64_t Sequence = Slot.Sequence.load(std::memory_order_acquire);
+				const uint64_t Expected = PublishedSequence(ReadIndex);
+				if (Sequence < Expected)
+				{
+					// not published yet
+					break;
+				}
+				ReadIndex++;
+				if (Sequence > Expected)
+				{
+					// lapped by the producers
+					Overruns++;
+					continue;
+				}
+
+				// copy out, then check the producers did not come round again while we were copying
+				const int64_t WriteUnixNs = Slot.WriteUnixNs;
+				const uint16_t Stream = Slot.Stream;
+				const uint32_t Size = Slot.Size < MaxDatagram ? Slot.Size : MaxDatagram;
+				std::memcpy(Buffer, Slot.Data, Size);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Slot.Sequence.load(std::memory_order_relaxed) != Sequence)
+				{
+					Overruns++;
+					continue;
+				}
+
+				Sink(Stream, static_cast<const uint8_t*>(Buffer), Size, WriteUnixNs);
+				Received++;
+			}
+			return Received;
+		}
+	};
+
+#if defined(__linux__)
+	inline void WakeReader(FRing& Ring)
+	{
+		Ring.WakeCount.fetch_add(1, std::memory_order_seq_cst);
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Ring.WakeCount), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+	}
+
+	// Sleeps until WakeCount moves off ExpectedWakeCount or TimeoutSeconds pass. Set ReaderWaiting and read
+	// ExpectedWakeCount before the last look at the ring, see Write.
+	inline void WaitForWake(FRing& Ring, uint32_t ExpectedWakeCount, double TimeoutSeconds)
+	{
+		timespec Timeout;
+		Timeout.tv_sec = static_cast<time_t>(TimeoutSeconds);
+		Timeout.tv_nsec = static_cast<long>((TimeoutSeconds - Timeout.tv_sec) * 1e9);
+		// not FUTEX_PRIVATE_FLAG, the producers are other processes
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Ring.WakeCount), FUTEX_WAIT, ExpectedWakeCount, &Timeout, nullptr, 0);
+	}
+#endif
+}
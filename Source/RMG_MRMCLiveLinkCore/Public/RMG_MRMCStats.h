@@ -0,0 +1,144 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Collection budget per packet. A packet passes at most RMG_MRMC_STATS_RECORDS_PER_PACKET timed records
+// (receive, transit, relay, handoff, decode, push, jitter); sources measure the cost on start and collect nothing above it.
+// 1 us is 0.005% of a 50 Hz period and well below the cost of the LiveLink push itself.
+#define RMG_MRMC_STATS_BUDGET_NS 1000.0
+#define RMG_MRMC_STATS_RECORDS_PER_PACKET 7
+
+// Log-linear latency histogram in nanoseconds, HDR style: eight linear sub-buckets per power of two,
+// so any recorded value is reported within 12.5% over the whole 1 ns - 9 hour range.
+// Record() is a handful of integer ops and one relaxed atomic add; any thread may record or read.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCLatencyHistogram
+{
+public:
+
+	FRMG_MRMCLatencyHistogram();
+
+	void Record(uint64 Nanoseconds);
+
+	void RecordSeconds(double Seconds) { Record(Seconds > 0.0 ? static_cast<uint64>(Seconds * 1e9) : 0); }
+
+	uint64 GetCount() const { return Count.load(std::memory_order_relaxed); }
+	uint64 GetMax() const { return Max.load(std::memory_order_relaxed); }
+	double GetMean() const;
+
+	// Highest value of the bucket holding the given percentile (0-100), 0 while empty
+	uint64 GetPercentile(double Percentile) const;
+
+	void Reset();
+
+private:
+
+	static const int32 SubBucketBits = 3;
+	static const int32 SubBucketCount = 1 << SubBucketBits;
+	static const int32 MaxMagnitude = 45;
+	static const int32 BucketCount = (MaxMagnitude - SubBucketBits + 2) * SubBucketCount;
+
+	static int32 GetBucket(uint64 Value);
+	static uint64 GetBucketUpperBound(int32 Bucket);
+
+	std::atomic<uint64> Buckets[BucketCount];
+	std::atomic<uint64> Count;
+	std::atomic<uint64> Sum;
+	std::atomic<uint64> Max;
+};
+
+// Instrumented stages of the packet path
+namespace RMG_MRMCStage
+{
+	enum Type : int32
+	{
+		// Kernel receive timestamp to the receive thread's callback
+		Receive,
+		// Time a packet waited in the ring for the processing thread
+		Handoff,
+		// Decode, conversion and prediction of one packet
+		Decode,
+		// Assembling and pushing all subjects of one frame
+		Push,
+		// Change of the inter-arrival interval between consecutive packets of a stream
+		Jitter,
+		// Forwarding one datagram to every relay target
+		Relay,
+		// Time in a datagram's relay header to its local receive time: one-way latency from a relay or the
+		// simulator's --timestamp. Only meaningful when both clocks agree, e.g. on one machine or under PTP.
+		Transit,
+		Num
+	};
+
+	RMG_MRMCLIVELINKCORE_API const TCHAR* GetName(Type Stage);
+}
+
+// Counters and stage histograms of one source. Everything is lock-free; writers on the receive and
+// game threads never wait on readers. Collection costs a few hundred nanoseconds per packet at most,
+// see MeasureRecordOverheadNs().
+struct RMG_MRMCLIVELINKCORE_API FRMG_MRMCStats
+{
+	std::atomic<uint64> PacketsReceived;
+	// Lost because the packet ring was full
+	std::atomic<uint64> PacketsDropped;
+	// Overwritten by a newer datagram before the game thread read them, with ProcessingMode=Mailbox
+	std::atomic<uint64> PacketsSuperseded;
+	// Not the size of any known packet variant
+	std::atomic<uint64> PacketsMalformed;
+	// Discarded by sequence tracking, see FRMG_MRMCSequenceTracker
+	std::atomic<uint64> PacketsDuplicate;
+	std::atomic<uint64> PacketsStale;
+	// Robot frames that never arrived, and the runs of them
+	std::atomic<uint64> FramesLost;
+	std::atomic<uint64> Gaps;
+	// Extrapolated frames pushed while a gap lasted
+	std::atomic<uint64> FramesFilled;
+	// Decoded but not pushed because they arrived faster than the timecode rate
+	std::atomic<uint64> FramesSkipped;
+	std::atomic<uint64> FramesPushed;
+	// Datagrams forwarded to relay targets, and sends that failed
+	std::atomic<uint64> PacketsRelayed;
+	std::atomic<uint64> RelayFailures;
+
+	FRMG_MRMCLatencyHistogram Stages[RMG_MRMCStage::Num];
+
+	FRMG_MRMCStats();
+
+	void Reset();
+
+	// One line summary for the LiveLink panel. PacketsPerSecond is computed by the caller between two calls.
+	FString ToStatusString(double PacketsPerSecond) const;
+
+	// Writes counters and per-stage count, mean, percentiles and max in microseconds
+	bool WriteCsv(const FString& Filename) const;
+
+	// Average cost of one timed stage record (two cycle counter reads plus Record()), measured on a scratch histogram
+	static double MeasureRecordOverheadNs();
+};
+
+// Times a scope into one histogram; does nothing when the histogram is null
+class FRMG_MRMCStageTimer
+{
+public:
+
+	explicit FRMG_MRMCStageTimer(FRMG_MRMCLatencyHistogram* InHistogram)
+	: Histogram(InHistogram)
+	, StartCycles(InHistogram != nullptr ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FRMG_MRMCStageTimer()
+	{
+		if (Histogram != nullptr)
+		{
+			Histogram->RecordSeconds(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+	}
+
+private:
+
+	FRMG_MRMCLatencyHistogram* Histogram;
+	uint64 StartCycles;
+};
@@ -0,0 +1,152 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/QualifiedFrameTime.h"
+#include "RMG_MRMCFrameClock.h"
+#include "RMG_MRMCFrameSink.h"
+#include "RMG_MRMCLensProfile.h"
+#include "RMG_MRMCPredictor.h"
+#include "RMG_MRMCRobotData.h"
+#include "RMG_MRMCSampleHistory.h"
+#include "RMG_MRMCSequenceTracker.h"
+#include "RMG_MRMCStats.h"
+#include "RMG_MRMCSubjectMapping.h"
+
+// How received samples become frames
+struct FRMG_MRMCProcessingOptions
+{
+	// Buffer samples for PushInterpolatedFrame() instead of pushing a frame per packet
+	bool bInterpolate = false;
+
+	// Constant-acceleration prediction, see FRMG_MRMCPredictor. 0 disables it.
+	float PredictionLeadMs = 0.0f;
+	float PredictionProcessNoise = 1.0e5f;
+	float PredictionMeasurementNoise = 0.01f;
+
+	// Keep the camera moving through gaps up to this long by continuing the motion of the last two
+	// samples. 0 holds the last pose instead.
+	float GapFillMs = 0.0f;
+
+	// Rate of the robot's frame counter, used to count scene time from it
+	FFrameRate SampleRate = FFrameRate(50, 1);
+
+	// Push subjects the mapping gives a "camera" object as LiveLink Camera role frames
+	bool bCameraRole = false;
+};
+
+// Decode, conversion, prediction and frame assembly for one robot stream, with no dependency on
+// sockets, LiveLink or the engine. Not thread safe; owned by whichever thread consumes packets.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCStreamProcessor
+{
+public:
+
+	FRMG_MRMCStreamProcessor(const FRMG_MRMCCompiledMapping& InMapping, const FRMG_MRMCProcessingOptions& InOptions);
+
+	// Counters and decode, push and jitter timings go here; null (the default) collects nothing
+	void SetStats(FRMG_MRMCStats* InStats) { Stats = InStats; }
+
+	// Maps the raw zoom and focus encoders through the profile's tables from the next packet on
+	void SetLensProfile(const FRMG_MRMCLensProfile& InLensProfile) { LensProfile = InLensProfile; }
+
+	// Pushes the skeleton of every mapped subject
+	void PushStaticData(IRMG_MRMCFrameSink& Sink) const;
+
+	// Switches to a reloaded mapping between two packets. Only subjects that are new or whose bones or
+	// properties changed get their static data pushed again, and subjects no longer mapped are removed;
+	// the rest keep streaming without a break. Returns the number of subjects pushed.
+	int32 SetMapping(const FRMG_MRMCCompiledMapping& NewMapping, IRMG_MRMCFrameSink& Sink);
+
+	// Decodes and converts one datagram. Without interpolation the subjects are pushed straight away,
+	// skipping packets that arrive faster than the timecode rate; with it the sample is only buffered.
+	// Returns false when the datagram could not be decoded or was discarded as stale or duplicate.
+	bool ProcessPacket(const uint8* Data, int32 Size, double ReceiveSeconds, IRMG_MRMCFrameSink& Sink);
+
+	// Count datagrams a mailbox overwrote before the next ProcessPacket(), so they are not taken for loss
+	void AddSuperseded(uint32 Count);
+
+	// Pushes the subjects resampled from the buffered samples at EvaluationSeconds, extrapolated
+	// past the newest sample for up to GapFillMs
+	void PushInterpolatedFrame(double EvaluationSeconds, const FQualifiedFrameTime& SceneTime, IRMG_MRMCFrameSink& Sink);
+
+	// Without interpolation: pushes an extrapolated frame when the stream has been silent for more than
+	// one and a half periods but less than GapFillMs, at most once per period. Call regularly from the
+	// thread that processes packets.
+	void FillGap(double NowSeconds, IRMG_MRMCFrameSink& Sink);
+
+	const FRMG_MRMCSequenceTracker& GetSequence() const { return Sequence; }
+
+	const FRMG_MRMCFrameClock& GetFrameClock() const { return FrameClock; }
+
+	const FRMG_MRMCCompiledMapping& GetMapping() const { return Mapping; }
+
+	// Null unless prediction is enabled
+	const FRMG_MRMCPredictor* GetPredictor() const { return Predictor.Get(); }
+
+private:
+
+	// Scene time of a sample at the engine timecode rate: counted from the frame counter when the packet
+	// has one, otherwise its sent timecode or receive time
+	FQualifiedFrameTime MakeSceneTime(const FRMG_MRMCDecodedPacket& Packet, double ReceiveSeconds);
+
+	bool SkipFrame(const FRMG_MRMCDecodedPacket& Packet, double ReceiveSeconds, FQualifiedFrameTime& SceneTime);
+
+	void PushSubjectStaticData(int32 SubjectIdx, IRMG_MRMCFrameSink& Sink) const;
+
+	// Index of the subject's camera in the mapping when it is pushed with the Camera role, else INDEX_NONE
+	int32 GetCamera(int32 SubjectIdx) const { return Options.bCameraRole ? Mapping.SubjectCamera[SubjectIdx] : INDEX_NONE; }
+
+	void RecordArrival(double ReceiveSeconds);
+	void CountSequence(ERMG_MRMCSequenceVerdict Verdict, int32 LostChange);
+
+	// Pushes every subject, blending from Values towards NextValues by Alpha
+	void PushSubjectFrames(const float* Values, const float* NextValues, float Alpha, double WorldSeconds, const FQualifiedFrameTime& SceneTime, IRMG_MRMCFrameSink& Sink) const;
+
+	FRMG_MRMCCompiledMapping Mapping;
+
+	FRMG_MRMCProcessingOptions Options;
+
+	// Channel values of the current sample, sized once; see RMG_MRMCChannel
+	TArray<float> FrameValues;
+
+	// Sample before FrameValues and the extrapolation scratch, only used for gap filling
+	TArray<float> PreviousValues;
+	TArray<float> GapValues;
+	double PreviousSeconds;
+	double LatestSeconds;
+	double LastFillSeconds;
+
+	// Drops stale and duplicate datagrams and counts losses
+	FRMG_MRMCSequenceTracker Sequence;
+
+	// Timestamped samples waiting to be resampled when interpolating, keyed by FrameClock's counted receive time
+	// when the packets carry a frame counter
+	FRMG_MRMCSampleHistory History;
+
+	// Focal length, focus distance and distortion tables; empty leaves Zoom and Focus as converted
+	FRMG_MRMCLensProfile LensProfile;
+
+	// Lead-time extrapolation of decoded samples, null unless PredictionLeadMs is set
+	TUniquePtr<FRMG_MRMCPredictor> Predictor;
+
+	// Scene time counted from the robot frame counter
+	FRMG_MRMCFrameClock FrameClock;
+
+	// Receive time, or counted timecode frame, of the last frame pushed without interpolation, for
+	// frame-rate skipping
+	double LastPushSeconds;
+	bool bHasPushedFrame;
+	FFrameNumber LastPushFrame;
+
+	// Scene time of the last sample and whether it was counted, continued by FillGap()
+	bool bCountedSceneTime;
+	FQualifiedFrameTime LastSceneTime;
+
+	// Shared with the other streams of the source, may be null
+	FRMG_MRMCStats* Stats;
+
+	// Receive time of the previous packet and the interval before it, for jitter
+	double LastReceiveSeconds;
+	double LastInterval;
+};
@@ -0,0 +1,66 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCRobotData.h"
+
+// Subject mapping compiled from JSON into flat structure-of-arrays form.
+// All channel indices are validated at compile time, so evaluating a frame is a loop over integers.
+struct RMG_MRMCLIVELINKCORE_API FRMG_MRMCCompiledMapping
+{
+	// Per subject
+	TArray<FName> SubjectNames;
+	TArray<int32> SubjectFirstBone;
+	TArray<int32> SubjectNumBones;
+	TArray<int32> SubjectFirstProperty;
+	TArray<int32> SubjectNumProperties;
+
+	// Per bone, three channels each for location and euler rotation
+	TArray<int32> LocationChannels;
+	TArray<int32> RotationChannels;
+	TArray<bool> BoneHasRotation;
+
+	// Per property
+	TArray<int32> PropertyChannels;
+
+	// Skeleton layout, only read when pushing static data
+	TArray<FName> BoneNames;
+	TArray<int32> BoneParents;
+	TArray<FName> PropertyNames;
+
+	// Per subject, the index of its camera below, or INDEX_NONE when the mapping gives it no "camera" object
+	TArray<int32> SubjectCamera;
+
+	// Per camera, what the subject is pushed as with the LiveLink Camera role: the bone, within the subject,
+	// whose transform relative to the subject root is the camera's, the channels of focal length (mm) and
+	// focus distance (cm), and the filmback size in mm
+	TArray<int32> CameraBone;
+	TArray<int32> CameraFocalLengthChannel;
+	TArray<int32> CameraFocusDistanceChannel;
+	TArray<FVector2D> CameraFilmback;
+
+	int32 NumSubjects() const { return SubjectNames.Num(); }
+
+	// Index of the named subject, INDEX_NONE when it is not mapped
+	int32 FindSubject(FName SubjectName) const { return SubjectNames.IndexOfByKey(SubjectName); }
+
+	// True when subject SubjectIdx has the same bones, parents, properties, camera filmback and mapped lens
+	// values as subject OtherIdx of Other, i.e. the same static data. The channels feeding them may differ.
+	bool HasSameLayout(int32 SubjectIdx, const FRMG_MRMCCompiledMapping& Other, int32 OtherIdx) const;
+
+	void Reset();
+
+	// Parses and validates a mapping. An empty string compiles the built-in robot_camera/camera_target mapping.
+	static bool Compile(const FString& JsonString, FRMG_MRMCCompiledMapping& OutMapping, FString& OutError);
+
+	// Loads a mapping file, relative paths resolving against the project directory; an empty path loads the
+	// built-in mapping. Compiled mappings are cached in Saved/RMG_MRMCLiveLink keyed by the hash of the JSON,
+	// so unchanged files are not reparsed on reconnect or editor restart.
+	static bool Load(const FString& MappingFile, FRMG_MRMCCompiledMapping& OutMapping, FString& OutError);
+
+	// True when all arrays agree in size, every channel index is in range and every parent chain reaches the root
+	bool IsConsistent() const;
+
+	friend FArchive& operator<<(FArchive& Ar, FRMG_MRMCCompiledMapping& Mapping);
+};
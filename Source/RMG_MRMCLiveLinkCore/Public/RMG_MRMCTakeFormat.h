@@ -0,0 +1,78 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// On-disk layout of a recorded take, written by FRMG_MRMCTakeRecorder.
+//
+//   [FRMG_MRMCTakeHeader]                        HeaderSize bytes
+//   [double x IndexCapacity]                     receive time of every IndexStride-th record, at IndexOffset
+//   [FRMG_MRMCTakeRecord x RecordCapacity]       at RecordOffset
+//
+// All values are little endian. The file is preallocated and records are only ever appended, so a reader
+// may map it while it is still being written: read RecordCount (8-byte aligned, written with release
+// semantics after the record and its index entry), then only look at records below it.
+// A finalized take is truncated to RecordOffset + RecordCount * RecordSize.
+
+#define RMG_MRMC_TAKE_MAGIC 0x544d4752 // 'RGMT'
+#define RMG_MRMC_TAKE_VERSION 1
+
+// Datagram bytes kept per record; the basic Flair RobotData packet is 36 bytes
+#define RMG_MRMC_TAKE_PAYLOAD_SIZE 44
+
+// Records between two index entries
+#define RMG_MRMC_TAKE_INDEX_STRIDE 1024
+
+// Set once the recorder closed the take cleanly
+#define RMG_MRMC_TAKE_FLAG_FINALIZED 0x1
+
+struct FRMG_MRMCTakeHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 HeaderSize;
+	uint32 RecordSize;
+	uint32 PayloadSize;
+	uint32 IndexStride;
+	uint32 NumStreams;
+	uint32 Flags;
+
+	uint64 RecordCapacity;
+	uint64 IndexOffset;
+	uint64 RecordOffset;
+
+	// UTC wall clock when recording started, and the matching FPlatformTime::Seconds() value, so
+	// record times can be converted to wall clock time
+	int64 StartUnixMicroseconds;
+	double StartPlatformSeconds;
+
+	// Records appended so far; the reader's only synchronization point
+	uint64 RecordCount;
+
+	// Datagrams not recorded because the take was full
+	uint64 DroppedCount;
+
+	uint8 Reserved[256 - 88];
+};
+
+struct FRMG_MRMCTakeRecord
+{
+	// FPlatformTime::Seconds() when the datagram was received
+	double ReceiveSeconds;
+
+	// Per-stream arrival index, starting at 0
+	uint64 Sequence;
+
+	// Stream the datagram arrived on
+	uint16 Stream;
+
+	// Size of the datagram on the wire; only the first RMG_MRMC_TAKE_PAYLOAD_SIZE bytes are kept
+	uint16 Size;
+
+	uint8 Data[RMG_MRMC_TAKE_PAYLOAD_SIZE];
+};
+
+static_assert(sizeof(FRMG_MRMCTakeHeader) == 256, "take header layout is part of the file format");
+static_assert(STRUCT_OFFSET(FRMG_MRMCTakeHeader, RecordCount) == 72, "take header layout is part of the file format");
+static_assert(sizeof(FRMG_MRMCTakeRecord) == 64, "take record layout is part of the file format");
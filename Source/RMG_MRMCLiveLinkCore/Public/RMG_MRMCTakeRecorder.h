@@ -0,0 +1,54 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RMG_MRMCTakeFormat.h"
+
+// Appends raw datagrams to a preallocated, memory-mapped take file (see RMG_MRMCTakeFormat.h).
+// The whole file is sized and its pages faulted in when the take is opened, so Append() is a
+// memcpy into mapped memory and never waits on the disk; the OS writes pages back in the background.
+// Append() may only be called from one thread. Opening and closing happen on the thread that owns the source.
+class RMG_MRMCLIVELINKCORE_API FRMG_MRMCTakeRecorder
+{
+public:
+
+	// Creates the take file with room for Capacity records. Returns null and logs when the file cannot be mapped.
+	static TUniquePtr<FRMG_MRMCTakeRecorder> Open(const FString& Filename, uint64 Capacity, int32 NumStreams);
+
+	// Marks the take finalized, unmaps it and trims the unused record space
+	~FRMG_MRMCTakeRecorder();
+
+	// Receive thread. Returns false and counts a drop once the take is full.
+	bool Append(int32 Stream, const uint8* Data, int32 Size, double ReceiveSeconds);
+
+	uint64 GetRecordCount() const { return Header->RecordCount; }
+	uint64 GetDroppedCount() const { return Header->DroppedCount; }
+	const FString& GetFilename() const { return Filename; }
+
+private:
+
+	FRMG_MRMCTakeRecorder() {}
+
+	bool Map(uint64 FileSize);
+	void Unmap(uint64 UsedSize);
+
+	FString Filename;
+
+	uint8* Base = nullptr;
+	uint64 MappedSize = 0;
+
+	FRMG_MRMCTakeHeader* Header = nullptr;
+	double* Index = nullptr;
+	FRMG_MRMCTakeRecord* Records = nullptr;
+
+	// Next sequence number per stream
+	TArray<uint64> StreamSequence;
+
+#if PLATFORM_WINDOWS
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#else
+	int FileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,27 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+// Packet decode, pose conversion, subject mapping, frame assembly, take recording and the relay. Depends on
+// Core, Json and the socket layer only, so it links into headless programs without the editor or LiveLink.
+public class RMG_MRMCLiveLinkCore : ModuleRules
+{
+	public RMG_MRMCLiveLinkCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"Networking",
+			});
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Json",
+				"Sockets",
+			});
+	}
+}
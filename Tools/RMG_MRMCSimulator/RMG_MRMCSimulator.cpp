@@ -0,0 +1,683 @@
+// Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
+
+// Stand-in for Flair: sends RobotData datagrams to the plugin from scripted trajectories or a recorded take,
+// at 50 Hz up to tens of kHz, on any number of streams, with optional jitter, bursts and send timestamps.
+// Standalone, no engine needed:
+//
+//   g++ -std=c++14 -O2 -pthread -I Source/RMG_MRMCLiveLinkCore/Public Tools/RMG_MRMCSimulator/RMG_MRMCSimulator.cpp -o rmg_mrmc_simulator
+//   cl /std:c++14 /O2 /EHsc /I Source\RMG_MRMCLiveLinkCore\Public Tools\RMG_MRMCSimulator\RMG_MRMCSimulator.cpp ws2_32.lib
+//
+// Run with --help for the options.
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET FSocketHandle;
+#define RMG_MRMC_INVALID_SOCKET INVALID_SOCKET
+#define RMG_MRMC_CLOSE_SOCKET closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int FSocketHandle;
+#define RMG_MRMC_INVALID_SOCKET -1
+#define RMG_MRMC_CLOSE_SOCKET close
+#endif
+
+#if defined(__linux__)
+#include "RMG_MRMCSharedMemoryRing.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+// Datagram layouts, see RMG_MRMCPacketLayout in RMG_MRMCPacketDecoder.h: nine little endian floats, then the
+// frame counter and the packed timecode. The relay header carries the send time.
+static const int BasicSize = 36;
+static const int FrameCounterSize = 40;
+static const int TimecodeSize = 44;
+static const int RelayHeaderSize = 16;
+static const uint32_t RelayMagic = 0x52474d52; // 'RMGR'
+static const uint32_t RelayVersion = 1;
+
+// Take file layout, see RMG_MRMCTakeFormat.h
+static const uint32_t TakeMagic = 0x544d4752; // 'RGMT'
+static const size_t TakeHeaderSize = 256;
+static const size_t TakeRecordSize = 64;
+static const size_t TakePayloadSize = 44;
+
+// Longest sleep left before a send is spun out instead, the scheduler wakes this late at worst on a quiet machine
+static const double SpinSeconds = 200e-6;
+
+typedef std::chrono::steady_clock FClock;
+
+static std::atomic<bool> bStopRequested(false);
+
+struct FSample
+{
+	// Camera and target in meters, roll in radians, raw focus and zoom encoders
+	float CameraX, CameraY, CameraZ;
+	float TargetX, TargetY, TargetZ;
+	float Roll, Focus, Zoom;
+};
+
+struct FOptions
+{
+	std::string Address = "127.0.0.1";
+	int Port = 55535;
+	int Streams = 1;
+	double Rate = 50.0;
+	double Duration = 0.0;
+	std::string Variant = "timecode";
+	std::string Trajectory = "orbit";
+	std::string TakeFile;
+	double Speed = 1.0;
+	bool bLoop = false;
+	double JitterUs = 0.0;
+	int BurstSize = 0;
+	double BurstEvery = 1.0;
+	bool bTimestamp = false;
+	int Ttl = 1;
+	double TimecodeRate = 50.0;
+	std::string SharedMemoryName;
+	unsigned Seed = 1;
+	double ReportEvery = 1.0;
+};
+
+// Send lateness in microseconds, 1 us buckets up to 10 ms
+struct FLatenessHistogram
+{
+	std::vector<uint64_t> Buckets = std::vector<uint64_t>(10001, 0);
+	uint64_t Count = 0;
+	double Max = 0.0;
+
+	void Record(double Us)
+	{
+		const double Clamped = Us < 0.0 ? 0.0 : Us;
+		Buckets[Clamped < 10000.0 ? static_cast<size_t>(Clamped) : 10000]++;
+		Count++;
+		Max = Clamped > Max ? Clamped : Max;
+	}
+
+	double Percentile(double Percent) const
+	{
+		const uint64_t Target = static_cast<uint64_t>(std::ceil(Count * Percent / 100.0));
+		uint64_t Seen = 0;
+		for (size_t Idx = 0; Idx < Buckets.size(); Idx++)
+		{
+			Seen += Buckets[Idx];
+			if (Seen >= Target && Seen > 0)
+			{
+				return static_cast<double>(Idx + 1);
+			}
+		}
+		return 0.0;
+	}
+
+	void Reset()
+	{
+		std::fill(Buckets.begin(), Buckets.end(), 0);
+		Count = 0;
+		Max = 0.0;
+	}
+};
+
+static void Store32(uint32_t Value, uint8_t* Bytes)
+{
+	for (int Idx = 0; Idx < 4; Idx++)
+	{
+		Bytes[Idx] = static_cast<uint8_t>(Value >> (Idx * 8));
+	}
+}
+
+static void StoreFloat(float Value, uint8_t* Bytes)
+{
+	uint32_t Bits;
+	std::memcpy(&Bits, &Value, sizeof(Bits));
+	Store32(Bits, Bytes);
+}
+
+static int64_t UnixNowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Scripted motion, Time in seconds; Phase shifts each stream so they do not move in lockstep
+static FSample Evaluate(const std::string& Trajectory, double Time, double Phase)
+{
+	const double Pi = 3.14159265358979323846;
+	FSample Sample = {};
+	Sample.TargetZ = 1.2f;
+	Sample.CameraZ = 1.6f;
+	Sample.CameraX = -3.0f;
+
+	const double T = Time + Phase;
+	if (Trajectory == "orbit")
+	{
+		// 3 m circle around the target every 10 s
+		Sample.CameraX = static_cast<float>(3.0 * std::cos(2.0 * Pi * T / 10.0));
+		Sample.CameraY = static_cast<float>(3.0 * std::sin(2.0 * Pi * T / 10.0));
+	}
+	else if (Trajectory == "dolly")
+	{
+		// 2 m either way along the lens axis every 8 s
+		Sample.CameraX = static_cast<float>(-3.0 + 2.0 * std::sin(2.0 * Pi * T / 8.0));
+	}
+	else if (Trajectory == "crane")
+	{
+		// rises from beside the target to straight above it and back every 12 s, tilting through vertical
+		const double Angle = 0.5 * Pi * (0.5 - 0.5 * std::cos(2.0 * Pi * T / 12.0));
+		Sample.CameraX = static_cast<float>(-2.5 * std::cos(Angle));
+		Sample.CameraZ = static_cast<float>(1.2 + 2.5 * std::sin(Angle));
+	}
+	else if (Trajectory == "shake")
+	{
+		// handheld-like: several incommensurate wobbles a few centimeters wide
+		Sample.CameraX = static_cast<float>(-3.0 + 0.02 * std::sin(2.0 * Pi * 3.1 * T) + 0.01 * std::sin(2.0 * Pi * 7.3 * T));
+		Sample.CameraY = static_cast<float>(0.02 * std::sin(2.0 * Pi * 4.7 * T + 1.0));
+		Sample.CameraZ = static_cast<float>(1.6 + 0.015 * std::sin(2.0 * Pi * 5.9 * T + 2.0));
+	}
+
+	if (Trajectory != "static")
+	{
+		Sample.Roll = static_cast<float>(0.05 * std::sin(2.0 * Pi * T / 7.0));
+		Sample.Zoom = static_cast<float>(32767.5 + 32767.5 * std::sin(2.0 * Pi * T / 20.0));
+		Sample.Focus = static_cast<float>(32767.5 + 32767.5 * std::sin(2.0 * Pi * T / 15.0));
+	}
+	return Sample;
+}
+
+// Writes the datagram for Sample in the requested variant behind an optional relay header; returns its size
+static int EncodeDatagram(const FOptions& Options, const FSample& Sample, uint32_t FrameCounter, uint32_t Timecode, uint8_t* Data)
+{
+	uint8_t* Body = Data;
+	if (Options.bTimestamp)
+	{
+		Body += RelayHeaderSize;
+	}
+
+	const float Fields[9] = { Sample.CameraX, Sample.CameraY, Sample.CameraZ, Sample.TargetX, Sample.TargetY, Sample.TargetZ, Sample.Roll, Sample.Focus, Sample.Zoom };
+	for (int Idx = 0; Idx < 9; Idx++)
+	{
+		StoreFloat(Fields[Idx], Body + Idx * 4);
+	}
+
+	int Size = BasicSize;
+	if (Options.Variant != "basic")
+	{
+		Store32(FrameCounter, Body + BasicSize);
+		Size = FrameCounterSize;
+	}
+	if (Options.Variant == "timecode")
+	{
+		Store32(Timecode, Body + FrameCounterSize);
+		Size = TimecodeSize;
+	}
+	return Options.bTimestamp ? Size + RelayHeaderSize : Size;
+}
+
+// Stamps the relay header just before the send, so the receiver measures the network and nothing else
+static void StampDatagram(const FOptions& Options, uint8_t* Data)
+{
+	if (Options.bTimestamp)
+	{
+		const uint64_t Now = static_cast<uint64_t>(UnixNowNs());
+		Store32(RelayMagic, Data);
+		Store32(RelayVersion, Data + 4);
+		Store32(static_cast<uint32_t>(Now), Data + 8);
+		Store32(static_cast<uint32_t>(Now >> 32), Data + 12);
+	}
+}
+
+// Packs the timecode of Elapsed seconds after StartSecondOfDay as hours << 24 | minutes << 16 | seconds << 8 | frames
+static uint32_t PackTimecode(double StartSecondOfDay, double Elapsed, double TimecodeRate)
+{
+	const uint64_t TotalFrames = static_cast<uint64_t>((StartSecondOfDay + Elapsed) * TimecodeRate + 1e-6);
+	const uint64_t FramesPerSecond = static_cast<uint64_t>(std::ceil(TimecodeRate));
+	const uint64_t Frames = TotalFrames % FramesPerSecond;
+	const uint64_t Seconds = (TotalFrames / FramesPerSecond) % 86400;
+	return static_cast<uint32_t>((Seconds / 3600) << 24 | ((Seconds / 60) % 60) << 16 | (Seconds % 60) << 8 | Frames);
+}
+
+// Either a UDP socket with one address per stream, or the shared-memory ring
+class FOutput
+{
+public:
+
+	bool Open(const FOptions& Options)
+	{
+		if (!Options.SharedMemoryName.empty())
+		{
+#if defined(__linux__)
+			const std::string Name = "/" + Options.SharedMemoryName;
+			const int Fd = shm_open(Name.c_str(), O_RDWR | O_CREAT, 0666);
+			if (Fd < 0 || ftruncate(Fd, sizeof(RMG_MRMCSharedMemory::FRing)) != 0)
+			{
+				std::fprintf(stderr, "cannot open shared memory %s\n", Name.c_str());
+				return false;
+			}
+			void* Address = mmap(nullptr, sizeof(RMG_MRMCSharedMemory::FRing), PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+			close(Fd);
+			if (Address == MAP_FAILED)
+			{
+				std::fprintf(stderr, "cannot map shared memory %s\n", Name.c_str());
+				return false;
+			}
+			Ring = static_cast<RMG_MRMCSharedMemory::FRing*>(Address);
+			if (!RMG_MRMCSharedMemory::Initialize(*Ring))
+			{
+				std::fprintf(stderr, "shared memory %s holds another ring layout\n", Name.c_str());
+				return false;
+			}
+			return true;
+#else
+			std::fprintf(stderr, "--shm is only supported on Linux\n");
+			return false;
+#endif
+		}
+
+#if defined(_WIN32)
+		WSADATA WsaData;
+		WSAStartup(MAKEWORD(2, 2), &WsaData);
+#endif
+		Socket = socket(AF_INET, SOCK_DGRAM, 0);
+		if (Socket == RMG_MRMC_INVALID_SOCKET)
+		{
+			std::fprintf(stderr, "cannot open a UDP socket\n");
+			return false;
+		}
+		const int SendBufferSize = 4 * 1024 * 1024;
+		const unsigned char Ttl = static_cast<unsigned char>(Options.Ttl);
+		const unsigned char Loopback = 1;
+		setsockopt(Socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&SendBufferSize), sizeof(SendBufferSize));
+		setsockopt(Socket, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char*>(&Ttl), sizeof(Ttl));
+		setsockopt(Socket, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char*>(&Loopback), sizeof(Loopback));
+
+		for (int Stream = 0; Stream < Options.Streams; Stream++)
+		{
+			sockaddr_in Target = {};
+			Target.sin_family = AF_INET;
+			Target.sin_port = htons(static_cast<uint16_t>(Options.Port + Stream));
+			if (inet_pton(AF_INET, Options.Address.c_str(), &Target.sin_addr) != 1)
+			{
+				std::fprintf(stderr, "bad address %s\n", Options.Address.c_str());
+				return false;
+			}
+			Targets.push_back(Target);
+		}
+		return true;
+	}
+
+	~FOutput()
+	{
+		if (Socket != RMG_MRMC_INVALID_SOCKET)
+		{
+			RMG_MRMC_CLOSE_SOCKET(Socket);
+		}
+#if defined(__linux__)
+		if (Ring != nullptr)
+		{
+			munmap(Ring, sizeof(RMG_MRMCSharedMemory::FRing));
+		}
+#endif
+	}
+
+	bool Send(int Stream, const uint8_t* Data, int Size)
+	{
+#if defined(__linux__)
+		if (Ring != nullptr)
+		{
+			if (RMG_MRMCSharedMemory::Write(*Ring, static_cast<uint16_t>(Stream), Data, Size, UnixNowNs()))
+			{
+				RMG_MRMCSharedMemory::WakeReader(*Ring);
+			}
+			return true;
+		}
+#endif
+		const sockaddr_in& Target = Targets[Stream];
+		return sendto(Socket, reinterpret_cast<const char*>(Data), Size, 0, reinterpret_cast<const sockaddr*>(&Target), sizeof(Target)) == Size;
+	}
+
+private:
+
+	FSocketHandle Socket = RMG_MRMC_INVALID_SOCKET;
+	std::vector<sockaddr_in> Targets;
+#if defined(__linux__)
+	RMG_MRMCSharedMemory::FRing* Ring = nullptr;
+#endif
+};
+
+// Sleeps until shortly before Deadline, then spins, so sends keep to the schedule at tens of kHz
+static void WaitUntil(FClock::time_point Deadline)
+{
+	const FClock::duration Spin = std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(SpinSeconds));
+	const FClock::time_point SleepUntil = Deadline - Spin;
+	if (FClock::now() < SleepUntil)
+	{
+		std::this_thread::sleep_until(SleepUntil);
+	}
+	while (FClock::now() < Deadline && !bStopRequested)
+	{
+	}
+}
+
+struct FTakeRecord
+{
+	double Offset;
+	int Stream;
+	std::vector<uint8_t> Payload;
+};
+
+static uint32_t Load32(const uint8_t* Bytes)
+{
+	return uint32_t(Bytes[0]) | uint32_t(Bytes[1]) << 8 | uint32_t(Bytes[2]) << 16 | uint32_t(Bytes[3]) << 24;
+}
+
+static uint64_t Load64(const uint8_t* Bytes)
+{
+	return uint64_t(Load32(Bytes)) | uint64_t(Load32(Bytes + 4)) << 32;
+}
+
+// Reads every record of a take, with its time relative to the first; returns the stream count or 0 on failure
+static int LoadTake(const std::string& Filename, std::vector<FTakeRecord>& OutRecords)
+{
+	FILE* File = std::fopen(Filename.c_str(), "rb");
+	if (File == nullptr)
+	{
+		std::fprintf(stderr, "cannot open take %s\n", Filename.c_str());
+		return 0;
+	}
+
+	uint8_t Header[TakeHeaderSize];
+	if (std::fread(Header, 1, sizeof(Header), File) != sizeof(Header) || Load32(Header) != TakeMagic || Load32(Header + 12) != TakeRecordSize)
+	{
+		std::fprintf(stderr, "%s is not a take file\n", Filename.c_str());
+		std::fclose(File);
+		return 0;
+	}
+	const int NumStreams = static_cast<int>(Load32(Header + 24));
+	const uint64_t RecordOffset = Load64(Header + 48);
+	const uint64_t RecordCount = Load64(Header + 72);
+
+	std::fseek(File, static_cast<long>(RecordOffset), SEEK_SET);
+	double FirstSeconds = 0.0;
+	uint8_t Record[TakeRecordSize];
+	for (uint64_t Idx = 0; Idx < RecordCount && std::fread(Record, 1, sizeof(Record), File) == sizeof(Record); Idx++)
+	{
+		double ReceiveSeconds;
+		std::memcpy(&ReceiveSeconds, Record, sizeof(ReceiveSeconds));
+		FirstSeconds = Idx == 0 ? ReceiveSeconds : FirstSeconds;
+
+		const uint16_t Stream = static_cast<uint16_t>(Record[16] | Record[17] << 8);
+		const uint16_t Size = static_cast<uint16_t>(Record[18] | Record[19] << 8);
+		FTakeRecord Take;
+		Take.Offset = ReceiveSeconds - FirstSeconds;
+		Take.Stream = Stream;
+		Take.Payload.assign(Record + 20, Record + 20 + (Size < TakePayloadSize ? Size : TakePayloadSize));
+		OutRecords.push_back(Take);
+	}
+	std::fclose(File);
+	return NumStreams;
+}
+
+static void PrintUsage()
+{
+	std::printf(
+		"Sends Flair RobotData datagrams to the RMG_MRMC LiveLink source.\n"
+		"\n"
+		"  --target <addr:port>      first stream's endpoint, unicast or multicast (127.0.0.1:55535)\n"
+		"  --streams <n>             streams, sent to consecutive ports from the target port (1)\n"
+		"  --rate <hz>               samples per second per stream (50)\n"
+		"  --duration <s>            stop after this long; 0 runs until interrupted (0)\n"
+		"  --variant <v>             basic, counter or timecode datagrams (timecode)\n"
+		"  --trajectory <t>          orbit, dolly, crane, shake or static (orbit)\n"
+		"  --timecode-rate <fps>     rate of the packed timecode (50)\n"
+		"  --take <file>             replay a recorded take instead, with its own timing and streams\n"
+		"  --speed <x>               take replay speed (1)\n"
+		"  --loop                    replay the take until interrupted\n"
+		"  --jitter <us>             delay each send by a random 0 - us microseconds\n"
+		"  --burst <n>               every --burst-every seconds, hold n samples back and send them at once\n"
+		"  --burst-every <s>         (1)\n"
+		"  --timestamp               put a relay header with the send time in front of every datagram\n"
+		"  --ttl <n>                 multicast hop limit (1)\n"
+		"  --shm <name>              write into the shared-memory ring <name> instead of UDP (Linux)\n"
+		"  --seed <n>                jitter seed (1)\n"
+		"  --report <s>              progress line interval (1)\n");
+}
+
+static bool ParseOptions(int Argc, char** Argv, FOptions& Options)
+{
+	for (int Idx = 1; Idx < Argc; Idx++)
+	{
+		const std::string Arg = Argv[Idx];
+		const char* Value = Idx + 1 < Argc ? Argv[Idx + 1] : nullptr;
+		auto Next = [&]() -> const char*
+		{
+			if (Value == nullptr)
+			{
+				std::fprintf(stderr, "%s needs a value\n", Arg.c_str());
+				std::exit(2);
+			}
+			Idx++;
+			return Value;
+		};
+
+		if (Arg == "--target")
+		{
+			const std::string Target = Next();
+			const size_t Colon = Target.rfind(':');
+			if (Colon == std::string::npos)
+			{
+				std::fprintf(stderr, "--target needs <addr:port>\n");
+				return false;
+			}
+			Options.Address = Target.substr(0, Colon);
+			Options.Port = std::atoi(Target.c_str() + Colon + 1);
+		}
+		else if (Arg == "--streams") Options.Streams = std::atoi(Next());
+		else if (Arg == "--rate") Options.Rate = std::atof(Next());
+		else if (Arg == "--duration") Options.Duration = std::atof(Next());
+		else if (Arg == "--variant") Options.Variant = Next();
+		else if (Arg == "--trajectory") Options.Trajectory = Next();
+		else if (Arg == "--timecode-rate") Options.TimecodeRate = std::atof(Next());
+		else if (Arg == "--take") Options.TakeFile = Next();
+		else if (Arg == "--speed") Options.Speed = std::atof(Next());
+		else if (Arg == "--loop") Options.bLoop = true;
+		else if (Arg == "--jitter") Options.JitterUs = std::atof(Next());
+		else if (Arg == "--burst") Options.BurstSize = std::atoi(Next());
+		else if (Arg == "--burst-every") Options.BurstEvery = std::atof(Next());
+		else if (Arg == "--timestamp") Options.bTimestamp = true;
+		else if (Arg == "--ttl") Options.Ttl = std::atoi(Next());
+		else if (Arg == "--shm") Options.SharedMemoryName = Next();
+		else if (Arg == "--seed") Options.Seed = static_cast<unsigned>(std::atoi(Next()));
+		else if (Arg == "--report") Options.ReportEvery = std::atof(Next());
+		else
+		{
+			PrintUsage();
+			return false;
+		}
+	}
+
+	if (Options.Rate <= 0.0 || Options.Streams < 1 || Options.Speed <= 0.0 || Options.TimecodeRate <= 0.0)
+	{
+		std::fprintf(stderr, "rate, streams, speed and timecode rate must be positive\n");
+		return false;
+	}
+	if (Options.Variant != "basic" && Options.Variant != "counter" && Options.Variant != "timecode")
+	{
+		std::fprintf(stderr, "unknown variant %s\n", Options.Variant.c_str());
+		return false;
+	}
+	if (Options.bTimestamp && !Options.SharedMemoryName.empty())
+	{
+		// ring slots carry the write time already and hold no more than the timecode datagram
+		std::fprintf(stderr, "--timestamp is ignored with --shm, ring slots carry the write time\n");
+		Options.bTimestamp = false;
+	}
+	return true;
+}
+
+int main(int Argc, char** Argv)
+{
+	FOptions Options;
+	if (!ParseOptions(Argc, Argv, Options))
+	{
+		return 2;
+	}
+
+	std::vector<FTakeRecord> Take;
+	if (!Options.TakeFile.empty())
+	{
+		Options.Streams = LoadTake(Options.TakeFile, Take);
+		if (Options.Streams == 0 || Take.empty())
+		{
+			return 1;
+		}
+	}
+
+	FOutput Output;
+	if (!Output.Open(Options))
+	{
+		return 1;
+	}
+
+	std::signal(SIGINT, [](int) { bStopRequested = true; });
+
+	std::mt19937 Random(Options.Seed);
+	std::uniform_real_distribution<double> Jitter(0.0, Options.JitterUs * 1e-6);
+
+	const std::time_t WallStart = std::time(nullptr);
+	const std::tm* Utc = std::gmtime(&WallStart);
+	const double StartSecondOfDay = Utc->tm_hour * 3600.0 + Utc->tm_min * 60.0 + Utc->tm_sec;
+
+	const uint64_t BurstPeriod = Options.BurstSize > 0 ? static_cast<uint64_t>(std::llround(Options.BurstEvery * Options.Rate)) : 0;
+
+	if (Take.empty())
+	{
+		std::printf("sending %d stream(s) of %s datagrams at %g Hz%s to %s\n", Options.Streams, Options.Variant.c_str(), Options.Rate,
+			Options.bTimestamp ? " with send timestamps" : "",
+			Options.SharedMemoryName.empty() ? (Options.Address + ":" + std::to_string(Options.Port)).c_str() : ("shared memory " + Options.SharedMemoryName).c_str());
+	}
+	else
+	{
+		std::printf("replaying %zu records of %d stream(s) at %gx\n", Take.size(), Options.Streams, Options.Speed);
+	}
+
+	FLatenessHistogram Lateness;
+	uint64_t Sent = 0;
+	uint64_t SendErrors = 0;
+	uint64_t SentAtReport = 0;
+	uint8_t Datagram[RelayHeaderSize + TimecodeSize];
+
+	const FClock::time_point Start = FClock::now() + std::chrono::milliseconds(10);
+	FClock::time_point NextReport = Start + std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(Options.ReportEvery));
+	double TakeLoopOffset = 0.0;
+
+	for (uint64_t Tick = 0; !bStopRequested; Tick++)
+	{
+		// schedule of this tick, in seconds after Start
+		double Scheduled;
+		if (Take.empty())
+		{
+			Scheduled = Tick / Options.Rate;
+			if (Options.Duration > 0.0 && Scheduled >= Options.Duration)
+			{
+				break;
+			}
+		}
+		else
+		{
+			const size_t Record = static_cast<size_t>(Tick % Take.size());
+			if (Record == 0 && Tick > 0)
+			{
+				if (!Options.bLoop)
+				{
+					break;
+				}
+				TakeLoopOffset += Take.back().Offset / Options.Speed + 1.0 / Options.Rate;
+			}
+			Scheduled = TakeLoopOffset + Take[Record].Offset / Options.Speed;
+			if (Options.Duration > 0.0 && Scheduled >= Options.Duration)
+			{
+				break;
+			}
+		}
+
+		// a burst holds the first BurstSize ticks of every period back to the time of the tick after them
+		double SendAt = Scheduled;
+		if (BurstPeriod > 0 && Take.empty() && Tick % BurstPeriod < static_cast<uint64_t>(Options.BurstSize))
+		{
+			SendAt = (Tick - Tick % BurstPeriod + Options.BurstSize) / Options.Rate;
+		}
+		if (Options.JitterUs > 0.0)
+		{
+			SendAt += Jitter(Random);
+		}
+
+		const FClock::time_point Deadline = Start + std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(SendAt));
+		WaitUntil(Deadline);
+		if (bStopRequested)
+		{
+			break;
+		}
+
+		if (Take.empty())
+		{
+			const uint32_t Timecode = PackTimecode(StartSecondOfDay, Scheduled, Options.TimecodeRate);
+			for (int Stream = 0; Stream < Options.Streams; Stream++)
+			{
+				const int Size = EncodeDatagram(Options, Evaluate(Options.Trajectory, Scheduled, Stream * 0.37), static_cast<uint32_t>(Tick), Timecode, Datagram);
+				StampDatagram(Options, Datagram);
+				SendErrors += Output.Send(Stream, Datagram, Size) ? 0 : 1;
+				Sent++;
+			}
+		}
+		else
+		{
+			const FTakeRecord& Record = Take[static_cast<size_t>(Tick % Take.size())];
+			if (Record.Stream >= Options.Streams)
+			{
+				continue;
+			}
+			uint8_t* Body = Options.bTimestamp ? Datagram + RelayHeaderSize : Datagram;
+			std::memcpy(Body, Record.Payload.data(), Record.Payload.size());
+			StampDatagram(Options, Datagram);
+			const int Size = static_cast<int>(Record.Payload.size()) + (Options.bTimestamp ? RelayHeaderSize : 0);
+			SendErrors += Output.Send(Record.Stream, Datagram, Size) ? 0 : 1;
+			Sent++;
+		}
+
+		const FClock::time_point Now = FClock::now();
+		Lateness.Record(std::chrono::duration<double, std::micro>(Now - Deadline).count());
+
+		if (Now >= NextReport)
+		{
+			const double Elapsed = std::chrono::duration<double>(Now - Start).count();
+			std::printf("%8.1f s  sent %llu  %.0f datagrams/s  late p50 %.0f us  p99 %.0f us  max %.0f us  send errors %llu\n",
+				Elapsed, static_cast<unsigned long long>(Sent), (Sent - SentAtReport) / Options.ReportEvery,
+				Lateness.Percentile(50.0), Lateness.Percentile(99.0), Lateness.Max, static_cast<unsigned long long>(SendErrors));
+			std::fflush(stdout);
+			SentAtReport = Sent;
+			Lateness.Reset();
+			NextReport += std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(Options.ReportEvery));
+		}
+	}
+
+	const double Elapsed = std::chrono::duration<double>(FClock::now() - Start).count();
+	std::printf("sent %llu datagrams in %.2f s, %llu send errors\n", static_cast<unsigned long long>(Sent), Elapsed, static_cast<unsigned long long>(SendErrors));
+	return 0;
+}